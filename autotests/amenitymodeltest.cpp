@@ -8,10 +8,14 @@
 
 #include <KOSMIndoorMap/MapData>
 
+#include <osm/geomath.h>
 #include <osm/io.h>
 
 #include <QAbstractItemModelTester>
 #include <QFile>
+#include <QPointF>
+#include <QRandomGenerator>
+#include <QSignalSpy>
 #include <QTest>
 
 using namespace KOSMIndoorMap;
@@ -29,6 +33,63 @@ Q_CONSTRUCTOR_FUNCTION(initLocale)
 class AmenityModelTest : public QObject
 {
     Q_OBJECT
+private:
+    /** @p count toilets randomly scattered around a venue, on two floor levels. */
+    [[nodiscard]] static MapData makeScatteredData(int count)
+    {
+        OSM::DataSet dataSet;
+        const auto amenityKey = dataSet.makeTagKey("amenity");
+        const auto levelKey = dataSet.makeTagKey("level");
+        auto rng = QRandomGenerator(42);
+        for (int i = 0; i < count; ++i) {
+            OSM::Node node;
+            node.id = i + 1;
+            node.coordinate = OSM::Coordinate(52.5 + rng.bounded(0.005), 13.4 + rng.bounded(0.008));
+            OSM::setTagValue(node, amenityKey, "toilets");
+            OSM::setTagValue(node, levelKey, i % 2 ? "1" : "0");
+            dataSet.addNode(std::move(node));
+        }
+        MapData mapData;
+        mapData.setDataSet(std::move(dataSet));
+        return mapData;
+    }
+
+    /** @p count toilets on a line, 0.001° apart in longitude. */
+    [[nodiscard]] static MapData makeLinearData(int count)
+    {
+        OSM::DataSet dataSet;
+        const auto amenityKey = dataSet.makeTagKey("amenity");
+        const auto levelKey = dataSet.makeTagKey("level");
+        for (int i = 0; i < count; ++i) {
+            OSM::Node node;
+            node.id = i + 1;
+            node.coordinate = OSM::Coordinate(52.5, 13.4 + i * 0.001);
+            OSM::setTagValue(node, amenityKey, "toilets");
+            OSM::setTagValue(node, levelKey, "0");
+            dataSet.addNode(std::move(node));
+        }
+        MapData mapData;
+        mapData.setDataSet(std::move(dataSet));
+        return mapData;
+    }
+
+    static void verifyDistanceOrder(const AmenitySortFilterProxyModel &proxyModel, QPointF pos, int floorLevel)
+    {
+        double prevDist = 0.0;
+        for (int i = 0; i < proxyModel.rowCount(); ++i) {
+            const auto idx = proxyModel.index(i, 0);
+            const auto dist = idx.data(AmenitySortFilterProxyModel::DistanceRole).toDouble();
+            QVERIFY(dist >= prevDist);
+            prevDist = dist;
+
+            // straight-line distance plus a floor level change penalty
+            const auto coord = idx.data(AmenityModel::CoordinateRole).toPointF();
+            const auto straightDist = OSM::distance(pos.y(), pos.x(), coord.y(), coord.x());
+            QVERIFY(dist >= straightDist - 0.1);
+            QCOMPARE(dist > straightDist + 1.0, idx.data(AmenityModel::LevelRole).toInt() != floorLevel);
+        }
+    }
+
 private Q_SLOTS:
     void testModel()
     {
@@ -135,6 +196,162 @@ private Q_SLOTS:
         proxyModel.setProperty("filterString", QString());
         QCOMPARE(proxyModel.rowCount(), 4);
     }
+
+    void testDistanceOrder()
+    {
+        AmenityModel model;
+        AmenitySortFilterProxyModel proxyModel;
+        proxyModel.setSourceModel(&model);
+        QAbstractItemModelTester proxyModelTest(&proxyModel);
+        model.setMapData(makeScatteredData(100));
+        QCOMPARE(proxyModel.rowCount(), 100);
+        QVERIFY(!proxyModel.index(0, 0).data(AmenitySortFilterProxyModel::DistanceRole).isValid());
+        QCOMPARE(proxyModel.roleNames().value(AmenitySortFilterProxyModel::DistanceRole), "distance");
+
+        QSignalSpy layoutSpy(&proxyModel, &QAbstractItemModel::layoutChanged);
+        QSignalSpy changeSpy(&proxyModel, &QAbstractItemModel::dataChanged);
+        QPointF pos(13.403, 52.502);
+        proxyModel.setPosition(pos);
+        QCOMPARE(proxyModel.position().x(), pos.x());
+        QCOMPARE(proxyModel.rowCount(), 100);
+        QCOMPARE(layoutSpy.size(), 1);
+        QCOMPARE(layoutSpy[0][1].value<QAbstractItemModel::LayoutChangeHint>(), QAbstractItemModel::VerticalSortHint);
+        QCOMPARE(changeSpy.size(), 1);
+        verifyDistanceOrder(proxyModel, pos, 0);
+
+        // walking around
+        for (int i = 0; i < 50; ++i) {
+            pos += QPointF(0.0001, 0.00005);
+            proxyModel.setPosition(pos);
+            verifyDistanceOrder(proxyModel, pos, 0);
+        }
+
+        // a tiny position change doesn't require re-sorting, nor notifying about distance changes
+        layoutSpy.clear();
+        changeSpy.clear();
+        proxyModel.setPosition(pos + QPointF(0.0000001, 0.0));
+        QCOMPARE(layoutSpy.size(), 0);
+        QCOMPARE(changeSpy.size(), 0);
+
+        // larger position changes only move rows whose order changed, everything else remains in place
+        QSignalSpy moveSpy(&proxyModel, &QAbstractItemModel::rowsMoved);
+        std::vector<QPersistentModelIndex> persistentIndexes;
+        std::vector<QModelIndex> sourceIndexes;
+        for (int i = 0; i < proxyModel.rowCount(); ++i) {
+            persistentIndexes.emplace_back(proxyModel.index(i, 0));
+            sourceIndexes.push_back(proxyModel.mapToSource(persistentIndexes.back()));
+        }
+        pos += QPointF(0.0005, 0.0);
+        proxyModel.setPosition(pos);
+        verifyDistanceOrder(proxyModel, pos, 0);
+        QCOMPARE(layoutSpy.size(), 0);
+        QVERIFY(changeSpy.size() >= 1);
+        int movedRows = 0;
+        for (std::size_t i = 0; i < persistentIndexes.size(); ++i) {
+            QVERIFY(persistentIndexes[i].isValid());
+            QCOMPARE(proxyModel.mapToSource(persistentIndexes[i]), sourceIndexes[i]);
+            movedRows += persistentIndexes[i].row() != (int)i ? 1 : 0;
+        }
+        QVERIFY(moveSpy.size() <= movedRows);
+        QCOMPARE(moveSpy.size() > 0, movedRows > 0);
+        for (const auto &args : moveSpy) {
+            QCOMPARE(args[1].toInt(), args[2].toInt());
+        }
+        for (const auto &args : changeSpy) {
+            QCOMPARE(args[2].value<QList<int>>(), QList<int>({AmenitySortFilterProxyModel::DistanceRole}));
+        }
+
+        // floor level changes
+        proxyModel.setFloorLevel(10);
+        QCOMPARE(proxyModel.floorLevel(), 10);
+        verifyDistanceOrder(proxyModel, pos, 10);
+
+        // filtering is retained
+        proxyModel.setProperty("filterString", QLatin1String("lounge"));
+        QCOMPARE(proxyModel.rowCount(), 0);
+        proxyModel.setPosition(pos + QPointF(0.001, 0.0));
+        QCOMPARE(proxyModel.rowCount(), 0);
+        proxyModel.setProperty("filterString", QString());
+        QCOMPARE(proxyModel.rowCount(), 100);
+
+        // back to ordering by name
+        proxyModel.resetPosition();
+        QVERIFY(proxyModel.position().isNull());
+        QCOMPARE(proxyModel.rowCount(), 100);
+        QVERIFY(!proxyModel.index(0, 0).data(AmenitySortFilterProxyModel::DistanceRole).isValid());
+
+        // source model changes
+        proxyModel.setPosition(pos);
+        model.setMapData(makeScatteredData(50));
+        QCOMPARE(proxyModel.rowCount(), 50);
+        verifyDistanceOrder(proxyModel, pos, 10);
+    }
+
+    void testDisplacedRowMoves()
+    {
+        AmenityModel model;
+        AmenitySortFilterProxyModel proxyModel;
+        proxyModel.setSourceModel(&model);
+        QAbstractItemModelTester proxyModelTest(&proxyModel);
+        model.setMapData(makeLinearData(10));
+        QCOMPARE(proxyModel.rowCount(), 10);
+
+        proxyModel.setPosition(QPointF(13.3995, 52.5));
+        verifyDistanceOrder(proxyModel, QPointF(13.3995, 52.5), 0);
+        const auto firstSourceIdx = proxyModel.mapToSource(proxyModel.index(0, 0));
+        const auto lastSourceIdx = proxyModel.mapToSource(proxyModel.index(9, 0));
+
+        // walking past the first entry only moves that one back behind its two successors
+        QSignalSpy layoutSpy(&proxyModel, &QAbstractItemModel::layoutChanged);
+        QSignalSpy moveSpy(&proxyModel, &QAbstractItemModel::rowsMoved);
+        proxyModel.setPosition(QPointF(13.4012, 52.5));
+        verifyDistanceOrder(proxyModel, QPointF(13.4012, 52.5), 0);
+        QCOMPARE(layoutSpy.size(), 0);
+        QCOMPARE(moveSpy.size(), 1);
+        QCOMPARE(moveSpy[0][1].toInt(), 0);
+        QCOMPARE(moveSpy[0][2].toInt(), 0);
+        QCOMPARE(moveSpy[0][4].toInt(), 3);
+        QCOMPARE(proxyModel.mapToSource(proxyModel.index(2, 0)), firstSourceIdx);
+        QCOMPARE(proxyModel.mapToSource(proxyModel.index(9, 0)), lastSourceIdx);
+
+        // turning around the other way reverses the entire order
+        moveSpy.clear();
+        proxyModel.setPosition(QPointF(13.4095, 52.5));
+        verifyDistanceOrder(proxyModel, QPointF(13.4095, 52.5), 0);
+        QCOMPARE(layoutSpy.size(), 0);
+        QCOMPARE(moveSpy.size(), 8); // the first two entries of the previous order remain in place relative to each other
+        QCOMPARE(proxyModel.mapToSource(proxyModel.index(0, 0)), lastSourceIdx);
+        QCOMPARE(proxyModel.mapToSource(proxyModel.index(9, 0)), firstSourceIdx);
+
+        // filtering inserts and removes individual rows, in distance order
+        QSignalSpy removeSpy(&proxyModel, &QAbstractItemModel::rowsRemoved);
+        QSignalSpy insertSpy(&proxyModel, &QAbstractItemModel::rowsInserted);
+        proxyModel.setFilterString(QStringLiteral("lounge"));
+        QCOMPARE(proxyModel.rowCount(), 0);
+        QCOMPARE(removeSpy.size(), 1);
+        proxyModel.setFilterString(QString());
+        QCOMPARE(proxyModel.rowCount(), 10);
+        QCOMPARE(insertSpy.size(), 1);
+        verifyDistanceOrder(proxyModel, QPointF(13.4095, 52.5), 0);
+        QCOMPARE(layoutSpy.size(), 0);
+    }
+
+    void benchmarkPositionUpdate()
+    {
+        AmenityModel model;
+        AmenitySortFilterProxyModel proxyModel;
+        proxyModel.setSourceModel(&model);
+        model.setMapData(makeScatteredData(5000));
+        QCOMPARE(proxyModel.rowCount(), 5000);
+
+        // walking speed at a 10Hz position update rate
+        QPointF pos(13.403, 52.502);
+        QBENCHMARK {
+            pos += QPointF(0.000002, 0.000001);
+            proxyModel.setPosition(pos);
+        }
+        QCOMPARE(proxyModel.rowCount(), 5000);
+    }
 };
 
 QTEST_GUILESS_MAIN(AmenityModelTest)
@@ -0,0 +1,270 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <osm/abstractreader.h>
+#include <osm/datatypes.h>
+#include <osm/io.h>
+
+#include <QFile>
+#include <QTest>
+
+#include <algorithm>
+
+Q_DECLARE_METATYPE(OSM::DataSet::ConflictPolicy)
+
+class DataSetUnionTest : public QObject
+{
+    Q_OBJECT
+private:
+    static void addNode(OSM::DataSet &dataSet, OSM::Id id, const char *key, const char *value)
+    {
+        OSM::Node node;
+        node.id = id;
+        node.coordinate = OSM::Coordinate(52.5, 13.4);
+        node.tags.emplace_back(dataSet.makeTagKey(key), QByteArray(value));
+        dataSet.addNode(std::move(node));
+    }
+
+    template <typename Elem>
+    static void verifySorted(const std::vector<Elem> &elements)
+    {
+        QVERIFY(std::is_sorted(elements.begin(), elements.end()));
+        QVERIFY(std::adjacent_find(elements.begin(), elements.end(), [](const auto &lhs, const auto &rhs) { return lhs.id == rhs.id; }) == elements.end());
+        for (const auto &elem : elements) {
+            QVERIFY(std::is_sorted(elem.tags.begin(), elem.tags.end()));
+        }
+    }
+
+    static void readFile(const QByteArray &data, OSM::DataSet &dataSet)
+    {
+        auto p = OSM::IO::readerForMimeType(u"application/vnd.openstreetmap.data+xml", &dataSet);
+        QVERIFY(p);
+        p->read(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+        QVERIFY(!p->hasError());
+    }
+
+    /** Keep the elements in [begin, end) of every element type, with begin/end given as fractions. */
+    static void slice(OSM::DataSet &dataSet, double begin, double end)
+    {
+        const auto sliceElements = [begin, end](auto &elements) {
+            const auto size = (double)elements.size();
+            elements.erase(elements.begin() + (std::ptrdiff_t)(size * end), elements.end());
+            elements.erase(elements.begin(), elements.begin() + (std::ptrdiff_t)(size * begin));
+        };
+        sliceElements(dataSet.nodes);
+        sliceElements(dataSet.ways);
+        sliceElements(dataSet.relations);
+    }
+
+    /** What combining data sets needs to do without unite(). */
+    template <typename Elem>
+    static void copyTags(OSM::DataSet &dataSet, Elem &elem)
+    {
+        for (auto &tag : elem.tags) {
+            tag.key = dataSet.makeTagKey(tag.key.name());
+        }
+        std::sort(elem.tags.begin(), elem.tags.end());
+    }
+    static void addElementwise(OSM::DataSet &dataSet, OSM::DataSet &&other)
+    {
+        for (auto &node : other.nodes) {
+            copyTags(dataSet, node);
+            dataSet.addNode(std::move(node));
+        }
+        for (auto &way : other.ways) {
+            copyTags(dataSet, way);
+            dataSet.addWay(std::move(way));
+        }
+        for (auto &rel : other.relations) {
+            copyTags(dataSet, rel);
+            for (auto &member : rel.members) {
+                member.setRole(dataSet.makeRole(member.role().name()));
+            }
+            dataSet.addRelation(std::move(rel));
+        }
+    }
+
+private Q_SLOTS:
+    void testEmpty()
+    {
+        OSM::DataSet ds1;
+        OSM::DataSet ds2;
+        ds1.unite(std::move(ds2));
+        QVERIFY(ds1.nodes.empty());
+
+        addNode(ds2, 1, "name", "A");
+        ds1.unite(std::move(ds2));
+        QCOMPARE(ds1.nodes.size(), 1);
+        QVERIFY(ds2.nodes.empty());
+        QCOMPARE(OSM::tagValue(ds1.nodes[0], ds1.tagKey("name")), "A");
+
+        ds1.unite(OSM::DataSet());
+        QCOMPARE(ds1.nodes.size(), 1);
+    }
+
+    void testOverlapping_data()
+    {
+        QTest::addColumn<OSM::DataSet::ConflictPolicy>("policy");
+        QTest::newRow("keep") << OSM::DataSet::ConflictPolicy::KeepExisting;
+        QTest::newRow("replace") << OSM::DataSet::ConflictPolicy::ReplaceExisting;
+    }
+
+    void testOverlapping()
+    {
+        QFETCH(OSM::DataSet::ConflictPolicy, policy);
+
+        OSM::DataSet ds1;
+        addNode(ds1, 1, "name", "A1");
+        addNode(ds1, 3, "name", "C1");
+        addNode(ds1, 5, "ref", "E1");
+        OSM::Relation rel1;
+        rel1.id = 10;
+        rel1.members.push_back({});
+        rel1.members.back().id = 1;
+        rel1.members.back().setType(OSM::Type::Node);
+        rel1.members.back().setRole(ds1.makeRole("stop"));
+        ds1.addRelation(std::move(rel1));
+
+        OSM::DataSet ds2;
+        // keys created in different order than in ds1, so remapping changes the tag order
+        addNode(ds2, 2, "ref", "B2");
+        addNode(ds2, 3, "name", "C2");
+        addNode(ds2, 6, "level", "F2");
+        ds2.nodes[0].tags.emplace_back(ds2.makeTagKey("name"), QByteArray("B2"));
+        std::sort(ds2.nodes[0].tags.begin(), ds2.nodes[0].tags.end());
+        OSM::Relation rel2;
+        rel2.id = 11;
+        rel2.members.push_back({});
+        rel2.members.back().id = 2;
+        rel2.members.back().setType(OSM::Type::Node);
+        rel2.members.back().setRole(ds2.makeRole("platform"));
+        rel2.members.push_back({});
+        rel2.members.back().id = 6;
+        rel2.members.back().setType(OSM::Type::Node);
+        rel2.members.back().setRole(ds2.makeRole("stop"));
+        ds2.addRelation(std::move(rel2));
+
+        ds1.unite(std::move(ds2), policy);
+        QVERIFY(ds2.nodes.empty());
+        QVERIFY(ds2.relations.empty());
+
+        verifySorted(ds1.nodes);
+        verifySorted(ds1.relations);
+        QCOMPARE(ds1.nodes.size(), 5);
+        QCOMPARE(ds1.relations.size(), 2);
+
+        const auto nameKey = ds1.tagKey("name");
+        const auto refKey = ds1.tagKey("ref");
+        const auto levelKey = ds1.tagKey("level");
+        QVERIFY(!nameKey.isNull());
+        QVERIFY(!refKey.isNull());
+        QVERIFY(!levelKey.isNull());
+        QCOMPARE(OSM::tagValue(*ds1.node(1), nameKey), "A1");
+        QCOMPARE(OSM::tagValue(*ds1.node(2), nameKey), "B2");
+        QCOMPARE(OSM::tagValue(*ds1.node(2), refKey), "B2");
+        QCOMPARE(OSM::tagValue(*ds1.node(3), nameKey), policy == OSM::DataSet::ConflictPolicy::KeepExisting ? "C1" : "C2");
+        QCOMPARE(OSM::tagValue(*ds1.node(5), refKey), "E1");
+        QCOMPARE(OSM::tagValue(*ds1.node(6), levelKey), "F2");
+
+        // keys and roles map to the same registry entries afterwards
+        QCOMPARE(ds1.makeTagKey("level"), levelKey);
+        const auto stopRole = ds1.role("stop");
+        const auto platformRole = ds1.role("platform");
+        QVERIFY(!platformRole.isNull());
+        QCOMPARE(ds1.relation(10)->members[0].role(), stopRole);
+        QCOMPARE(ds1.relation(11)->members[0].role(), platformRole);
+        QCOMPARE(ds1.relation(11)->members[1].role(), stopRole);
+        QCOMPARE(ds1.relation(11)->members[1].type(), OSM::Type::Node);
+    }
+
+    void testMemoryOwnership()
+    {
+        OSM::DataSet ds1;
+        addNode(ds1, 1, "name", "A");
+        {
+            OSM::DataSet ds2;
+            addNode(ds2, 2, "transient-key", "B");
+            ds1.unite(std::move(ds2));
+        }
+        QCOMPARE(ds1.nodes[1].tags[0].key.name(), "transient-key");
+        QCOMPARE(ds1.tagKey("transient-key"), ds1.nodes[1].tags[0].key);
+    }
+
+    void testRealData()
+    {
+        QFile f(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-altona.osm"));
+        QVERIFY(f.open(QFile::ReadOnly));
+        const auto data = f.readAll();
+
+        OSM::DataSet full;
+        readFile(data, full);
+        OSM::DataSet ds1;
+        readFile(data, ds1);
+        slice(ds1, 0.0, 0.6);
+        OSM::DataSet ds2;
+        readFile(data, ds2);
+        slice(ds2, 0.4, 1.0);
+
+        ds1.unite(std::move(ds2));
+        verifySorted(ds1.nodes);
+        verifySorted(ds1.ways);
+        verifySorted(ds1.relations);
+        QCOMPARE(ds1.nodes.size(), full.nodes.size());
+        QCOMPARE(ds1.ways.size(), full.ways.size());
+        QCOMPARE(ds1.relations.size(), full.relations.size());
+        for (std::size_t i = 0; i < full.ways.size(); ++i) {
+            QCOMPARE(ds1.ways[i].id, full.ways[i].id);
+            QCOMPARE(ds1.ways[i].nodes, full.ways[i].nodes);
+            QCOMPARE(ds1.ways[i].tags.size(), full.ways[i].tags.size());
+            for (const auto &tag : full.ways[i].tags) {
+                QCOMPARE(OSM::tagValue(ds1.ways[i], ds1.tagKey(tag.key.name())), tag.value);
+            }
+        }
+        for (std::size_t i = 0; i < full.relations.size(); ++i) {
+            QCOMPARE(ds1.relations[i].members.size(), full.relations[i].members.size());
+            for (std::size_t j = 0; j < full.relations[i].members.size(); ++j) {
+                QCOMPARE(ds1.relations[i].members[j].role(), ds1.role(full.relations[i].members[j].role().name()));
+            }
+        }
+    }
+
+    void benchmarkUnion_data()
+    {
+        QTest::addColumn<bool>("unite");
+        QTest::newRow("element-by-element") << false;
+        QTest::newRow("unite") << true;
+    }
+
+    void benchmarkUnion()
+    {
+        QFETCH(bool, unite);
+        QFile f(QStringLiteral(SOURCE_DIR "/data/platforms/paris-gare-de-lyon.osm"));
+        QVERIFY(f.open(QFile::ReadOnly));
+        const auto data = f.readAll();
+
+        // parsing is included in both variants, as unite() consumes its input
+        std::size_t nodeCount = 0;
+        QBENCHMARK {
+            OSM::DataSet ds1;
+            readFile(data, ds1);
+            slice(ds1, 0.0, 0.6);
+            OSM::DataSet ds2;
+            readFile(data, ds2);
+            slice(ds2, 0.4, 1.0);
+
+            if (unite) {
+                ds1.unite(std::move(ds2));
+            } else {
+                addElementwise(ds1, std::move(ds2));
+            }
+            nodeCount = ds1.nodes.size();
+        }
+        QVERIFY(nodeCount > 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(DataSetUnionTest)
+
+#include "datasetuniontest.moc"
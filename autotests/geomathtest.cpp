@@ -0,0 +1,242 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <osm/datatypes.h>
+#include <osm/geomath.h>
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+class GeoMathTest : public QObject
+{
+    Q_OBJECT
+private:
+    /** Random coordinate within roughly @p range meters of @p ref. */
+    static OSM::Coordinate randomCoordinate(OSM::Coordinate ref, double range, QRandomGenerator &rng)
+    {
+        const auto dLat = (rng.generateDouble() * 2.0 - 1.0) * range / 111'000.0;
+        const auto dLon = (rng.generateDouble() * 2.0 - 1.0) * range / 111'000.0 / std::cos(OSM::degToRad(ref.latF()));
+        return OSM::Coordinate(ref.latF() + dLat, ref.lonF() + dLon);
+    }
+
+    /** Random polyline of @p count nodes within roughly @p range meters of @p ref. */
+    static std::vector<OSM::Node> randomPath(OSM::Coordinate ref, int count, double range, QRandomGenerator &rng)
+    {
+        std::vector<OSM::Node> nodes((std::size_t)count);
+        for (int i = 0; i < count; ++i) {
+            nodes[i].id = i + 1;
+            nodes[i].coordinate = randomCoordinate(ref, range, rng);
+        }
+        return nodes;
+    }
+
+    static std::vector<const OSM::Node*> nodePointers(const std::vector<OSM::Node> &nodes)
+    {
+        std::vector<const OSM::Node*> path;
+        std::transform(nodes.begin(), nodes.end(), std::back_inserter(path), [](const auto &node) { return &node; });
+        return path;
+    }
+
+    /** Haversine distance to a densely sampled path segment. */
+    static double sampledDistance(OSM::Coordinate l1, OSM::Coordinate l2, OSM::Coordinate p)
+    {
+        constexpr int SAMPLES = 5000;
+        auto dist = std::numeric_limits<double>::max();
+        for (int i = 0; i <= SAMPLES; ++i) {
+            const auto r = (double)i / SAMPLES;
+            const OSM::Coordinate c(l1.latF() + r * (l2.latF() - l1.latF()), l1.lonF() + r * (l2.lonF() - l1.lonF()));
+            dist = std::min(dist, OSM::distance(c, p));
+        }
+        return dist;
+    }
+
+private Q_SLOTS:
+    void testLocalDistance_data()
+    {
+        QTest::addColumn<double>("lat");
+        QTest::addColumn<double>("lon");
+        QTest::newRow("equator") << 0.0 << 30.0;
+        QTest::newRow("berlin") << 52.525 << 13.369;
+        QTest::newRow("tromso") << 69.65 << 18.96;
+        QTest::newRow("sydney") << -33.883 << 151.206;
+        QTest::newRow("west") << 40.75 << -73.993;
+    }
+
+    void testLocalDistance()
+    {
+        QFETCH(double, lat);
+        QFETCH(double, lon);
+        const OSM::Coordinate ref(lat, lon);
+        const OSM::LocalDistance localDist(ref);
+        QCOMPARE(localDist.distance(ref), 0.0);
+
+        auto rng = QRandomGenerator(42);
+        std::vector<OSM::Coordinate> coords;
+        for (int i = 0; i < 10000; ++i) {
+            coords.push_back(randomCoordinate(ref, 10'000.0, rng));
+        }
+        std::vector<double> distances(coords.size());
+        localDist.distances(coords, distances);
+
+        for (std::size_t i = 0; i < coords.size(); ++i) {
+            const auto expected = OSM::distance(ref, coords[i]);
+            const auto dist = localDist.distance(coords[i]);
+            QCOMPARE(distances[i], dist);
+            QVERIFY2(std::abs(dist - expected) <= std::max(0.01, expected * 1.0e-5), qPrintable(QString::number(dist) + QLatin1String(" vs. ") + QString::number(expected)));
+        }
+    }
+
+    void testPathDistance_data()
+    {
+        QTest::addColumn<double>("lat");
+        QTest::addColumn<double>("lon");
+        QTest::newRow("berlin") << 52.525 << 13.369;
+        QTest::newRow("tromso") << 69.65 << 18.96;
+        QTest::newRow("sydney") << -33.883 << 151.206;
+    }
+
+    void testPathDistance()
+    {
+        QFETCH(double, lat);
+        QFETCH(double, lon);
+        const OSM::Coordinate ref(lat, lon);
+        auto rng = QRandomGenerator(42);
+
+        for (int i = 0; i < 100; ++i) {
+            const auto nodes = randomPath(ref, 2 + (int)rng.bounded(5), 200.0, rng);
+            const auto path = nodePointers(nodes);
+            const auto coord = randomCoordinate(ref, 300.0, rng);
+
+            auto expected = std::numeric_limits<double>::max();
+            for (std::size_t j = 0; j + 1 < path.size(); ++j) {
+                expected = std::min(expected, sampledDistance(path[j]->coordinate, path[j + 1]->coordinate, coord));
+            }
+            const auto dist = OSM::LocalDistance(coord).distance(path);
+            QVERIFY2(std::abs(dist - expected) < 0.1, qPrintable(QString::number(dist) + QLatin1String(" vs. ") + QString::number(expected)));
+            // OSM::distance projects in degrees, so it never finds a closer point
+            QVERIFY(dist <= OSM::distance(path, coord) + 0.01);
+        }
+    }
+
+    void testPathLoops()
+    {
+        // two closed loops, the connection between them is not part of the path
+        std::vector<OSM::Node> nodes(8);
+        const std::pair<double, double> coords[] = {
+            { 52.0, 13.0 }, { 52.0, 13.001 }, { 52.001, 13.001 }, { 52.0, 13.0 },
+            { 52.0, 13.01 }, { 52.0, 13.011 }, { 52.001, 13.011 }, { 52.0, 13.01 },
+        };
+        const OSM::Id ids[] = { 1, 2, 3, 1, 4, 5, 6, 4 };
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            nodes[i].id = ids[i];
+            nodes[i].coordinate = OSM::Coordinate(coords[i].first, coords[i].second);
+        }
+        const auto path = nodePointers(nodes);
+
+        const OSM::Coordinate between(52.0, 13.005);
+        const auto dist = OSM::LocalDistance(between).distance(path);
+        QVERIFY(dist > 250.0);
+        QVERIFY(std::abs(dist - OSM::distance(path, between)) < 0.1);
+
+        QCOMPARE(OSM::LocalDistance(between).distance(std::vector<const OSM::Node*>{}), std::numeric_limits<double>::max());
+        QVERIFY(std::abs(OSM::LocalDistance(between).distance(std::vector<const OSM::Node*>{ path[0] }) - OSM::distance(nodes[0].coordinate, between)) < 0.01);
+    }
+
+    void testProjectedSegmentDistance()
+    {
+        // diagonal segment far away from the equator, the point is 4m away from its center
+        std::vector<OSM::Node> nodes(2);
+        nodes[0].id = 1;
+        nodes[0].coordinate = OSM::Coordinate(70.0, 19.0);
+        nodes[1].id = 2;
+        nodes[1].coordinate = OSM::Coordinate(70.0005, 19.002);
+        const auto path = nodePointers(nodes);
+        const OSM::Coordinate coord(70.000279, 19.0009379);
+
+        const auto dist = OSM::LocalDistance(coord).distance(path);
+        QVERIFY2(std::abs(dist - 4.0) < 0.05, qPrintable(QString::number(dist)));
+        QVERIFY(std::abs(dist - sampledDistance(nodes[0].coordinate, nodes[1].coordinate, coord)) < 0.05);
+        // the segment projection in degrees misses the closest point by quite a bit
+        QVERIFY(OSM::distance(path, coord) > 4.6);
+    }
+
+    void benchmarkDistances_data()
+    {
+        QTest::addColumn<int>("mode");
+        QTest::newRow("haversine") << 0;
+        QTest::newRow("local") << 1;
+        QTest::newRow("local-batch") << 2;
+    }
+
+    void benchmarkDistances()
+    {
+        QFETCH(int, mode);
+        const OSM::Coordinate ref(52.525, 13.369);
+        auto rng = QRandomGenerator(42);
+        std::vector<OSM::Coordinate> coords;
+        for (int i = 0; i < 100'000; ++i) {
+            coords.push_back(randomCoordinate(ref, 1000.0, rng));
+        }
+        std::vector<double> distances(coords.size());
+
+        QBENCHMARK {
+            switch (mode) {
+                case 0:
+                    for (std::size_t i = 0; i < coords.size(); ++i) {
+                        distances[i] = OSM::distance(ref, coords[i]);
+                    }
+                    break;
+                case 1:
+                {
+                    const OSM::LocalDistance localDist(ref);
+                    for (std::size_t i = 0; i < coords.size(); ++i) {
+                        distances[i] = localDist.distance(coords[i]);
+                    }
+                    break;
+                }
+                case 2:
+                    OSM::LocalDistance(ref).distances(coords, distances);
+                    break;
+            }
+        }
+        QVERIFY(std::accumulate(distances.begin(), distances.end(), 0.0) > 0.0);
+    }
+
+    void benchmarkPathDistance_data()
+    {
+        QTest::addColumn<bool>("local");
+        QTest::newRow("haversine") << false;
+        QTest::newRow("local") << true;
+    }
+
+    void benchmarkPathDistance()
+    {
+        QFETCH(bool, local);
+        const OSM::Coordinate ref(52.525, 13.369);
+        auto rng = QRandomGenerator(42);
+        const auto nodes = randomPath(ref, 1000, 300.0, rng);
+        const auto path = nodePointers(nodes);
+        std::vector<OSM::Coordinate> coords;
+        for (int i = 0; i < 100; ++i) {
+            coords.push_back(randomCoordinate(ref, 300.0, rng));
+        }
+
+        double dist = 0.0;
+        QBENCHMARK {
+            for (const auto coord : coords) {
+                dist += local ? OSM::LocalDistance(coord).distance(path) : OSM::distance(path, coord);
+            }
+        }
+        QVERIFY(dist > 0.0);
+    }
+};
+
+QTEST_GUILESS_MAIN(GeoMathTest)
+
+#include "geomathtest.moc"
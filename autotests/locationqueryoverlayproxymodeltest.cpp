@@ -0,0 +1,95 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "../src/map-publictransport-integration/locationqueryoverlayproxymodel.h"
+
+#include <KPublicTransport/Location>
+#include <KPublicTransport/LocationQueryModel>
+#include <KPublicTransport/RentalVehicle>
+
+#include <osm/element.h>
+
+#include <QAbstractItemModelTester>
+#include <QStandardItemModel>
+#include <QTest>
+
+using namespace Qt::Literals::StringLiterals;
+using namespace KOSMIndoorMap;
+
+class LocationQueryOverlayProxyModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    static QStandardItem* makeVehicle(const QString &name)
+    {
+        KPublicTransport::RentalVehicle vehicle;
+        vehicle.setType(KPublicTransport::RentalVehicle::Bicycle);
+
+        KPublicTransport::Location loc;
+        loc.setType(KPublicTransport::Location::RentedVehicle);
+        loc.setName(name);
+        loc.setCoordinate(52.525f, 13.369f);
+        loc.setData(QVariant::fromValue(vehicle));
+
+        auto item = new QStandardItem;
+        item->setData(QVariant::fromValue(loc), KPublicTransport::LocationQueryModel::LocationRole);
+        return item;
+    }
+
+    static QStringList names(const QAbstractItemModel &model)
+    {
+        QStringList n;
+        for (int i = 0; i < model.rowCount(); ++i) {
+            const auto elem = model.index(i, 0).data(LocationQueryOverlayProxyModel::ElementRole).value<OSM::Element>();
+            n.push_back(QString::fromUtf8(elem.tagValue("name")));
+        }
+        return n;
+    }
+
+private Q_SLOTS:
+    void testRowUpdates()
+    {
+        OSM::DataSet dataSet;
+        OSM::Node node;
+        node.id = 1;
+        node.coordinate = OSM::Coordinate(52.525, 13.369);
+        dataSet.addNode(std::move(node));
+        MapData mapData;
+        mapData.setDataSet(std::move(dataSet));
+
+        QStandardItemModel sourceModel;
+        for (const auto &name : { u"A"_s, u"B"_s, u"C"_s, u"D"_s, u"E"_s }) {
+            sourceModel.appendRow(makeVehicle(name));
+        }
+
+        LocationQueryOverlayProxyModel model;
+        QAbstractItemModelTester modelTester(&model);
+        model.setMapData(mapData);
+        model.setSourceModel(&sourceModel);
+        QCOMPARE(names(model), QStringList({u"A"_s, u"B"_s, u"C"_s, u"D"_s, u"E"_s}));
+
+        // removing a range has to remove its last row as well
+        sourceModel.removeRows(1, 2);
+        QCOMPARE(model.rowCount(), 3);
+        QCOMPARE(names(model), QStringList({u"A"_s, u"D"_s, u"E"_s}));
+
+        // boundary rows at the end and the start
+        sourceModel.removeRows(1, 2);
+        QCOMPARE(names(model), QStringList({u"A"_s}));
+        sourceModel.removeRow(0);
+        QCOMPARE(model.rowCount(), 0);
+
+        // block insertion and changes
+        sourceModel.appendRow(makeVehicle(u"F"_s));
+        sourceModel.insertRow(1, makeVehicle(u"G"_s));
+        QCOMPARE(names(model), QStringList({u"F"_s, u"G"_s}));
+        sourceModel.item(1)->setData(sourceModel.item(0)->data(KPublicTransport::LocationQueryModel::LocationRole), KPublicTransport::LocationQueryModel::LocationRole);
+        QCOMPARE(names(model), QStringList({u"F"_s, u"F"_s}));
+    }
+};
+
+QTEST_GUILESS_MAIN(LocationQueryOverlayProxyModelTest)
+
+#include "locationqueryoverlayproxymodeltest.moc"
@@ -0,0 +1,53 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <map/loader/mapdata.h>
+#include <map/loader/maploader.h>
+
+#include <QSignalSpy>
+#include <QTest>
+
+using namespace KOSMIndoorMap;
+
+class MapLoaderTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testLoadFromFileError_data()
+    {
+        QTest::addColumn<QString>("fileName");
+        QTest::newRow("missing file") << QStringLiteral(SOURCE_DIR "/data/platforms/does-not-exist.osm");
+        QTest::newRow("unknown format") << QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-altona.platforms");
+    }
+
+    void testLoadFromFileError()
+    {
+        QFETCH(QString, fileName);
+
+        MapLoader loader;
+        QSignalSpy doneSpy(&loader, &MapLoader::done);
+        loader.loadFromFile(fileName);
+        QVERIFY(doneSpy.wait());
+        QCOMPARE(doneSpy.size(), 1);
+        QVERIFY(loader.hasError());
+        QVERIFY(!loader.errorMessage().isEmpty());
+        QVERIFY(!loader.isLoading());
+        QVERIFY(loader.takeData().isEmpty());
+    }
+
+    void testLoadFromFile()
+    {
+        MapLoader loader;
+        QSignalSpy doneSpy(&loader, &MapLoader::done);
+        loader.loadFromFile(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-altona.osm"));
+        QVERIFY(doneSpy.wait());
+        QVERIFY(!loader.hasError());
+        QVERIFY(!loader.takeData().isEmpty());
+    }
+};
+
+QTEST_GUILESS_MAIN(MapLoaderTest)
+
+#include "maploadertest.moc"
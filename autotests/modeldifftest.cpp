@@ -0,0 +1,438 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "../src/map-quick/amenitymodel.h"
+#include "../src/map-quick/floorlevelchangemodel.h"
+#include "../src/map-quick/osmelementinformationmodel.h"
+#include "../src/map-quick/roommodel.h"
+
+#include <map/content/floorlevelmodel.h>
+#include <map/content/gatemodel.h>
+#include <map/content/modeldiff_p.h>
+#include <map/content/platformmodel.h>
+#include <map/loader/mapdata.h>
+#include <map/loader/maploader.h>
+
+#include <QAbstractItemModelTester>
+#include <QAbstractListModel>
+#include <QRandomGenerator>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <algorithm>
+#include <numeric>
+
+using namespace KOSMIndoorMap;
+
+void initLocale()
+{
+    qputenv("LC_ALL", "en_US.utf-8");
+    qputenv("TZ", "UTC");
+
+    Q_INIT_RESOURCE(assets);
+}
+
+Q_CONSTRUCTOR_FUNCTION(initLocale)
+
+namespace {
+struct Entry {
+    int key;
+    QString value;
+};
+
+class TestModel : public QAbstractListModel
+{
+public:
+    explicit TestModel(bool incremental) : m_incremental(incremental)
+    {
+        // what views would do on their end, recreating delegates for new or reset rows
+        connect(this, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex&, int first, int last) { m_churn += last - first + 1; });
+        connect(this, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex&, int first, int last) { m_churn += last - first + 1; });
+        connect(this, &QAbstractItemModel::modelReset, this, [this]() { m_churn += rowCount(); });
+    }
+
+    [[nodiscard]] int rowCount(const QModelIndex &parent = {}) const override
+    {
+        return parent.isValid() ? 0 : (int)m_entries.size();
+    }
+
+    [[nodiscard]] QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (!checkIndex(index, CheckIndexOption::IndexIsValid)) {
+            return {};
+        }
+        switch (role) {
+            case Qt::DisplayRole:
+                return m_entries[index.row()].value;
+            case Qt::UserRole:
+                return m_entries[index.row()].key;
+        }
+        return {};
+    }
+
+    void setEntries(std::vector<Entry> &&entries)
+    {
+        setEntries(std::move(entries), [](const Entry &lhs, const Entry &rhs) {
+            return lhs.key == rhs.key;
+        });
+    }
+
+    template <typename SameRow>
+    void setEntries(std::vector<Entry> &&entries, SameRow isSameRow)
+    {
+        if (m_incremental) {
+            ModelDiff::apply(this, m_entries, std::move(entries), [](const Entry &entry) {
+                return std::hash<int>{}(entry.key);
+            }, isSameRow, [](const Entry &lhs, const Entry &rhs) {
+                return lhs.value == rhs.value;
+            });
+        } else {
+            beginResetModel();
+            m_entries = std::move(entries);
+            endResetModel();
+        }
+    }
+
+    [[nodiscard]] std::vector<int> keys() const
+    {
+        std::vector<int> keys;
+        std::transform(m_entries.begin(), m_entries.end(), std::back_inserter(keys), [](const auto &e) { return e.key; });
+        return keys;
+    }
+
+    int m_churn = 0;
+    std::vector<Entry> m_entries;
+
+private:
+    friend class KOSMIndoorMap::ModelDiff;
+
+    bool m_incremental;
+};
+}
+
+[[nodiscard]] static std::vector<Entry> makeEntries(const std::vector<int> &keys, const QString &suffix = {})
+{
+    std::vector<Entry> entries;
+    for (const auto key : keys) {
+        entries.push_back({key, QString::number(key) + suffix});
+    }
+    return entries;
+}
+
+[[nodiscard]] static std::vector<int> range(int count)
+{
+    std::vector<int> keys((std::size_t)count);
+    std::iota(keys.begin(), keys.end(), 0);
+    return keys;
+}
+
+/** A synthetic venue with a room, a gate and an amenity for each of @p ids,
+ *  spread over three floor levels connected by an elevator.
+ */
+[[nodiscard]] static MapData makeVenue(const std::vector<int> &ids)
+{
+    OSM::DataSet dataSet;
+    const auto levelKey = dataSet.makeTagKey("level");
+    const auto nameKey = dataSet.makeTagKey("name");
+    const auto refKey = dataSet.makeTagKey("ref");
+    const auto roomKey = dataSet.makeTagKey("room");
+    const auto amenityKey = dataSet.makeTagKey("amenity");
+    const auto aerowayKey = dataSet.makeTagKey("aeroway");
+    const auto highwayKey = dataSet.makeTagKey("highway");
+
+    OSM::Id nodeId = 1;
+    OSM::Id wayId = 1;
+    const auto makeNode = [&nodeId](double lat, double lon) {
+        OSM::Node node;
+        node.id = nodeId++;
+        node.coordinate = OSM::Coordinate(lat, lon);
+        return node;
+    };
+    const auto addNode = [&](double lat, double lon) {
+        auto node = makeNode(lat, lon);
+        const auto id = node.id;
+        dataSet.addNode(std::move(node));
+        return id;
+    };
+
+    for (const auto id : ids) {
+        const auto lat = 52.5 + id * 0.0001;
+        const auto level = QByteArray::number(id % 3);
+
+        OSM::Way room;
+        room.id = wayId++;
+        room.nodes = { addNode(lat, 13.4), addNode(lat + 0.00005, 13.4), addNode(lat + 0.00005, 13.40005), addNode(lat, 13.40005) };
+        room.nodes.push_back(room.nodes.front());
+        OSM::setTagValue(room, roomKey, "office");
+        OSM::setTagValue(room, nameKey, "Room " + QByteArray::number(id));
+        OSM::setTagValue(room, levelKey, QByteArray(level));
+        dataSet.addWay(std::move(room));
+
+        auto gate = makeNode(lat, 13.401);
+        OSM::setTagValue(gate, aerowayKey, "gate");
+        OSM::setTagValue(gate, refKey, QByteArray::number(id));
+        OSM::setTagValue(gate, levelKey, QByteArray(level));
+        dataSet.addNode(std::move(gate));
+
+        auto amenity = makeNode(lat, 13.402);
+        OSM::setTagValue(amenity, amenityKey, id % 2 ? "toilets" : "cafe");
+        OSM::setTagValue(amenity, nameKey, "Amenity " + QByteArray::number(id));
+        OSM::setTagValue(amenity, levelKey, QByteArray(level));
+        dataSet.addNode(std::move(amenity));
+    }
+
+    auto elevator = makeNode(52.5, 13.403);
+    OSM::setTagValue(elevator, highwayKey, "elevator");
+    OSM::setTagValue(elevator, levelKey, ids.size() % 2 ? "0;1;2" : "0;1");
+    dataSet.addNode(std::move(elevator));
+
+    MapData mapData;
+    mapData.setDataSet(std::move(dataSet));
+    return mapData;
+}
+
+class ModelDiffTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testDiff_data()
+    {
+        QTest::addColumn<std::vector<int>>("oldKeys");
+        QTest::addColumn<std::vector<int>>("newKeys");
+        QTest::addColumn<int>("inserted");
+        QTest::addColumn<int>("removed");
+        QTest::addColumn<int>("moved");
+
+        QTest::newRow("empty") << std::vector<int>{} << std::vector<int>{} << 0 << 0 << 0;
+        QTest::newRow("fill") << std::vector<int>{} << std::vector<int>{1, 2, 3} << 1 << 0 << 0;
+        QTest::newRow("clear") << std::vector<int>{1, 2, 3} << std::vector<int>{} << 0 << 1 << 0;
+        QTest::newRow("unchanged") << std::vector<int>{1, 2, 3} << std::vector<int>{1, 2, 3} << 0 << 0 << 0;
+        QTest::newRow("insert") << std::vector<int>{1, 2, 5, 6} << std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7} << 3 << 0 << 0;
+        QTest::newRow("remove") << std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7} << std::vector<int>{1, 2, 5, 6} << 0 << 3 << 0;
+        QTest::newRow("replace") << std::vector<int>{1, 2, 3} << std::vector<int>{4, 5, 6} << 1 << 1 << 0;
+        QTest::newRow("move") << std::vector<int>{1, 2, 3, 4} << std::vector<int>{4, 1, 2, 3} << 0 << 0 << 1;
+        QTest::newRow("reverse") << std::vector<int>{1, 2, 3, 4} << std::vector<int>{4, 3, 2, 1} << 0 << 0 << 3;
+        QTest::newRow("duplicates") << std::vector<int>{1, 1, 2, 2} << std::vector<int>{1, 2, 2, 2, 1} << 1 << 0 << 2;
+        QTest::newRow("mixed") << std::vector<int>{1, 2, 3, 4, 5} << std::vector<int>{0, 5, 2, 3, 6} << 2 << 2 << 1;
+    }
+
+    void testDiff()
+    {
+        QFETCH(std::vector<int>, oldKeys);
+        QFETCH(std::vector<int>, newKeys);
+        QFETCH(int, inserted);
+        QFETCH(int, removed);
+        QFETCH(int, moved);
+
+        TestModel model(true);
+        model.setEntries(makeEntries(oldKeys));
+        QAbstractItemModelTester modelTest(&model);
+        QSignalSpy insertSpy(&model, &QAbstractItemModel::rowsInserted);
+        QSignalSpy removeSpy(&model, &QAbstractItemModel::rowsRemoved);
+        QSignalSpy moveSpy(&model, &QAbstractItemModel::rowsMoved);
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+
+        model.setEntries(makeEntries(newKeys));
+        QCOMPARE(model.keys(), newKeys);
+        QCOMPARE(insertSpy.size(), inserted);
+        QCOMPARE(removeSpy.size(), removed);
+        QCOMPARE(moveSpy.size(), moved);
+        QCOMPARE(resetSpy.size(), 0);
+    }
+
+    void testInconsistentPredicates()
+    {
+        TestModel model(true);
+        model.setEntries(makeEntries({1, 2, 3, 4}));
+        QAbstractItemModelTester modelTest(&model);
+
+        // rows match during the initial matching, but not anymore when moving them in place
+        int calls = 0;
+        model.setEntries(makeEntries({4, 3, 2, 1}), [&calls](const Entry &lhs, const Entry &rhs) {
+            return ++calls <= 10 && lhs.key == rhs.key;
+        });
+        QCOMPARE(model.keys(), std::vector<int>({4, 3, 2, 1}));
+    }
+
+    void testHashCollisions()
+    {
+        TestModel model(true);
+        model.setEntries(makeEntries({1, 2, 3, 4, 5, 6}));
+        QAbstractItemModelTester modelTest(&model);
+        QSignalSpy insertSpy(&model, &QAbstractItemModel::rowsInserted);
+        QSignalSpy removeSpy(&model, &QAbstractItemModel::rowsRemoved);
+
+        // all rows in the same bucket, matching still relies on the predicate
+        auto entries = makeEntries({6, 2, 7, 4});
+        ModelDiff::apply(&model, model.m_entries, std::move(entries), [](const Entry &) { return std::size_t(0); },
+            [](const Entry &lhs, const Entry &rhs) { return lhs.key == rhs.key; },
+            [](const Entry &lhs, const Entry &rhs) { return lhs.value == rhs.value; });
+        QCOMPARE(model.keys(), std::vector<int>({6, 2, 7, 4}));
+        QCOMPARE(insertSpy.size(), 1);
+        QCOMPARE(removeSpy.size(), 3);
+    }
+
+    void testContentModels()
+    {
+        // FloorLevelModel keeps a pointer to this, so this must not reallocate
+        std::vector<MapData> data;
+        data.reserve(6);
+        for (const auto &name : { QStringLiteral("hamburg-altona"), QStringLiteral("hamburg-central") }) {
+            MapLoader loader;
+            QSignalSpy doneSpy(&loader, &MapLoader::done);
+            loader.loadFromFile(QStringLiteral(SOURCE_DIR "/data/platforms/%1.osm").arg(name));
+            QVERIFY(doneSpy.wait());
+            QVERIFY(!loader.hasError());
+            data.push_back(loader.takeData());
+        }
+        const std::vector<std::vector<int>> venues({{1, 2, 3, 4, 5, 6, 7, 8}, {0, 2, 3, 5, 6, 9, 10}, {10, 9, 8, 7, 3, 2}});
+        for (const auto &ids : venues) {
+            data.push_back(makeVenue(ids));
+        }
+        data.emplace_back();
+
+        PlatformModel platformModel;
+        QAbstractItemModelTester platformModelTest(&platformModel);
+        GateModel gateModel;
+        QAbstractItemModelTester gateModelTest(&gateModel);
+        RoomModel roomModel;
+        QAbstractItemModelTester roomModelTest(&roomModel);
+        AmenityModel amenityModel;
+        QAbstractItemModelTester amenityModelTest(&amenityModel);
+        FloorLevelModel floorLevelModel;
+        QAbstractItemModelTester floorLevelModelTest(&floorLevelModel);
+        FloorLevelChangeModel levelChangeModel;
+        QAbstractItemModelTester levelChangeModelTest(&levelChangeModel);
+        levelChangeModel.setFloorLevelModel(&floorLevelModel);
+        OSMElementInformationModel infoModel;
+        QAbstractItemModelTester infoModelTest(&infoModel);
+
+        for (const auto i : {0, 1, 0, 2, 3, 4, 3, 2, 4, 5, 2, 1, 5}) {
+            auto &d = data[i];
+            platformModel.setMapData(d);
+            gateModel.setMapData(d);
+            roomModel.setMapData(d);
+            amenityModel.setMapData(d);
+            floorLevelModel.setMapData(&d);
+
+            OSM::Element levelChangeElement;
+            OSM::Element infoElement;
+            if (!d.isEmpty()) {
+                for (const auto &node : d.dataSet().nodes) {
+                    const OSM::Element e(&node);
+                    if (levelChangeElement.type() == OSM::Type::Null && !e.tagValue("highway").isEmpty() && e.tagValue("level").contains(';')) {
+                        levelChangeElement = e;
+                    }
+                    if (infoElement.type() == OSM::Type::Null && !e.tagValue("name").isEmpty()) {
+                        infoElement = e;
+                    }
+                }
+            }
+            levelChangeModel.setElement(OSMElement(levelChangeElement));
+            levelChangeModel.setCurrentFloorLevel(10);
+            infoModel.setElement(OSMElement(infoElement));
+
+            if (i >= 2 && i < 5) {
+                const auto count = (int)venues[i - 2].size();
+                QCOMPARE(gateModel.rowCount(), count);
+                QCOMPARE(roomModel.rowCount(), count);
+                QCOMPARE(amenityModel.rowCount(), count);
+                QCOMPARE(levelChangeModel.rowCount(), count % 2 ? 3 : 2);
+                QVERIFY(infoModel.rowCount() > 0);
+            }
+            QCOMPARE(platformModel.rowCount() > 0, i < 2);
+            QCOMPARE(floorLevelModel.rowCount() > 0, !d.isEmpty());
+        }
+    }
+
+    void testDataChanged()
+    {
+        TestModel model(true);
+        model.setEntries(makeEntries(range(10)));
+        QAbstractItemModelTester modelTest(&model);
+        QSignalSpy changeSpy(&model, &QAbstractItemModel::dataChanged);
+
+        auto entries = makeEntries(range(10));
+        entries[3].value = QStringLiteral("changed");
+        entries[4].value = QStringLiteral("changed");
+        entries[8].value = QStringLiteral("changed");
+        model.setEntries(std::move(entries));
+        QCOMPARE(model.rowCount(), 10);
+        QCOMPARE(model.index(3, 0).data().toString(), QLatin1String("changed"));
+
+        // consecutive changes are coalesced
+        QCOMPARE(changeSpy.size(), 2);
+        QCOMPARE(changeSpy[0][0].toModelIndex().row(), 3);
+        QCOMPARE(changeSpy[0][1].toModelIndex().row(), 4);
+        QCOMPARE(changeSpy[1][0].toModelIndex().row(), 8);
+        QCOMPARE(changeSpy[1][1].toModelIndex().row(), 8);
+    }
+
+    void testPersistentIndexes()
+    {
+        TestModel model(true);
+        model.setEntries(makeEntries({1, 2, 3, 4, 5}));
+        QAbstractItemModelTester modelTest(&model);
+
+        QPersistentModelIndex idx2(model.index(1, 0));
+        QPersistentModelIndex idx4(model.index(3, 0));
+        QPersistentModelIndex idx5(model.index(4, 0));
+        model.setEntries(makeEntries({0, 5, 2, 3}));
+
+        QVERIFY(idx2.isValid());
+        QCOMPARE(idx2.row(), 2);
+        QCOMPARE(idx2.data(Qt::UserRole).toInt(), 2);
+        QVERIFY(!idx4.isValid());
+        QVERIFY(idx5.isValid());
+        QCOMPARE(idx5.row(), 1);
+        QCOMPARE(idx5.data(Qt::UserRole).toInt(), 5);
+    }
+
+    void testRandom()
+    {
+        TestModel model(true);
+        QAbstractItemModelTester modelTest(&model);
+        auto rng = QRandomGenerator(42);
+        for (int i = 0; i < 200; ++i) {
+            std::vector<int> keys(rng.bounded(30));
+            std::generate(keys.begin(), keys.end(), [&rng]() { return (int)rng.bounded(40); });
+            model.setEntries(makeEntries(keys, QString::number(rng.bounded(2))));
+            QCOMPARE(model.keys(), keys);
+        }
+    }
+
+    void benchmarkChurn_data()
+    {
+        QTest::addColumn<bool>("incremental");
+        QTest::newRow("reset") << false;
+        QTest::newRow("diff") << true;
+    }
+
+    void benchmarkChurn()
+    {
+        QFETCH(bool, incremental);
+
+        // a small change to a large model, such as a changed time range or reloaded map data
+        auto oldKeys = range(1000);
+        auto newKeys = oldKeys;
+        newKeys.erase(newKeys.begin() + 100);
+        newKeys.insert(newKeys.begin() + 500, 1000);
+
+        TestModel model(incremental);
+        QBENCHMARK {
+            model.setEntries(makeEntries(oldKeys));
+            model.m_churn = 0;
+            auto entries = makeEntries(newKeys);
+            entries[800].value = QStringLiteral("changed");
+            model.setEntries(std::move(entries));
+        }
+        QCOMPARE(model.keys(), newKeys);
+        QCOMPARE(model.m_churn, incremental ? 2 : 1000);
+    }
+};
+
+QTEST_GUILESS_MAIN(ModelDiffTest)
+
+#include "modeldifftest.moc"
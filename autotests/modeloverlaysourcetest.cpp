@@ -0,0 +1,264 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <KOSMIndoorMap/EquipmentModel>
+#include <KOSMIndoorMap/OverlaySource>
+
+#include <osm/datatypes.h>
+#include <osm/element.h>
+
+#include <QSignalSpy>
+#include <QStandardItemModel>
+#include <QTest>
+
+#include <algorithm>
+#include <map>
+
+using namespace KOSMIndoorMap;
+
+/** Overlay source keeping its own per-floor element lists, as third-party sources would. */
+class FloorListOverlaySource : public AbstractOverlaySource
+{
+public:
+    explicit FloorListOverlaySource(bool provideFloorLists)
+        : AbstractOverlaySource(nullptr)
+    {
+        if (provideFloorLists) {
+            setElementsForFloorFunction([this](int floorLevel) {
+                const auto it = floors.find(floorLevel);
+                return it == floors.end() ? &empty : &(*it).second;
+            });
+        }
+    }
+
+    void forEach(int floorLevel, const std::function<void(OSM::Element, int)> &func) const override
+    {
+        if (const auto it = floors.find(floorLevel); it != floors.end()) {
+            std::for_each((*it).second.begin(), (*it).second.end(), [&func, floorLevel](auto e) { func(e, floorLevel); });
+        }
+    }
+
+    std::map<int, std::vector<OSM::Element>> floors;
+    const std::vector<OSM::Element> empty;
+};
+
+class ModelOverlaySourceTest : public QObject
+{
+    Q_OBJECT
+private:
+    enum {
+        ElementRole = Qt::UserRole,
+        LevelRole,
+        HiddenElementRole,
+    };
+
+    OSM::DataSet m_dataSet;
+
+    OSM::Element node(OSM::Id id) const
+    {
+        return OSM::Element(m_dataSet.node(id));
+    }
+
+    QStandardItem* makeItem(OSM::Id id, int level, OSM::Id hiddenId = 0) const
+    {
+        auto item = new QStandardItem;
+        item->setData(QVariant::fromValue(node(id)), ElementRole);
+        item->setData(level, LevelRole);
+        if (hiddenId) {
+            item->setData(QVariant::fromValue(node(hiddenId)), HiddenElementRole);
+        }
+        return item;
+    }
+
+    static void setupModel(QStandardItemModel &model)
+    {
+        model.setItemRoleNames({
+            { ElementRole, "osmElement" },
+            { LevelRole, "level" },
+            { HiddenElementRole, "hiddenElement" },
+        });
+    }
+
+    static std::vector<OSM::Id> floorIds(const AbstractOverlaySource &source, int level)
+    {
+        std::vector<OSM::Id> ids;
+        const auto elems = source.elementsForFloor(level);
+        if (!elems) {
+            return ids;
+        }
+        std::transform(elems->begin(), elems->end(), std::back_inserter(ids), [](auto e) { return e.id(); });
+
+        // forEach has to produce the same result
+        std::vector<OSM::Id> forEachIds;
+        source.forEach(level, [&forEachIds, level](OSM::Element e, int floorLevel) {
+            QCOMPARE(floorLevel, level);
+            forEachIds.push_back(e.id());
+        });
+        if (ids != forEachIds) {
+            qWarning() << "elementsForFloor and forEach disagree";
+            return {};
+        }
+        return ids;
+    }
+
+    static std::vector<OSM::Id> hiddenIds(const ModelOverlaySource &source)
+    {
+        std::vector<OSM::Element> elems;
+        source.hiddenElements(elems);
+        std::vector<OSM::Id> ids;
+        std::transform(elems.begin(), elems.end(), std::back_inserter(ids), [](auto e) { return e.id(); });
+        return ids;
+    }
+
+    static std::vector<OSM::Id> sortedIds(const std::vector<OSM::Element> &elems)
+    {
+        std::vector<OSM::Id> ids;
+        std::transform(elems.begin(), elems.end(), std::back_inserter(ids), [](auto e) { return e.id(); });
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        return ids;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        for (OSM::Id id = 1; id <= 10; ++id) {
+            OSM::Node n;
+            n.id = id;
+            m_dataSet.addNode(std::move(n));
+        }
+    }
+
+    void testFloorLists()
+    {
+        QStandardItemModel model;
+        setupModel(model);
+        model.appendRow(makeItem(1, 0));
+        model.appendRow(makeItem(2, 10));
+        model.appendRow(makeItem(3, 0, 8));
+
+        ModelOverlaySource source(&model);
+        QSignalSpy updateSpy(&source, &AbstractOverlaySource::update);
+        QCOMPARE(floorIds(source, 0), (std::vector<OSM::Id>{1, 3}));
+        QCOMPARE(floorIds(source, 10), (std::vector<OSM::Id>{2}));
+        QVERIFY(floorIds(source, 20).empty());
+        QCOMPARE(hiddenIds(source), (std::vector<OSM::Id>{8}));
+
+        // insertion
+        model.insertRow(1, makeItem(4, 0));
+        QCOMPARE(updateSpy.size(), 1);
+        QCOMPARE(floorIds(source, 0), (std::vector<OSM::Id>{1, 4, 3}));
+        QCOMPARE(floorIds(source, 10), (std::vector<OSM::Id>{2}));
+
+        // floor level change moves the element between lists
+        model.item(1)->setData(10, LevelRole);
+        QCOMPARE(floorIds(source, 0), (std::vector<OSM::Id>{1, 3}));
+        QCOMPARE(floorIds(source, 10), (std::vector<OSM::Id>{4, 2}));
+
+        // hidden element changes
+        model.item(0)->setData(QVariant::fromValue(node(9)), HiddenElementRole);
+        QCOMPARE(hiddenIds(source), (std::vector<OSM::Id>{9, 8}));
+        model.item(3)->setData(QVariant(), HiddenElementRole);
+        QCOMPARE(hiddenIds(source), (std::vector<OSM::Id>{9}));
+
+        // removal, including emptying a floor entirely
+        model.removeRows(1, 2);
+        QCOMPARE(floorIds(source, 0), (std::vector<OSM::Id>{1, 3}));
+        QVERIFY(floorIds(source, 10).empty());
+        QCOMPARE(hiddenIds(source), (std::vector<OSM::Id>{9}));
+        model.removeRow(0);
+        QCOMPARE(floorIds(source, 0), (std::vector<OSM::Id>{3}));
+        QVERIFY(hiddenIds(source).empty());
+
+        // reset
+        model.clear();
+        setupModel(model);
+        QVERIFY(floorIds(source, 0).empty());
+        model.appendRow(makeItem(5, 20));
+        QCOMPARE(floorIds(source, 20), (std::vector<OSM::Id>{5}));
+    }
+
+    void testChildRows()
+    {
+        QStandardItemModel model;
+        setupModel(model);
+        auto parent = makeItem(1, 0);
+        parent->appendRow(makeItem(2, 0));
+        parent->appendRow(makeItem(3, 10));
+        model.appendRow(parent);
+
+        ModelOverlaySource source(&model);
+        // children come first, and only count when on the same floor as their parent
+        QCOMPARE(floorIds(source, 0), (std::vector<OSM::Id>{2, 1}));
+        QVERIFY(floorIds(source, 10).empty());
+
+        parent->appendRow(makeItem(4, 0));
+        QCOMPARE(floorIds(source, 0), (std::vector<OSM::Id>{2, 4, 1}));
+        parent->removeRow(0);
+        QCOMPARE(floorIds(source, 0), (std::vector<OSM::Id>{4, 1}));
+    }
+
+    void testChangedElements()
+    {
+        QStandardItemModel model;
+        setupModel(model);
+        model.appendRow(makeItem(1, 0));
+        model.appendRow(makeItem(2, 10));
+
+        ModelOverlaySource source(&model);
+        std::vector<OSM::Element> changed;
+        // initially everything is new
+        QVERIFY(!source.takeChangedElements(changed));
+        QVERIFY(source.takeChangedElements(changed));
+        QVERIFY(changed.empty());
+
+        model.insertRow(1, makeItem(3, 0));
+        QVERIFY(source.takeChangedElements(changed));
+        QCOMPARE(sortedIds(changed), (std::vector<OSM::Id>{3}));
+        changed.clear();
+
+        // data changes affect the previous and the new element, and accumulate until taken
+        model.item(1)->setData(QVariant::fromValue(node(4)), ElementRole);
+        model.removeRow(0);
+        QVERIFY(source.takeChangedElements(changed));
+        QCOMPARE(sortedIds(changed), (std::vector<OSM::Id>{1, 3, 4}));
+        changed.clear();
+
+        // hidden element changes only report the element of the row, the scene controller compares hidden elements itself
+        model.item(1)->setData(QVariant::fromValue(node(8)), HiddenElementRole);
+        QVERIFY(source.takeChangedElements(changed));
+        QCOMPARE(sortedIds(changed), (std::vector<OSM::Id>{2}));
+        changed.clear();
+
+        // resets change everything
+        model.clear();
+        setupModel(model);
+        QVERIFY(!source.takeChangedElements(changed));
+        QVERIFY(changed.empty());
+    }
+
+    void testCustomSource()
+    {
+        FloorListOverlaySource source(true);
+        source.floors[0] = { node(1), node(2) };
+        source.floors[10] = { node(3) };
+        QCOMPARE(floorIds(source, 0), (std::vector<OSM::Id>{1, 2}));
+        QCOMPARE(floorIds(source, 10), (std::vector<OSM::Id>{3}));
+        QVERIFY(floorIds(source, 20).empty());
+
+        // without per-floor lists, elements are only available via forEach
+        FloorListOverlaySource plainSource(false);
+        plainSource.floors[0] = { node(1) };
+        QVERIFY(!plainSource.elementsForFloor(0));
+
+        // sub-classes without private data of their own
+        EquipmentModel equipment;
+        QVERIFY(!equipment.elementsForFloor(0));
+    }
+};
+
+QTEST_GUILESS_MAIN(ModelOverlaySourceTest)
+
+#include "modeloverlaysourcetest.moc"
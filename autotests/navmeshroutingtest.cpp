@@ -0,0 +1,408 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <KOSMIndoorRouting/AgentProfile>
+#include <KOSMIndoorRouting/Isochrone>
+#include <KOSMIndoorRouting/NavMesh>
+#include <KOSMIndoorRouting/NavMeshBuilder>
+#include <KOSMIndoorRouting/NavMeshPosition>
+#include <KOSMIndoorRouting/NavMeshTransform>
+#include <KOSMIndoorRouting/Route>
+#include <KOSMIndoorRouting/RoutingJob>
+#include <KOSMIndoorRouting/RoutingProfile>
+
+#include <KOSMIndoorMap/EquipmentModel>
+#include <KOSMIndoorMap/MapData>
+#include <KOSMIndoorMap/MapLoader>
+
+#include <osm/geomath.h>
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std::chrono_literals;
+using namespace KOSMIndoorMap;
+using namespace KOSMIndoorRouting;
+
+class NavMeshRoutingTest : public QObject
+{
+    Q_OBJECT
+private:
+    MapData m_data;
+    EquipmentModel m_equipmentModel;
+    NavMesh m_navMesh;
+    NavMeshPosition m_start;
+    NavMeshPosition m_end;
+
+    [[nodiscard]] static Route route(const NavMesh &navMesh, NavMeshPosition from, NavMeshPosition to, const RoutingProfile &profile = RoutingProfile())
+    {
+        RoutingJob job;
+        job.setNavMesh(navMesh);
+        job.setStart(navMesh.transform().mapGeoHeightToNav(from.coordinate, from.floorLevel));
+        job.setEnd(navMesh.transform().mapGeoHeightToNav(to.coordinate, to.floorLevel));
+        job.setRoutingProfile(profile);
+        QSignalSpy finishedSpy(&job, &RoutingJob::finished);
+        job.start();
+        if (!finishedSpy.wait()) {
+            return {};
+        }
+        return job.route();
+    }
+
+    [[nodiscard]] std::vector<NavMesh> buildNavMeshes(const std::vector<AgentProfile> &agents)
+    {
+        NavMeshBuilder builder;
+        builder.setMapData(m_data);
+        builder.setEquipmentModel(&m_equipmentModel);
+        builder.setAgentProfiles(agents);
+        QSignalSpy finishedSpy(&builder, &NavMeshBuilder::finished);
+        builder.start();
+        if (!finishedSpy.wait(60000)) {
+            return {};
+        }
+        std::vector<NavMesh> navMeshes;
+        for (const auto &agent : agents) {
+            navMeshes.push_back(builder.navMesh(agent));
+        }
+        return navMeshes;
+    }
+
+    [[nodiscard]] static bool isSameRoute(const Route &lhs, const Route &rhs)
+    {
+        return std::equal(lhs.steps().begin(), lhs.steps().end(), rhs.steps().begin(), rhs.steps().end(), [](const auto &l, const auto &r) {
+            return l.floorLevel == r.floorLevel && OSM::distance(l.coordinate, r.coordinate) < 0.01;
+        });
+    }
+
+    [[nodiscard]] bool reachesEnd(const Route &route) const
+    {
+        return !route.steps().empty() && OSM::distance(route.steps().back().coordinate, m_end.coordinate) < 1.0;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        MapLoader loader;
+        QSignalSpy doneSpy(&loader, &MapLoader::done);
+        loader.loadFromFile(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-altona.osm"));
+        QVERIFY(doneSpy.wait());
+        QVERIFY(!loader.hasError());
+        m_data = loader.takeData();
+        m_equipmentModel.setMapData(m_data);
+
+        NavMeshBuilder builder;
+        builder.setMapData(m_data);
+        builder.setEquipmentModel(&m_equipmentModel);
+        QSignalSpy finishedSpy(&builder, &NavMeshBuilder::finished);
+        builder.start();
+        QVERIFY(finishedSpy.wait(60000));
+        m_navMesh = builder.navMesh();
+        if (!m_navMesh.isValid()) {
+            QSKIP("built without nav mesh support");
+        }
+
+        m_start = m_navMesh.snap({m_data.boundingBox().center(), 0}, 200.0f);
+        QVERIFY(m_start.isValid());
+
+        // the most distant point reachable within a few minutes
+        const auto iso = m_navMesh.isochrone(m_start.coordinate, m_start.floorLevel, RoutingProfile(), 3min);
+        QVERIFY(!iso.polygons().empty());
+        const auto &farthest = iso.polygons().back();
+        double lat = 0.0, lon = 0.0;
+        for (std::size_t i = 0; i + 1 < farthest.outline.size(); ++i) {
+            lat += farthest.outline[i].latF();
+            lon += farthest.outline[i].lonF();
+        }
+        const auto n = (double)(farthest.outline.size() - 1);
+        m_end = m_navMesh.snap({OSM::Coordinate(lat / n, lon / n), farthest.floorLevel}, 5.0f);
+        QVERIFY(m_end.isValid());
+    }
+
+    void testIsochrone()
+    {
+        RoutingProfile profile;
+        const auto iso1 = m_navMesh.isochrone(m_start.coordinate, m_start.floorLevel, profile, 1min);
+        QVERIFY(!iso1.polygons().empty());
+        QVERIFY(!iso1.contours().empty());
+        QCOMPARE(iso1.polygons().front().duration.count(), 0.0f);
+        QVERIFY(std::is_sorted(iso1.polygons().begin(), iso1.polygons().end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.duration < rhs.duration;
+        }));
+        QVERIFY(iso1.polygons().back().duration <= 60s);
+
+        // more time reaches more
+        const auto iso3 = m_navMesh.isochrone(m_start.coordinate, m_start.floorLevel, profile, 3min);
+        QVERIFY(iso3.polygons().size() > iso1.polygons().size());
+        QVERIFY(iso3.polygons().back().duration <= 180s);
+
+        // walking twice as fast reaches the same area in half the time
+        auto fastProfile = profile;
+        fastProfile.setWalkingSpeed(profile.walkingSpeed() * 2.0f);
+        const auto iso1Fast = m_navMesh.isochrone(m_start.coordinate, m_start.floorLevel, fastProfile, 1min);
+        const auto iso2 = m_navMesh.isochrone(m_start.coordinate, m_start.floorLevel, profile, 2min);
+        QCOMPARE(iso1Fast.polygons().size(), iso2.polygons().size());
+        for (std::size_t i = 0; i < iso2.polygons().size(); ++i) {
+            QVERIFY(std::abs(iso1Fast.polygons()[i].duration.count() * 2.0f - iso2.polygons()[i].duration.count()) < 0.01f);
+        }
+
+        // nothing reachable from outside the nav mesh
+        QVERIFY(m_navMesh.isochrone(m_start.coordinate, 990, profile, 1min).polygons().empty());
+    }
+
+    void testOffMeshEndpoints()
+    {
+        // a position some distance away from any walkable area
+        NavMeshPosition offMesh;
+        NavMeshPosition snapped;
+        const auto bbox = m_data.boundingBox();
+        for (int i = 0; i < 20 && !offMesh.isValid(); ++i) {
+            for (int j = 0; j < 20; ++j) {
+                const NavMeshPosition pos{OSM::Coordinate(bbox.min.latF() + bbox.heightF() * i / 19.0, bbox.min.lonF() + bbox.widthF() * j / 19.0), m_start.floorLevel};
+                const auto s = m_navMesh.snap(pos, 20.0f);
+                if (s.isValid() && s.floorLevel == pos.floorLevel && OSM::distance(s.coordinate, pos.coordinate) > 3.0) {
+                    offMesh = pos;
+                    snapped = s;
+                    break;
+                }
+            }
+        }
+        QVERIFY(offMesh.isValid());
+
+        // routes from and to it start/end at the snapped position
+        const auto fromRoute = route(m_navMesh, offMesh, m_end);
+        QVERIFY(reachesEnd(fromRoute));
+        QVERIFY(OSM::distance(fromRoute.steps().front().coordinate, snapped.coordinate) < 1.0);
+        const auto toRoute = route(m_navMesh, m_start, offMesh);
+        QVERIFY(!toRoute.steps().empty());
+        QVERIFY(OSM::distance(toRoute.steps().back().coordinate, snapped.coordinate) < 1.0);
+    }
+
+    void testClosures()
+    {
+        const auto baseRoute = route(m_navMesh, m_start, m_end);
+        QVERIFY(reachesEnd(baseRoute));
+        QVERIFY(baseRoute.steps().size() >= 2);
+
+        // close the middle of the longest route segment
+        const RouteStep *closureStep = nullptr;
+        double longestSegment = 0.0;
+        for (std::size_t i = 1; i < baseRoute.steps().size(); ++i) {
+            const auto &s0 = baseRoute.steps()[i - 1];
+            const auto &s1 = baseRoute.steps()[i];
+            const auto dist = OSM::distance(s0.coordinate, s1.coordinate);
+            if (s0.floorLevel == s1.floorLevel && dist > longestSegment) {
+                longestSegment = dist;
+                closureStep = &s0;
+            }
+        }
+        QVERIFY(closureStep);
+        const auto &nextStep = *(closureStep + 1);
+        const OSM::Coordinate closureCoord((closureStep->coordinate.latF() + nextStep.coordinate.latF()) / 2.0, (closureStep->coordinate.lonF() + nextStep.coordinate.lonF()) / 2.0);
+
+        // excluded: the original route can't be taken anymore
+        auto closureId = m_navMesh.addClosure(closureCoord, closureStep->floorLevel, NavMesh::ClosureMode::Exclude);
+        QVERIFY(closureId > 0);
+        const auto excludedRoute = route(m_navMesh, m_start, m_end);
+        QVERIFY(!isSameRoute(excludedRoute, baseRoute));
+
+        // removing the closure restores the original route
+        m_navMesh.removeClosure(closureId);
+        QVERIFY(isSameRoute(route(m_navMesh, m_start, m_end), baseRoute));
+
+        // penalized: the penalty is applied on top of the original area cost, a neutral penalty changes nothing
+        m_navMesh.setClosurePenalty(1.0f);
+        closureId = m_navMesh.addClosure(closureCoord, closureStep->floorLevel, NavMesh::ClosureMode::Penalize);
+        QVERIFY(closureId > 0);
+        QVERIFY(isSameRoute(route(m_navMesh, m_start, m_end), baseRoute));
+
+        // a high penalty is avoided if possible, but unlike exclusion never makes the destination unreachable
+        m_navMesh.setClosurePenalty(1000.0f);
+        const auto penalizedRoute = route(m_navMesh, m_start, m_end);
+        QVERIFY(reachesEnd(penalizedRoute));
+        if (reachesEnd(excludedRoute)) {
+            QVERIFY(!isSameRoute(penalizedRoute, baseRoute));
+        }
+
+        // exclusion takes precedence over penalization of the same area
+        const auto excludeId = m_navMesh.addClosure(closureCoord, closureStep->floorLevel, NavMesh::ClosureMode::Exclude);
+        QVERIFY(isSameRoute(route(m_navMesh, m_start, m_end), excludedRoute));
+        m_navMesh.removeClosure(excludeId);
+        QVERIFY(isSameRoute(route(m_navMesh, m_start, m_end), penalizedRoute));
+
+        m_navMesh.removeClosure(closureId);
+        QVERIFY(isSameRoute(route(m_navMesh, m_start, m_end), baseRoute));
+        m_navMesh.setClosurePenalty(50.0f);
+    }
+
+    void testLargeClosure()
+    {
+        const auto baseRoute = route(m_navMesh, m_start, m_end);
+        QVERIFY(reachesEnd(baseRoute));
+
+        // closing the entire floor, which can exceed the initial polygon query buffer
+        const auto bbox = m_data.boundingBox();
+        const std::vector<OSM::Coordinate> polygon{
+            bbox.min, OSM::Coordinate(bbox.min.latF(), bbox.max.lonF()), bbox.max, OSM::Coordinate(bbox.max.latF(), bbox.min.lonF()), bbox.min
+        };
+        const auto closureId = m_navMesh.addClosure(polygon, m_start.floorLevel, NavMesh::ClosureMode::Exclude);
+        QVERIFY(closureId > 0);
+        QVERIFY(m_navMesh.isochrone(m_start.coordinate, m_start.floorLevel, RoutingProfile(), 3min).polygons().empty());
+        QVERIFY(!reachesEnd(route(m_navMesh, m_start, m_end)));
+
+        m_navMesh.clearClosures();
+        QVERIFY(isSameRoute(route(m_navMesh, m_start, m_end), baseRoute));
+    }
+
+    void testLazyTileBuilding()
+    {
+        NavMeshBuilder builder;
+        builder.setMapData(m_data);
+        builder.setEquipmentModel(&m_equipmentModel);
+        builder.setLazyTileBuilding(true);
+        QSignalSpy finishedSpy(&builder, &NavMeshBuilder::finished);
+        builder.start();
+        QVERIFY(finishedSpy.wait(60000));
+        const auto lazyNavMesh = builder.navMesh();
+        QVERIFY(lazyNavMesh.isValid());
+
+        // routes between points spread over the entire map, starting before all tiles are built
+        std::vector<NavMeshPosition> positions{ m_start, m_end };
+        const auto bbox = m_data.boundingBox();
+        for (int i = 0; i < 4; ++i) {
+            for (int j = 0; j < 4; ++j) {
+                const OSM::Coordinate coord(bbox.min.latF() + bbox.heightF() * (i + 0.5) / 4.0, bbox.min.lonF() + bbox.widthF() * (j + 0.5) / 4.0);
+                if (const auto pos = m_navMesh.snap({coord, m_start.floorLevel}, 50.0f); pos.isValid()) {
+                    positions.push_back(pos);
+                }
+            }
+        }
+        QVERIFY(positions.size() > 4);
+
+        int routeCount = 0;
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            for (std::size_t j = i + 1; j < positions.size(); j += 3) {
+                const auto eagerRoute = route(m_navMesh, positions[i], positions[j]);
+                const auto lazyRoute = route(lazyNavMesh, positions[i], positions[j]);
+                QVERIFY(isSameRoute(lazyRoute, eagerRoute));
+                routeCount += eagerRoute.steps().empty() ? 0 : 1;
+            }
+        }
+        QVERIFY(routeCount > 0);
+
+        RoutingProfile profile;
+        const auto eagerIso = m_navMesh.isochrone(m_start.coordinate, m_start.floorLevel, profile, 2min);
+        const auto lazyIso = lazyNavMesh.isochrone(m_start.coordinate, m_start.floorLevel, profile, 2min);
+        QCOMPARE(lazyIso.polygons().size(), eagerIso.polygons().size());
+    }
+
+    void testAgentProfiles()
+    {
+        // wheelchair, stroller with the same climb but a smaller radius and thus using a cropped copy of the
+        // wheelchair rasterization, default, and one that only differs in height from the default
+        const std::vector<AgentProfile> agents{
+            AgentProfile{ .height = 1.5f, .radius = 0.5f, .maxClimb = 0.05f },
+            AgentProfile{ .height = 1.8f, .radius = 0.3f, .maxClimb = 0.1f },
+            AgentProfile{},
+            AgentProfile{ .height = 2.2f, .radius = 0.2f, .maxClimb = 0.9f },
+        };
+        const auto combined = buildNavMeshes(agents);
+        QCOMPARE(combined.size(), agents.size());
+
+        RoutingProfile profile;
+        for (std::size_t i = 0; i < agents.size(); ++i) {
+            const auto separate = buildNavMeshes({agents[i]});
+            QCOMPARE(separate.size(), 1);
+            QVERIFY(combined[i].isValid());
+            QVERIFY(separate[0].isValid());
+
+            const auto from = separate[0].snap({m_start.coordinate, m_start.floorLevel}, 5.0f);
+            const auto to = separate[0].snap({m_end.coordinate, m_end.floorLevel}, 5.0f);
+            QVERIFY(from.isValid());
+            QVERIFY(to.isValid());
+            QVERIFY(isSameRoute(route(combined[i], from, to), route(separate[0], from, to)));
+
+            const auto combinedIso = combined[i].isochrone(from.coordinate, from.floorLevel, profile, 2min);
+            const auto separateIso = separate[0].isochrone(from.coordinate, from.floorLevel, profile, 2min);
+            QVERIFY(!separateIso.polygons().empty());
+            QCOMPARE(combinedIso.polygons().size(), separateIso.polygons().size());
+        }
+    }
+
+    void benchmarkAgentProfiles_data()
+    {
+        QTest::addColumn<bool>("combined");
+        QTest::newRow("combined") << true;
+        QTest::newRow("separate") << false;
+    }
+
+    void benchmarkAgentProfiles()
+    {
+        QFETCH(bool, combined);
+        // wheelchair, stroller and pedestrian
+        const std::vector<AgentProfile> agents{
+            AgentProfile{ .height = 1.5f, .radius = 0.5f, .maxClimb = 0.05f },
+            AgentProfile{ .height = 1.8f, .radius = 0.3f, .maxClimb = 0.1f },
+            AgentProfile{},
+        };
+        QBENCHMARK_ONCE {
+            if (combined) {
+                QCOMPARE(buildNavMeshes(agents).size(), agents.size());
+            } else {
+                for (const auto &agent : agents) {
+                    QCOMPARE(buildNavMeshes({agent}).size(), 1);
+                }
+            }
+        }
+    }
+
+    void benchmarkClosure_data()
+    {
+        QTest::addColumn<bool>("area");
+        QTest::newRow("point") << false;
+        QTest::newRow("area") << true;
+    }
+
+    void benchmarkClosure()
+    {
+        QFETCH(bool, area);
+        // a closure of about 20m x 20m around the start position, or just the polygon there
+        const auto &c = m_start.coordinate;
+        const std::vector<OSM::Coordinate> polygon{
+            OSM::Coordinate(c.latF() - 0.0001, c.lonF() - 0.00015), OSM::Coordinate(c.latF() - 0.0001, c.lonF() + 0.00015),
+            OSM::Coordinate(c.latF() + 0.0001, c.lonF() + 0.00015), OSM::Coordinate(c.latF() + 0.0001, c.lonF() - 0.00015),
+            OSM::Coordinate(c.latF() - 0.0001, c.lonF() - 0.00015),
+        };
+        QBENCHMARK {
+            const auto closureId = area ? m_navMesh.addClosure(polygon, m_start.floorLevel) : m_navMesh.addClosure(c, m_start.floorLevel);
+            QVERIFY(closureId > 0);
+            m_navMesh.removeClosure(closureId);
+        }
+    }
+
+    void benchmarkIsochrone_data()
+    {
+        QTest::addColumn<int>("minutes");
+        QTest::newRow("1min") << 1;
+        QTest::newRow("3min") << 3;
+        QTest::newRow("10min") << 10;
+    }
+
+    void benchmarkIsochrone()
+    {
+        QFETCH(int, minutes);
+        RoutingProfile profile;
+        QBENCHMARK {
+            const auto iso = m_navMesh.isochrone(m_start.coordinate, m_start.floorLevel, profile, std::chrono::minutes(minutes));
+            QVERIFY(!iso.polygons().empty());
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(NavMeshRoutingTest)
+
+#include "navmeshroutingtest.moc"
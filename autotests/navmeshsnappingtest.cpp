@@ -0,0 +1,149 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <KOSMIndoorRouting/NavMesh>
+#include <KOSMIndoorRouting/NavMeshBuilder>
+#include <KOSMIndoorRouting/NavMeshPosition>
+#include <KOSMIndoorRouting/RoutingArea>
+#include <KOSMIndoorRouting/RoutingProfile>
+
+#include <KOSMIndoorMap/EquipmentModel>
+#include <KOSMIndoorMap/MapData>
+#include <KOSMIndoorMap/MapLoader>
+
+#include <osm/geomath.h>
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include <cmath>
+
+using namespace KOSMIndoorMap;
+using namespace KOSMIndoorRouting;
+
+class NavMeshSnappingTest : public QObject
+{
+    Q_OBJECT
+private:
+    MapData m_data;
+    EquipmentModel m_equipmentModel;
+    NavMesh m_navMesh;
+
+    // grid of positions covering the entire map area
+    [[nodiscard]] std::vector<NavMeshPosition> gridPositions(int size) const
+    {
+        std::vector<NavMeshPosition> positions;
+        positions.reserve(size * size);
+        const auto bbox = m_data.boundingBox();
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                const auto lat = bbox.min.latF() + bbox.heightF() * i / (size - 1);
+                const auto lon = bbox.min.lonF() + bbox.widthF() * j / (size - 1);
+                positions.push_back({OSM::Coordinate(lat, lon), 0});
+            }
+        }
+        return positions;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        MapLoader loader;
+        QSignalSpy doneSpy(&loader, &MapLoader::done);
+        loader.loadFromFile(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-altona.osm"));
+        QVERIFY(doneSpy.wait());
+        QVERIFY(!loader.hasError());
+        m_data = loader.takeData();
+        m_equipmentModel.setMapData(m_data);
+
+        NavMeshBuilder builder;
+        builder.setMapData(m_data);
+        builder.setEquipmentModel(&m_equipmentModel);
+        QSignalSpy finishedSpy(&builder, &NavMeshBuilder::finished);
+        builder.start();
+        QVERIFY(finishedSpy.wait(60000));
+        m_navMesh = builder.navMesh();
+        if (!m_navMesh.isValid()) {
+            QSKIP("built without nav mesh support");
+        }
+    }
+
+    void testSnap()
+    {
+        const auto positions = gridPositions(50);
+        const auto snapped = m_navMesh.snap(positions, 25.0f);
+        QCOMPARE(snapped.size(), positions.size());
+
+        int snapCount = 0;
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            if (!snapped[i].isValid()) {
+                continue;
+            }
+            ++snapCount;
+            // the floor level is that of the snapped point, which differs on stairs or ramps
+            QVERIFY(std::abs(snapped[i].floorLevel - positions[i].floorLevel) <= 10);
+            QVERIFY(OSM::distance(snapped[i].coordinate, positions[i].coordinate) <= 25.5);
+
+            // snapping is idempotent, and matches the batch result
+            const auto resnapped = m_navMesh.snap(snapped[i], 25.0f);
+            QVERIFY(resnapped.isValid());
+            QVERIFY(OSM::distance(resnapped.coordinate, snapped[i].coordinate) < 0.1);
+            const auto single = m_navMesh.snap(positions[i], 25.0f);
+            QVERIFY(single.isValid());
+            QCOMPARE(single.coordinate, snapped[i].coordinate);
+        }
+        QVERIFY(snapCount > 0);
+
+        // progressive search radius
+        std::size_t largeRadiusCount = 0;
+        for (const auto &pos : m_navMesh.snap(positions, 500.0f)) {
+            largeRadiusCount += pos.isValid() ? 1 : 0;
+        }
+        QVERIFY(largeRadiusCount >= (std::size_t)snapCount);
+
+        // invalid input and nothing on a non-existing floor
+        QVERIFY(!m_navMesh.snap(NavMeshPosition{}, 25.0f).isValid());
+        QVERIFY(!m_navMesh.snap(NavMeshPosition{positions[0].coordinate, 990}, 500.0f).isValid());
+    }
+
+    void testSnapProfile()
+    {
+        const auto positions = gridPositions(30);
+        const auto snapped = m_navMesh.snap(positions, 25.0f);
+
+        // fewer usable areas never result in a closer snap position
+        RoutingProfile wheelchair;
+        wheelchair.setFlags(wheelchair.flags() & ~AreaFlags(AreaFlag::Stairs | AreaFlag::Escalator));
+        const auto restricted = m_navMesh.snap(positions, wheelchair, 25.0f);
+        QCOMPARE(restricted.size(), positions.size());
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            if (!restricted[i].isValid()) {
+                continue;
+            }
+            QVERIFY(snapped[i].isValid());
+            QVERIFY(OSM::distance(restricted[i].coordinate, positions[i].coordinate) >= OSM::distance(snapped[i].coordinate, positions[i].coordinate) - 0.01);
+        }
+
+        // nothing usable at all
+        RoutingProfile none;
+        none.setFlags(AreaFlag::NoFlag);
+        for (const auto &pos : m_navMesh.snap(positions, none, 25.0f)) {
+            QVERIFY(!pos.isValid());
+        }
+    }
+
+    void benchmarkBatchSnap()
+    {
+        const auto positions = gridPositions(100);
+        QBENCHMARK {
+            const auto snapped = m_navMesh.snap(positions, 25.0f);
+            QCOMPARE(snapped.size(), positions.size());
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(NavMeshSnappingTest)
+
+#include "navmeshsnappingtest.moc"
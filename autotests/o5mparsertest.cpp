@@ -5,14 +5,77 @@
 */
 
 #include <osm/datatypes.h>
+#include <osm/io.h>
 #include <osm/o5mparser.h>
 
+#include <QBuffer>
 #include <QTest>
 
+#include <cstring>
+
 // see https://wiki.openstreetmap.org/wiki/O5m for the examples used below
 class O5mParserTest : public QObject
 {
     Q_OBJECT
+private:
+    // synthetic data set large enough to contain several reset markers
+    static QByteArray makeO5mData()
+    {
+        OSM::DataSet dataSet;
+        const auto nameKey = dataSet.makeTagKey("name");
+        const auto amenityKey = dataSet.makeTagKey("amenity");
+        const auto levelKey = dataSet.makeTagKey("level");
+        const auto outerRole = dataSet.makeRole("outer");
+        constexpr const char *amenities[] = { "toilets", "cafe", "atm", "vending_machine", "bench" };
+
+        for (int i = 0; i < 200000; ++i) {
+            OSM::Node node;
+            node.id = 1000 + i;
+            node.coordinate = OSM::Coordinate(52.5 + (i % 1000) * 0.00001, 13.3 + (i / 1000) * 0.00001);
+            if (i % 4 == 0) {
+                OSM::setTagValue(node, amenityKey, QByteArray(amenities[i % std::size(amenities)]));
+                OSM::setTagValue(node, levelKey, QByteArray::number(i % 3));
+                OSM::setTagValue(node, nameKey, "Node " + QByteArray::number(i));
+            }
+            dataSet.addNode(std::move(node));
+        }
+        for (int i = 0; i < 40000; ++i) {
+            OSM::Way way;
+            way.id = 500 + i;
+            for (int j = 0; j < 5; ++j) {
+                way.nodes.push_back(1000 + (i * 5 + j) % 200000);
+            }
+            OSM::setTagValue(way, levelKey, QByteArray::number(i % 3));
+            dataSet.addWay(std::move(way));
+        }
+        for (int i = 0; i < 20000; ++i) {
+            OSM::Relation rel;
+            rel.id = 100 + i;
+            OSM::Member mem;
+            mem.id = 500 + i;
+            mem.setType(OSM::Type::Way);
+            mem.setRole(outerRole);
+            rel.members.push_back(mem);
+            OSM::setTagValue(rel, nameKey, "Relation " + QByteArray::number(i));
+            dataSet.addRelation(std::move(rel));
+        }
+
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        auto writer = OSM::IO::writerForMimeType(u"application/vnd.openstreetmap.data+o5m");
+        writer->write(dataSet, &buffer);
+        return data;
+    }
+
+    template <typename Elem>
+    static bool compareTags(const Elem &lhs, const Elem &rhs)
+    {
+        return std::equal(lhs.tags.begin(), lhs.tags.end(), rhs.tags.begin(), rhs.tags.end(), [](const auto &lt, const auto &rt) {
+            return std::strcmp(lt.key.name(), rt.key.name()) == 0 && lt.value == rt.value;
+        });
+    }
+
 private Q_SLOTS:
     void testParseUnsignedInt_data()
     {
@@ -177,6 +240,73 @@ private Q_SLOTS:
         QCOMPARE(rel.tags[0].key.name(), "type");
         QCOMPARE(rel.tags[0].value, "multipolygon");
     }
+
+    void testParallelParsing()
+    {
+        const auto data = makeO5mData();
+        QVERIFY(data.count((char)0xff) > 3);
+
+        OSM::DataSet serialDataSet;
+        OSM::O5mParser serialParser(&serialDataSet);
+        serialParser.read(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+        QCOMPARE(serialDataSet.nodes.size(), 200000);
+        QCOMPARE(serialDataSet.ways.size(), 40000);
+        QCOMPARE(serialDataSet.relations.size(), 20000);
+
+        OSM::DataSet parallelDataSet;
+        OSM::O5mParser parallelParser(&parallelDataSet);
+        parallelParser.setThreadCount(0);
+        parallelParser.read(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+
+        QCOMPARE(parallelDataSet.nodes.size(), serialDataSet.nodes.size());
+        for (std::size_t i = 0; i < serialDataSet.nodes.size(); ++i) {
+            QCOMPARE(parallelDataSet.nodes[i].id, serialDataSet.nodes[i].id);
+            QCOMPARE(parallelDataSet.nodes[i].coordinate, serialDataSet.nodes[i].coordinate);
+            QVERIFY(compareTags(parallelDataSet.nodes[i], serialDataSet.nodes[i]));
+        }
+        QCOMPARE(parallelDataSet.ways.size(), serialDataSet.ways.size());
+        for (std::size_t i = 0; i < serialDataSet.ways.size(); ++i) {
+            QCOMPARE(parallelDataSet.ways[i].id, serialDataSet.ways[i].id);
+            QCOMPARE(parallelDataSet.ways[i].nodes, serialDataSet.ways[i].nodes);
+            QVERIFY(compareTags(parallelDataSet.ways[i], serialDataSet.ways[i]));
+        }
+        QCOMPARE(parallelDataSet.relations.size(), serialDataSet.relations.size());
+        for (std::size_t i = 0; i < serialDataSet.relations.size(); ++i) {
+            const auto &serialRel = serialDataSet.relations[i];
+            const auto &parallelRel = parallelDataSet.relations[i];
+            QCOMPARE(parallelRel.id, serialRel.id);
+            QCOMPARE(parallelRel.members.size(), serialRel.members.size());
+            for (std::size_t j = 0; j < serialRel.members.size(); ++j) {
+                QCOMPARE(parallelRel.members[j].id, serialRel.members[j].id);
+                QCOMPARE(parallelRel.members[j].type(), serialRel.members[j].type());
+                QCOMPARE(parallelRel.members[j].role().name(), serialRel.members[j].role().name());
+            }
+            QVERIFY(compareTags(parallelRel, serialRel));
+        }
+    }
+
+    void benchmarkParallelParsing_data()
+    {
+        QTest::addColumn<int>("threadCount");
+        QTest::newRow("serial") << 1;
+        QTest::newRow("2 threads") << 2;
+        QTest::newRow("4 threads") << 4;
+        QTest::newRow("8 threads") << 8;
+        QTest::newRow("all cores") << 0;
+    }
+
+    void benchmarkParallelParsing()
+    {
+        QFETCH(int, threadCount);
+        const auto data = makeO5mData();
+
+        QBENCHMARK {
+            OSM::DataSet dataSet;
+            OSM::O5mParser p(&dataSet);
+            p.setThreadCount(threadCount);
+            p.read(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+        }
+    }
 };
 
 QTEST_GUILESS_MAIN(O5mParserTest)
@@ -7,6 +7,7 @@
 #include <osm/datatypes.h>
 #include <osm/io.h>
 
+#include <QFile>
 #include <QTest>
 
 using namespace Qt::Literals::StringLiterals;
@@ -14,9 +15,28 @@ using namespace Qt::Literals::StringLiterals;
 class OscParserTest : public QObject
 {
     Q_OBJECT
+private:
+    static void read(OSM::AbstractReader *reader, QFile &file, bool fromData)
+    {
+        if (fromData) {
+            const auto data = file.readAll();
+            reader->read(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+        } else {
+            reader->read(&file);
+        }
+    }
+
 private Q_SLOTS:
+    void testChangesetLoad_data()
+    {
+        QTest::addColumn<bool>("fromData");
+        QTest::newRow("QIODevice") << false;
+        QTest::newRow("memory-mapped") << true;
+    }
+
     void testChangesetLoad()
     {
+        QFETCH(bool, fromData);
         OSM::DataSet dataSet;
 
         {
@@ -24,7 +44,7 @@ private Q_SLOTS:
             QVERIFY(p);
             QFile baseFile(QStringLiteral(SOURCE_DIR "/data/changeset/base.osm"));
             QVERIFY(baseFile.open(QFile::ReadOnly));
-            p->read(&baseFile);
+            read(p.get(), baseFile, fromData);
             QVERIFY(!p->hasError());
         }
         QCOMPARE(dataSet.ways.size(), 1);
@@ -35,7 +55,7 @@ private Q_SLOTS:
             QVERIFY(p);
             QFile changeFile(QStringLiteral(SOURCE_DIR "/data/changeset/changeset.osc"));
             QVERIFY(changeFile.open(QFile::ReadOnly));
-            p->read(&changeFile);
+            read(p.get(), changeFile, fromData);
             QVERIFY(!p->hasError());
         }
         QCOMPARE(dataSet.ways.size(), 1);
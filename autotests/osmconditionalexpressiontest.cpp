@@ -11,6 +11,9 @@
 #include <QFile>
 #include <QTest>
 
+#include <atomic>
+#include <thread>
+
 using namespace Qt::Literals;
 
 class OSMConditionalExpressionTest : public QObject
@@ -63,6 +66,130 @@ private Q_SLOTS:
             QCOMPARE(expr.evaluate(context), "talks");
         }
     }
+
+    void testCache()
+    {
+        OSMConditionalExpressionCache cache;
+        const auto expr1 = cache.expression("option 1 @ Mo-Fr; option 2 @ Sa-Su");
+        const auto expr2 = cache.expression("talks @ Sa-Su");
+        QCOMPARE(cache.expression("talks @ Sa-Su"), expr2);
+        QVERIFY(expr1 != expr2);
+        QCOMPARE(cache.expression("option 1 @ Mo-Fr; option 2 @ Sa-Su"), expr1);
+        QCOMPARE(cache.count(), 2);
+
+        OSM::DataSet dataSet;
+        OSM::Node node;
+        node.id = 1;
+        dataSet.addNode(std::move(node));
+        MapData mapData;
+        mapData.setDataSet(std::move(dataSet));
+
+        OpeningHoursCache ohCache;
+        ohCache.setMapData(mapData);
+        ohCache.setTimeRange({{2024, 7, 20}, {}}, {{2024, 7, 22}, {}});
+
+        OSMConditionalExpressionContext context;
+        context.element = mapData.dataSet().node(1);
+        context.openingHoursCache = &ohCache;
+        QCOMPARE(cache.expression("option 1 @ Mo-Fr; option 2 @ Sa-Su")->evaluate(context), "option 2");
+        QCOMPARE(cache.expression("talks @ Sa-Su")->evaluate(context), "talks");
+
+        cache.clear();
+        QCOMPARE(cache.count(), 0);
+        QCOMPARE(cache.expression("talks @ Sa-Su")->evaluate(context), "talks");
+        // expressions handed out before remain valid
+        QCOMPARE(expr2->evaluate(context), "talks");
+    }
+
+    void testCacheEviction()
+    {
+        OSMConditionalExpressionCache cache;
+        cache.setMaximumCount(10);
+        const auto first = cache.expression("no @ (Mo 00:00-01:00)");
+        for (int i = 1; i < 20; ++i) {
+            QVERIFY(cache.expression("no @ (Mo 00:00-" + QByteArray::number(i).rightJustified(2, '0') + ":00)"));
+        }
+        QCOMPARE(cache.count(), 10);
+        QVERIFY(cache.expression("no @ (Mo 00:00-01:00)") != first);
+    }
+
+    void testCacheConcurrency()
+    {
+        OSMConditionalExpressionCache cache;
+        cache.setMaximumCount(16);
+        std::vector<std::thread> threads;
+        std::atomic<int> failures = 0;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&cache, &failures, t]() {
+                for (int i = 0; i < 1000; ++i) {
+                    const auto source = "value" + QByteArray::number((i * (t + 1)) % 32) + " @ Mo-Fr";
+                    if (!cache.expression(source)) {
+                        ++failures;
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        QCOMPARE(failures.load(), 0);
+        QVERIFY(cache.count() <= 16);
+    }
+
+    void benchmarkStation_data()
+    {
+        QTest::addColumn<bool>("useCache");
+        QTest::newRow("uncached") << false;
+        QTest::newRow("cached") << true;
+    }
+
+    void benchmarkStation()
+    {
+        QFETCH(bool, useCache);
+
+        // station data set with typical access:conditional tagging added on all ways
+        const QString osmFile = QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-central.osm");
+        QFile inFile(osmFile);
+        QVERIFY(inFile.open(QFile::ReadOnly));
+        OSM::DataSet dataSet;
+        auto p = OSM::IO::readerForFileName(osmFile, &dataSet);
+        p->read(&inFile);
+        QVERIFY(!dataSet.ways.empty());
+
+        constexpr const char *conditions[] = {
+            "no @ (Mo-Fr 01:00-04:30)",
+            "no @ (00:30-04:30); private @ (Sa,Su 22:00-06:00)",
+            "yes @ (Mo-Sa 06:00-22:00); no @ (PH)",
+            "delivery @ (Mo-Fr 05:00-10:00)",
+        };
+        const auto key = dataSet.makeTagKey("access:conditional");
+        for (std::size_t i = 0; i < dataSet.ways.size(); ++i) {
+            OSM::setTagValue(dataSet.ways[i], key, QByteArray(conditions[i % std::size(conditions)]));
+        }
+
+        MapData mapData;
+        mapData.setDataSet(std::move(dataSet));
+        OpeningHoursCache ohCache;
+        ohCache.setMapData(mapData);
+        ohCache.setTimeRange({{2024, 7, 20}, {}}, {{2024, 7, 22}, {}});
+        OSMConditionalExpressionCache exprCache;
+
+        QBENCHMARK {
+            for (const auto &way : mapData.dataSet().ways) {
+                OSMConditionalExpressionContext context;
+                context.element = OSM::Element(&way);
+                context.openingHoursCache = &ohCache;
+                const auto cond = OSM::tagValue(way, key);
+                if (useCache) {
+                    (void)exprCache.expression(cond)->evaluate(context);
+                } else {
+                    OSMConditionalExpression expr;
+                    expr.parse(cond);
+                    (void)expr.evaluate(context);
+                }
+            }
+        }
+    }
 };
 
 QTEST_GUILESS_MAIN(OSMConditionalExpressionTest)
@@ -0,0 +1,175 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <osm/overpassquery.h>
+#include <osm/overpassquerymanager.h>
+
+#include <QDir>
+#include <QFile>
+#include <QNetworkCacheMetaData>
+#include <QNetworkDiskCache>
+#include <QNetworkProxy>
+#include <QNetworkRequest>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+#include <QUrlQuery>
+
+#include <memory>
+
+using namespace OSM;
+
+class OverpassQueryManagerTest : public QObject
+{
+    Q_OBJECT
+private:
+    [[nodiscard]] static QString networkCacheDir()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/org.kde.osm/overpass-cache/");
+    }
+    [[nodiscard]] static QString resultCacheDir()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/org.kde.osm/overpass-results/");
+    }
+    [[nodiscard]] static QStringList resultCacheEntries()
+    {
+        return QDir(resultCacheDir()).entryList({ QStringLiteral("*.o5m") }, QDir::Files);
+    }
+
+    [[nodiscard]] static std::unique_ptr<OverpassQuery> makeQuery()
+    {
+        auto query = std::make_unique<OverpassQuery>();
+        query->setQuery(QStringLiteral("[out:xml];node[amenity=toilets]({{bbox}});out;"));
+        query->setBoundingBox({ 13.4, 52.5, 0.01, 0.01 });
+        query->setTileSize({ 1.0, 1.0 });
+        return query;
+    }
+
+    /** Put a reply with @p nodeCount nodes into the network cache, as if @p query had been executed before. */
+    static void cacheReply(const OverpassQuery &query, int nodeCount)
+    {
+        // the first executor handles the single task of our queries
+        QUrl url(QStringLiteral("https://overpass-api.de/api/interpreter"));
+        QUrlQuery params;
+        params.addQueryItem(QStringLiteral("data"), query.query(query.boundingBox()));
+        url.setQuery(params);
+
+        QByteArray content("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<osm version=\"0.6\" generator=\"Overpass API\">\n");
+        for (int i = 0; i < nodeCount; ++i) {
+            content += "<node id=\"" + QByteArray::number(i + 1) + "\" lat=\"52.505\" lon=\"13.405\"><tag k=\"amenity\" v=\"toilets\"/></node>\n";
+        }
+        content += "</osm>\n";
+
+        QNetworkCacheMetaData metaData;
+        metaData.setUrl(url);
+        metaData.setSaveToDisk(true);
+        metaData.setLastModified(QDateTime::currentDateTimeUtc());
+        metaData.setExpirationDate(QDateTime::currentDateTimeUtc().addDays(1));
+        metaData.setRawHeaders({ { "Content-Type", "application/osm3s+xml" } });
+        metaData.setAttributes({ { QNetworkRequest::HttpStatusCodeAttribute, 200 } });
+
+        QNetworkDiskCache cache;
+        cache.setCacheDirectory(networkCacheDir());
+        cache.remove(url);
+        auto dev = cache.prepare(metaData);
+        QVERIFY(dev);
+        dev->write(content);
+        cache.insert(dev);
+    }
+
+    [[nodiscard]] static bool runQuery(OverpassQueryManager &mgr, OverpassQuery &query, bool reload = false)
+    {
+        QSignalSpy finishedSpy(&query, &OverpassQuery::finished);
+        if (reload) {
+            mgr.reload(&query);
+        } else {
+            mgr.execute(&query);
+        }
+        return finishedSpy.wait();
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        // make sure nothing ever reaches the actual Overpass servers from here
+        QNetworkProxy::setApplicationProxy(QNetworkProxy(QNetworkProxy::HttpProxy, QStringLiteral("127.0.0.1"), 1));
+    }
+
+    void init()
+    {
+        QDir(networkCacheDir()).removeRecursively();
+        QDir(resultCacheDir()).removeRecursively();
+    }
+
+    void testResultCache()
+    {
+        {
+            // parsed from the network cache, and stored in the result cache
+            auto query = makeQuery();
+            cacheReply(*query, 2);
+            OverpassQueryManager mgr;
+            QVERIFY(runQuery(mgr, *query));
+            QCOMPARE(query->error(), OverpassQuery::NoError);
+            QCOMPARE(query->result().nodes.size(), 2);
+            QCOMPARE(resultCacheEntries().size(), 1);
+        }
+        {
+            // served from the result cache, without looking at the network cache
+            auto query = makeQuery();
+            cacheReply(*query, 3);
+            OverpassQueryManager mgr;
+            QVERIFY(runQuery(mgr, *query));
+            QCOMPARE(query->error(), OverpassQuery::NoError);
+            QCOMPARE(query->result().nodes.size(), 2);
+            QCOMPARE(resultCacheEntries().size(), 1);
+        }
+        {
+            // reloading invalidates the result cache before going to the network, which fails here
+            auto query = makeQuery();
+            OverpassQueryManager mgr;
+            QVERIFY(runQuery(mgr, *query, true));
+            QCOMPARE(query->error(), OverpassQuery::NetworkError);
+            QVERIFY(resultCacheEntries().isEmpty());
+        }
+        {
+            // and thus the next query uses the network cache again
+            auto query = makeQuery();
+            cacheReply(*query, 3);
+            OverpassQueryManager mgr;
+            QVERIFY(runQuery(mgr, *query));
+            QCOMPARE(query->error(), OverpassQuery::NoError);
+            QCOMPARE(query->result().nodes.size(), 3);
+            QCOMPARE(resultCacheEntries().size(), 1);
+        }
+    }
+
+    void testResultCacheExpiry()
+    {
+        // created before the oversized entry below, so the expiry on startup doesn't catch that
+        OverpassQueryManager mgr;
+
+        // an old entry exceeding the size limit on its own, sparse so this doesn't actually need the disk space
+        QDir().mkpath(resultCacheDir());
+        QFile oldEntry(resultCacheDir() + QLatin1String("old.o5m"));
+        QVERIFY(oldEntry.open(QFile::WriteOnly));
+        QVERIFY(oldEntry.resize(260'000'000));
+        QVERIFY(oldEntry.setFileTime(QDateTime::currentDateTimeUtc().addDays(-1), QFileDevice::FileModificationTime));
+        oldEntry.close();
+
+        auto query = makeQuery();
+        cacheReply(*query, 2);
+        QVERIFY(runQuery(mgr, *query));
+        QCOMPARE(query->error(), OverpassQuery::NoError);
+
+        // storing the new result expired the old one
+        QVERIFY(!oldEntry.exists());
+        QCOMPARE(resultCacheEntries().size(), 1);
+    }
+};
+
+QTEST_GUILESS_MAIN(OverpassQueryManagerTest)
+
+#include "overpassquerymanagertest.moc"
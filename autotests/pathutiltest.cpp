@@ -0,0 +1,251 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <osm/abstractreader.h>
+#include <osm/datatypes.h>
+#include <osm/io.h>
+#include <osm/pathutil.h>
+
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTest>
+
+#include <algorithm>
+
+class PathUtilTest : public QObject
+{
+    Q_OBJECT
+private:
+    /** The previous quadratic implementation, as reference for the expected results. */
+    static OSM::Id referenceAppendNextPath(const OSM::DataSet &dataSet, std::vector<const OSM::Node*> &nodes, OSM::Id startNode, std::vector<const OSM::Way*> &ways)
+    {
+        for (auto it = std::next(ways.begin()); it != ways.end(); ++it) {
+            if ((*it)->nodes.front() == startNode) {
+                OSM::appendNodesFromWay(dataSet, nodes, (*it)->nodes.begin(), (*it)->nodes.end());
+                const auto lastNodeId = (*it)->nodes.back();
+                ways.erase(it);
+                return lastNodeId;
+            }
+            if ((*it)->nodes.back() == startNode) {
+                OSM::appendNodesFromWay(dataSet, nodes, (*it)->nodes.rbegin(), (*it)->nodes.rend());
+                const auto lastNodeId = (*it)->nodes.front();
+                ways.erase(it);
+                return lastNodeId;
+            }
+        }
+        return {};
+    }
+    static void referenceAssemblePath(const OSM::DataSet &dataSet, std::vector<const OSM::Way*> &&ways, std::vector<const OSM::Node*> &path)
+    {
+        for (auto it = ways.begin(); it != ways.end();) {
+            OSM::appendNodesFromWay(dataSet, path, (*it)->nodes.begin(), (*it)->nodes.end());
+            const auto startNode = (*it)->nodes.front();
+            auto lastNode = (*it)->nodes.back();
+            do {
+                lastNode = referenceAppendNextPath(dataSet, path, lastNode, ways);
+            } while (lastNode && lastNode != startNode);
+            it = ways.erase(it);
+        }
+    }
+
+    static void verifyAssemblePath(const OSM::DataSet &dataSet, const std::vector<const OSM::Way*> &ways)
+    {
+        std::vector<const OSM::Node*> expected;
+        referenceAssemblePath(dataSet, std::vector<const OSM::Way*>(ways), expected);
+        std::vector<const OSM::Node*> path;
+        OSM::assemblePath(dataSet, std::vector<const OSM::Way*>(ways), path);
+        QCOMPARE(path, expected);
+    }
+
+    static void readFile(const QString &fileName, OSM::DataSet &dataSet)
+    {
+        QFile f(fileName);
+        QVERIFY(f.open(QFile::ReadOnly));
+        auto p = OSM::IO::readerForFileName(fileName, &dataSet);
+        QVERIFY(p);
+        p->read(&f);
+        QVERIFY(!p->hasError());
+    }
+
+    /** Nodes 1 to @p count, and ways of @p nodesPerWay nodes forming a ring over them. */
+    static std::vector<const OSM::Way*> makeRing(OSM::DataSet &dataSet, int count, int nodesPerWay)
+    {
+        for (int i = 1; i <= count; ++i) {
+            OSM::Node node;
+            node.id = i;
+            node.coordinate = OSM::Coordinate(52.5 + i * 1.0e-5, 13.4);
+            dataSet.addNode(std::move(node));
+        }
+        for (int i = 0; i < count; i += nodesPerWay - 1) {
+            OSM::Way way;
+            way.id = i + 1;
+            for (int j = i; j < std::min(i + nodesPerWay, count + 1); ++j) {
+                way.nodes.push_back(j % count + 1);
+            }
+            dataSet.addWay(std::move(way));
+        }
+
+        std::vector<const OSM::Way*> ways;
+        std::transform(dataSet.ways.begin(), dataSet.ways.end(), std::back_inserter(ways), [](const auto &way) { return &way; });
+        return ways;
+    }
+
+    /** Shuffle @p ways and reverse the direction of some of them. */
+    static void scramble(OSM::DataSet &dataSet, std::vector<const OSM::Way*> &ways, QRandomGenerator &rng)
+    {
+        std::shuffle(ways.begin(), ways.end(), rng);
+        for (auto &way : dataSet.ways) {
+            if (rng.bounded(2)) {
+                std::reverse(way.nodes.begin(), way.nodes.end());
+            }
+        }
+    }
+
+private Q_SLOTS:
+    void testAssemblePath_data()
+    {
+        QTest::addColumn<std::vector<std::vector<OSM::Id>>>("ways");
+        QTest::addColumn<std::vector<OSM::Id>>("path");
+
+        QTest::newRow("empty") << std::vector<std::vector<OSM::Id>>{} << std::vector<OSM::Id>{};
+        QTest::newRow("single") << std::vector<std::vector<OSM::Id>>{{1, 2, 3}} << std::vector<OSM::Id>{1, 2, 3};
+        QTest::newRow("ring") << std::vector<std::vector<OSM::Id>>{{1, 2}, {3, 1}, {2, 3}} << std::vector<OSM::Id>{1, 2, 2, 3, 3, 1};
+        QTest::newRow("reversed") << std::vector<std::vector<OSM::Id>>{{1, 2}, {3, 2}, {1, 3}} << std::vector<OSM::Id>{1, 2, 2, 3, 3, 1};
+        QTest::newRow("open") << std::vector<std::vector<OSM::Id>>{{2, 3}, {4, 3}, {1, 2}} << std::vector<OSM::Id>{2, 3, 3, 4, 1, 2};
+        QTest::newRow("two rings") << std::vector<std::vector<OSM::Id>>{{1, 2}, {4, 5}, {2, 1}, {5, 4}} << std::vector<OSM::Id>{1, 2, 2, 1, 4, 5, 5, 4};
+        // the first way in input order wins when several ways share an endpoint
+        QTest::newRow("junction") << std::vector<std::vector<OSM::Id>>{{1, 2}, {2, 4}, {3, 2}, {4, 1}} << std::vector<OSM::Id>{1, 2, 2, 4, 4, 1, 3, 2};
+        // closed ways get one more connected way appended
+        QTest::newRow("closed") << std::vector<std::vector<OSM::Id>>{{1, 2, 1}, {1, 3}} << std::vector<OSM::Id>{1, 2, 1, 1, 3};
+        QTest::newRow("duplicate way") << std::vector<std::vector<OSM::Id>>{{1, 2}, {1, 2}, {2, 3}} << std::vector<OSM::Id>{1, 2, 2, 1, 2, 3};
+    }
+
+    void testAssemblePath()
+    {
+        QFETCH(std::vector<std::vector<OSM::Id>>, ways);
+        QFETCH(std::vector<OSM::Id>, path);
+
+        OSM::DataSet dataSet;
+        for (OSM::Id id = 1; id <= 5; ++id) {
+            OSM::Node node;
+            node.id = id;
+            dataSet.addNode(std::move(node));
+        }
+        std::vector<OSM::Way> wayData(ways.size());
+        std::vector<const OSM::Way*> wayPtrs;
+        for (std::size_t i = 0; i < ways.size(); ++i) {
+            wayData[i].id = (OSM::Id)i + 1;
+            wayData[i].nodes = ways[i];
+            wayPtrs.push_back(&wayData[i]);
+        }
+
+        std::vector<const OSM::Node*> result;
+        OSM::assemblePath(dataSet, std::vector<const OSM::Way*>(wayPtrs), result);
+        std::vector<OSM::Id> resultIds;
+        std::transform(result.begin(), result.end(), std::back_inserter(resultIds), [](auto node) { return node->id; });
+        QCOMPARE(resultIds, path);
+
+        verifyAssemblePath(dataSet, wayPtrs);
+    }
+
+    void testRealData_data()
+    {
+        QTest::addColumn<QString>("fileName");
+        for (const auto name : { "berlin-central", "cologne-central", "hamburg-central", "leipzig-central", "paris-gare-de-lyon" }) {
+            QTest::newRow(name) << QString(QStringLiteral(SOURCE_DIR "/data/platforms/") + QLatin1String(name) + QLatin1String(".osm"));
+        }
+    }
+
+    void testRealData()
+    {
+        QFETCH(QString, fileName);
+        OSM::DataSet dataSet;
+        readFile(fileName, dataSet);
+
+        // outer rings of multipolygons
+        const auto typeKey = dataSet.tagKey("type");
+        const auto outerRole = dataSet.role("outer");
+        for (const auto &rel : dataSet.relations) {
+            if (OSM::tagValue(rel, typeKey) != "multipolygon") {
+                continue;
+            }
+            std::vector<const OSM::Way*> ways;
+            for (const auto &member : rel.members) {
+                if (member.role() != outerRole) {
+                    continue;
+                }
+                if (auto way = dataSet.way(member.id); way && !way->nodes.empty()) {
+                    ways.push_back(way);
+                }
+            }
+            verifyAssemblePath(dataSet, ways);
+        }
+
+        // all track segments at once, a large network with many junctions
+        const auto railwayKey = dataSet.tagKey("railway");
+        std::vector<const OSM::Way*> tracks;
+        for (const auto &way : dataSet.ways) {
+            if (!way.nodes.empty() && OSM::tagValue(way, railwayKey) == "rail") {
+                tracks.push_back(&way);
+            }
+        }
+        QVERIFY(!tracks.empty());
+        verifyAssemblePath(dataSet, tracks);
+        std::reverse(tracks.begin(), tracks.end());
+        verifyAssemblePath(dataSet, tracks);
+    }
+
+    void testScrambledRing()
+    {
+        OSM::DataSet dataSet;
+        auto ways = makeRing(dataSet, 1000, 5);
+        auto rng = QRandomGenerator(42);
+        for (int i = 0; i < 10; ++i) {
+            scramble(dataSet, ways, rng);
+            verifyAssemblePath(dataSet, ways);
+
+            std::vector<const OSM::Node*> path;
+            OSM::assemblePath(dataSet, std::vector<const OSM::Way*>(ways), path);
+            QCOMPARE(path.size(), ways.size() * 5);
+            QCOMPARE(path.front(), path.back());
+        }
+    }
+
+    void benchmarkAssemblePath_data()
+    {
+        QTest::addColumn<bool>("reference");
+        QTest::addColumn<int>("wayCount");
+        for (const auto wayCount : { 10, 100, 1000 }) {
+            QTest::addRow("reference-%d", wayCount) << true << wayCount;
+            QTest::addRow("indexed-%d", wayCount) << false << wayCount;
+        }
+    }
+
+    void benchmarkAssemblePath()
+    {
+        QFETCH(bool, reference);
+        QFETCH(int, wayCount);
+
+        OSM::DataSet dataSet;
+        auto ways = makeRing(dataSet, wayCount * 4, 5);
+        auto rng = QRandomGenerator(42);
+        scramble(dataSet, ways, rng);
+
+        std::vector<const OSM::Node*> path;
+        QBENCHMARK {
+            path.clear();
+            if (reference) {
+                referenceAssemblePath(dataSet, std::vector<const OSM::Way*>(ways), path);
+            } else {
+                OSM::assemblePath(dataSet, std::vector<const OSM::Way*>(ways), path);
+            }
+        }
+        QCOMPARE(path.size(), (std::size_t)wayCount * 5);
+    }
+};
+
+QTEST_GUILESS_MAIN(PathUtilTest)
+
+#include "pathutiltest.moc"
@@ -156,6 +156,30 @@ private Q_SLOTS:
         }
         QVERIFY(platforms == expectedPlatforms);
     }
+    void benchmarkPlatformFinder_data()
+    {
+        QTest::addColumn<QString>("input");
+        QTest::newRow("berlin-central") << (SOURCE_DIR "/data/platforms/berlin-central.osm");
+        QTest::newRow("hamburg-central") << (SOURCE_DIR "/data/platforms/hamburg-central.osm");
+    }
+
+    void benchmarkPlatformFinder()
+    {
+        QFETCH(QString, input);
+
+        MapLoader loader;
+        QSignalSpy doneSpy(&loader, &MapLoader::done);
+        loader.loadFromFile(input);
+        QVERIFY(doneSpy.wait());
+        const auto mapData = loader.takeData();
+
+        std::vector<Platform> result;
+        QBENCHMARK {
+            PlatformFinder finder;
+            result = finder.find(mapData);
+        }
+        QVERIFY(!result.empty());
+    }
 };
 
 QTEST_GUILESS_MAIN(PlatformFinderTest)
@@ -104,6 +104,56 @@ private Q_SLOTS:
         QCOMPARE(model.departurePlatformRow(), -1);
         QCOMPARE(model.arrivalPlatformRow(), -1);
     }
+
+    void testReload()
+    {
+        const auto load = []() {
+            MapLoader loader;
+            QSignalSpy doneSpy(&loader, &MapLoader::done);
+            loader.loadFromFile(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-altona.osm"));
+            doneSpy.wait();
+            return loader.takeData();
+        };
+
+        PlatformModel model;
+        QAbstractItemModelTester modelTest(&model);
+        model.setMapData(load());
+        QCOMPARE(model.rowCount(), 12);
+
+        const auto parentIdx = model.index(0, 0);
+        QVERIFY(model.rowCount(parentIdx) > 0);
+        QPersistentModelIndex platformIdx(parentIdx);
+        QPersistentModelIndex sectionIdx(model.index(0, 0, parentIdx));
+        const auto platformName = platformIdx.data().toString();
+        const auto sectionName = sectionIdx.data().toString();
+
+        // reloading the same data only updates the existing rows
+        QSignalSpy resetSpy(&model, &QAbstractItemModel::modelReset);
+        QSignalSpy insertSpy(&model, &QAbstractItemModel::rowsInserted);
+        QSignalSpy removeSpy(&model, &QAbstractItemModel::rowsRemoved);
+        QSignalSpy changeSpy(&model, &QAbstractItemModel::dataChanged);
+        model.setMapData(load());
+        QCOMPARE(model.rowCount(), 12);
+        QCOMPARE(resetSpy.size(), 0);
+        QCOMPARE(insertSpy.size(), 0);
+        QCOMPARE(removeSpy.size(), 0);
+        QVERIFY(!changeSpy.empty());
+
+        QVERIFY(platformIdx.isValid());
+        QCOMPARE(platformIdx.data().toString(), platformName);
+        QVERIFY(sectionIdx.isValid());
+        QCOMPARE(sectionIdx.parent(), QModelIndex(platformIdx));
+        QCOMPARE(sectionIdx.data().toString(), sectionName);
+        const auto newLabel = platformIdx.data(PlatformModel::ElementRole).value<OSM::Element>();
+        QVERIFY(newLabel.type() != OSM::Type::Null);
+
+        // switching to empty data removes everything
+        model.setMapData({});
+        QCOMPARE(model.rowCount(), 0);
+        QCOMPARE(resetSpy.size(), 0);
+        QVERIFY(!platformIdx.isValid());
+        QVERIFY(!sectionIdx.isValid());
+    }
 };
 
 QTEST_GUILESS_MAIN(PlatformModelTest)
@@ -0,0 +1,151 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "../src/map-publictransport-integration/realtimeequipmentmodel.h"
+
+#include <KPublicTransport/Equipment>
+#include <KPublicTransport/Location>
+#include <KPublicTransport/LocationQueryModel>
+
+#include <QSignalSpy>
+#include <QStandardItemModel>
+#include <QTest>
+
+using namespace KOSMIndoorMap;
+
+class RealtimeEquipmentModelTest : public QObject
+{
+    Q_OBJECT
+private:
+    static KPublicTransport::Location makeElevator(bool working)
+    {
+        KPublicTransport::Equipment eq;
+        eq.setType(KPublicTransport::Equipment::Elevator);
+        eq.setDisruptionEffect(working ? KPublicTransport::Disruption::NormalService : KPublicTransport::Disruption::NoService);
+
+        KPublicTransport::Location loc;
+        loc.setType(KPublicTransport::Location::Equipment);
+        loc.setCoordinate(52.525f, 13.369f);
+        loc.setData(QVariant::fromValue(eq));
+        return loc;
+    }
+
+    static QByteArray realtimeStatus(const EquipmentModel &model)
+    {
+        QByteArray status;
+        model.forEach(0, [&status](OSM::Element e, int) {
+            status = e.tagValue("mx:realtime_status");
+        });
+        return status;
+    }
+
+    static MapData makeMapData()
+    {
+        OSM::DataSet dataSet;
+        OSM::Node node;
+        node.id = 1;
+        node.coordinate = OSM::Coordinate(52.525, 13.369);
+        OSM::setTagValue(node, dataSet.makeTagKey("highway"), "elevator");
+        OSM::setTagValue(node, dataSet.makeTagKey("level"), "0;1");
+        dataSet.addNode(std::move(node));
+        MapData mapData;
+        mapData.setDataSet(std::move(dataSet));
+        return mapData;
+    }
+
+    static void setElevator(QStandardItem *item, bool working)
+    {
+        item->setData(QVariant::fromValue(makeElevator(working)), KPublicTransport::LocationQueryModel::LocationRole);
+    }
+
+private Q_SLOTS:
+    void testUnchangedUpdates()
+    {
+        RealtimeEquipmentModel model;
+        model.setMapData(makeMapData());
+        model.setUpdateInterval(50);
+        QCOMPARE(model.updateInterval(), 50);
+
+        QStandardItemModel rtModel;
+        auto item = new QStandardItem;
+        setElevator(item, true);
+        rtModel.appendRow(item);
+
+        QSignalSpy updateSpy(&model, &AbstractOverlaySource::update);
+        model.setRealtimeModel(&rtModel);
+        QCOMPARE(updateSpy.size(), 1);
+        QCOMPARE(realtimeStatus(model), "1");
+
+        // a burst of notifications without an actual state change doesn't trigger an update
+        for (int i = 0; i < 1000; ++i) {
+            Q_EMIT rtModel.dataChanged(rtModel.index(0, 0), rtModel.index(0, 0));
+        }
+        QCOMPARE(updateSpy.size(), 1);
+        QVERIFY(!updateSpy.wait(4 * model.updateInterval()));
+        QCOMPARE(realtimeStatus(model), "1");
+
+        // an actual change still gets through, right away or merged with the above
+        setElevator(item, false);
+        QTRY_COMPARE(updateSpy.size(), 2);
+        QCOMPARE(realtimeStatus(model), "0");
+    }
+
+    void testHighRateUpdates()
+    {
+        RealtimeEquipmentModel model;
+        model.setMapData(makeMapData());
+        model.setUpdateInterval(50);
+
+        QStandardItemModel rtModel;
+        auto item = new QStandardItem;
+        setElevator(item, true);
+        rtModel.appendRow(item);
+
+        QSignalSpy updateSpy(&model, &AbstractOverlaySource::update);
+        model.setRealtimeModel(&rtModel);
+        QCOMPARE(updateSpy.size(), 1);
+
+        // the first change is applied immediately
+        setElevator(item, false);
+        QCOMPARE(updateSpy.size(), 2);
+        QCOMPARE(realtimeStatus(model), "0");
+
+        // a burst of state changes following that is merged into a single update
+        for (int i = 0; i < 1000; ++i) {
+            setElevator(item, i % 2 == 1);
+        }
+        QCOMPARE(updateSpy.size(), 2);
+        QCOMPARE(realtimeStatus(model), "0");
+        QTRY_COMPARE(updateSpy.size(), 3);
+        QCOMPARE(realtimeStatus(model), "1");
+        QVERIFY(!updateSpy.wait(4 * model.updateInterval()));
+        QCOMPARE(updateSpy.size(), 3);
+    }
+
+    void testRemoval()
+    {
+        RealtimeEquipmentModel model;
+        model.setMapData(makeMapData());
+
+        QStandardItemModel rtModel;
+        auto item = new QStandardItem;
+        setElevator(item, false);
+        rtModel.appendRow(item);
+
+        QSignalSpy updateSpy(&model, &AbstractOverlaySource::update);
+        model.setRealtimeModel(&rtModel);
+        QCOMPARE(updateSpy.size(), 1);
+        QCOMPARE(realtimeStatus(model), "0");
+
+        // removing the realtime data resets the state, immediately as nothing changed before
+        rtModel.clear();
+        QCOMPARE(updateSpy.size(), 2);
+        QCOMPARE(realtimeStatus(model), QByteArray());
+    }
+};
+
+QTEST_GUILESS_MAIN(RealtimeEquipmentModelTest)
+
+#include "realtimeequipmentmodeltest.moc"
@@ -0,0 +1,191 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <routing/route.h>
+#include <routing/routeoverlay.h>
+
+#include <map/loader/mapdata.h>
+#include <map/loader/maploader.h>
+#include <map/scene/overlayreclaimer.h>
+#include <map/scene/scenegraph.h>
+
+#include <QSignalSpy>
+#include <QTest>
+
+using namespace KOSMIndoorMap;
+using namespace KOSMIndoorRouting;
+
+namespace {
+// reports its deletion
+class DeletionTracker {
+public:
+    explicit DeletionTracker(bool *deleted) : m_deleted(deleted) {}
+    DeletionTracker(DeletionTracker &&other) noexcept : m_deleted(std::exchange(other.m_deleted, nullptr)) {}
+    ~DeletionTracker() { if (m_deleted) { *m_deleted = true; } }
+    [[nodiscard]] explicit operator bool() const { return m_deleted; }
+private:
+    bool *m_deleted = nullptr;
+};
+}
+
+class RouteOverlayTest : public QObject
+{
+    Q_OBJECT
+private:
+    MapData m_data;
+
+    [[nodiscard]] Route makeRoute(int i) const
+    {
+        const auto center = m_data.boundingBox().center();
+        std::vector<RouteStep> steps;
+        for (int j = 0; j < 5; ++j) {
+            steps.push_back({OSM::Coordinate(center.latF() + (i % 100) * 1.0e-5, center.lonF() + j * 1.0e-5), j < 3 ? 0 : 10});
+        }
+        Route route;
+        route.setSteps(std::move(steps));
+        return route;
+    }
+
+    void updateRoute(RouteOverlay &overlay, int i) const
+    {
+        const auto center = m_data.boundingBox().center();
+        overlay.setStart(OSM::Coordinate(center.latF(), center.lonF() + i * 1.0e-7), 0);
+        overlay.setEnd(OSM::Coordinate(center.latF() + i * 1.0e-7, center.lonF()), 10);
+        overlay.setRoute(makeRoute(i));
+    }
+
+    static void buildScene(SceneGraph &sg, const RouteOverlay &overlay)
+    {
+        sg.beginSwap();
+        overlay.forEach(0, [](OSM::Element, int) {});
+        overlay.forEach(10, [](OSM::Element, int) {});
+        sg.endSwap();
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        MapLoader loader;
+        QSignalSpy doneSpy(&loader, &MapLoader::done);
+        loader.loadFromFile(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-altona.osm"));
+        QVERIFY(doneSpy.wait());
+        QVERIFY(!loader.hasError());
+        m_data = loader.takeData();
+        QVERIFY(!m_data.isEmpty());
+    }
+
+    void testEpochs()
+    {
+        bool unseen = false;
+        bool seen = false;
+        bool current = false;
+        {
+            SceneGraph sg;
+
+            // never displayed
+            OverlayReclaimer::retire(OverlayReclaimer::currentEpoch(), DeletionTracker(&unseen));
+            QVERIFY(unseen);
+
+            // displayed in the current scene graph
+            const auto birth = OverlayReclaimer::currentEpoch();
+            sg.beginSwap();
+            sg.endSwap();
+            OverlayReclaimer::retire(birth, DeletionTracker(&seen));
+            QVERIFY(!seen);
+            QCOMPARE(OverlayReclaimer::pendingCount(), 1);
+
+            // created after the last scene graph update
+            OverlayReclaimer::retire(OverlayReclaimer::currentEpoch(), DeletionTracker(&current));
+            QVERIFY(current);
+
+            sg.beginSwap();
+            QVERIFY(!seen); // still referenced by the previous scene graph content
+            sg.endSwap();
+            QVERIFY(seen);
+            QCOMPARE(OverlayReclaimer::pendingCount(), 0);
+
+            // retained until the scene graph is gone
+            seen = false;
+            const auto birth2 = OverlayReclaimer::currentEpoch();
+            sg.beginSwap();
+            sg.endSwap();
+            OverlayReclaimer::retire(birth2, DeletionTracker(&seen));
+            QVERIFY(!seen);
+        }
+        QVERIFY(seen);
+        QCOMPARE(OverlayReclaimer::pendingCount(), 0);
+    }
+
+    void testMultipleScenes()
+    {
+        SceneGraph sg1;
+        SceneGraph sg2;
+        bool deleted = false;
+        const auto birth = OverlayReclaimer::currentEpoch();
+        buildScene(sg1, RouteOverlay());
+        buildScene(sg2, RouteOverlay());
+        OverlayReclaimer::retire(birth, DeletionTracker(&deleted));
+
+        buildScene(sg1, RouteOverlay());
+        QVERIFY(!deleted);
+        buildScene(sg2, RouteOverlay());
+        QVERIFY(deleted);
+
+        deleted = false;
+        const auto birth2 = OverlayReclaimer::currentEpoch();
+        buildScene(sg1, RouteOverlay());
+        OverlayReclaimer::retire(birth2, DeletionTracker(&deleted));
+        QVERIFY(!deleted);
+        sg1.clear();
+        QVERIFY(deleted);
+    }
+
+    void testRouteUpdatesWithoutScene()
+    {
+        RouteOverlay overlay;
+        overlay.setMapData(m_data);
+        for (int i = 0; i < 100000; ++i) {
+            updateRoute(overlay, i);
+            QCOMPARE(OverlayReclaimer::pendingCount(), 0);
+        }
+    }
+
+    void testRouteUpdatesWithScene_data()
+    {
+        QTest::addColumn<int>("updatesPerFrame");
+        QTest::newRow("1") << 1;
+        QTest::newRow("10") << 10;
+        QTest::newRow("1000") << 1000;
+    }
+
+    void testRouteUpdatesWithScene()
+    {
+        QFETCH(int, updatesPerFrame);
+
+        SceneGraph sg;
+        {
+            RouteOverlay overlay;
+            overlay.setMapData(m_data);
+            // start, end, and the two ways with their seven nodes of the one displayed route
+            constexpr std::size_t maxPending = 11;
+            for (int i = 0; i < 100000; ++i) {
+                updateRoute(overlay, i);
+                QVERIFY(OverlayReclaimer::pendingCount() <= maxPending);
+                if (i % updatesPerFrame == 0) {
+                    buildScene(sg, overlay);
+                }
+            }
+            QVERIFY(OverlayReclaimer::pendingCount() <= maxPending);
+        }
+        QVERIFY(OverlayReclaimer::pendingCount() > 0); // the last displayed route is still referenced
+        sg.beginSwap();
+        sg.endSwap();
+        QCOMPARE(OverlayReclaimer::pendingCount(), 0);
+    }
+};
+
+QTEST_GUILESS_MAIN(RouteOverlayTest)
+
+#include "routeoverlaytest.moc"
@@ -0,0 +1,393 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <map/content/equipmentmodel.h>
+#include <map/loader/mapdata.h>
+#include <map/loader/maploader.h>
+#include <map/renderer/painterrenderer.h>
+#include <map/scene/overlaysource.h>
+#include <map/scene/scenecontroller.h>
+#include <map/scene/scenegraph.h>
+#include <map/scene/view.h>
+#include <map/style/mapcssloader.h>
+#include <map/style/mapcssparser.h>
+#include <map/style/mapcssstyle.h>
+
+#include <QImage>
+#include <QPainter>
+#include <QRegion>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <algorithm>
+
+using namespace Qt::Literals::StringLiterals;
+using namespace KOSMIndoorMap;
+
+/** Overlay without elements of its own, hiding elements of the base map. */
+class HidingOverlaySource : public AbstractOverlaySource
+{
+public:
+    explicit HidingOverlaySource()
+        : AbstractOverlaySource(nullptr)
+    {
+    }
+
+    void forEach([[maybe_unused]] int floorLevel, [[maybe_unused]] const std::function<void(OSM::Element, int)> &func) const override
+    {
+    }
+
+    void hiddenElements(std::vector<OSM::Element> &elems) const override
+    {
+        elems.insert(elems.end(), hidden.begin(), hidden.end());
+    }
+
+    std::vector<OSM::Element> hidden;
+};
+
+/** Equipment overlay changing the realtime status of single elevators, as done by the public transport integration. */
+class RealtimeEquipmentModel : public EquipmentModel
+{
+public:
+    std::size_t addElevator(OSM::Element e)
+    {
+        Equipment elevator;
+        elevator.type = Equipment::Elevator;
+        elevator.sourceElements.push_back(e);
+        elevator.levels = { 0, 10 };
+        createSyntheticElement(elevator);
+        m_equipment.push_back(std::move(elevator));
+        Q_EMIT update();
+        return m_equipment.size() - 1;
+    }
+
+    [[nodiscard]] OSM::Element elevator(std::size_t idx) const
+    {
+        return m_equipment[idx].syntheticElement.element();
+    }
+
+    void setRealtimeStatus(std::size_t idx, bool available)
+    {
+        auto &elevator = m_equipment[idx];
+        elevator.syntheticElement.setTagValue(m_tagKeys.realtimeStatus, available ? "1" : "0");
+        addChangedElement(elevator.syntheticElement.element());
+        Q_EMIT update();
+    }
+};
+
+class SceneDamageTest : public QObject
+{
+    Q_OBJECT
+private:
+    MapData m_data;
+    MapCSSStyle m_style;
+
+    void setupView(View &view, SceneController &controller)
+    {
+        view.setScreenSize({1920, 1080});
+        view.setSceneBoundingBox(m_data.boundingBox());
+        view.setLevel(0);
+        view.setZoomLevel(19.0, { 960.0, 540.0 });
+        controller.setView(&view);
+        controller.setMapData(m_data);
+        controller.setStyleSheet(&m_style);
+    }
+
+    /** A named area fully on screen and not too large, hovering those has a visible effect.
+     *  Areas intersecting @p exclude are skipped.
+     */
+    static OSM::Element findHoverCandidate(const SceneGraph &sg, const View &view, const QRectF &exclude = {})
+    {
+        const QRectF screenRect(0.0, 0.0, view.screenWidth(), view.screenHeight());
+        for (const auto &item : sg.items()) {
+            if (!item.payload->inSceneSpace() || item.element.tagValue("name").isEmpty()) {
+                continue;
+            }
+            const auto bbox = item.payload->screenBoundingRect(&view);
+            if (screenRect.contains(bbox) && bbox.width() < screenRect.width() / 4.0 && bbox.height() < screenRect.height() / 4.0 && !bbox.intersects(exclude)) {
+                return item.element;
+            }
+        }
+        return {};
+    }
+
+    /** Screen area covered by all scene graph items of @p elem. */
+    static QRegion elementArea(const SceneGraph &sg, const View &view, OSM::Element elem)
+    {
+        QRegion area;
+        for (const auto &item : sg.items()) {
+            if (item.element == elem) {
+                area += item.payload->screenBoundingRect(&view).toAlignedRect();
+            }
+        }
+        return area;
+    }
+
+    [[nodiscard]] static bool covers(const QRegion &region, const QRegion &area)
+    {
+        return area.subtracted(region).isEmpty();
+    }
+
+    void render(const SceneGraph &sg, View &view, QImage &img, const QRegion &clip = {})
+    {
+        PainterRenderer renderer;
+        QPainter painter(&img);
+        if (!clip.isEmpty()) {
+            painter.setClipRegion(clip);
+        }
+        renderer.setPainter(&painter);
+        renderer.render(sg, &view);
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        MapLoader loader;
+        QSignalSpy doneSpy(&loader, &MapLoader::done);
+        loader.loadFromFile(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-central.osm"));
+        QVERIFY(doneSpy.wait());
+        QVERIFY(!loader.hasError());
+        m_data = loader.takeData();
+
+        MapCSSParser p;
+        m_style = p.parse(MapCSSLoader::resolve(u"breeze-light"_s));
+        QVERIFY(!m_style.isEmpty());
+        m_style.compile(m_data.dataSet());
+    }
+
+    void testDamage()
+    {
+        View view;
+        SceneController controller;
+        setupView(view, controller);
+        SceneGraph sg;
+        controller.updateScene(sg);
+        QVERIFY(controller.hasFullDamage());
+        controller.resetDamage();
+
+        // nothing changed
+        controller.updateScene(sg);
+        QVERIFY(!controller.hasFullDamage());
+        QVERIFY(controller.damage().isEmpty());
+
+        // hovering an element only damages the area of that element
+        const auto elem = findHoverCandidate(sg, view);
+        QVERIFY(elem);
+        controller.setHoveredElement(elem);
+        controller.updateScene(sg);
+        QVERIFY(!controller.hasFullDamage());
+        QVERIFY(!controller.damage().isEmpty());
+        QVERIFY(covers(controller.damage(), elementArea(sg, view, elem)));
+        QVERIFY(controller.damage().boundingRect().width() < view.screenWidth() / 2.0);
+        controller.resetDamage();
+
+        // zoom and floor level changes damage everything
+        view.setZoomLevel(18.0, { 960.0, 540.0 });
+        controller.updateScene(sg);
+        QVERIFY(controller.hasFullDamage());
+        controller.resetDamage();
+        view.setLevel(10);
+        controller.updateScene(sg);
+        QVERIFY(controller.hasFullDamage());
+    }
+
+    void testHiddenElements()
+    {
+        View view;
+        SceneController controller;
+        setupView(view, controller);
+        HidingOverlaySource overlay;
+        controller.setOverlaySources({ &overlay });
+        SceneGraph sg;
+        controller.updateScene(sg);
+        controller.resetDamage();
+
+        const auto elem = findHoverCandidate(sg, view);
+        QVERIFY(elem);
+        const auto elemArea = elementArea(sg, view, elem);
+
+        // hiding a base element damages the area it was shown in
+        overlay.hidden = { elem };
+        controller.overlaySourceUpdated();
+        controller.updateScene(sg);
+        QVERIFY(!controller.hasFullDamage());
+        QVERIFY(covers(controller.damage(), elemArea));
+        QVERIFY(std::none_of(sg.items().begin(), sg.items().end(), [elem](const auto &item) { return item.element == elem; }));
+        controller.resetDamage();
+
+        // and so does showing it again
+        overlay.hidden.clear();
+        controller.overlaySourceUpdated();
+        controller.updateScene(sg);
+        QVERIFY(!controller.hasFullDamage());
+        QVERIFY(covers(controller.damage(), elemArea));
+        QVERIFY(std::any_of(sg.items().begin(), sg.items().end(), [elem](const auto &item) { return item.element == elem; }));
+    }
+
+    void testEquipmentOverlay()
+    {
+        View view;
+        SceneController controller;
+        setupView(view, controller);
+        RealtimeEquipmentModel equipment;
+        equipment.setMapData(m_data);
+        controller.setOverlaySources({ &equipment });
+        SceneGraph sg;
+        controller.updateScene(sg);
+
+        // two elevators far enough apart to not share any damaged area
+        const auto elem1 = findHoverCandidate(sg, view);
+        QVERIFY(elem1);
+        const auto elem2 = findHoverCandidate(sg, view, elementArea(sg, view, elem1).boundingRect().adjusted(-100, -100, 100, 100));
+        QVERIFY(elem2);
+        const auto elevator1 = equipment.addElevator(elem1);
+        const auto elevator2 = equipment.addElevator(elem2);
+        controller.overlaySourceUpdated();
+        controller.updateScene(sg);
+        controller.resetDamage();
+
+        const auto area1 = elementArea(sg, view, equipment.elevator(elevator1));
+        const auto area2 = elementArea(sg, view, equipment.elevator(elevator2));
+        QVERIFY(!area1.isEmpty());
+        QVERIFY(!area2.isEmpty());
+        QVERIFY(!area1.intersects(area2));
+
+        // a status change of one elevator only damages the area of that one
+        equipment.setRealtimeStatus(elevator1, false);
+        controller.overlaySourceUpdated();
+        controller.updateScene(sg);
+        QVERIFY(!controller.hasFullDamage());
+        QVERIFY(covers(controller.damage(), area1));
+        QVERIFY(!controller.damage().intersects(area2));
+        controller.resetDamage();
+
+        // several changes before the next scene update accumulate
+        equipment.setRealtimeStatus(elevator1, true);
+        equipment.setRealtimeStatus(elevator2, false);
+        controller.overlaySourceUpdated();
+        controller.updateScene(sg);
+        QVERIFY(!controller.hasFullDamage());
+        QVERIFY(covers(controller.damage(), area1));
+        QVERIFY(covers(controller.damage(), area2));
+        // ... in separate areas rather than their bounding rectangle
+        QVERIFY(controller.damage().rectCount() > 1);
+        controller.resetDamage();
+
+        // updates without reported changes damage all overlay elements
+        Q_EMIT equipment.update();
+        controller.overlaySourceUpdated();
+        controller.updateScene(sg);
+        QVERIFY(!controller.hasFullDamage());
+        QVERIFY(covers(controller.damage(), area1));
+        QVERIFY(covers(controller.damage(), area2));
+    }
+
+    void testPartialRepaint()
+    {
+        View view;
+        SceneController controller;
+        setupView(view, controller);
+        SceneGraph sg;
+        controller.updateScene(sg);
+        controller.resetDamage();
+
+        QImage img(view.screenWidth(), view.screenHeight(), QImage::Format_ARGB32_Premultiplied);
+        render(sg, view, img);
+
+        const auto elem = findHoverCandidate(sg, view);
+        QVERIFY(elem);
+        controller.setHoveredElement(elem);
+        controller.updateScene(sg);
+        QVERIFY(!controller.hasFullDamage());
+        const auto damage = controller.damage();
+        QVERIFY(!damage.isEmpty());
+
+        // repainting the damaged area only has to produce the same result as a full repaint
+        auto partialImg = img.copy();
+        render(sg, view, partialImg, damage);
+        QVERIFY(partialImg != img);
+        render(sg, view, img);
+        QCOMPARE(partialImg, img);
+    }
+
+    void benchmarkRepaint_data()
+    {
+        QTest::addColumn<bool>("partial");
+        QTest::newRow("full") << false;
+        QTest::newRow("damaged area") << true;
+    }
+
+    void benchmarkRepaint()
+    {
+        QFETCH(bool, partial);
+
+        View view;
+        SceneController controller;
+        setupView(view, controller);
+        SceneGraph sg;
+        controller.updateScene(sg);
+        const auto elem = findHoverCandidate(sg, view);
+        QVERIFY(elem);
+
+        QImage img(view.screenWidth(), view.screenHeight(), QImage::Format_ARGB32_Premultiplied);
+        render(sg, view, img);
+        controller.resetDamage();
+
+        // single element updates, as from hovering
+        bool hovered = false;
+        QBENCHMARK {
+            hovered = !hovered;
+            controller.setHoveredElement(hovered ? elem : OSM::Element());
+            controller.updateScene(sg);
+            QVERIFY(!controller.hasFullDamage());
+            render(sg, view, img, partial ? controller.damage() : QRegion());
+            controller.resetDamage();
+        }
+    }
+
+    void benchmarkOverlayRepaint_data()
+    {
+        benchmarkRepaint_data();
+    }
+
+    void benchmarkOverlayRepaint()
+    {
+        QFETCH(bool, partial);
+
+        View view;
+        SceneController controller;
+        setupView(view, controller);
+        RealtimeEquipmentModel equipment;
+        equipment.setMapData(m_data);
+        controller.setOverlaySources({ &equipment });
+        SceneGraph sg;
+        controller.updateScene(sg);
+        const auto elem = findHoverCandidate(sg, view);
+        QVERIFY(elem);
+        const auto elevator = equipment.addElevator(elem);
+        controller.overlaySourceUpdated();
+        controller.updateScene(sg);
+
+        QImage img(view.screenWidth(), view.screenHeight(), QImage::Format_ARGB32_Premultiplied);
+        render(sg, view, img);
+        controller.resetDamage();
+
+        // realtime status changes of a single elevator
+        bool available = false;
+        QBENCHMARK {
+            available = !available;
+            equipment.setRealtimeStatus(elevator, available);
+            controller.overlaySourceUpdated();
+            controller.updateScene(sg);
+            QVERIFY(!controller.hasFullDamage());
+            render(sg, view, img, partial ? controller.damage() : QRegion());
+            controller.resetDamage();
+        }
+    }
+};
+
+QTEST_MAIN(SceneDamageTest)
+
+#include "scenedamagetest.moc"
@@ -0,0 +1,281 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <map/loader/mapdata.h>
+#include <map/loader/maploader.h>
+#include <map/scene/scenecontroller.h>
+#include <map/scene/scenegraph.h>
+#include <map/scene/view.h>
+#include <map/style/mapcssloader.h>
+#include <map/style/mapcssparser.h>
+#include <map/style/mapcssstyle.h>
+#include <map/style/mapcssstylecache.h>
+
+#include <QSignalSpy>
+#include <QTest>
+
+#include <algorithm>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define HAVE_MALLINFO2 1
+#endif
+
+using namespace Qt::Literals::StringLiterals;
+using namespace KOSMIndoorMap;
+
+namespace {
+// per-view state, as in MapItem
+struct MapView {
+    MapData data;
+    View view;
+    SceneController controller;
+    SceneGraph sg;
+    std::shared_ptr<MapCSSStyle> style;
+};
+}
+
+class StyleCacheTest : public QObject
+{
+    Q_OBJECT
+private:
+    MapData m_data;
+    QUrl m_styleUrl;
+
+    [[nodiscard]] static MapData loadData(const QString &fileName = QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-altona.osm"))
+    {
+        MapLoader loader;
+        QSignalSpy doneSpy(&loader, &MapLoader::done);
+        loader.loadFromFile(fileName);
+        if (!doneSpy.wait() || loader.hasError()) {
+            return {};
+        }
+        return loader.takeData();
+    }
+
+    [[nodiscard]] MapCSSStyle parseStyle() const
+    {
+        MapCSSParser p;
+        return p.parse(m_styleUrl);
+    }
+
+    // every view has its own loader, as in MapItem
+    void setupView(MapView &v, bool shared)
+    {
+        v.data = loadData();
+        if (shared) {
+            v.style = MapCSSStyleCache::find(m_styleUrl, v.data);
+            if (!v.style) {
+                v.style = MapCSSStyleCache::insert(m_styleUrl, v.data, parseStyle());
+            }
+        } else {
+            v.style = std::make_shared<MapCSSStyle>(parseStyle());
+            v.style->compile(v.data.dataSet());
+        }
+
+        v.view.setScreenSize({800, 600});
+        v.view.setSceneBoundingBox(v.data.boundingBox());
+        v.view.setLevel(0);
+        v.controller.setView(&v.view);
+        v.controller.setMapData(v.data);
+        v.controller.setStyleSheet(v.style.get());
+        v.controller.updateScene(v.sg);
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_data = loadData();
+        QVERIFY(!m_data.isEmpty());
+
+        m_styleUrl = MapCSSLoader::resolve(u"breeze-light"_s);
+        QVERIFY(m_styleUrl.isValid());
+    }
+
+    void testSharing()
+    {
+        QCOMPARE(MapCSSStyleCache::size(), 0);
+        QVERIFY(!MapCSSStyleCache::find(m_styleUrl, m_data));
+
+        auto s1 = MapCSSStyleCache::insert(m_styleUrl, m_data, parseStyle());
+        QVERIFY(s1);
+        QVERIFY(!s1->isEmpty());
+        QCOMPARE(MapCSSStyleCache::find(m_styleUrl, m_data), s1);
+        QCOMPARE(MapCSSStyleCache::size(), 1);
+
+        // concurrent load for the same style and data
+        auto s2 = MapCSSStyleCache::insert(m_styleUrl, m_data, parseStyle());
+        QCOMPARE(s2, s1);
+        QCOMPARE(MapCSSStyleCache::size(), 1);
+
+        // different style or different data
+        const auto darkUrl = MapCSSLoader::resolve(u"breeze-dark"_s);
+        MapCSSParser p;
+        auto s3 = MapCSSStyleCache::insert(darkUrl, m_data, p.parse(darkUrl));
+        QVERIFY(s3 != s1);
+        MapData otherData;
+        auto s4 = MapCSSStyleCache::insert(m_styleUrl, otherData, parseStyle());
+        QVERIFY(s4 != s1);
+        QCOMPARE(MapCSSStyleCache::size(), 3);
+
+        // released with the last reference
+        s2.reset();
+        s3.reset();
+        s4.reset();
+        QCOMPARE(MapCSSStyleCache::size(), 1);
+        s1.reset();
+        QCOMPARE(MapCSSStyleCache::size(), 0);
+        QVERIFY(!MapCSSStyleCache::find(m_styleUrl, m_data));
+    }
+
+    void testSharedMapData()
+    {
+        // separate loaders for the same map share the data, and thus the style
+        auto data = loadData();
+        QCOMPARE(data, m_data);
+        auto s1 = MapCSSStyleCache::insert(m_styleUrl, m_data, parseStyle());
+        QCOMPARE(MapCSSStyleCache::find(m_styleUrl, data), s1);
+
+        // different map
+        const auto otherData = loadData(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-central.osm"));
+        QVERIFY(!otherData.isEmpty());
+        QVERIFY(!(otherData == m_data));
+        QVERIFY(!MapCSSStyleCache::find(m_styleUrl, otherData));
+
+        QCOMPARE(loadData(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-central.osm")), otherData);
+    }
+
+    void testStyleOutlivesData()
+    {
+        auto s = MapCSSStyleCache::insert(m_styleUrl, loadData(), parseStyle());
+        QVERIFY(s);
+        QCOMPARE(MapCSSStyleCache::size(), 1);
+        s.reset();
+        QCOMPARE(MapCSSStyleCache::size(), 0);
+    }
+
+    void testDataChange()
+    {
+        auto s1 = MapCSSStyleCache::insert(m_styleUrl, m_data, parseStyle());
+        const auto otherData = loadData(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-central.osm"));
+        QVERIFY(!otherData.isEmpty());
+
+        // not used anywhere else, so that gets recompiled rather than loaded again
+        const auto *style = s1.get();
+        auto s2 = MapCSSStyleCache::find(m_styleUrl, otherData, std::move(s1));
+        QCOMPARE(s2.get(), style);
+        QVERIFY(!s1);
+        QCOMPARE(MapCSSStyleCache::find(m_styleUrl, otherData), s2);
+        QVERIFY(!MapCSSStyleCache::find(m_styleUrl, m_data));
+        QCOMPARE(MapCSSStyleCache::size(), 1);
+
+        // shared with another view, that one keeps using it for the old data
+        auto s3 = MapCSSStyleCache::find(m_styleUrl, otherData);
+        QVERIFY(!MapCSSStyleCache::find(m_styleUrl, m_data, std::move(s3)));
+        QVERIFY(!s3);
+
+        // different style
+        const auto darkUrl = MapCSSLoader::resolve(u"breeze-dark"_s);
+        QVERIFY(!MapCSSStyleCache::find(darkUrl, m_data, std::move(s2)));
+        QCOMPARE(MapCSSStyleCache::size(), 0);
+    }
+
+    void testDeferredCompile()
+    {
+        // no data yet, so this is only parsed and not shared
+        auto s1 = MapCSSStyleCache::insert(m_styleUrl, MapData(), parseStyle());
+        QVERIFY(s1);
+        QVERIFY(!MapCSSStyleCache::find(m_styleUrl, MapData()));
+        QVERIFY(!MapCSSStyleCache::find(m_styleUrl, m_data));
+        QCOMPARE(MapCSSStyleCache::size(), 1);
+
+        // compiled once data is available
+        const auto *style = s1.get();
+        auto s2 = MapCSSStyleCache::find(m_styleUrl, m_data, std::move(s1));
+        QCOMPARE(s2.get(), style);
+        QCOMPARE(MapCSSStyleCache::find(m_styleUrl, m_data), s2);
+        QCOMPARE(MapCSSStyleCache::size(), 1);
+        s2.reset();
+        QCOMPARE(MapCSSStyleCache::size(), 0);
+    }
+
+    void testRecompile()
+    {
+        auto data = loadData();
+        auto s1 = MapCSSStyleCache::insert(m_styleUrl, data, parseStyle());
+        auto s2 = MapCSSStyleCache::find(m_styleUrl, data);
+        QCOMPARE(s2, s1);
+
+        // only needed when new tag keys got added, and only once for all views sharing the style
+        QVERIFY(!MapCSSStyleCache::recompile(s1));
+        (void)data.dataSet().makeTagKey("org.kde.kosmindoormap.test");
+        QVERIFY(MapCSSStyleCache::recompile(s1));
+        QVERIFY(!MapCSSStyleCache::recompile(s2));
+    }
+
+    void benchmarkViews_data()
+    {
+        QTest::addColumn<int>("viewCount");
+        QTest::addColumn<bool>("shared");
+        for (const auto viewCount : {1, 4, 16}) {
+            QTest::addRow("%d views, separate styles", viewCount) << viewCount << false;
+            QTest::addRow("%d views, shared style", viewCount) << viewCount << true;
+        }
+    }
+
+    void benchmarkViews()
+    {
+        QFETCH(int, viewCount);
+        QFETCH(bool, shared);
+
+        std::vector<std::unique_ptr<MapView>> views;
+        QBENCHMARK {
+            views.clear();
+            for (int i = 0; i < viewCount; ++i) {
+                views.push_back(std::make_unique<MapView>());
+                setupView(*views.back(), shared);
+            }
+        }
+
+        std::vector<const MapCSSStyle*> styles;
+        for (const auto &v : views) {
+            QVERIFY(!v->sg.items().empty());
+            styles.push_back(v->style.get());
+        }
+        std::sort(styles.begin(), styles.end());
+        styles.erase(std::unique(styles.begin(), styles.end()), styles.end());
+        QCOMPARE(styles.size(), shared ? 1 : viewCount);
+    }
+
+    void benchmarkMemory_data()
+    {
+        benchmarkViews_data();
+    }
+
+    // heap memory allocated for setting up the views, including their styles
+    void benchmarkMemory()
+    {
+#ifdef HAVE_MALLINFO2
+        QFETCH(int, viewCount);
+        QFETCH(bool, shared);
+
+        const auto before = mallinfo2().uordblks;
+        std::vector<std::unique_ptr<MapView>> views;
+        for (int i = 0; i < viewCount; ++i) {
+            views.push_back(std::make_unique<MapView>());
+            setupView(*views.back(), shared);
+        }
+        const auto after = mallinfo2().uordblks;
+        QVERIFY(after > before);
+        QTest::setBenchmarkResult((qreal)(after - before), QTest::BytesAllocated);
+#else
+        QSKIP("memory measurement not supported on this platform");
+#endif
+    }
+};
+
+QTEST_MAIN(StyleCacheTest)
+
+#include "stylecachetest.moc"
@@ -0,0 +1,213 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <map/loader/mapdata.h>
+#include <map/loader/maploader.h>
+#include <map/renderer/painterrenderer.h>
+#include <map/scene/scenecontroller.h>
+#include <map/scene/scenegraph.h>
+#include <map/scene/scenegraph_p.h>
+#include <map/scene/textlayoutcache_p.h>
+#include <map/scene/view.h>
+#include <map/style/mapcssloader.h>
+#include <map/style/mapcssparser.h>
+#include <map/style/mapcssstyle.h>
+
+#include <QDebug>
+#include <QFontMetricsF>
+#include <QImage>
+#include <QPainter>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <memory>
+#include <utility>
+
+using namespace Qt::Literals::StringLiterals;
+using namespace KOSMIndoorMap;
+
+class TextLayoutCacheTest : public QObject
+{
+    Q_OBJECT
+private:
+    /** The most label-dense venue we have test data for. */
+    [[nodiscard]] static MapData loadData()
+    {
+        MapLoader loader;
+        QSignalSpy doneSpy(&loader, &MapLoader::done);
+        loader.loadFromFile(QStringLiteral(SOURCE_DIR "/data/platforms/hamburg-central.osm"));
+        doneSpy.wait();
+        return loader.takeData();
+    }
+
+    static void setupView(View &view, const MapData &data)
+    {
+        view.setScreenSize({1920, 1080});
+        view.setSceneBoundingBox(data.boundingBox());
+        view.setLevel(0);
+        view.setZoomLevel(18.0, { 960.0, 540.0 });
+    }
+
+    [[nodiscard]] static const LabelItem* firstTextLabel(const SceneGraph &sg)
+    {
+        for (const auto &item : sg.items()) {
+            if (const auto label = dynamic_cast<const LabelItem*>(item.payload.get()); label && label->hasText()) {
+                return label;
+            }
+        }
+        return nullptr;
+    }
+
+private Q_SLOTS:
+    void testLayout()
+    {
+        TextLayoutCache cache;
+        QFont font;
+
+        const auto simple = cache.layout(u"Gate A12"_s, font, 0.0);
+        QVERIFY(simple);
+        QCOMPARE(simple->outputSize, QFontMetricsF(font).size(0, u"Gate A12"_s));
+        QVERIFY(simple->size.width() > 0.0);
+
+        // multi-line text
+        const auto multiLine = cache.layout(u"Baggage Claim\nBelts 1-5"_s, font, 0.0);
+        QVERIFY(multiLine->outputSize.height() > simple->outputSize.height() * 1.5);
+        QVERIFY(multiLine->outputSize.width() >= QFontMetricsF(font).horizontalAdvance(u"Baggage Claim"_s) - 1.0);
+        QVERIFY(multiLine->outputSize.width() < QFontMetricsF(font).horizontalAdvance(u"Baggage Claim Belts 1-5"_s));
+
+        // word-wrapped text
+        const auto wrapped = cache.layout(u"Left Luggage and Lost Property Office"_s, font, 80.0);
+        QVERIFY(wrapped->outputSize.width() <= 80.0);
+        QVERIFY(wrapped->outputSize.height() > simple->outputSize.height() * 1.5);
+
+        // repeated lookups are served from the cache
+        auto stats = cache.statistics();
+        QCOMPARE(stats.hits, 0);
+        QCOMPARE(stats.misses, 3);
+        QCOMPARE(stats.count, 3);
+        QCOMPARE(cache.layout(u"Gate A12"_s, font, 0.0), simple);
+        QCOMPARE(cache.layout(u"Gate A12"_s, font, -1.0), simple);
+        QCOMPARE(cache.layout(u"Left Luggage and Lost Property Office"_s, font, 80.0), wrapped);
+        stats = cache.statistics();
+        QCOMPARE(stats.hits, 3);
+        QCOMPARE(stats.misses, 3);
+
+        // different font or maximum width
+        auto boldFont = font;
+        boldFont.setBold(true);
+        QVERIFY(cache.layout(u"Gate A12"_s, boldFont, 0.0) != simple);
+        QVERIFY(cache.layout(u"Left Luggage and Lost Property Office"_s, font, 120.0) != wrapped);
+        QCOMPARE(cache.statistics().count, 5);
+    }
+
+    void testEviction()
+    {
+        TextLayoutCache cache;
+        cache.setMaximumCount(10);
+        QFont font;
+        const auto first = cache.layout(u"Gate 0"_s, font, 0.0);
+        for (int i = 1; i < 20; ++i) {
+            QVERIFY(cache.layout(u"Gate "_s + QString::number(i), font, 0.0));
+        }
+        QCOMPARE(cache.statistics().count, 10);
+
+        // evicted layouts remain valid while in use
+        QCOMPARE(first->outputSize, QFontMetricsF(font).size(0, u"Gate 0"_s));
+        QVERIFY(cache.layout(u"Gate 0"_s, font, 0.0) != first);
+    }
+
+    void testControllerCache()
+    {
+        auto data = loadData();
+        QVERIFY(!data.dataSet().nodes.empty());
+        MapCSSParser p;
+        auto style = p.parse(MapCSSLoader::resolve(u"breeze-light"_s));
+        style.compile(data.dataSet());
+        View view;
+        setupView(view, data);
+
+        // QStaticText and QTextLayout must not be drawn from multiple threads, so each controller has its own cache
+        SceneController controller1, controller2;
+        SceneGraph sg1, sg2;
+        for (auto [controller, sg] : { std::pair{ &controller1, &sg1 }, { &controller2, &sg2 } }) {
+            controller->setView(&view);
+            controller->setMapData(data);
+            controller->setStyleSheet(&style);
+            controller->updateScene(*sg);
+        }
+
+        const auto label1 = firstTextLabel(sg1);
+        const auto label2 = firstTextLabel(sg2);
+        QVERIFY(label1 && label2);
+        const auto layouts1 = SceneGraphPrivate::get(sg1)->m_textLayouts;
+        const auto layouts2 = SceneGraphPrivate::get(sg2)->m_textLayouts;
+        QVERIFY(layouts1);
+        QVERIFY(layouts2);
+        QVERIFY(layouts1 != layouts2);
+        const auto layout1 = layouts1->layout(label1->text.text(), label1->font, label1->text.textWidth());
+        const auto layout2 = layouts2->layout(label2->text.text(), label2->font, label2->text.textWidth());
+        QVERIFY(layout1 != layout2);
+        QCOMPARE(layout1->size, layout2->size);
+    }
+
+    void benchmarkRelayout_data()
+    {
+        QTest::addColumn<bool>("warm");
+        QTest::newRow("cold") << false;
+        QTest::newRow("warm") << true;
+    }
+
+    void benchmarkRelayout()
+    {
+        QFETCH(bool, warm);
+
+        auto data = loadData();
+        MapCSSParser p;
+        auto style = p.parse(MapCSSLoader::resolve(u"breeze-light"_s));
+        style.compile(data.dataSet());
+
+        View view;
+        setupView(view, data);
+        const auto setupController = [&](SceneController &controller) {
+            controller.setView(&view);
+            controller.setMapData(data);
+            controller.setStyleSheet(&style);
+        };
+        SceneController warmController;
+        setupController(warmController);
+
+        QImage img(view.screenWidth(), view.screenHeight(), QImage::Format_ARGB32_Premultiplied);
+        PainterRenderer renderer;
+        SceneGraph sg;
+        // zooming rebuilds the scene, and all labels need their size for collision detection and rendering
+        QBENCHMARK {
+            // every scene controller has its own text layout cache, a new one starts out empty
+            std::unique_ptr<SceneController> coldController;
+            if (!warm) {
+                coldController = std::make_unique<SceneController>();
+                setupController(*coldController);
+            }
+            auto &controller = warm ? warmController : *coldController;
+            for (const auto zoom : { 17.0, 18.0, 19.0 }) {
+                view.setZoomLevel(zoom, { 960.0, 540.0 });
+                controller.updateScene(sg);
+                QPainter painter(&img);
+                renderer.setPainter(&painter);
+                renderer.render(sg, &view);
+            }
+        }
+
+        const auto layouts = SceneGraphPrivate::get(sg)->m_textLayouts;
+        QVERIFY(layouts);
+        const auto stats = layouts->statistics();
+        qDebug() << "text layout cache:" << stats.hits << "hits" << stats.misses << "misses" << stats.count << "entries";
+        QVERIFY(stats.misses > 0);
+        QVERIFY(stats.hits > 0);
+    }
+};
+
+QTEST_MAIN(TextLayoutCacheTest)
+
+#include "textlayoutcachetest.moc"
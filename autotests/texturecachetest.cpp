@@ -0,0 +1,226 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <map/loader/mapdata.h>
+#include <map/scene/scenecontroller.h>
+#include <map/scene/scenegraph.h>
+#include <map/scene/texturecache_p.h>
+#include <map/scene/view.h>
+#include <map/style/mapcssparser.h>
+#include <map/style/mapcssstyle.h>
+
+#include <osm/datatypes.h>
+
+#include <QRegion>
+#include <QSemaphore>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <tuple>
+#include <utility>
+
+using namespace Qt::Literals::StringLiterals;
+using namespace KOSMIndoorMap;
+
+class TextureCacheTest : public QObject
+{
+    Q_OBJECT
+private:
+    [[nodiscard]] static qsizetype textureSize(const QString &name)
+    {
+        TextureCache cache;
+        (void)cache.image(name, 1.0);
+        return cache.statistics().size;
+    }
+
+    /** Two square areas next to each other, the first one textured by the test style. */
+    [[nodiscard]] static MapData makeData()
+    {
+        OSM::DataSet dataSet;
+        const auto landuseKey = dataSet.makeTagKey("landuse");
+        OSM::Id nodeId = 1;
+        for (const auto &[wayId, landuse, lon] : { std::tuple<OSM::Id, const char*, double>{ 1, "meadow", 13.4 }, { 2, "grass", 13.402 } }) {
+            OSM::Way way;
+            way.id = wayId;
+            for (const auto &[dlat, dlon] : { std::pair{ 0.0, 0.0 }, { 0.001, 0.0 }, { 0.001, 0.001 }, { 0.0, 0.001 } }) {
+                OSM::Node node;
+                node.id = nodeId++;
+                node.coordinate = OSM::Coordinate(52.5 + dlat, lon + dlon);
+                way.nodes.push_back(node.id);
+                dataSet.addNode(std::move(node));
+            }
+            way.nodes.push_back(way.nodes.front());
+            OSM::setTagValue(way, landuseKey, QByteArray(landuse));
+            dataSet.addWay(std::move(way));
+        }
+        MapData mapData;
+        mapData.setDataSet(std::move(dataSet));
+        return mapData;
+    }
+
+private Q_SLOTS:
+    void testSyncLoading()
+    {
+        TextureCache cache;
+        const auto img = cache.image(u"beach.png"_s, 1.0);
+        QVERIFY(!img.isNull());
+        auto stats = cache.statistics();
+        QCOMPARE(stats.hits, 0);
+        QCOMPARE(stats.misses, 1);
+        QCOMPARE(stats.count, 1);
+        QCOMPARE(stats.size, img.sizeInBytes());
+
+        QCOMPARE(cache.image(u"beach.png"_s, 1.0), img);
+        stats = cache.statistics();
+        QCOMPARE(stats.hits, 1);
+        QCOMPARE(stats.misses, 1);
+
+        // different device pixel ratios are separate entries
+        const auto hidpiImg = cache.image(u"orchard.svg"_s, 2.0);
+        QCOMPARE(hidpiImg.devicePixelRatio(), 2.0);
+        QCOMPARE(hidpiImg.size(), cache.image(u"orchard.svg"_s, 1.0).size() * 2);
+        stats = cache.statistics();
+        QCOMPARE(stats.misses, 3);
+        QCOMPARE(stats.count, 3);
+
+        // failed loads are cached as well
+        QVERIFY(cache.image(u"does-not-exist.png"_s, 1.0).isNull());
+        QVERIFY(cache.image(u"does-not-exist.png"_s, 1.0).isNull());
+        stats = cache.statistics();
+        QCOMPARE(stats.hits, 2);
+        QCOMPARE(stats.misses, 4);
+    }
+
+    void testAsyncLoading()
+    {
+        TextureCache cache;
+        QSignalSpy loadedSpy(&cache, &TextureCache::textureLoaded);
+
+        QVERIFY(!cache.requestImage(u"beach.png"_s, 1.0));
+        QVERIFY(!cache.requestImage(u"does-not-exist.png"_s, 1.0));
+        QTRY_COMPARE(loadedSpy.size(), 2);
+
+        const auto img = cache.requestImage(u"beach.png"_s, 1.0);
+        QVERIFY(img);
+        QVERIFY(!img->isNull());
+        QCOMPARE(*img, TextureCache().image(u"beach.png"_s, 1.0));
+        const auto failedImg = cache.requestImage(u"does-not-exist.png"_s, 1.0);
+        QVERIFY(failedImg);
+        QVERIFY(failedImg->isNull());
+
+        const auto stats = cache.statistics();
+        QCOMPARE(stats.hits, 2);
+        QCOMPARE(stats.misses, 2);
+        QCOMPARE(stats.count, 2);
+    }
+
+    void testRequestPriority()
+    {
+        TextureCache cache;
+        QSignalSpy loadedSpy(&cache, &TextureCache::textureLoaded);
+
+        // block the loader thread until all requests are queued
+        QSemaphore blocker;
+        cache.m_pool.setMaxThreadCount(1);
+        cache.m_pool.start([&blocker]() { blocker.acquire(); });
+
+        QVERIFY(!cache.requestImage(u"beach.png"_s, 1.0));
+        QVERIFY(!cache.requestImage(u"scrub.png"_s, 1.0));
+        for (int i = 0; i < 3; ++i) {
+            QVERIFY(!cache.requestImage(u"wetland.png"_s, 1.0));
+        }
+        QCOMPARE(cache.statistics().misses, 3);
+
+        blocker.release();
+        cache.m_pool.waitForDone();
+
+        // the most requested texture is loaded first, then in request order
+        QCOMPARE(loadedSpy.size(), 3);
+        QCOMPARE(loadedSpy[0][0].toString(), u"wetland.png"_s);
+        QCOMPARE(loadedSpy[1][0].toString(), u"beach.png"_s);
+        QCOMPARE(loadedSpy[2][0].toString(), u"scrub.png"_s);
+    }
+
+    void testEviction()
+    {
+        const auto sizeA = textureSize(u"beach.png"_s);
+        const auto sizeB = textureSize(u"scrub.png"_s);
+        const auto sizeC = textureSize(u"wetland.png"_s);
+        QVERIFY(sizeA > 0 && sizeB > 0 && sizeC > 0);
+
+        TextureCache cache;
+        cache.setMaximumSize(sizeA + sizeB + sizeC - 1);
+        (void)cache.image(u"beach.png"_s, 1.0);
+        (void)cache.image(u"scrub.png"_s, 1.0);
+        (void)cache.image(u"beach.png"_s, 1.0);
+        QCOMPARE(cache.statistics().count, 2);
+
+        // exceeding the size limit evicts the least recently used texture only
+        (void)cache.image(u"wetland.png"_s, 1.0);
+        auto stats = cache.statistics();
+        QCOMPARE(stats.count, 2);
+        QCOMPARE(stats.size, sizeA + sizeC);
+
+        const auto hits = stats.hits;
+        const auto misses = stats.misses;
+        (void)cache.image(u"beach.png"_s, 1.0);
+        (void)cache.image(u"wetland.png"_s, 1.0);
+        (void)cache.image(u"scrub.png"_s, 1.0);
+        stats = cache.statistics();
+        QCOMPARE(stats.hits, hits + 2);
+        QCOMPARE(stats.misses, misses + 1);
+    }
+
+    void testSceneDamage()
+    {
+        auto data = makeData();
+        MapCSSParser p;
+        auto style = p.parse(QStringLiteral(SOURCE_DIR "/data/mapcss/textured.mapcss"));
+        QVERIFY(!p.hasError());
+        style.compile(data.dataSet());
+
+        View view;
+        view.setScreenSize({1920, 1080});
+        view.setSceneBoundingBox(data.boundingBox());
+        view.setLevel(0);
+        view.setZoomLevel(17.0, { 960.0, 540.0 });
+
+        // this uses the shared texture cache, which none of the above tests touched
+        SceneController controller;
+        QObject context;
+        int loadedCount = 0;
+        controller.setAsyncTextureLoading(&context, [&loadedCount]() { ++loadedCount; });
+        controller.setView(&view);
+        controller.setMapData(data);
+        controller.setStyleSheet(&style);
+
+        SceneGraph sg;
+        controller.updateScene(sg);
+        QVERIFY(controller.hasFullDamage());
+        controller.resetDamage();
+        QTRY_COMPARE(loadedCount, 1);
+
+        // only the textured area is damaged by the texture becoming available
+        controller.updateScene(sg);
+        QVERIFY(!controller.hasFullDamage());
+        QVERIFY(!controller.damage().isEmpty());
+        int itemCount = 0;
+        for (const auto &item : sg.items()) {
+            const auto bbox = item.payload->screenBoundingRect(&view);
+            if (item.element.tagValue("landuse") == "meadow") {
+                QVERIFY(QRegion(bbox.toAlignedRect()).subtracted(controller.damage()).isEmpty());
+                ++itemCount;
+            } else if (item.element.tagValue("landuse") == "grass") {
+                QVERIFY(!controller.damage().intersects(bbox.adjusted(4.0, 4.0, -4.0, -4.0).toAlignedRect()));
+                ++itemCount;
+            }
+        }
+        QCOMPARE(itemCount, 2);
+    }
+};
+
+QTEST_MAIN(TextureCacheTest)
+
+#include "texturecachetest.moc"
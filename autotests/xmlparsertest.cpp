@@ -0,0 +1,202 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include <osm/abstractreader.h>
+#include <osm/datatypes.h>
+#include <osm/io.h>
+
+#include <QBuffer>
+#include <QDirIterator>
+#include <QFile>
+#include <QTest>
+
+#include <cstring>
+
+using namespace Qt::Literals::StringLiterals;
+
+class XmlParserTest : public QObject
+{
+    Q_OBJECT
+private:
+    static void readFromData(const QByteArray &data, OSM::DataSet &dataSet)
+    {
+        auto p = OSM::IO::readerForMimeType(u"application/vnd.openstreetmap.data+xml", &dataSet);
+        QVERIFY(p);
+        p->read(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+        QVERIFY(!p->hasError());
+    }
+
+    static void readFromIODevice(QByteArray data, OSM::DataSet &dataSet)
+    {
+        auto p = OSM::IO::readerForMimeType(u"application/vnd.openstreetmap.data+xml", &dataSet);
+        QVERIFY(p);
+        QBuffer buffer(&data);
+        QVERIFY(buffer.open(QIODevice::ReadOnly));
+        p->read(&buffer);
+        QVERIFY(!p->hasError());
+    }
+
+    template <typename Elem>
+    static void compareTags(const Elem &lhs, const Elem &rhs)
+    {
+        QCOMPARE(lhs.tags.size(), rhs.tags.size());
+        for (std::size_t i = 0; i < lhs.tags.size(); ++i) {
+            QCOMPARE(lhs.tags[i].key.name(), rhs.tags[i].key.name());
+            QCOMPARE(lhs.tags[i].value, rhs.tags[i].value);
+        }
+    }
+
+    static void compareDataSets(const OSM::DataSet &lhs, const OSM::DataSet &rhs)
+    {
+        QCOMPARE(lhs.nodes.size(), rhs.nodes.size());
+        for (std::size_t i = 0; i < lhs.nodes.size(); ++i) {
+            QCOMPARE(lhs.nodes[i].id, rhs.nodes[i].id);
+            QCOMPARE(lhs.nodes[i].coordinate.latitude, rhs.nodes[i].coordinate.latitude);
+            QCOMPARE(lhs.nodes[i].coordinate.longitude, rhs.nodes[i].coordinate.longitude);
+            compareTags(lhs.nodes[i], rhs.nodes[i]);
+        }
+        QCOMPARE(lhs.ways.size(), rhs.ways.size());
+        for (std::size_t i = 0; i < lhs.ways.size(); ++i) {
+            QCOMPARE(lhs.ways[i].id, rhs.ways[i].id);
+            QCOMPARE(lhs.ways[i].nodes, rhs.ways[i].nodes);
+            QVERIFY(lhs.ways[i].bbox == rhs.ways[i].bbox);
+            compareTags(lhs.ways[i], rhs.ways[i]);
+        }
+        QCOMPARE(lhs.relations.size(), rhs.relations.size());
+        for (std::size_t i = 0; i < lhs.relations.size(); ++i) {
+            QCOMPARE(lhs.relations[i].id, rhs.relations[i].id);
+            QVERIFY(lhs.relations[i].bbox == rhs.relations[i].bbox);
+            QCOMPARE(lhs.relations[i].members.size(), rhs.relations[i].members.size());
+            for (std::size_t j = 0; j < lhs.relations[i].members.size(); ++j) {
+                QCOMPARE(lhs.relations[i].members[j].id, rhs.relations[i].members[j].id);
+                QCOMPARE(lhs.relations[i].members[j].type(), rhs.relations[i].members[j].type());
+                QCOMPARE(lhs.relations[i].members[j].role().name(), rhs.relations[i].members[j].role().name());
+            }
+            compareTags(lhs.relations[i], rhs.relations[i]);
+        }
+    }
+
+private Q_SLOTS:
+    void testMemoryMappedParser_data()
+    {
+        QTest::addColumn<QString>("osmFile");
+        QDirIterator it(QStringLiteral(SOURCE_DIR "/data/"), {u"*.osm"_s}, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            it.next();
+            QTest::newRow(it.fileName().toUtf8().constData()) << it.filePath();
+        }
+    }
+
+    void testMemoryMappedParser()
+    {
+        QFETCH(QString, osmFile);
+        QFile f(osmFile);
+        QVERIFY(f.open(QFile::ReadOnly));
+        const auto data = f.readAll();
+
+        OSM::DataSet mmapDataSet;
+        readFromData(data, mmapDataSet);
+        OSM::DataSet ioDataSet;
+        readFromIODevice(data, ioDataSet);
+
+        QVERIFY(!mmapDataSet.nodes.empty());
+        compareDataSets(mmapDataSet, ioDataSet);
+    }
+
+    void testDecoding()
+    {
+        const auto data = QByteArray(
+            "\xEF\xBB\xBF<?xml version='1.0' encoding='utf-8'?>\n"
+            "<osm version=\"0.6\">\n"
+            "  <!-- comment <node id=\"42\"/> -->\n"
+            "  <node id='1' lat='-33.8567844' lon='-0.5'>\n"
+            "    <tag k='name' v='Caf&#xE9; &amp; Bar &lt;&quot;&apos;&gt; &#8364;'/>\n"
+            "    <tag k='de&#x3A;name' v='line1\nline2\tend'/>\n"
+            "  </node>\n"
+            "  <node id=\"2\" lat=\"52.5\" lon=\"13\"/>\n"
+            "  <way id='10'><nd ref='1'/><nd ref='2'/><tag k='highway' v='footway'/></way>\n"
+            "  <relation id=\"100\">\n"
+            "    <member type=\"way\" ref=\"10\" role=\"outer\"/>\n"
+            "    <member type=\"node\" ref=\"1\" role=\"\"/>\n"
+            "    <tag k=\"type\" v=\"multipolygon\"/>\n"
+            "  </relation>\n"
+            "</osm>\n");
+
+        OSM::DataSet mmapDataSet;
+        readFromData(data, mmapDataSet);
+        OSM::DataSet ioDataSet;
+        readFromIODevice(data, ioDataSet);
+        compareDataSets(mmapDataSet, ioDataSet);
+
+        QCOMPARE(mmapDataSet.nodes.size(), 2);
+        const auto &node = mmapDataSet.nodes[0];
+        QCOMPARE(node.coordinate.latitude, 561432156u);
+        QCOMPARE(node.coordinate.longitude, 1795000000u);
+        QCOMPARE(OSM::tagValue(node, "name"), "Café & Bar <\"'> €");
+        QCOMPARE(OSM::tagValue(node, "de:name"), "line1 line2 end");
+        QCOMPARE(mmapDataSet.ways.size(), 1);
+        QCOMPARE(mmapDataSet.ways[0].nodes.size(), 2);
+        QCOMPARE(mmapDataSet.relations.size(), 1);
+        QCOMPARE(mmapDataSet.relations[0].members.size(), 2);
+        QCOMPARE(mmapDataSet.relations[0].members[0].role().name(), "outer");
+    }
+
+    void testFallback_data()
+    {
+        QTest::addColumn<QByteArray>("data");
+        QTest::newRow("latin1") << QByteArray("<?xml version='1.0' encoding='ISO-8859-1'?>\n<osm><node id='1' lat='48.1' lon='11.5'><tag k='name' v='M\xFCnchen'/></node></osm>");
+        QTest::newRow("dtd") << QByteArray("<?xml version='1.0'?>\n<!DOCTYPE osm [<!ENTITY city \"M\xC3\xBCnchen\">]>\n<osm><node id='1' lat='48.1' lon='11.5'><tag k='name' v='&city;'/></node></osm>");
+        QTest::newRow("cdata") << QByteArray("<osm><note><![CDATA[<>]]></note><node id='1' lat='48.1' lon='11.5'><tag k='name' v='M&#xFC;nchen'/></node></osm>");
+    }
+
+    void testFallback()
+    {
+        QFETCH(QByteArray, data);
+
+        OSM::DataSet dataSet;
+        readFromData(data, dataSet);
+        QCOMPARE(dataSet.nodes.size(), 1);
+        QCOMPARE(OSM::tagValue(dataSet.nodes[0], "name"), "München");
+    }
+
+    void testRemark()
+    {
+        const auto data = QByteArray("<osm><node id='1' lat='48.1' lon='11.5'/><remark>runtime error: Query timed out &amp; stuff</remark></osm>");
+        OSM::DataSet dataSet;
+        auto p = OSM::IO::readerForMimeType(u"application/vnd.openstreetmap.data+xml", &dataSet);
+        p->read(reinterpret_cast<const uint8_t*>(data.constData()), data.size());
+        QVERIFY(p->hasError());
+        QCOMPARE(p->errorString(), u"runtime error: Query timed out & stuff"_s);
+        QCOMPARE(dataSet.nodes.size(), 1);
+    }
+
+    void benchmarkParser_data()
+    {
+        QTest::addColumn<bool>("fromData");
+        QTest::newRow("QXmlStreamReader") << false;
+        QTest::newRow("memory-mapped") << true;
+    }
+
+    void benchmarkParser()
+    {
+        QFETCH(bool, fromData);
+        QFile f(QStringLiteral(SOURCE_DIR "/data/platforms/paris-gare-de-lyon.osm"));
+        QVERIFY(f.open(QFile::ReadOnly));
+        const auto data = f.readAll();
+
+        QBENCHMARK {
+            OSM::DataSet dataSet;
+            if (fromData) {
+                readFromData(data, dataSet);
+            } else {
+                readFromIODevice(data, dataSet);
+            }
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(XmlParserTest)
+
+#include "xmlparsertest.moc"
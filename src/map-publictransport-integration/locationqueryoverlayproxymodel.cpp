@@ -69,6 +69,16 @@ void LocationQueryOverlayProxyModel::setMapData(const MapData &data)
         m_realtimeAvailableTagKeys[i++] = m_data.dataSet().makeTagKey(v.tagName);
     }
 
+    m_rentalStations.clear();
+    for (const auto &n : m_data.dataSet().nodes) {
+        if (OSM::tagValue(n, m_tagKeys.amenity) == "bicycle_rental") {
+            m_rentalStations.push_back(&n);
+        }
+    }
+    std::sort(m_rentalStations.begin(), m_rentalStations.end(), [](auto lhs, auto rhs) {
+        return lhs->coordinate.latitude < rhs->coordinate.latitude;
+    });
+
     initialize();
     endResetModel();
     Q_EMIT mapDataChanged();
@@ -98,10 +108,9 @@ void LocationQueryOverlayProxyModel::setSourceModel(QObject *sourceModel)
         if (parent.isValid() || m_data.isEmpty()) {
             return;
         }
+        auto nodes = nodesForRows(first, last);
         beginInsertRows({}, first, last);
-        for (int i = first; i <= last; ++i) {
-            m_nodes.insert(m_nodes.begin() + i, nodeForRow(i));
-        }
+        m_nodes.insert(m_nodes.begin() + first, std::make_move_iterator(nodes.begin()), std::make_move_iterator(nodes.end()));
         endInsertRows();
     });
     connect(m_sourceModel, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex &parent, int first, int last) {
@@ -109,16 +118,15 @@ void LocationQueryOverlayProxyModel::setSourceModel(QObject *sourceModel)
             return;
         }
         beginRemoveRows({}, first, last);
-        m_nodes.erase(m_nodes.begin() + first, m_nodes.begin() + last);
+        m_nodes.erase(m_nodes.begin() + first, m_nodes.begin() + last + 1);
         endRemoveRows();
     });
     connect(m_sourceModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &first, const QModelIndex &last) {
         if (first.parent().isValid() || last.parent().isValid() || m_data.isEmpty()) {
             return;
         }
-        for (int i = first.row(); i <= last.row(); ++i) {
-            m_nodes[i] = nodeForRow(i);
-        }
+        auto nodes = nodesForRows(first.row(), last.row());
+        std::move(nodes.begin(), nodes.end(), m_nodes.begin() + first.row());
         Q_EMIT dataChanged(index(first.row(), 0), index(last.row(), 0));
     });
 }
@@ -164,12 +172,42 @@ void LocationQueryOverlayProxyModel::initialize()
         return;
     }
 
-    m_nodes.clear();
-    const auto rows = m_sourceModel->rowCount();
-    m_nodes.reserve(rows);
-    for (int i = 0; i < rows; ++i) {
-        m_nodes.push_back(nodeForRow(i));
+    m_nodes = nodesForRows(0, m_sourceModel->rowCount() - 1);
+}
+
+std::vector<LocationQueryOverlayProxyModel::Info> LocationQueryOverlayProxyModel::nodesForRows(int first, int last) const
+{
+    std::vector<Info> nodes;
+    nodes.reserve(std::max(0, last - first + 1));
+    for (int i = first; i <= last; ++i) {
+        nodes.push_back(nodeForRow(i));
     }
+    return nodes;
+}
+
+// maximum distance in meters between a realtime rental station and its OSM counterpart
+constexpr inline double RENTAL_STATION_MATCH_DISTANCE = 10.0;
+
+const OSM::Node* LocationQueryOverlayProxyModel::findRentalStation(OSM::Coordinate coord) const
+{
+    // only consider the latitude band that can possibly contain a match (~111km per degree, 10^7 units per degree)
+    constexpr uint32_t latRange = RENTAL_STATION_MATCH_DISTANCE / 111'000.0 * 10'000'000.0 + 1;
+    const auto latBegin = coord.latitude > latRange ? coord.latitude - latRange : 0;
+    auto it = std::lower_bound(m_rentalStations.begin(), m_rentalStations.end(), latBegin, [](auto n, uint32_t lat) {
+        return n->coordinate.latitude < lat;
+    });
+
+    const OSM::Node *match = nullptr;
+    double matchDist = RENTAL_STATION_MATCH_DISTANCE;
+    const OSM::LocalDistance localDist(coord);
+    for (; it != m_rentalStations.end() && (*it)->coordinate.latitude <= coord.latitude + latRange; ++it) {
+        const auto dist = localDist.distance((*it)->coordinate);
+        if (dist < matchDist) {
+            match = (*it);
+            matchDist = dist;
+        }
+    }
+    return match;
 }
 
 static void setTagIfMissing(OSM::Node &node, OSM::TagKey tag, const QString &value)
@@ -198,14 +236,11 @@ LocationQueryOverlayProxyModel::Info LocationQueryOverlayProxyModel::nodeForRow(
             const auto station = loc.rentalVehicleStation();
 
             // try to find a matching node in the base OSM data
-            for (const auto &n : m_data.dataSet().nodes) {
-                if (OSM::distance(n.coordinate, info.overlayNode.coordinate) < 10 && OSM::tagValue(n, m_tagKeys.amenity) == "bicycle_rental") {
-                    qDebug() << "found matching node, cloning that!" << n.url();
-                    info.sourceElement = OSM::Element(&n);
-                    info.overlayNode = n;
-                    OSM::setTagValue(info.overlayNode, m_tagKeys.mxoid, QByteArray::number(qlonglong(n.id)));
-                    break;
-                }
+            if (const auto n = findRentalStation(info.overlayNode.coordinate)) {
+                qDebug() << "found matching node, cloning that!" << n->url();
+                info.sourceElement = OSM::Element(n);
+                info.overlayNode = *n;
+                OSM::setTagValue(info.overlayNode, m_tagKeys.mxoid, QByteArray::number(qlonglong(n->id)));
             }
 
             info.overlayNode.id = m_data.dataSet().nextInternalId();
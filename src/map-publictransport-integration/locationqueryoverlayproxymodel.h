@@ -61,6 +61,10 @@ private:
 
     void initialize();
     Info nodeForRow(int row) const;
+    /** Creates overlay nodes for the source rows @p first to @p last (inclusive). */
+    std::vector<Info> nodesForRows(int first, int last) const;
+    /** Find a rental station in the base map data matching @p coord. */
+    const OSM::Node* findRentalStation(OSM::Coordinate coord) const;
 
     struct {
         OSM::TagKey name;
@@ -78,6 +82,8 @@ private:
     OSM::TagKey m_realtimeAvailableTagKeys[5];
 
     std::vector<Info> m_nodes;
+    /** Rental stations in the base map data, sorted by latitude. */
+    std::vector<const OSM::Node*> m_rentalStations;
     MapData m_data;
     QAbstractItemModel *m_sourceModel = nullptr;
 };
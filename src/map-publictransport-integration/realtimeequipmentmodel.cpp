@@ -19,6 +19,15 @@ constexpr inline const float EquipmentMatchDistance = 2.0; // meters
 RealtimeEquipmentModel::RealtimeEquipmentModel(QObject *parent)
     : EquipmentModel(parent)
 {
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(std::chrono::milliseconds(500));
+    connect(&m_updateTimer, &QTimer::timeout, this, [this]() {
+        if (m_updatePending) {
+            m_updatePending = false;
+            updateRealtimeState();
+            m_updateTimer.start();
+        }
+    });
 }
 
 RealtimeEquipmentModel::~RealtimeEquipmentModel() = default;
@@ -38,32 +47,30 @@ void RealtimeEquipmentModel::setRealtimeModel(QObject *model)
     Q_EMIT realtimeModelChanged();
 
     if (m_realtimeModel) {
-        connect(m_realtimeModel, &QAbstractItemModel::modelReset, this, &RealtimeEquipmentModel::updateRealtimeState);
+        connect(m_realtimeModel, &QAbstractItemModel::modelReset, this, &RealtimeEquipmentModel::scheduleRealtimeUpdate);
         connect(m_realtimeModel, &QAbstractItemModel::rowsInserted, this, [this](const auto &parent, auto first, auto last) {
-            if (parent.isValid() || m_pendingRealtimeUpdate) {
+            if (parent.isValid() || m_updatePending) {
                 return;
             }
             for (auto i = first; i <= last; ++i) {
                 const auto idx = m_realtimeModel->index(i, 0);
                 const auto loc = idx.data(KPublicTransport::LocationQueryModel::LocationRole).template value<KPublicTransport::Location>();
                 if (loc.type() == KPublicTransport::Location::Equipment) {
-                    m_pendingRealtimeUpdate = true;
-                    QMetaObject::invokeMethod(this, &RealtimeEquipmentModel::updateRealtimeState, Qt::QueuedConnection);
+                    scheduleRealtimeUpdate();
                     return;
                 }
             }
         });
-        connect(m_realtimeModel, &QAbstractItemModel::rowsRemoved, this, &RealtimeEquipmentModel::updateRealtimeState);
+        connect(m_realtimeModel, &QAbstractItemModel::rowsRemoved, this, &RealtimeEquipmentModel::scheduleRealtimeUpdate);
         connect(m_realtimeModel, &QAbstractItemModel::dataChanged, this, [this](const auto &fromIdx, const auto &toIdx) {
-            if (m_pendingRealtimeUpdate) {
+            if (m_updatePending) {
                 return;
             }
             for (auto i = fromIdx.row(); i <= toIdx.row(); ++i) {
                 const auto idx = m_realtimeModel->index(i, 0);
                 const auto loc = idx.data(KPublicTransport::LocationQueryModel::LocationRole).template value<KPublicTransport::Location>();
                 if (loc.type() == KPublicTransport::Location::Equipment) {
-                    m_pendingRealtimeUpdate = true;
-                    QMetaObject::invokeMethod(this, &RealtimeEquipmentModel::updateRealtimeState, Qt::QueuedConnection);
+                    scheduleRealtimeUpdate();
                     return;
                 }
             }
@@ -75,16 +82,40 @@ void RealtimeEquipmentModel::setRealtimeModel(QObject *model)
     }
 }
 
+int RealtimeEquipmentModel::updateInterval() const
+{
+    return m_updateTimer.interval();
+}
+
+void RealtimeEquipmentModel::setUpdateInterval(int interval)
+{
+    if (m_updateTimer.interval() == interval) {
+        return;
+    }
+    m_updateTimer.setInterval(interval);
+    Q_EMIT updateIntervalChanged();
+}
+
+void RealtimeEquipmentModel::scheduleRealtimeUpdate()
+{
+    // apply the first change right away, and merge all following ones within the update interval
+    if (m_updateTimer.isActive()) {
+        m_updatePending = true;
+        return;
+    }
+    updateRealtimeState();
+    m_updateTimer.start();
+}
+
 static bool isSameEquipmentType(Equipment::Type lhs, KPublicTransport::Equipment::Type rhs)
 {
     return (lhs == Equipment::Elevator && rhs == KPublicTransport::Equipment::Elevator)
         || (lhs == Equipment::Escalator && rhs == KPublicTransport::Equipment::Escalator);
 }
 
-void RealtimeEquipmentModel::updateEquipment(Equipment &eq, const KPublicTransport::Equipment &rtEq) const
+static QByteArray realtimeStatus(const KPublicTransport::Equipment &rtEq)
 {
-    createSyntheticElement(eq);
-    eq.syntheticElement.setTagValue(m_tagKeys.realtimeStatus, rtEq.disruptionEffect() == KPublicTransport::Disruption::NoService ? "0" : "1");
+    return rtEq.disruptionEffect() == KPublicTransport::Disruption::NoService ? "0" : "1";
 }
 
 static int matchCount(const std::vector<std::vector<int>> &matches, int idx)
@@ -110,19 +141,10 @@ static int findOtherMatch(const std::vector<std::vector<int>> &matches, int valu
 
 void RealtimeEquipmentModel::updateRealtimeState()
 {
-    m_pendingRealtimeUpdate = false;
     if (!m_realtimeModel) {
         return;
     }
 
-    // clear previous data
-    for (auto &eq : m_equipment) {
-        if (!eq.syntheticElement) {
-            continue;
-        }
-        eq.syntheticElement.removeTag(m_tagKeys.realtimeStatus);
-    }
-
     // find candidates by distance
     std::vector<std::vector<int>> matches;
     matches.resize(m_equipment.size());
@@ -145,24 +167,25 @@ void RealtimeEquipmentModel::updateRealtimeState()
         }
     }
 
-    // apply realtime status
+    // determine realtime status
     // we accept 3 different cases:
     // - a single 1:1 match
     // - a 1/2 or a 2/2 match for horizontally adjacent elements if there is a distance difference
+    std::vector<QByteArray> states(m_equipment.size());
     for (std::size_t i = 0; i < m_equipment.size(); ++i) {
         if (matches[i].size() == 1) {
             const auto mcount = matchCount(matches, matches[i][0]);
             if (mcount == 1) {
                 const auto idx =  m_realtimeModel->index(matches[i][0], 0);
                 const auto rtEq = idx.data(KPublicTransport::LocationQueryModel::LocationRole).value<KPublicTransport::Location>().equipment();
-                updateEquipment(m_equipment[i], rtEq);
+                states[i] = realtimeStatus(rtEq);
             }
             else if (mcount == 2) {
                 const auto other = findOtherMatch(matches, matches[i][0], i);
                 if (matches[other].size() == 2) {
                     const auto otherRow = matches[other][0] == matches[i][0] ? matches[other][1] : matches[other][0];
                     if (matchCount(matches, otherRow) == 1) {
-                        resolveEquipmentPair(i, other, matches[other][0], matches[other][1]);
+                        resolveEquipmentPair(i, other, matches[other][0], matches[other][1], states);
                     }
                 }
             }
@@ -172,15 +195,35 @@ void RealtimeEquipmentModel::updateRealtimeState()
             if (matchCount(matches, matches[i][0]) == 2 && matchCount(matches, matches[i][1]) == 2) {
                 const auto it = std::find(std::next(matches.begin() + i), matches.end(), matches[i]);
                 if (it != matches.end()) {
-                    resolveEquipmentPair(i, std::distance(matches.begin(), it), matches[i][0], matches[i][1]);
+                    resolveEquipmentPair(i, std::distance(matches.begin(), it), matches[i][0], matches[i][1], states);
                 }
             }
         }
     }
 
-    Q_EMIT update();
+    // apply changed states only
+    bool changed = false;
+    for (std::size_t i = 0; i < m_equipment.size(); ++i) {
+        auto &eq = m_equipment[i];
+        const auto currentState = eq.syntheticElement ? eq.syntheticElement.element().tagValue(m_tagKeys.realtimeStatus) : QByteArray();
+        if (currentState == states[i]) {
+            continue;
+        }
+        changed = true;
+        if (states[i].isEmpty()) {
+            eq.syntheticElement.removeTag(m_tagKeys.realtimeStatus);
+        } else {
+            createSyntheticElement(eq);
+            eq.syntheticElement.setTagValue(m_tagKeys.realtimeStatus, std::move(states[i]));
+        }
+    }
+
+    if (changed) {
+        Q_EMIT update();
+    }
 }
-void RealtimeEquipmentModel::resolveEquipmentPair(int eqRow1, int eqRow2, int rtRow1, int rtRow2)
+
+void RealtimeEquipmentModel::resolveEquipmentPair(int eqRow1, int eqRow2, int rtRow1, int rtRow2, std::vector<QByteArray> &states) const
 {
     // check if the equipment pair is horizontally adjacent
     if (m_equipment[eqRow1].levels != m_equipment[eqRow2].levels) {
@@ -207,13 +250,13 @@ void RealtimeEquipmentModel::resolveEquipmentPair(int eqRow1, int eqRow2, int rt
 
     if (swap1) {
         if (d12 < EquipmentMatchDistance && d21 < EquipmentMatchDistance) {
-            updateEquipment(m_equipment[eqRow1], rtEq2.equipment());
-            updateEquipment(m_equipment[eqRow2], rtEq1.equipment());
+            states[eqRow1] = realtimeStatus(rtEq2.equipment());
+            states[eqRow2] = realtimeStatus(rtEq1.equipment());
         }
     } else {
         if (d11 < EquipmentMatchDistance && d22 < EquipmentMatchDistance) {
-            updateEquipment(m_equipment[eqRow1], rtEq1.equipment());
-            updateEquipment(m_equipment[eqRow2], rtEq2.equipment());
+            states[eqRow1] = realtimeStatus(rtEq1.equipment());
+            states[eqRow2] = realtimeStatus(rtEq2.equipment());
         }
     }
 }
@@ -9,6 +9,8 @@
 
 #include <KOSMIndoorMap/EquipmentModel>
 
+#include <QTimer>
+
 #include <qqmlregistration.h>
 
 namespace KPublicTransport {
@@ -19,11 +21,17 @@ class QAbstractItemModel;
 
 namespace KOSMIndoorMap {
 
-/** Elevator/escalator overlay source augmented with realtime status data where available. */
+/** Elevator/escalator overlay source augmented with realtime status data where available.
+ *  The first realtime model change is applied immediately, changes following within a short
+ *  time window after that are merged. The overlay is only updated if that actually changed
+ *  the state of any equipment.
+ */
 class RealtimeEquipmentModel : public EquipmentModel
 {
     Q_OBJECT
     Q_PROPERTY(QObject* realtimeModel READ realtimeModel WRITE setRealtimeModel NOTIFY realtimeModelChanged)
+    /** Time window in milliseconds after an update in which further realtime model changes are merged into a single update. */
+    Q_PROPERTY(int updateInterval READ updateInterval WRITE setUpdateInterval NOTIFY updateIntervalChanged)
     QML_ELEMENT
 
 public:
@@ -33,16 +41,21 @@ public:
     QObject *realtimeModel() const;
     void setRealtimeModel(QObject *model);
 
+    int updateInterval() const;
+    void setUpdateInterval(int interval);
+
 Q_SIGNALS:
     void realtimeModelChanged();
+    void updateIntervalChanged();
 
 private:
+    void scheduleRealtimeUpdate();
     void updateRealtimeState();
-    void updateEquipment(Equipment &eq, const KPublicTransport::Equipment &rtEq) const;
-    void resolveEquipmentPair(int eqRow1, int eqRow2, int rtRow1, int rtRow2);
+    void resolveEquipmentPair(int eqRow1, int eqRow2, int rtRow1, int rtRow2, std::vector<QByteArray> &states) const;
 
     QPointer<QAbstractItemModel> m_realtimeModel;
-    bool m_pendingRealtimeUpdate = false;
+    QTimer m_updateTimer;
+    bool m_updatePending = false;
 };
 
 }
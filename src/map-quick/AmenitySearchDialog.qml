@@ -20,7 +20,6 @@ Kirigami.SearchDialog {
     model: AmenitySortFilterProxyModel {
         id: amenitySortModel
         sourceModel: root.visible ? root.amenityModel : null
-        filterCaseSensitivity: Qt.CaseInsensitive
     }
 
     /** Emitted when an entry of this dialog as been selected. */
@@ -25,7 +25,6 @@ Kirigami.SearchDialog {
     model: RoomSortFilterProxyModel {
         id: roomSortModel
         sourceModel: root.visible ? root.roomModel : null
-        filterCaseSensitivity: Qt.CaseInsensitive
     }
 
     delegate: QQC2.ItemDelegate {
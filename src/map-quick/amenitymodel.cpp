@@ -8,6 +8,7 @@
 #include "logging.h"
 #include "osmelement.h"
 
+#include <content/modeldiff_p.h>
 #include <style/mapcssdeclaration_p.h>
 #include <style/mapcssstate_p.h>
 
@@ -24,6 +25,7 @@
 #include <QTimeZone>
 
 #include <limits>
+#include <utility>
 
 using namespace KOSMIndoorMap;
 
@@ -55,13 +57,25 @@ void AmenityModel::setMapData(const MapData &data)
         }
     }
 
-    beginResetModel();
-    m_entries.clear();
-    m_data = data;
+    // the current rows reference the previous data until they are replaced
+    const auto prevData = std::exchange(m_data, data);
     if (!m_data.isEmpty()) {
         m_style.compile(m_data.dataSet());
     }
-    endResetModel();
+
+    if (m_entries.empty()) {
+        // not populated yet, that happens lazily on demand
+        beginResetModel();
+        endResetModel();
+    } else {
+        ModelDiff::apply(this, m_entries, m_data.isEmpty() ? std::vector<Entry>() : findEntries(), [](const Entry &entry) {
+            return std::hash<OSM::Element>{}(entry.element);
+        }, [](const Entry &lhs, const Entry &rhs) {
+            return lhs.element.type() == rhs.element.type() && lhs.element.id() == rhs.element.id();
+        }, [](const Entry &lhs, const Entry &rhs) {
+            return lhs.element == rhs.element && lhs.level == rhs.level && lhs.group == rhs.group && lhs.typeKey == rhs.typeKey && lhs.icon == rhs.icon;
+        });
+    }
     Q_EMIT mapDataChanged();
 }
 
@@ -74,7 +88,7 @@ int AmenityModel::rowCount(const QModelIndex &parent) const
     if (m_entries.empty() && !m_data.isEmpty()) {
         // we assume that this is expensive but almost never will result in an empty result
         // and if it does nevertheless, it's a sparsely populated tile where this is cheap
-        const_cast<AmenityModel*>(this)->populateModel();
+        const_cast<AmenityModel*>(this)->m_entries = findEntries();
     }
 
     return (int)m_entries.size();
@@ -210,8 +224,9 @@ struct {
     { "toilets", AmenityModel::ToiletGroup },
 };
 
-void AmenityModel::populateModel()
+std::vector<AmenityModel::Entry> AmenityModel::findEntries() const
 {
+    std::vector<Entry> entries;
     const auto layerKey = m_data.dataSet().tagKey("layer");
 
     MapCSSResult filterResult;
@@ -272,28 +287,29 @@ void AmenityModel::populateModel()
             }
 
             entry.level = (*it).first.numericLevel(); // TODO we only need one entry, not one per level!
-            m_entries.push_back(std::move(entry));
+            entries.push_back(std::move(entry));
         }
     }
 
     // de-duplicate multi-level entries
     // we could also just iterate over the non-level-split data, but
     // then we need to reparse the level data here...
-    std::sort(m_entries.begin(), m_entries.end(), [](const auto &lhs, const auto &rhs) {
+    std::sort(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
         if (lhs.element == rhs.element) {
             return std::abs(lhs.level) < std::abs(rhs.level);
         }
         return lhs.element < rhs.element;
     });
-    m_entries.erase(std::unique(m_entries.begin(), m_entries.end(), [](const auto &lhs, const auto &rhs) {
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
         return lhs.element == rhs.element;
-    }), m_entries.end());
+    }), entries.end());
 
     // sort by group
-    std::sort(m_entries.begin(), m_entries.end(), [](const auto &lhs, const auto &rhs) {
+    std::sort(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
         return lhs.group < rhs.group;
     });
-    qCDebug(Log) << m_entries.size() << "amenities found";
+    qCDebug(Log) << entries.size() << "amenities found";
+    return entries;
 }
 
 #include "moc_amenitymodel.cpp"
@@ -65,6 +65,8 @@ Q_SIGNALS:
     void mapDataChanged();
 
 private:
+    friend class ModelDiff;
+
     struct Entry {
         OSM::Element element;
         int level;
@@ -73,7 +75,7 @@ private:
         QString icon;
     };
 
-    void populateModel();
+    [[nodiscard]] std::vector<Entry> findEntries() const;
     static QString iconSource(const Entry &entry);
 
     MapData m_data;
@@ -9,16 +9,11 @@
 using namespace KOSMIndoorMap;
 
 AmenitySortFilterProxyModel::AmenitySortFilterProxyModel(QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : DistanceSortFilterProxyModel(AmenityModel::CoordinateRole, AmenityModel::LevelRole, parent)
     , m_collator(QLocale())
 {
-    setDynamicSortFilter(true);
-
     m_collator.setCaseSensitivity(Qt::CaseInsensitive);
     m_collator.setIgnorePunctuation(true);
-
-    connect(this, &QAbstractProxyModel::sourceModelChanged, this, [this]() { sort(0); });
-    connect(this, &AmenitySortFilterProxyModel::filterStringChanged, this, &QSortFilterProxyModel::invalidate);
 }
 
 AmenitySortFilterProxyModel::~AmenitySortFilterProxyModel() = default;
@@ -26,10 +21,6 @@ AmenitySortFilterProxyModel::~AmenitySortFilterProxyModel() = default;
 
 bool AmenitySortFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
-    if (m_filter.isEmpty()) {
-        return true;
-    }
-
     const auto idx = sourceModel()->index(source_row, 0, source_parent);
     return filterMatches(idx.data(AmenityModel::NameRole).toString())
         || filterMatches(idx.data(AmenityModel::TypeNameRole).toString())
@@ -58,7 +49,7 @@ bool AmenitySortFilterProxyModel::lessThan(const QModelIndex &source_left, const
 
 bool AmenitySortFilterProxyModel::filterMatches(const QString &s) const
 {
-    return s.contains(m_filter, Qt::CaseInsensitive); // TODO ignore diacritics
+    return s.contains(filterString(), Qt::CaseInsensitive); // TODO ignore diacritics
 }
 
 #include "moc_amenitysortfilterproxymodel.cpp"
@@ -0,0 +1,559 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "distancesortfilterproxymodel_p.h"
+
+#include <algorithm>
+
+using namespace KOSMIndoorMap;
+
+DistanceSortFilterProxyModel::DistanceSortFilterProxyModel(int coordinateRole, int levelRole, QObject *parent)
+    : QAbstractProxyModel(parent)
+    , m_cache(coordinateRole, levelRole)
+{
+}
+
+DistanceSortFilterProxyModel::~DistanceSortFilterProxyModel() = default;
+
+QString DistanceSortFilterProxyModel::filterString() const
+{
+    return m_filter;
+}
+
+void DistanceSortFilterProxyModel::setFilterString(const QString &filter)
+{
+    if (m_filter == filter) {
+        return;
+    }
+
+    m_filter = filter;
+    updateFilter();
+    Q_EMIT filterStringChanged();
+}
+
+QPointF DistanceSortFilterProxyModel::position() const
+{
+    return m_cache.position();
+}
+
+void DistanceSortFilterProxyModel::setPosition(const QPointF &position)
+{
+    if (m_cache.hasPosition() && m_cache.position() == position) {
+        return;
+    }
+
+    const auto sortModeChanged = !m_cache.hasPosition();
+    m_cache.setPosition(position);
+    if (sortModeChanged) {
+        sortAll();
+    } else {
+        updateOrder();
+    }
+    notifyDistanceChanges();
+    Q_EMIT positionChanged();
+}
+
+void DistanceSortFilterProxyModel::resetPosition()
+{
+    if (!m_cache.hasPosition()) {
+        return;
+    }
+
+    m_cache.resetPosition();
+    m_cache.resetDistanceChanges();
+    sortAll();
+    if (!m_sourceRows.empty()) {
+        Q_EMIT dataChanged(index(0, 0), index(rowCount() - 1, 0), {DistanceRole});
+    }
+    Q_EMIT positionChanged();
+}
+
+int DistanceSortFilterProxyModel::floorLevel() const
+{
+    return m_cache.floorLevel();
+}
+
+void DistanceSortFilterProxyModel::setFloorLevel(int level)
+{
+    if (m_cache.floorLevel() == level) {
+        return;
+    }
+
+    m_cache.setFloorLevel(level);
+    if (m_cache.hasPosition()) {
+        updateOrder();
+        notifyDistanceChanges();
+    }
+    Q_EMIT floorLevelChanged();
+}
+
+void DistanceSortFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (sourceModel == this->sourceModel()) {
+        return;
+    }
+
+    beginResetModel();
+    for (const auto &c : m_connections) {
+        disconnect(c);
+    }
+    m_connections.clear();
+
+    QAbstractProxyModel::setSourceModel(sourceModel);
+    m_cache.setSourceModel(sourceModel);
+    if (sourceModel) {
+        m_connections.push_back(connect(sourceModel, &QAbstractItemModel::modelAboutToBeReset, this, [this]() { beginResetModel(); }));
+        m_connections.push_back(connect(sourceModel, &QAbstractItemModel::modelReset, this, [this]() {
+            m_cache.clear();
+            rebuild();
+            endResetModel();
+        }));
+        m_connections.push_back(connect(sourceModel, &QAbstractItemModel::dataChanged, this, &DistanceSortFilterProxyModel::sourceDataChanged));
+        m_connections.push_back(connect(sourceModel, &QAbstractItemModel::rowsAboutToBeRemoved, this, &DistanceSortFilterProxyModel::sourceRowsAboutToBeRemoved));
+        m_connections.push_back(connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &DistanceSortFilterProxyModel::sourceRowsRemoved));
+        m_connections.push_back(connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &DistanceSortFilterProxyModel::sourceRowsInserted));
+        m_connections.push_back(connect(sourceModel, &QAbstractItemModel::rowsMoved, this, &DistanceSortFilterProxyModel::sourceRowsMoved));
+        m_connections.push_back(connect(sourceModel, &QAbstractItemModel::layoutAboutToBeChanged, this, &DistanceSortFilterProxyModel::sourceLayoutAboutToBeChanged));
+        m_connections.push_back(connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &DistanceSortFilterProxyModel::sourceLayoutChanged));
+        m_connections.push_back(connect(sourceModel, &QObject::destroyed, this, [this]() {
+            beginResetModel();
+            m_cache.setSourceModel(nullptr);
+            m_sourceRows.clear();
+            m_proxyRows.clear();
+            endResetModel();
+        }));
+    }
+    rebuild();
+    endResetModel();
+}
+
+QModelIndex DistanceSortFilterProxyModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+    if (!proxyIndex.isValid() || !sourceModel()) {
+        return {};
+    }
+    return sourceModel()->index(m_sourceRows[proxyIndex.row()], proxyIndex.column());
+}
+
+QModelIndex DistanceSortFilterProxyModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+    if (!sourceIndex.isValid() || sourceIndex.row() >= (int)m_proxyRows.size()) {
+        return {};
+    }
+    const auto row = m_proxyRows[sourceIndex.row()];
+    return row < 0 ? QModelIndex() : index(row, sourceIndex.column());
+}
+
+QModelIndex DistanceSortFilterProxyModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (parent.isValid() || row < 0 || row >= rowCount() || column < 0 || column >= columnCount()) {
+        return {};
+    }
+    return createIndex(row, column);
+}
+
+QModelIndex DistanceSortFilterProxyModel::parent([[maybe_unused]] const QModelIndex &child) const
+{
+    return {};
+}
+
+int DistanceSortFilterProxyModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : (int)m_sourceRows.size();
+}
+
+int DistanceSortFilterProxyModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() || !sourceModel() ? 0 : sourceModel()->columnCount();
+}
+
+bool DistanceSortFilterProxyModel::hasChildren(const QModelIndex &parent) const
+{
+    return rowCount(parent) > 0;
+}
+
+QVariant DistanceSortFilterProxyModel::data(const QModelIndex &index, int role) const
+{
+    if (role == DistanceRole) {
+        if (!m_cache.hasPosition() || !checkIndex(index, CheckIndexOption::IndexIsValid)) {
+            return {};
+        }
+        return m_cache.distance(m_sourceRows[index.row()]);
+    }
+    return QAbstractProxyModel::data(index, role);
+}
+
+QHash<int, QByteArray> DistanceSortFilterProxyModel::roleNames() const
+{
+    auto r = QAbstractProxyModel::roleNames();
+    r.insert(DistanceRole, "distance");
+    return r;
+}
+
+bool DistanceSortFilterProxyModel::acceptsRow(int sourceRow) const
+{
+    if (m_filter.isEmpty()) {
+        return true;
+    }
+    return m_cache.filterAcceptsRow(sourceRow, [&]() { return filterAcceptsRow(sourceRow, {}); });
+}
+
+bool DistanceSortFilterProxyModel::rowLessThan(int lhsSourceRow, int rhsSourceRow) const
+{
+    // ties are broken by source row, for a strict total order that incremental updates can rely on
+    if (m_cache.hasPosition()) {
+        const auto lhsDist = m_cache.distance(lhsSourceRow);
+        const auto rhsDist = m_cache.distance(rhsSourceRow);
+        return lhsDist == rhsDist ? lhsSourceRow < rhsSourceRow : lhsDist < rhsDist;
+    }
+
+    const auto lhs = sourceModel()->index(lhsSourceRow, 0);
+    const auto rhs = sourceModel()->index(rhsSourceRow, 0);
+    if (lessThan(lhs, rhs)) {
+        return true;
+    }
+    return !lessThan(rhs, lhs) && lhsSourceRow < rhsSourceRow;
+}
+
+int DistanceSortFilterProxyModel::insertPosition(int sourceRow) const
+{
+    return (int)std::distance(m_sourceRows.begin(), std::upper_bound(m_sourceRows.begin(), m_sourceRows.end(), sourceRow, [this](int lhs, int rhs) {
+        return rowLessThan(lhs, rhs);
+    }));
+}
+
+void DistanceSortFilterProxyModel::updateProxyRows(int begin, int end)
+{
+    for (auto i = begin; i < end; ++i) {
+        m_proxyRows[m_sourceRows[i]] = i;
+    }
+}
+
+void DistanceSortFilterProxyModel::rebuild()
+{
+    m_sourceRows.clear();
+    m_proxyRows.clear();
+    if (!sourceModel()) {
+        return;
+    }
+
+    m_proxyRows.resize(sourceModel()->rowCount(), -1);
+    for (int i = 0; i < (int)m_proxyRows.size(); ++i) {
+        if (acceptsRow(i)) {
+            m_sourceRows.push_back(i);
+        }
+    }
+    std::sort(m_sourceRows.begin(), m_sourceRows.end(), [this](int lhs, int rhs) { return rowLessThan(lhs, rhs); });
+    updateProxyRows(0, (int)m_sourceRows.size());
+}
+
+void DistanceSortFilterProxyModel::sortAll()
+{
+    // the entire order changes when switching between ordering by name and by distance
+    // so this is done as a vertical sort layout change, so views keep their delegates
+    Q_EMIT layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
+    const auto persistentIndexes = persistentIndexList();
+    std::vector<int> persistentSourceRows;
+    persistentSourceRows.reserve(persistentIndexes.size());
+    for (const auto &idx : persistentIndexes) {
+        persistentSourceRows.push_back(m_sourceRows[idx.row()]);
+    }
+
+    std::sort(m_sourceRows.begin(), m_sourceRows.end(), [this](int lhs, int rhs) { return rowLessThan(lhs, rhs); });
+    updateProxyRows(0, (int)m_sourceRows.size());
+
+    QModelIndexList newIndexes;
+    newIndexes.reserve(persistentIndexes.size());
+    for (qsizetype i = 0; i < persistentIndexes.size(); ++i) {
+        newIndexes.push_back(index(m_proxyRows[persistentSourceRows[i]], persistentIndexes[i].column()));
+    }
+    changePersistentIndexList(persistentIndexes, newIndexes);
+    Q_EMIT layoutChanged({}, QAbstractItemModel::VerticalSortHint);
+}
+
+void DistanceSortFilterProxyModel::updateOrder()
+{
+    const auto cmp = [this](int lhs, int rhs) { return rowLessThan(lhs, rhs); };
+    if (std::is_sorted(m_sourceRows.begin(), m_sourceRows.end(), cmp)) {
+        return;
+    }
+
+    auto sorted = m_sourceRows;
+    std::sort(sorted.begin(), sorted.end(), cmp);
+    std::vector<int> rank(m_proxyRows.size(), -1);
+    for (int i = 0; i < (int)sorted.size(); ++i) {
+        rank[sorted[i]] = i;
+    }
+
+    // rows in the longest already ordered subsequence remain in place, only the others need to be moved
+    // tails[l] is the proxy row ending the best ordered subsequence of length l + 1 found so far
+    std::vector<int> tails;
+    std::vector<int> predecessors(m_sourceRows.size(), -1);
+    for (int i = 0; i < (int)m_sourceRows.size(); ++i) {
+        const auto it = std::lower_bound(tails.begin(), tails.end(), rank[m_sourceRows[i]], [&](int row, int r) {
+            return rank[m_sourceRows[row]] < r;
+        });
+        if (it != tails.begin()) {
+            predecessors[i] = *std::prev(it);
+        }
+        if (it == tails.end()) {
+            tails.push_back(i);
+        } else {
+            *it = i;
+        }
+    }
+    std::vector<bool> inPlace(m_proxyRows.size(), false);
+    for (auto i = tails.empty() ? -1 : tails.back(); i >= 0; i = predecessors[i]) {
+        inPlace[m_sourceRows[i]] = true;
+    }
+
+    // move each displaced row right behind its predecessor in the target order
+    // as that one is either in place already or has been moved there before, this ends up fully ordered
+    for (int i = 0; i < (int)sorted.size(); ++i) {
+        const auto sourceRow = sorted[i];
+        if (inPlace[sourceRow]) {
+            continue;
+        }
+        const auto from = m_proxyRows[sourceRow];
+        const auto to = i == 0 ? 0 : m_proxyRows[sorted[i - 1]] + 1;
+        if (from == to) {
+            continue;
+        }
+
+        beginMoveRows({}, from, from, {}, to);
+        if (to < from) {
+            std::rotate(m_sourceRows.begin() + to, m_sourceRows.begin() + from, m_sourceRows.begin() + from + 1);
+            updateProxyRows(to, from + 1);
+        } else {
+            std::rotate(m_sourceRows.begin() + from, m_sourceRows.begin() + from + 1, m_sourceRows.begin() + to);
+            updateProxyRows(from, to);
+        }
+        endMoveRows();
+    }
+}
+
+void DistanceSortFilterProxyModel::updateFilter()
+{
+    m_cache.clearFilter();
+
+    std::vector<int> removedRows;
+    for (int i = 0; i < (int)m_sourceRows.size(); ++i) {
+        if (!acceptsRow(m_sourceRows[i])) {
+            removedRows.push_back(i);
+        }
+    }
+    removeProxyRows(std::move(removedRows));
+
+    std::vector<int> addedRows;
+    for (int i = 0; i < (int)m_proxyRows.size(); ++i) {
+        if (m_proxyRows[i] < 0 && acceptsRow(i)) {
+            addedRows.push_back(i);
+        }
+    }
+    insertSourceRows(std::move(addedRows));
+}
+
+void DistanceSortFilterProxyModel::insertSourceRows(std::vector<int> &&sourceRows)
+{
+    std::sort(sourceRows.begin(), sourceRows.end(), [this](int lhs, int rhs) { return rowLessThan(lhs, rhs); });
+
+    // insert consecutive runs of new rows ending up at the same position in one go
+    for (auto it = sourceRows.begin(); it != sourceRows.end();) {
+        const auto row = insertPosition(*it);
+        const auto runEnd = row == (int)m_sourceRows.size() ? sourceRows.end() : std::find_if(std::next(it), sourceRows.end(), [&](int sourceRow) {
+            return !rowLessThan(sourceRow, m_sourceRows[row]);
+        });
+
+        beginInsertRows({}, row, row + (int)std::distance(it, runEnd) - 1);
+        m_sourceRows.insert(m_sourceRows.begin() + row, it, runEnd);
+        updateProxyRows(row, (int)m_sourceRows.size());
+        endInsertRows();
+        it = runEnd;
+    }
+}
+
+void DistanceSortFilterProxyModel::removeProxyRows(std::vector<int> &&proxyRows)
+{
+    std::sort(proxyRows.begin(), proxyRows.end());
+
+    // remove consecutive runs in one go, back to front so the remaining rows don't shift
+    while (!proxyRows.empty()) {
+        const auto last = proxyRows.back();
+        auto first = last;
+        proxyRows.pop_back();
+        while (!proxyRows.empty() && proxyRows.back() == first - 1) {
+            first = proxyRows.back();
+            proxyRows.pop_back();
+        }
+
+        beginRemoveRows({}, first, last);
+        for (auto i = first; i <= last; ++i) {
+            m_proxyRows[m_sourceRows[i]] = -1;
+        }
+        m_sourceRows.erase(m_sourceRows.begin() + first, m_sourceRows.begin() + last + 1);
+        updateProxyRows(first, (int)m_sourceRows.size());
+        endRemoveRows();
+    }
+}
+
+void DistanceSortFilterProxyModel::notifyDistanceChanges()
+{
+    if (!m_cache.hasPosition()) {
+        return;
+    }
+
+    std::vector<int> changedRows;
+    for (int i = 0; i < (int)m_sourceRows.size(); ++i) {
+        if (m_cache.takeDistanceChange(m_sourceRows[i])) {
+            changedRows.push_back(i);
+        }
+    }
+    emitDataChanged(std::move(changedRows), {DistanceRole});
+}
+
+void DistanceSortFilterProxyModel::emitDataChanged(std::vector<int> &&proxyRows, const QList<int> &roles)
+{
+    std::sort(proxyRows.begin(), proxyRows.end());
+    for (auto it = proxyRows.begin(); it != proxyRows.end();) {
+        auto runEnd = std::next(it);
+        while (runEnd != proxyRows.end() && *runEnd == *std::prev(runEnd) + 1) {
+            ++runEnd;
+        }
+        Q_EMIT dataChanged(index(*it, 0), index(*std::prev(runEnd), columnCount() - 1), roles);
+        it = runEnd;
+    }
+}
+
+void DistanceSortFilterProxyModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    if (topLeft.parent().isValid()) {
+        return;
+    }
+
+    m_cache.clear();
+    std::vector<int> removedRows;
+    std::vector<int> addedRows;
+    std::vector<int> changedRows;
+    for (auto sourceRow = topLeft.row(); sourceRow <= bottomRight.row(); ++sourceRow) {
+        const auto accepted = acceptsRow(sourceRow);
+        const auto row = m_proxyRows[sourceRow];
+        if (row >= 0 && !accepted) {
+            removedRows.push_back(row);
+        } else if (row < 0 && accepted) {
+            addedRows.push_back(sourceRow);
+        } else if (row >= 0) {
+            changedRows.push_back(sourceRow);
+        }
+    }
+
+    removeProxyRows(std::move(removedRows));
+    insertSourceRows(std::move(addedRows));
+    updateOrder();
+    for (auto &row : changedRows) {
+        row = m_proxyRows[row];
+    }
+    emitDataChanged(std::move(changedRows), roles);
+}
+
+void DistanceSortFilterProxyModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    std::vector<int> removedRows;
+    for (auto sourceRow = first; sourceRow <= last; ++sourceRow) {
+        if (m_proxyRows[sourceRow] >= 0) {
+            removedRows.push_back(m_proxyRows[sourceRow]);
+        }
+    }
+    removeProxyRows(std::move(removedRows));
+}
+
+void DistanceSortFilterProxyModel::sourceRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    const auto count = last - first + 1;
+    for (auto &sourceRow : m_sourceRows) {
+        if (sourceRow > last) {
+            sourceRow -= count;
+        }
+    }
+    m_proxyRows.erase(m_proxyRows.begin() + first, m_proxyRows.begin() + last + 1);
+    m_cache.clear();
+}
+
+void DistanceSortFilterProxyModel::sourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    const auto count = last - first + 1;
+    for (auto &sourceRow : m_sourceRows) {
+        if (sourceRow >= first) {
+            sourceRow += count;
+        }
+    }
+    m_proxyRows.insert(m_proxyRows.begin() + first, count, -1);
+    m_cache.clear();
+
+    std::vector<int> addedRows;
+    for (auto sourceRow = first; sourceRow <= last; ++sourceRow) {
+        if (acceptsRow(sourceRow)) {
+            addedRows.push_back(sourceRow);
+        }
+    }
+    insertSourceRows(std::move(addedRows));
+}
+
+void DistanceSortFilterProxyModel::sourceRowsMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd, const QModelIndex &destinationParent, int destinationRow)
+{
+    if (sourceParent.isValid() || destinationParent.isValid()) {
+        return;
+    }
+
+    // our order doesn't depend on the source order (other than for ties), so only the source row numbers change
+    const auto count = sourceEnd - sourceStart + 1;
+    for (auto &sourceRow : m_sourceRows) {
+        if (sourceRow >= sourceStart && sourceRow <= sourceEnd) {
+            sourceRow += destinationRow > sourceEnd ? destinationRow - count - sourceStart : destinationRow - sourceStart;
+        } else if (destinationRow > sourceEnd && sourceRow > sourceEnd && sourceRow < destinationRow) {
+            sourceRow -= count;
+        } else if (destinationRow < sourceStart && sourceRow >= destinationRow && sourceRow < sourceStart) {
+            sourceRow += count;
+        }
+    }
+    std::fill(m_proxyRows.begin(), m_proxyRows.end(), -1);
+    updateProxyRows(0, (int)m_sourceRows.size());
+    m_cache.clear();
+    updateOrder();
+}
+
+void DistanceSortFilterProxyModel::sourceLayoutAboutToBeChanged()
+{
+    m_layoutChangeIndexes.clear();
+    m_layoutChangeIndexes.reserve(m_sourceRows.size());
+    for (const auto sourceRow : m_sourceRows) {
+        m_layoutChangeIndexes.emplace_back(sourceModel()->index(sourceRow, 0));
+    }
+}
+
+void DistanceSortFilterProxyModel::sourceLayoutChanged()
+{
+    for (std::size_t i = 0; i < m_layoutChangeIndexes.size(); ++i) {
+        m_sourceRows[i] = m_layoutChangeIndexes[i].row();
+    }
+    m_layoutChangeIndexes.clear();
+    std::fill(m_proxyRows.begin(), m_proxyRows.end(), -1);
+    updateProxyRows(0, (int)m_sourceRows.size());
+    m_cache.clear();
+    updateOrder();
+}
+
+#include "moc_distancesortfilterproxymodel_p.cpp"
@@ -0,0 +1,110 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORMAP_DISTANCESORTFILTERPROXYMODEL_P_H
+#define KOSMINDOORMAP_DISTANCESORTFILTERPROXYMODEL_P_H
+
+#include "sortfiltercache_p.h"
+
+#include <QAbstractProxyModel>
+#include <QPersistentModelIndex>
+
+#include <vector>
+
+namespace KOSMIndoorMap {
+
+/** Common base for the amenity and room sort/filter proxy models.
+ *  This is a sort/filter proxy for flat list models, that can alternatively order by distance
+ *  from a given position. Unlike QSortFilterProxyModel this maintains the row mapping itself,
+ *  so that position updates only move the rows whose order actually changed (via beginMoveRows()),
+ *  rather than emitting a layout change for the entire model.
+ */
+class DistanceSortFilterProxyModel : public QAbstractProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(QString filterString READ filterString WRITE setFilterString NOTIFY filterStringChanged)
+    /** Reference position (longitude/latitude) for ordering by distance.
+     *  While this is set, entries are ordered by distance from this position instead of by name.
+     */
+    Q_PROPERTY(QPointF position READ position WRITE setPosition RESET resetPosition NOTIFY positionChanged)
+    /** Floor level at the reference position, in the same representation as the LevelRole of the source model. */
+    Q_PROPERTY(int floorLevel READ floorLevel WRITE setFloorLevel NOTIFY floorLevelChanged)
+
+public:
+    ~DistanceSortFilterProxyModel();
+
+    enum Role {
+        DistanceRole = Qt::UserRole + 256, ///< distance in meters from the reference position, if set
+    };
+    Q_ENUM(Role)
+
+    [[nodiscard]] QString filterString() const;
+    void setFilterString(const QString &filter);
+    [[nodiscard]] QPointF position() const;
+    void setPosition(const QPointF &position);
+    void resetPosition();
+    [[nodiscard]] int floorLevel() const;
+    void setFloorLevel(int level);
+
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+    [[nodiscard]] QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+    [[nodiscard]] QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+    [[nodiscard]] QModelIndex index(int row, int column, const QModelIndex &parent = {}) const override;
+    [[nodiscard]] QModelIndex parent(const QModelIndex &child) const override;
+    [[nodiscard]] int rowCount(const QModelIndex &parent = {}) const override;
+    [[nodiscard]] int columnCount(const QModelIndex &parent = {}) const override;
+    [[nodiscard]] bool hasChildren(const QModelIndex &parent = {}) const override;
+    [[nodiscard]] QVariant data(const QModelIndex &index, int role) const override;
+    [[nodiscard]] QHash<int, QByteArray> roleNames() const override;
+
+Q_SIGNALS:
+    void filterStringChanged();
+    void positionChanged();
+    void floorLevelChanged();
+
+protected:
+    explicit DistanceSortFilterProxyModel(int coordinateRole, int levelRole, QObject *parent = nullptr);
+
+    /** Returns @c true if @p source_row should be included, with a non-empty filter string. */
+    [[nodiscard]] virtual bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const = 0;
+    /** Ordering when no reference position is set. */
+    [[nodiscard]] virtual bool lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const = 0;
+
+private:
+    [[nodiscard]] bool acceptsRow(int sourceRow) const;
+    [[nodiscard]] bool rowLessThan(int lhsSourceRow, int rhsSourceRow) const;
+    [[nodiscard]] int insertPosition(int sourceRow) const;
+    void updateProxyRows(int begin, int end);
+
+    void rebuild();
+    void sortAll();
+    void updateOrder();
+    void updateFilter();
+    void insertSourceRows(std::vector<int> &&sourceRows);
+    void removeProxyRows(std::vector<int> &&proxyRows);
+    void notifyDistanceChanges();
+    void emitDataChanged(std::vector<int> &&proxyRows, const QList<int> &roles);
+
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+    void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsRemoved(const QModelIndex &parent, int first, int last);
+    void sourceRowsInserted(const QModelIndex &parent, int first, int last);
+    void sourceRowsMoved(const QModelIndex &sourceParent, int sourceStart, int sourceEnd, const QModelIndex &destinationParent, int destinationRow);
+    void sourceLayoutAboutToBeChanged();
+    void sourceLayoutChanged();
+
+    // proxy row -> source row, and source row -> proxy row (-1 if filtered out)
+    std::vector<int> m_sourceRows;
+    std::vector<int> m_proxyRows;
+    std::vector<QPersistentModelIndex> m_layoutChangeIndexes;
+    std::vector<QMetaObject::Connection> m_connections;
+
+    QString m_filter;
+    SortFilterCache m_cache;
+};
+
+}
+
+#endif // KOSMINDOORMAP_DISTANCESORTFILTERPROXYMODEL_P_H
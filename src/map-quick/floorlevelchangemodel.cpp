@@ -6,6 +6,7 @@
 
 #include "floorlevelchangemodel.h"
 
+#include "content/modeldiff_p.h"
 #include "loader/levelparser_p.h"
 #include <KOSMIndoorMap/MapData>
 
@@ -91,15 +92,13 @@ void FloorLevelChangeModel::setFloorLevelModel(FloorLevelModel *floorLevelModel)
     }
 
     if (m_floorLevelModel) {
-        disconnect(m_floorLevelModel, &FloorLevelModel::modelAboutToBeReset, this, nullptr);
+        disconnect(m_floorLevelModel, &FloorLevelModel::contentChanged, this, nullptr);
     }
 
     m_floorLevelModel = floorLevelModel;
-    connect(m_floorLevelModel, &FloorLevelModel::modelAboutToBeReset, this, [this]() {
-        beginResetModel();
+    connect(m_floorLevelModel, &FloorLevelModel::contentChanged, this, [this]() {
         m_element = {};
-        m_levels.clear();
-        endResetModel();
+        setLevels({});
     });
     Q_EMIT contentChanged();
 }
@@ -115,9 +114,8 @@ void FloorLevelChangeModel::setElement(const OSMElement &element)
         return;
     }
 
-    beginResetModel();
     m_element = element.element();
-    m_levels.clear();
+    std::vector<MapLevel> levels;
 
     if (isLevelChangeElement(m_element)) {
 
@@ -126,24 +124,32 @@ void FloorLevelChangeModel::setElement(const OSMElement &element)
         if (buildingLevels > 0) {
             const auto buildingMinLevel = m_element.tagValue("building:min_level", "level").toUInt();
             for (auto i = buildingMinLevel; i < buildingLevels; ++i) {
-                appendFullFloorLevel(i * 10);
+                appendFullFloorLevel(levels, i * 10);
             }
         }
         const auto buildingUndergroundLevel = m_element.tagValue("building:levels:underground").toUInt();
         for (auto i = buildingUndergroundLevel; i > 0; --i) {
-            appendFullFloorLevel(-i * 10);
+            appendFullFloorLevel(levels, -i * 10);
         }
 
-        LevelParser::parse(m_element.tagValue("level", "repeat_on"), m_element, [this](int level, OSM::Element e) {
+        LevelParser::parse(m_element.tagValue("level", "repeat_on"), m_element, [this, &levels](int level, OSM::Element e) {
             Q_UNUSED(e);
-            appendFloorLevel(level);
+            appendFloorLevel(levels, level);
 
         });
-        std::sort(m_levels.begin(), m_levels.end());
-        m_levels.erase(std::unique(m_levels.begin(), m_levels.end()), m_levels.end());
+        std::sort(levels.begin(), levels.end());
+        levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
     }
 
-    endResetModel();
+    setLevels(std::move(levels));
+}
+
+void FloorLevelChangeModel::setLevels(std::vector<MapLevel> &&levels)
+{
+    ModelDiff::apply(this, m_levels, std::move(levels),
+        [](const MapLevel &level) { return std::hash<int>{}(level.numericLevel()); },
+        [](const MapLevel &lhs, const MapLevel &rhs) { return lhs.numericLevel() == rhs.numericLevel(); },
+        [](const MapLevel &lhs, const MapLevel &rhs) { return lhs.name() == rhs.name(); });
     Q_EMIT contentChanged();
 }
 
@@ -160,26 +166,26 @@ bool FloorLevelChangeModel::isLevelChangeElement(OSM::Element element) const
         || element.tagValue("room") == "stairs";
 }
 
-void FloorLevelChangeModel::appendFloorLevel(int level)
+void FloorLevelChangeModel::appendFloorLevel(std::vector<MapLevel> &levels, int level) const
 {
     MapLevel ml(level);
     if (ml.isFullLevel()) {
-        appendFullFloorLevel(level);
+        appendFullFloorLevel(levels, level);
     } else {
-        appendFullFloorLevel(ml.fullLevelBelow());
-        appendFullFloorLevel(ml.fullLevelAbove());
+        appendFullFloorLevel(levels, ml.fullLevelBelow());
+        appendFullFloorLevel(levels, ml.fullLevelAbove());
     }
 }
 
-void FloorLevelChangeModel::appendFullFloorLevel(int level)
+void FloorLevelChangeModel::appendFullFloorLevel(std::vector<MapLevel> &levels, int level) const
 {
     if (!m_floorLevelModel) {
-        m_levels.push_back(MapLevel(level));
+        levels.push_back(MapLevel(level));
     } else {
         const auto row = m_floorLevelModel->rowForLevel(level);
         if (row >= 0) {
             const auto idx = m_floorLevelModel->index(row, 0);
-            m_levels.push_back(m_floorLevelModel->data(idx, FloorLevelModel::MapLevelRole).value<MapLevel>());
+            levels.push_back(m_floorLevelModel->data(idx, FloorLevelModel::MapLevelRole).value<MapLevel>());
         }
     }
 }
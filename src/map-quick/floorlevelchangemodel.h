@@ -82,9 +82,12 @@ Q_SIGNALS:
     void contentChanged();
 
 private:
+    friend class ModelDiff;
+
     [[nodiscard]] bool isLevelChangeElement(OSM::Element element) const;
-    void appendFloorLevel(int level);
-    void appendFullFloorLevel(int level);
+    void appendFloorLevel(std::vector<MapLevel> &levels, int level) const;
+    void appendFullFloorLevel(std::vector<MapLevel> &levels, int level) const;
+    void setLevels(std::vector<MapLevel> &&levels);
 
     int m_currentFloorLevel = 0;
     FloorLevelModel *m_floorLevelModel = nullptr;
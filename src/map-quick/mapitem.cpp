@@ -10,6 +10,7 @@
 #include <KOSMIndoorMap/HitDetector>
 #include <KOSMIndoorMap/MapCSSLoader>
 #include <KOSMIndoorMap/MapCSSParser>
+#include <KOSMIndoorMap/MapCSSStyleCache>
 #include <KOSMIndoorMap/OverlaySource>
 
 #include <QDebug>
@@ -17,6 +18,7 @@
 #include <QPainter>
 #include <QPalette>
 #include <QQuickWindow>
+#include <QRegion>
 #include <QTimeZone>
 
 using namespace KOSMIndoorMap;
@@ -32,6 +34,8 @@ MapItem::MapItem(QQuickItem *parent)
 
     m_view->setScreenSize({100, 100}); // FIXME this breaks view when done too late!
     m_controller.setView(m_view);
+    // textures only affect the items waiting for them, updatePolish() limits the repaint to that area
+    m_controller.setAsyncTextureLoading(this, [this]() { polish(); });
     connect(m_view, &View::floorLevelChanged, this, [this]() { update(); });
     connect(m_view, &View::transformationChanged, this, [this]() { update(); });
 
@@ -47,6 +51,20 @@ void MapItem::paint(QPainter *painter)
     m_controller.updateScene(m_sg);
     m_renderer.setPainter(painter);
     m_renderer.render(m_sg, m_view);
+    m_controller.resetDamage();
+}
+
+void MapItem::updatePolish()
+{
+    // hover or overlay changes only affect a few elements, so we only need to repaint the area covered by those
+    m_controller.updateScene(m_sg);
+    if (m_controller.hasFullDamage()) {
+        update();
+    } else if (const auto damage = m_controller.damage(); !damage.isEmpty()) {
+        // QQuickPaintedItem only supports a single dirty rectangle
+        update(damage.boundingRect());
+    }
+    m_controller.resetDamage();
 }
 
 MapLoader* MapItem::loader() const
@@ -71,33 +89,45 @@ void MapItem::setStylesheetName(const QString &styleSheet)
         return;
     }
     m_styleSheetUrl = styleFile;
-    m_style = MapCSSStyle();
-
     if (m_styleLoader) { // cancel an ongoing style load
         disconnect(m_styleLoader, nullptr, this, nullptr);
         delete m_styleLoader;
         m_styleLoader = nullptr;
     }
+    loadStyleSheet();
+
+    Q_EMIT styleSheetChanged();
+}
+
+void MapItem::loadStyleSheet()
+{
+    // another view might have this loaded for the same data already, or we can recompile
+    // the one we have if the data changed
+    m_style = MapCSSStyleCache::find(m_styleSheetUrl, m_data, std::move(m_style));
+    m_controller.setStyleSheet(m_style.get());
+    if (m_style) {
+        update();
+        return;
+    }
 
     m_styleLoader = new MapCSSLoader(m_styleSheetUrl, KOSMIndoorMap::defaultNetworkAccessManagerFactory, this);
     connect(m_styleLoader, &MapCSSLoader::finished, this, [this]() {
         if (m_styleLoader->hasError()) {
             m_errorMessage = m_styleLoader->errorMessage();
         } else {
-            m_style = m_styleLoader->takeStyle();
+            // without data this is only parsed, and compiled once the data is loaded
+            m_style = MapCSSStyleCache::insert(m_styleSheetUrl, m_data, m_styleLoader->takeStyle());
             m_errorMessage.clear();
-
-            m_style.compile(m_data.dataSet());
-            m_controller.setStyleSheet(&m_style);
-            update();
+            if (!m_data.isEmpty()) {
+                m_controller.setStyleSheet(m_style.get());
+                update();
+            }
         }
         Q_EMIT errorChanged();
         m_styleLoader->deleteLater();
         m_styleLoader = nullptr;
     });
     m_styleLoader->start();
-
-    Q_EMIT styleSheetChanged();
 }
 
 FloorLevelModel* MapItem::floorLevelModel() const
@@ -126,12 +156,19 @@ void MapItem::loaderDone()
         if (data.regionCode().isEmpty()) {
             data.setRegionCode(m_data.regionCode());
         }
-        data.setTimeZone(m_data.timeZone());
+        // data might be shared with other views, don't reset what they set already
+        if (!data.timeZone().isValid()) {
+            data.setTimeZone(m_data.timeZone());
+        }
         m_data = std::move(data);
         m_view->setSceneBoundingBox(m_data.boundingBox());
         m_controller.setMapData(m_data);
-        m_style.compile(m_data.dataSet());
-        m_controller.setStyleSheet(&m_style);
+        if (m_styleLoader) {
+            // an ongoing style load picks up the new data when done
+            m_controller.setStyleSheet(nullptr);
+        } else {
+            loadStyleSheet();
+        }
         m_view->setLevel(0);
         m_floorLevelModel->setMapData(&m_data);
         m_view->floorLevelChanged();
@@ -231,12 +268,15 @@ void MapItem::addOverlaySource(std::vector<QPointer<AbstractOverlaySource>> &ove
 void MapItem::overlayUpdate()
 {
     m_controller.overlaySourceUpdated();
-    update();
+    polish();
 }
 
 void MapItem::overlayReset()
 {
-    m_style.compile(m_data.dataSet());
+    // overlays might have added new tag keys, views sharing this style and data only need to recompile that once
+    if (m_style) {
+        MapCSSStyleCache::recompile(m_style);
+    }
 }
 
 QString MapItem::region() const
@@ -282,7 +322,7 @@ void MapItem::setHoveredElement(const OSMElement &element)
     }
     m_controller.setHoveredElement(element.element());
     Q_EMIT hoveredElementChanged();
-    update();
+    polish();
 }
 
 #include "moc_mapitem.cpp"
@@ -95,10 +95,12 @@ Q_SIGNALS:
 
 protected:
     void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void updatePolish() override;
 
 private:
     void clear();
     void loaderDone();
+    void loadStyleSheet();
     [[nodiscard]] MapData mapData() const;
     [[nodiscard]] QVariant overlaySources() const;
     void setOverlaySources(const QVariant &overlays);
@@ -116,7 +118,7 @@ private:
     View *m_view = nullptr;
     QUrl m_styleSheetUrl;
     MapCSSLoader *m_styleLoader = nullptr;
-    MapCSSStyle m_style;
+    std::shared_ptr<MapCSSStyle> m_style;
     SceneController m_controller;
     PainterRenderer m_renderer;
     FloorLevelModel *m_floorLevelModel = nullptr;
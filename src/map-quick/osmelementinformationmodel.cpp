@@ -10,6 +10,7 @@
 #include "localization.h"
 #include "osmaddress.h"
 
+#include <content/modeldiff_p.h>
 #include <wikidata/wikidataquery.h>
 
 #include <KLocalizedString>
@@ -17,6 +18,7 @@
 #include <QUrlQuery>
 
 #include <cctype>
+#include <functional>
 
 using namespace Qt::Literals::StringLiterals;
 using namespace KOSMIndoorMap;
@@ -66,13 +68,20 @@ void OSMElementInformationModel::setElement(const OSMElement &element)
         return;
     }
 
-    beginResetModel();
+    if (element.element().type() == OSM::Type::Null) {
+        clear();
+        return;
+    }
+
+    // reload() operates on m_infos, so temporarily swap out the current content
     m_element = element.element();
+    auto infos = std::move(m_infos);
     m_infos.clear();
-    if (m_element.type() != OSM::Type::Null) {
-        reload();
-    }
-    endResetModel();
+    reload();
+    std::swap(infos, m_infos);
+
+    // all values change with the element, so kept rows always need a data change notification
+    ModelDiff::apply(this, m_infos, std::move(infos), [](Info info) { return std::hash<int>{}(info.key); }, std::equal_to<Info>(), [](Info, Info) { return false; });
     Q_EMIT elementChanged();
 }
 
@@ -81,10 +90,8 @@ void OSMElementInformationModel::clear()
     if (m_element.type() == OSM::Type::Null) {
         return;
     }
-    beginResetModel();
-    m_infos.clear();
+    ModelDiff::apply(this, m_infos, std::vector<Info>(), [](Info info) { return std::hash<int>{}(info.key); }, std::equal_to<Info>(), [](Info, Info) { return false; });
     m_element = {};
-    endResetModel();
     Q_EMIT elementChanged();
 }
 
@@ -132,6 +132,7 @@ Q_SIGNALS:
     void allowOnlineContentChanged();
 
 private:
+    friend class ModelDiff;
     struct Info;
 
     void reload();
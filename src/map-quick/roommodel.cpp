@@ -8,6 +8,7 @@
 #include "logging.h"
 #include "osmelement.h"
 
+#include <content/modeldiff_p.h>
 #include <style/mapcssdeclaration_p.h>
 #include <style/mapcssstate_p.h>
 
@@ -21,6 +22,7 @@
 #include <QPointF>
 
 #include <limits>
+#include <utility>
 
 using namespace KOSMIndoorMap;
 
@@ -28,12 +30,7 @@ RoomModel::RoomModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_langs(OSM::Languages::fromQLocale(QLocale()))
 {
-    connect(this, &RoomModel::timeChanged, this, [this]() {
-        beginResetModel();
-        m_rooms.clear();
-        m_buildings.clear();
-        endResetModel();
-    });
+    connect(this, &RoomModel::timeChanged, this, &RoomModel::updateModel);
 }
 
 RoomModel::~RoomModel() = default;
@@ -58,14 +55,12 @@ void RoomModel::setMapData(const MapData &data)
         }
     }
 
-    beginResetModel();
-    m_buildings.clear();
-    m_rooms.clear();
-    m_data = data;
+    // the current rows reference the previous data until they are replaced
+    const auto prevData = std::exchange(m_data, data);
     if (!m_data.isEmpty()) {
         m_style.compile(m_data.dataSet());
     }
-    endResetModel();
+    updateModel();
     Q_EMIT mapDataChanged();
 }
 
@@ -174,12 +169,41 @@ void RoomModel::ensurePopulated() const
     if (m_rooms.empty() && !m_data.isEmpty()) {
         // we assume that this is expensive but almost never will result in an empty result
         // and if it does nevertheless, it's a sparsely populated tile where this is cheap
-        const_cast<RoomModel*>(this)->populateModel();
+        auto self = const_cast<RoomModel*>(this);
+        self->m_buildings.clear();
+        self->m_rooms = findRooms(self->m_buildings);
+        Q_EMIT self->populated();
     }
 }
 
-void RoomModel::populateModel()
+void RoomModel::updateModel()
 {
+    if (m_rooms.empty()) {
+        // not populated yet, that happens lazily on demand
+        beginResetModel();
+        m_buildings.clear();
+        endResetModel();
+        return;
+    }
+
+    std::vector<Building> buildings;
+    auto rooms = m_data.isEmpty() ? std::vector<Room>() : findRooms(buildings);
+    m_buildings = std::move(buildings);
+    ModelDiff::apply(this, m_rooms, std::move(rooms), [](const Room &room) {
+        return std::hash<OSM::Element>{}(room.element);
+    }, [](const Room &lhs, const Room &rhs) {
+        return lhs.element.type() == rhs.element.type() && lhs.element.id() == rhs.element.id();
+    }, [](const Room &lhs, const Room &rhs) {
+        return lhs.element == rhs.element && lhs.buildingElement == rhs.buildingElement && lhs.levelElement == rhs.levelElement
+            && lhs.level == rhs.level && lhs.name == rhs.name;
+    });
+    Q_EMIT populated();
+}
+
+std::vector<RoomModel::Room> RoomModel::findRooms(std::vector<Building> &buildings) const
+{
+    std::vector<Room> rooms;
+
     // find all buildings
     const auto buildingKey = m_data.dataSet().tagKey("building");
     const auto nameKey = m_data.dataSet().tagKey("name");
@@ -194,7 +218,7 @@ void RoomModel::populateModel()
                 Building building;
                 building.element = e;
                 // building.outerPath = e.outerPath(m_data.dataSet()); TODO needed?
-                m_buildings.push_back(std::move(building));
+                buildings.push_back(std::move(building));
             }
         }
     }
@@ -212,7 +236,7 @@ void RoomModel::populateModel()
                 level.level = (*it).first.numericLevel();
 
                 // find building this level belongs to
-                for (auto &building : m_buildings) {
+                for (auto &building : buildings) {
                     // TODO this is likely not precise enough?
                     if (OSM::intersects(e.boundingBox(), building.element.boundingBox())) {
                         building.levels.push_back(level);
@@ -251,7 +275,7 @@ void RoomModel::populateModel()
             room.level = (*it).first.numericLevel(); // TODO we only need one entry, not one per level!
 
             // find the building this room is in
-            for (auto &building :m_buildings) {
+            for (auto &building : buildings) {
                 // TODO this is likely not precise enough?
                 if (OSM::intersects(e.boundingBox(), building.element.boundingBox())) {
                     room.buildingElement = building.element;
@@ -273,7 +297,7 @@ void RoomModel::populateModel()
             if (name) {
                 room.name = QString::fromUtf8(*name);
             }
-            m_rooms.push_back(std::move(room));
+            rooms.push_back(std::move(room));
         }
     }
 
@@ -281,30 +305,30 @@ void RoomModel::populateModel()
     // de-duplicate multi-level entries
     // we could also just iterate over the non-level-split data, but
     // then we need to reparse the level data here...
-    std::sort(m_rooms.begin(), m_rooms.end(), [](const auto &lhs, const auto &rhs) {
+    std::sort(rooms.begin(), rooms.end(), [](const auto &lhs, const auto &rhs) {
         if (lhs.element == rhs.element) {
             return std::abs(lhs.level) < std::abs(rhs.level);
         }
         return lhs.element < rhs.element;
     });
-    m_rooms.erase(std::unique(m_rooms.begin(), m_rooms.end(), [](const auto &lhs, const auto &rhs) {
+    rooms.erase(std::unique(rooms.begin(), rooms.end(), [](const auto &lhs, const auto &rhs) {
         return lhs.element == rhs.element;
-    }), m_rooms.end());
+    }), rooms.end());
 
     // de-duplicate multi-level rooms that consist of multiple OSM elements (e.g. due to varying sizes per floor)
     // TODO
 
     // sort by building
-    std::sort(m_rooms.begin(), m_rooms.end(), [](const auto &lhs, const auto &rhs) {
+    std::sort(rooms.begin(), rooms.end(), [](const auto &lhs, const auto &rhs) {
         return lhs.buildingElement < rhs.buildingElement;
     });
 
     // remove buildings without rooms
-    m_buildings.erase(std::remove_if(m_buildings.begin(), m_buildings.end(), [](const auto &b) { return b.roomCount == 0; }), m_buildings.end());
+    buildings.erase(std::remove_if(buildings.begin(), buildings.end(), [](const auto &b) { return b.roomCount == 0; }), buildings.end());
 
-    qCDebug(Log) << m_buildings.size() << "buildings found";
-    qCDebug(Log) << m_rooms.size() << "rooms found";
-    Q_EMIT populated();
+    qCDebug(Log) << buildings.size() << "buildings found";
+    qCDebug(Log) << rooms.size() << "rooms found";
+    return rooms;
 }
 
 int RoomModel::findRoom(const QString &name) const
@@ -71,6 +71,8 @@ Q_SIGNALS:
     void timeChanged();
 
 private:
+    friend class ModelDiff;
+
     struct Level {
         OSM::Element element;
         int level;
@@ -92,7 +94,8 @@ private:
     };
 
     void ensurePopulated() const;
-    void populateModel();
+    void updateModel();
+    [[nodiscard]] std::vector<Room> findRooms(std::vector<Building> &buildings) const;
 
     MapData m_data;
     MapCSSStyle m_style;
@@ -9,26 +9,17 @@
 using namespace KOSMIndoorMap;
 
 RoomSortFilterProxyModel::RoomSortFilterProxyModel(QObject *parent)
-    : QSortFilterProxyModel(parent)
+    : DistanceSortFilterProxyModel(RoomModel::CoordinateRole, RoomModel::LevelRole, parent)
     , m_collator(QLocale())
 {
-    setDynamicSortFilter(true);
-
     m_collator.setCaseSensitivity(Qt::CaseInsensitive);
     m_collator.setIgnorePunctuation(true);
-
-    connect(this, &QAbstractProxyModel::sourceModelChanged, this, [this]() { sort(0); });
-    connect(this, &RoomSortFilterProxyModel::filterStringChanged, this, &QSortFilterProxyModel::invalidate);
 }
 
 RoomSortFilterProxyModel::~RoomSortFilterProxyModel() = default;
 
 bool RoomSortFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
-    if (m_filter.isEmpty()) {
-        return true;
-    }
-
     // TODO building name only makes sense if there is more than one
     const auto idx = sourceModel()->index(source_row, 0, source_parent);
     return filterMatches(idx.data(RoomModel::NameRole).toString())
@@ -63,7 +54,7 @@ bool RoomSortFilterProxyModel::lessThan(const QModelIndex &source_left, const QM
 
 bool RoomSortFilterProxyModel::filterMatches(const QString &s) const
 {
-    return s.contains(m_filter, Qt::CaseInsensitive); // TODO ignore diacritics
+    return s.contains(filterString(), Qt::CaseInsensitive); // TODO ignore diacritics
 }
 
 #include "moc_roomsortfilterproxymodel.cpp"
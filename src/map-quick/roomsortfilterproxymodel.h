@@ -6,27 +6,25 @@
 #ifndef KOSMINDOORMAP_ROOMSORTFILTERMODEL_H
 #define KOSMINDOORMAP_ROOMSORTFILTERMODEL_H
 
+#include "distancesortfilterproxymodel_p.h"
+
 #include <QCollator>
-#include <QSortFilterProxyModel>
 
 namespace KOSMIndoorMap {
 
 /** Filtering/sorting on top of the RoomModel.
  *  - filters on all visible roles
  *  - sorts while keeping the grouping intact
+ *  - alternatively orders by distance from a given position
  */
-class RoomSortFilterProxyModel : public QSortFilterProxyModel
+class RoomSortFilterProxyModel : public DistanceSortFilterProxyModel
 {
     Q_OBJECT
-    Q_PROPERTY(QString filterString MEMBER m_filter NOTIFY filterStringChanged)
 
 public:
     explicit RoomSortFilterProxyModel(QObject *parent = nullptr);
     ~RoomSortFilterProxyModel();
 
-Q_SIGNALS:
-    void filterStringChanged();
-
 protected:
     [[nodiscard]] bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
     [[nodiscard]] bool lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const override;
@@ -35,7 +33,6 @@ private:
     [[nodiscard]] bool filterMatches(const QString &s) const;
 
     QCollator m_collator;
-    QString m_filter;
 };
 
 }
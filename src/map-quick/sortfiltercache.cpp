@@ -0,0 +1,138 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "sortfiltercache_p.h"
+
+#include <osm/geomath.h>
+
+#include <QAbstractItemModel>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+using namespace KOSMIndoorMap;
+
+// rough walking distance equivalent of changing floor levels, in meters per level
+constexpr inline double FLOOR_LEVEL_CHANGE_DISTANCE = 20.0;
+// distance changes below this aren't worth notifying about, that's in the range of position noise anyway
+constexpr inline double DISTANCE_CHANGE_THRESHOLD = 1.0;
+
+SortFilterCache::SortFilterCache(int coordinateRole, int levelRole)
+    : m_coordinateRole(coordinateRole)
+    , m_levelRole(levelRole)
+{
+}
+
+SortFilterCache::~SortFilterCache() = default;
+
+void SortFilterCache::setSourceModel(QAbstractItemModel *model)
+{
+    m_model = model;
+    clear();
+}
+
+void SortFilterCache::clearFilter()
+{
+    m_filterResults.clear();
+}
+
+bool SortFilterCache::hasPosition() const
+{
+    return m_position.isValid();
+}
+
+QPointF SortFilterCache::position() const
+{
+    return m_position.isValid() ? QPointF(m_position.lonF(), m_position.latF()) : QPointF();
+}
+
+void SortFilterCache::setPosition(const QPointF &position)
+{
+    m_position = OSM::Coordinate(position.y(), position.x());
+    updateDistances();
+}
+
+void SortFilterCache::resetPosition()
+{
+    m_position = {};
+    updateDistances();
+}
+
+int SortFilterCache::floorLevel() const
+{
+    return m_floorLevel;
+}
+
+void SortFilterCache::setFloorLevel(int level)
+{
+    m_floorLevel = level;
+    updateDistances();
+}
+
+double SortFilterCache::distance(int sourceRow) const
+{
+    ensurePopulated();
+    return m_distances[sourceRow];
+}
+
+bool SortFilterCache::takeDistanceChange(int sourceRow)
+{
+    ensurePopulated();
+    const auto dist = m_distances[sourceRow];
+    auto &notifiedDist = m_notifiedDistances[sourceRow];
+    if (std::isnan(notifiedDist) || std::abs(dist - notifiedDist) >= DISTANCE_CHANGE_THRESHOLD) {
+        notifiedDist = dist;
+        return true;
+    }
+    return false;
+}
+
+void SortFilterCache::resetDistanceChanges()
+{
+    std::fill(m_notifiedDistances.begin(), m_notifiedDistances.end(), std::numeric_limits<double>::quiet_NaN());
+}
+
+void SortFilterCache::clear()
+{
+    m_coordinates.clear();
+    m_levels.clear();
+    m_distances.clear();
+    m_notifiedDistances.clear();
+    m_filterResults.clear();
+}
+
+void SortFilterCache::ensurePopulated() const
+{
+    if (!m_coordinates.empty() || !m_model) {
+        return;
+    }
+
+    const auto rowCount = (std::size_t)m_model->rowCount();
+    m_coordinates.resize(rowCount);
+    m_levels.resize(rowCount);
+    m_distances.resize(rowCount, 0.0);
+    m_notifiedDistances.resize(rowCount, std::numeric_limits<double>::quiet_NaN());
+    for (std::size_t i = 0; i < rowCount; ++i) {
+        const auto idx = m_model->index((int)i, 0);
+        const auto coord = idx.data(m_coordinateRole).toPointF();
+        m_coordinates[i] = OSM::Coordinate(coord.y(), coord.x());
+        m_levels[i] = idx.data(m_levelRole).toInt();
+    }
+    updateDistances();
+}
+
+void SortFilterCache::updateDistances() const
+{
+    if (!m_position.isValid()) {
+        return;
+    }
+
+    OSM::LocalDistance(m_position).distances(m_coordinates, m_distances);
+    for (std::size_t i = 0; i < m_distances.size(); ++i) {
+        m_distances[i] += std::abs(m_levels[i] - m_floorLevel) / 10.0 * FLOOR_LEVEL_CHANGE_DISTANCE;
+    }
+}
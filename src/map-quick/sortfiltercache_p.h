@@ -0,0 +1,101 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORMAP_SORTFILTERCACHE_P_H
+#define KOSMINDOORMAP_SORTFILTERCACHE_P_H
+
+#include <osm/datatypes.h>
+
+#include <QPointF>
+
+#include <cstdint>
+#include <vector>
+
+class QAbstractItemModel;
+
+namespace KOSMIndoorMap {
+
+/** Per source row cache of filter results and distances for DistanceSortFilterProxyModel.
+ *  This avoids repeated role lookups when re-sorting or re-filtering, e.g. when the distance
+ *  ordering needs to be updated for a moving position.
+ *
+ *  Cached content has to be discarded with clear() on any change of the source model.
+ */
+class SortFilterCache
+{
+public:
+    explicit SortFilterCache(int coordinateRole, int levelRole);
+    ~SortFilterCache();
+    SortFilterCache(const SortFilterCache&) = delete;
+    SortFilterCache& operator=(const SortFilterCache&) = delete;
+
+    void setSourceModel(QAbstractItemModel *model);
+    /** Discard all cached content, when the source model changed. */
+    void clear();
+
+    /** Cached result of @p filter for @p sourceRow. */
+    template <typename Filter>
+    [[nodiscard]] bool filterAcceptsRow(int sourceRow, Filter filter) const;
+    /** Discard cached filter results, when the filter criteria changed. */
+    void clearFilter();
+
+    /** Reference position for distance ordering, as longitude/latitude.
+     *  Distance ordering is active while this is set.
+     */
+    [[nodiscard]] bool hasPosition() const;
+    [[nodiscard]] QPointF position() const;
+    void setPosition(const QPointF &position);
+    void resetPosition();
+    /** Floor level at the reference position, in the same representation as the LevelRole of the source models. */
+    [[nodiscard]] int floorLevel() const;
+    void setFloorLevel(int level);
+
+    /** Distance in meters of @p sourceRow from the reference position.
+     *  This is the straight-line distance with a fixed penalty per floor level change.
+     */
+    [[nodiscard]] double distance(int sourceRow) const;
+    /** Returns @c true if the distance of @p sourceRow changed noticeably since it was last reported here,
+     *  ie. whether this is worth notifying about.
+     */
+    [[nodiscard]] bool takeDistanceChange(int sourceRow);
+    /** Forget about previously reported distances, e.g. when distance ordering got disabled. */
+    void resetDistanceChanges();
+
+private:
+    void ensurePopulated() const;
+    void updateDistances() const;
+
+    // per source row, kept separately for batch distance computation
+    mutable std::vector<OSM::Coordinate> m_coordinates;
+    mutable std::vector<int> m_levels;
+    mutable std::vector<double> m_distances;
+    // distances last announced via dataChanged(), NaN if never announced
+    mutable std::vector<double> m_notifiedDistances;
+    mutable std::vector<int8_t> m_filterResults;
+
+    QAbstractItemModel *m_model = nullptr;
+    int m_coordinateRole;
+    int m_levelRole;
+
+    OSM::Coordinate m_position;
+    int m_floorLevel = 0;
+};
+
+template <typename Filter>
+bool SortFilterCache::filterAcceptsRow(int sourceRow, Filter filter) const
+{
+    if (sourceRow >= (int)m_filterResults.size()) {
+        m_filterResults.resize(sourceRow + 1, -1);
+    }
+    auto &res = m_filterResults[sourceRow];
+    if (res < 0) {
+        res = filter() ? 1 : 0;
+    }
+    return res == 1;
+}
+
+}
+
+#endif // KOSMINDOORMAP_SORTFILTERCACHE_P_H
@@ -81,6 +81,12 @@ struct AmenitySortFilterProxyModelForeign {
     QML_FOREIGN(KOSMIndoorMap::AmenitySortFilterProxyModel)
 };
 
+struct DistanceSortFilterProxyModelForeign {
+    Q_GADGET
+    QML_ANONYMOUS
+    QML_FOREIGN(KOSMIndoorMap::DistanceSortFilterProxyModel)
+};
+
 struct FloorLevelChangeModelForeign {
     Q_GADGET
     QML_NAMED_ELEMENT(FloorLevelChangeModel)
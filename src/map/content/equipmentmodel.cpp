@@ -23,7 +23,7 @@ float Equipment::distanceTo(const OSM::DataSet &dataSet, float lat, float lon) c
         case OSM::Type::Null:
             return std::numeric_limits<float>::max();
         case OSM::Type::Node:
-            return OSM::distance(sourceElements[0].center(), OSM::Coordinate(lat, lon));
+            return OSM::LocalDistance(OSM::Coordinate(lat, lon)).distance(sourceElements[0].center());
         case OSM::Type::Way:
         case OSM::Type::Relation:
         {
@@ -5,6 +5,7 @@
 */
 
 #include "floorlevelmodel.h"
+#include "modeldiff_p.h"
 
 #include <KOSMIndoorMap/MapData>
 
@@ -13,23 +14,26 @@ using namespace KOSMIndoorMap;
 FloorLevelModel::FloorLevelModel(QObject *parent)
     : QAbstractListModel(parent)
 {
-    connect(this, &QAbstractItemModel::modelReset, this, &FloorLevelModel::contentChanged);
 }
 
 FloorLevelModel::~FloorLevelModel() = default;
 
 void FloorLevelModel::setMapData(MapData *data)
 {
-    beginResetModel();
-    m_level.clear();
+    std::vector<MapLevel> levels;
     if (data) {
         for (const auto &l : data->levelMap()) {
             if (l.first.isFullLevel()) {
-                m_level.push_back(l.first);
+                levels.push_back(l.first);
             }
         }
     }
-    endResetModel();
+
+    ModelDiff::apply(this, m_level, std::move(levels),
+        [](const MapLevel &level) { return std::hash<int>{}(level.numericLevel()); },
+        [](const MapLevel &lhs, const MapLevel &rhs) { return lhs.numericLevel() == rhs.numericLevel(); },
+        [](const MapLevel &lhs, const MapLevel &rhs) { return lhs.hasName() == rhs.hasName() && lhs.name() == rhs.name(); });
+    Q_EMIT contentChanged();
 }
 
 int FloorLevelModel::rowCount(const QModelIndex &parent) const
@@ -68,6 +68,7 @@ Q_SIGNALS:
     void contentChanged();
 
 private:
+    friend class ModelDiff;
     std::vector<MapLevel> m_level;
 };
 
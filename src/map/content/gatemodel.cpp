@@ -5,11 +5,14 @@
 */
 
 #include "gatemodel.h"
+#include "modeldiff_p.h"
 
 #include <QCollator>
 #include <QDebug>
 #include <QPointF>
 
+#include <utility>
+
 using namespace KOSMIndoorMap;
 
 GateModel::GateModel(QObject *parent)
@@ -17,7 +20,10 @@ GateModel::GateModel(QObject *parent)
 {
 }
 
-GateModel::~GateModel() = default;
+GateModel::~GateModel()
+{
+    OverlayReclaimer::retire(m_gatesEpoch, std::move(m_gates));
+}
 
 MapData GateModel::mapData() const
 {
@@ -30,15 +36,33 @@ void GateModel::setMapData(const MapData &data)
         return;
     }
 
-    beginResetModel();
-    m_gates.clear();
-    m_data = data;
+    // gate nodes can still be referenced by the scene graph via the overlay sources using this model,
+    // so retire the current content as a whole and update a copy of it instead
+    auto gates = m_gates;
+    OverlayReclaimer::retire(m_gatesEpoch, std::move(m_gates));
+    m_gates = std::move(gates);
+    m_gatesEpoch = OverlayReclaimer::currentEpoch();
+    m_arrivalGateRow = -1;
+    m_departureGateRow = -1;
+
+    // the current rows reference the previous data until they are replaced
+    const auto prevData = std::exchange(m_data, data);
+    std::vector<Gate> newGates;
     if (!m_data.isEmpty()) {
         m_tagKeys.mxArrival = m_data.dataSet().makeTagKey("mx:arrival");
         m_tagKeys.mxDeparture = m_data.dataSet().makeTagKey("mx:departure");
-        populateModel();
+        newGates = findGates();
     }
-    endResetModel();
+
+    // name and level are part of the row identity, and gate nodes are replaced in place so their
+    // address doesn't change, remaining content is the gate position and the (hidden) source element
+    ModelDiff::apply(this, m_gates, std::move(newGates), [](const Gate &gate) {
+        return std::hash<OSM::Element>{}(gate.sourceElement);
+    }, [](const Gate &lhs, const Gate &rhs) {
+        return lhs.name == rhs.name && lhs.level == rhs.level && lhs.sourceElement.type() == rhs.sourceElement.type() && lhs.sourceElement.id() == rhs.sourceElement.id();
+    }, [](const Gate &lhs, const Gate &rhs) {
+        return lhs.node.coordinate == rhs.node.coordinate && lhs.sourceElement == rhs.sourceElement;
+    });
     Q_EMIT mapDataChanged();
     matchGates();
 }
@@ -96,11 +120,12 @@ QHash<int, QByteArray> GateModel::roleNames() const
     return n;
 }
 
-void GateModel::populateModel()
+std::vector<Gate> GateModel::findGates() const
 {
+    std::vector<Gate> gates;
     const auto aerowayKey = m_data.dataSet().tagKey("aeroway");
     if (aerowayKey.isNull()) { // not looking at an airport at all here
-        return;
+        return gates;
     }
 
     for (auto it = m_data.levelMap().begin(); it != m_data.levelMap().end(); ++it) {
@@ -122,7 +147,7 @@ void GateModel::populateModel()
                 gate.node.id = m_data.dataSet().nextInternalId();
                 OSM::setTagValue(gate.node, m_data.dataSet().tagKey("name"), gate.name.toUtf8());
                 gate.level = (*it).first.numericLevel();
-                m_gates.push_back(gate);
+                gates.push_back(gate);
             }
         }
     }
@@ -131,11 +156,12 @@ void GateModel::populateModel()
     c.setNumericMode(true);
     c.setIgnorePunctuation(true);
     c.setCaseSensitivity(Qt::CaseInsensitive);
-    std::sort(m_gates.begin(), m_gates.end(), [&c](const auto &lhs, const auto &rhs) {
+    std::sort(gates.begin(), gates.end(), [&c](const auto &lhs, const auto &rhs) {
         return c.compare(lhs.name, rhs.name) < 0;
     });
 
-    qDebug() << m_gates.size() << "gates found";
+    qDebug() << gates.size() << "gates found";
+    return gates;
 }
 
 void GateModel::setArrivalGate(const QString &name)
@@ -10,6 +10,7 @@
 #include "kosmindoormap_export.h"
 
 #include <KOSMIndoorMap/MapData>
+#include <KOSMIndoorMap/OverlayReclaimer>
 
 #include <KOSM/Element>
 
@@ -74,12 +75,15 @@ Q_SIGNALS:
     void gateIndexChanged();
 
 private:
-    void populateModel();
+    friend class ModelDiff;
+
+    [[nodiscard]] std::vector<Gate> findGates() const;
     void matchGates();
     int matchGate(const QString &name) const;
     void setGateTag(int idx, OSM::TagKey key, bool enabled);
 
     std::vector<Gate> m_gates;
+    OverlayReclaimer::Epoch m_gatesEpoch = 0;
     MapData m_data;
 
     struct {
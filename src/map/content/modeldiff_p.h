@@ -0,0 +1,151 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORMAP_MODELDIFF_P_H
+#define KOSMINDOORMAP_MODELDIFF_P_H
+
+#include <QAbstractItemModel>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+namespace KOSMIndoorMap {
+
+/** Incremental content updates for list-like models.
+ *  Rather than resetting a model this determines the difference between its current and
+ *  its new content and emits the corresponding row removal, move, insertion and data change
+ *  notifications. That allows views to retain the delegates of unchanged rows.
+ *
+ *  Models using this need to declare ModelDiff as friend, for access to the protected
+ *  change notification methods of QAbstractItemModel.
+ */
+class ModelDiff
+{
+public:
+    /** Replace @p rows, the current content of @p model below @p parent, with @p newRows.
+     *  @param rowHash Hash function for rows, consistent with @p isSameRow. Typically
+     *  this hashes the OSM element id a row represents.
+     *  @param isSameRow Predicate whether two rows represent the same entry. Matching rows are
+     *  kept or moved, all others are removed or inserted.
+     *  @param isSameContent Predicate whether two matching rows also have the same content,
+     *  if not dataChanged() is emitted for the row.
+     *
+     *  Matching rows is linear in the number of rows (hash-based). Moving a row costs linear time
+     *  in the distance it is moved, so this is linear overall when the order of the rows doesn't
+     *  change much, which is the common case as all our models are sorted.
+     */
+    template <typename Model, typename T, typename RowHash, typename SameRow, typename SameContent>
+    static void apply(Model *model, std::vector<T> &rows, std::vector<T> &&newRows,
+                      RowHash rowHash, SameRow isSameRow, SameContent isSameContent, const QModelIndex &parent = {});
+};
+
+template <typename Model, typename T, typename RowHash, typename SameRow, typename SameContent>
+void ModelDiff::apply(Model *model, std::vector<T> &rows, std::vector<T> &&newRows, RowHash rowHash, SameRow isSameRow, SameContent isSameContent, const QModelIndex &parent)
+{
+    // match old and new rows, equivalent rows are matched one by one in order
+    // new row indexes per hash, in reverse order so the first candidate is at the back
+    std::unordered_map<std::size_t, std::vector<std::size_t>> candidates;
+    candidates.reserve(newRows.size());
+    for (auto j = newRows.size(); j > 0; --j) {
+        candidates[rowHash(newRows[j - 1])].push_back(j - 1);
+    }
+
+    // index of the new row each current row corresponds to, or -1 if it has no match
+    std::vector<std::ptrdiff_t> target(rows.size(), -1);
+    std::vector<bool> matched(newRows.size(), false);
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const auto it = candidates.find(rowHash(rows[i]));
+        if (it == candidates.end()) {
+            continue;
+        }
+        auto &bucket = (*it).second;
+        // search backwards, ie. in new row order, matched candidates are removed from the bucket
+        for (auto k = bucket.size(); k > 0; --k) {
+            const auto j = bucket[k - 1];
+            if (isSameRow(rows[i], newRows[j])) {
+                target[i] = (std::ptrdiff_t)j;
+                matched[j] = true;
+                bucket.erase(bucket.begin() + (std::ptrdiff_t)k - 1);
+                break;
+            }
+        }
+    }
+
+    // remove unmatched rows, back to front in consecutive ranges
+    for (auto last = (int)rows.size() - 1; last >= 0;) {
+        if (target[last] >= 0) {
+            --last;
+            continue;
+        }
+        auto first = last;
+        while (first > 0 && target[first - 1] < 0) {
+            --first;
+        }
+        model->beginRemoveRows(parent, first, last);
+        rows.erase(rows.begin() + first, rows.begin() + last + 1);
+        target.erase(target.begin() + first, target.begin() + last + 1);
+        model->endRemoveRows();
+        last = first - 1;
+    }
+
+    // rows[0, i) now corresponds to newRows[0, i), and rows[i, end) contains the matched rows of newRows[i, end) in any order
+    int changedBegin = -1;
+    int changedEnd = -1;
+    const auto flushChanged = [&]() {
+        if (changedBegin >= 0) {
+            Q_EMIT model->dataChanged(model->index(changedBegin, 0, parent), model->index(changedEnd, model->columnCount(parent) - 1, parent));
+            changedBegin = changedEnd = -1;
+        }
+    };
+
+    for (std::size_t i = 0; i < newRows.size();) {
+        if (!matched[i]) {
+            auto last = i + 1;
+            while (last < newRows.size() && !matched[last]) {
+                ++last;
+            }
+            flushChanged();
+            model->beginInsertRows(parent, (int)i, (int)last - 1);
+            rows.insert(rows.begin() + i, std::make_move_iterator(newRows.begin() + i), std::make_move_iterator(newRows.begin() + last));
+            const auto insertIt = target.insert(target.begin() + i, last - i, 0);
+            std::iota(insertIt, insertIt + (last - i), (std::ptrdiff_t)i);
+            model->endInsertRows();
+            i = last;
+            continue;
+        }
+
+        if (target[i] != (std::ptrdiff_t)i) {
+            // the search costs as much as the move itself
+            const auto it = std::find(target.begin() + i + 1, target.end(), (std::ptrdiff_t)i);
+            const auto j = (int)std::distance(target.begin(), it);
+            flushChanged();
+            model->beginMoveRows(parent, j, j, parent, (int)i);
+            std::rotate(rows.begin() + i, rows.begin() + j, rows.begin() + j + 1);
+            std::rotate(target.begin() + i, it, std::next(it));
+            model->endMoveRows();
+        }
+
+        if (!isSameContent(rows[i], newRows[i])) {
+            if (changedEnd != (int)i - 1) {
+                flushChanged();
+            }
+            if (changedBegin < 0) {
+                changedBegin = (int)i;
+            }
+            changedEnd = (int)i;
+        }
+        rows[i] = std::move(newRows[i]);
+        ++i;
+    }
+    flushChanged();
+}
+
+}
+
+#endif // KOSMINDOORMAP_MODELDIFF_P_H
@@ -8,10 +8,16 @@
 
 #include <scene/openinghourscache_p.h>
 
+#include <QMutexLocker>
+
+#include <algorithm>
+
 using namespace KOSMIndoorMap;
 
 OSMConditionalExpression::OSMConditionalExpression() = default;
+OSMConditionalExpression::OSMConditionalExpression(OSMConditionalExpression&&) noexcept = default;
 OSMConditionalExpression::~OSMConditionalExpression() = default;
+OSMConditionalExpression& OSMConditionalExpression::operator=(OSMConditionalExpression&&) noexcept = default;
 
 void OSMConditionalExpression::parse(const QByteArray &expression)
 {
@@ -42,3 +48,45 @@ QByteArray OSMConditionalExpression::evaluate(const OSMConditionalExpressionCont
     }
     return {};
 }
+
+
+OSMConditionalExpressionCache::OSMConditionalExpressionCache()
+{
+    m_cache.setMaxCost(1024);
+}
+
+OSMConditionalExpressionCache::~OSMConditionalExpressionCache() = default;
+
+std::shared_ptr<const OSMConditionalExpression> OSMConditionalExpressionCache::expression(const QByteArray &expression) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (const auto entry = m_cache.object(expression)) {
+        return *entry;
+    }
+    locker.unlock();
+
+    auto expr = std::make_shared<OSMConditionalExpression>();
+    expr->parse(expression);
+
+    locker.relock();
+    m_cache.insert(expression, new std::shared_ptr<const OSMConditionalExpression>(expr));
+    return expr;
+}
+
+void OSMConditionalExpressionCache::setMaximumCount(qsizetype count)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(count);
+}
+
+qsizetype OSMConditionalExpressionCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.count();
+}
+
+void OSMConditionalExpressionCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}
@@ -7,7 +7,10 @@
 #define KOSMINDOORMAP_OSM_CONDITIONAL_EXPRESSION_H
 
 #include <QByteArray>
+#include <QCache>
+#include <QMutex>
 
+#include <memory>
 #include <vector>
 
 namespace KOSMIndoorMap {
@@ -22,8 +25,10 @@ class OSMConditionalExpression
 public:
     explicit OSMConditionalExpression();
     OSMConditionalExpression(const OSMConditionalExpression&) = delete;
+    OSMConditionalExpression(OSMConditionalExpression&&) noexcept;
     ~OSMConditionalExpression();
     OSMConditionalExpression& operator=(const OSMConditionalExpression&) = delete;
+    OSMConditionalExpression& operator=(OSMConditionalExpression&&) noexcept;
 
     // TODO error handling
     void parse(const QByteArray &expression);
@@ -38,6 +43,34 @@ private:
     std::vector<Condition> m_conditions;
 };
 
+/** Cache of parsed conditional expressions, keyed by their source string.
+ *  Conditional tag values tend to repeat a lot within a dataset, so this avoids
+ *  re-parsing the same expression for every element and every style evaluation pass.
+ *  The cache is size-bounded and can be used from multiple threads, as compiled styles
+ *  are shared between views.
+ */
+class OSMConditionalExpressionCache
+{
+public:
+    explicit OSMConditionalExpressionCache();
+    OSMConditionalExpressionCache(const OSMConditionalExpressionCache&) = delete;
+    ~OSMConditionalExpressionCache();
+    OSMConditionalExpressionCache& operator=(const OSMConditionalExpressionCache&) = delete;
+
+    /** Returns the parsed expression for @p expression, parsing it on first use. */
+    [[nodiscard]] std::shared_ptr<const OSMConditionalExpression> expression(const QByteArray &expression) const;
+
+    /** Maximum number of cached expressions. */
+    void setMaximumCount(qsizetype count);
+    [[nodiscard]] qsizetype count() const;
+
+    void clear();
+
+private:
+    mutable QMutex m_mutex;
+    mutable QCache<QByteArray, std::shared_ptr<const OSMConditionalExpression>> m_cache;
+};
+
 }
 
 #endif
@@ -5,6 +5,7 @@
 */
 
 #include "platform.h"
+#include "platform_p.h"
 
 #include <osm/element.h>
 #include <osm/geomath.h>
@@ -12,6 +13,7 @@
 
 #include <QRegularExpression>
 
+#include <algorithm>
 #include <limits>
 
 using namespace KOSMIndoorMap;
@@ -79,6 +81,9 @@ public:
     QString m_ifopt;
     QStringList m_lines;
 
+    [[nodiscard]] static inline const PlatformPrivate* get(const Platform &p) { return p.d.data(); }
+
+    [[nodiscard]] static bool isSame(const Platform &lhs, const PlatformGeometryIndex &lhsIndex, const Platform &rhs, const PlatformGeometryIndex &rhsIndex, const OSM::DataSet &dataSet);
     static void appendSection(std::vector<PlatformSection> &sections, const Platform &p, PlatformSection &&sec, std::vector<const OSM::Node*> &edgePath, const OSM::DataSet &dataSet);
     static double maxSectionDistance(const Platform &p, const std::vector<PlatformSection> &sections, const OSM::DataSet &dataSet);
 };
@@ -248,13 +253,6 @@ static bool equalIfPresent(OSM::Element lhs, OSM::Element rhs)
     return lhs && rhs && lhs == rhs;
 }
 
-static bool isSubPath(const std::vector<const OSM::Node*> &path, const OSM::Way &way)
-{
-    return std::all_of(way.nodes.begin(), way.nodes.end(), [&path](OSM::Id node) {
-        return std::find_if(path.begin(), path.end(), [node](auto n) { return n->id == node; }) != path.end();
-    });
-}
-
 static constexpr const auto MAX_TRACK_TO_EDGE_DISTANCE = 4.5; // meters
 static constexpr const auto MAX_SECTION_TO_EDGE_DISTANCE = 5.0;
 
@@ -291,90 +289,152 @@ static const OSM::Way* outerWay(OSM::Element &multiPolygon, const OSM::DataSet &
     return nullptr;
 }
 
-static bool isConnectedGeometry(OSM::Element lhs, OSM::Element rhs, const OSM::DataSet &dataSet)
+[[nodiscard]] static PlatformIndexedWay indexWay(OSM::Element elem, const OSM::DataSet &dataSet)
 {
-    if (lhs == rhs) { return false; }
-    const OSM::Way *lway = nullptr;
-    const OSM::Way *rway = nullptr;
-
-    switch (lhs.type()) {
+    PlatformIndexedWay w;
+    w.element = elem;
+    switch (elem.type()) {
         case OSM::Type::Null:
         case OSM::Type::Node:
-            return false;
+            return w;
         case OSM::Type::Way:
-            lway = lhs.way();
+            w.way = elem.way();
             break;
         case OSM::Type::Relation:
-            lway  = outerWay(lhs, dataSet);
+            w.way = outerWay(elem, dataSet);
             break;
+    }
+    if (!w.way || w.way->nodes.empty()) {
+        w.way = nullptr;
+        return w;
+    }
 
+    if (w.way->isClosed() && w.way->nodes.size() > 2) {
+        // ### this assumes multi-polygons are structured in the way the Marble generator normalizes them!
+        const auto &nodes = w.way->nodes;
+        w.edges.reserve(nodes.size());
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            const auto n1 = nodes[i];
+            const auto n2 = nodes[(i + 1) % nodes.size()];
+            w.edges.insert({ std::min(n1, n2), std::max(n1, n2) });
+        }
     }
-    switch (rhs.type()) {
-        case OSM::Type::Null:
-        case OSM::Type::Node:
-            return false;
-        case OSM::Type::Way:
-            rway = rhs.way();
-            break;
-        case OSM::Type::Relation:
-            rway = outerWay(rhs, dataSet);
-            break;
+    return w;
+}
+
+PlatformGeometryIndex::PlatformGeometryIndex(const Platform &platform, const OSM::DataSet &dataSet)
+{
+    const auto p = PlatformPrivate::get(platform);
+    edge = indexWay(p->m_edge, dataSet);
+    area = indexWay(p->m_area, dataSet);
+    if (p->m_area) {
+        const auto path = p->m_area.outerPath(dataSet);
+        areaNodes.reserve(path.size());
+        for (auto node : path) {
+            areaNodes.insert(node->id);
+        }
+    }
+
+    tracks.reserve(p->m_track.size());
+    for (auto elem : p->m_track) {
+        auto w = indexWay(elem, dataSet);
+        if (w.way && !w.way->isClosed()) {
+            trackEndpoints.insert({ w.way->nodes.front(), elem });
+            trackEndpoints.insert({ w.way->nodes.back(), elem });
+        }
+        tracks.push_back(std::move(w));
     }
-    if (!lway || !rway) {
+    trackElements = p->m_track;
+    std::sort(trackElements.begin(), trackElements.end());
+}
+
+static bool isSubPath(const std::unordered_set<OSM::Id> &pathNodes, const OSM::Way &way)
+{
+    return std::all_of(way.nodes.begin(), way.nodes.end(), [&pathNodes](OSM::Id node) {
+        return pathNodes.contains(node);
+    });
+}
+
+static bool isConnectedGeometry(const PlatformIndexedWay &lhs, const PlatformIndexedWay &rhs)
+{
+    if (lhs.element == rhs.element || !lhs.way || !rhs.way) {
         return false;
     }
 
+    const auto lway = lhs.way;
+    const auto rway = rhs.way;
     if (!lway->isClosed() && !rway->isClosed()) {
         return lway->nodes.front() == rway->nodes.front()
             || lway->nodes.back() == rway->nodes.front()
             || lway->nodes.front() == rway->nodes.back()
             || lway->nodes.back() == rway->nodes.back();
     }
-    if (lway->isClosed() && lway->nodes.size() > 2 && rway->isClosed() && rway->nodes.size() > 2) {
-        // ### this assumes multi-polygons are structured in the way the Marble generator normalizes them!
-        bool found = false;
-        for (std::size_t i = 0; i < lway->nodes.size() && !found; ++i) {
-            const auto n1 = lway->nodes[i];
-            const auto n2 = lway->nodes[(i + 1) % lway->nodes.size()];
-            for (std::size_t j = 0; j < rway->nodes.size() && !found; ++j) {
-                found = ((n1 == rway->nodes[j]) && (n2 == rway->nodes[(j + 1) % rway->nodes.size()]))
-                     || ((n2 == rway->nodes[j]) && (n1 == rway->nodes[(j + 1) % rway->nodes.size()]));
-            }
-        }
-        return found;
+
+    // closed ways with at least one shared edge
+    if (!lhs.edges.empty() && !rhs.edges.empty()) {
+        const auto &small = lhs.edges.size() < rhs.edges.size() ? lhs.edges : rhs.edges;
+        const auto &large = lhs.edges.size() < rhs.edges.size() ? rhs.edges : lhs.edges;
+        return std::any_of(small.begin(), small.end(), [&large](const auto &edge) {
+            return large.contains(edge);
+        });
     }
 
     return false;
 }
 
-static bool isConnectedWay(const std::vector<OSM::Element> &lhs, const std::vector<OSM::Element> &rhs, const OSM::DataSet &dataSet)
+static bool isConnectedWay(const PlatformGeometryIndex &lhs, const PlatformGeometryIndex &rhs)
 {
-    return std::any_of(lhs.begin(), lhs.end(), [&](auto lway) {
-        return std::any_of(rhs.begin(), rhs.end(), [&](auto rway) {
-            return isConnectedGeometry(lway, rway, dataSet);
+    const auto isConnectedEndpoint = [&rhs](OSM::Id node, OSM::Element elem) {
+        const auto [begin, end] = rhs.trackEndpoints.equal_range(node);
+        return std::any_of(begin, end, [elem](const auto &endpoint) { return endpoint.second != elem; });
+    };
+
+    return std::any_of(lhs.tracks.begin(), lhs.tracks.end(), [&](const auto &lway) {
+        if (!lway.way) {
+            return false;
+        }
+        if (!lway.way->isClosed()) {
+            return isConnectedEndpoint(lway.way->nodes.front(), lway.element) || isConnectedEndpoint(lway.way->nodes.back(), lway.element);
+        }
+        return !lway.edges.empty() && std::any_of(rhs.tracks.begin(), rhs.tracks.end(), [&lway](const auto &rway) {
+            return isConnectedGeometry(lway, rway);
         });
     });
 }
 
-static bool isOverlappingWay(const std::vector<OSM::Element> &lhs, const std::vector<OSM::Element> &rhs)
+static bool isOverlappingWay(const PlatformGeometryIndex &lhs, const PlatformGeometryIndex &rhs)
 {
-    return std::any_of(lhs.begin(), lhs.end(), [&](auto lway) {
-        return std::any_of(rhs.begin(), rhs.end(), [&](auto rway) {
-            return lway == rway;
-        });
+    const auto &small = lhs.trackElements.size() < rhs.trackElements.size() ? lhs.trackElements : rhs.trackElements;
+    const auto &large = lhs.trackElements.size() < rhs.trackElements.size() ? rhs.trackElements : lhs.trackElements;
+    return std::any_of(small.begin(), small.end(), [&large](auto elem) {
+        return std::binary_search(large.begin(), large.end(), elem);
     });
 }
 
 bool Platform::isSame(const Platform &lhs, const Platform &rhs, const OSM::DataSet &dataSet)
+{
+    // no need to build the geometry indexes when we can decide by IFOPT id
+    if (!lhs.ifopt().isEmpty() && !rhs.ifopt().isEmpty()) {
+        return lhs.ifopt() == rhs.ifopt();
+    }
+    return PlatformPrivate::isSame(lhs, PlatformGeometryIndex(lhs, dataSet), rhs, PlatformGeometryIndex(rhs, dataSet), dataSet);
+}
+
+bool PlatformGeometryIndex::isSame(const Platform &lhs, const PlatformGeometryIndex &lhsIndex, const Platform &rhs, const PlatformGeometryIndex &rhsIndex, const OSM::DataSet &dataSet)
+{
+    return PlatformPrivate::isSame(lhs, lhsIndex, rhs, rhsIndex, dataSet);
+}
+
+bool PlatformPrivate::isSame(const Platform &lhs, const PlatformGeometryIndex &lhsIndex, const Platform &rhs, const PlatformGeometryIndex &rhsIndex, const OSM::DataSet &dataSet)
 {
     if (!lhs.ifopt().isEmpty() && !rhs.ifopt().isEmpty()) {
         return lhs.ifopt() == rhs.ifopt();
     }
 
-    const auto isConnectedEdge = isConnectedGeometry(lhs.d->m_edge, rhs.d->m_edge, dataSet);
-    const auto isConnectedTrack = isConnectedWay(lhs.d->m_track, rhs.d->m_track, dataSet);
-    const auto isOverlappingTrack = isOverlappingWay(lhs.d->m_track, rhs.d->m_track);
-    const auto isConnectedArea = isConnectedGeometry(lhs.d->m_area, rhs.d->m_area, dataSet);
+    const auto isConnectedEdge = isConnectedGeometry(lhsIndex.edge, rhsIndex.edge);
+    const auto isConnectedTrack = isConnectedWay(lhsIndex, rhsIndex);
+    const auto isOverlappingTrack = isOverlappingWay(lhsIndex, rhsIndex);
+    const auto isConnectedArea = isConnectedGeometry(lhsIndex.area, rhsIndex.area);
 
     if ((conflictIfPresent(lhs.d->m_stopPoint, rhs.d->m_stopPoint) && lhs.d->m_track != rhs.d->m_track && !isConnectedTrack)
      || (conflictIfPresent(lhs.d->m_edge, rhs.d->m_edge) && !isConnectedEdge)
@@ -395,8 +455,8 @@ bool Platform::isSame(const Platform &lhs, const Platform &rhs, const OSM::DataS
 
     // edge has to be part of area, but on its own that doesn't mean equallity
     if (!isConnectedArea && !isConnectedEdge) {
-        if ((lhs.d->m_area && rhs.d->m_edge.type() == OSM::Type::Way && !isSubPath(lhs.d->m_area.outerPath(dataSet), *rhs.d->m_edge.way()))
-        || (rhs.d->m_area && lhs.d->m_edge.type() == OSM::Type::Way && !isSubPath(rhs.d->m_area.outerPath(dataSet), *lhs.d->m_edge.way()))) {
+        if ((lhs.d->m_area && rhs.d->m_edge.type() == OSM::Type::Way && !isSubPath(lhsIndex.areaNodes, *rhs.d->m_edge.way()))
+        || (rhs.d->m_area && lhs.d->m_edge.type() == OSM::Type::Way && !isSubPath(rhsIndex.areaNodes, *lhs.d->m_edge.way()))) {
             return false;
         }
     }
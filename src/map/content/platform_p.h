@@ -0,0 +1,71 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORMAP_PLATFORM_P_H
+#define KOSMINDOORMAP_PLATFORM_P_H
+
+#include <osm/element.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace KOSMIndoorMap {
+
+class Platform;
+
+/** Undirected edge between two adjacent nodes of a way. */
+struct PlatformNodeEdge {
+    OSM::Id n1;
+    OSM::Id n2;
+    [[nodiscard]] constexpr bool operator==(const PlatformNodeEdge&) const = default;
+};
+
+struct PlatformNodeEdgeHash {
+    [[nodiscard]] std::size_t operator()(const PlatformNodeEdge &edge) const
+    {
+        return std::hash<OSM::Id>()(edge.n1) ^ (std::hash<OSM::Id>()(edge.n2) * 31);
+    }
+};
+
+/** Platform geometry element with its resolved way, for connectivity tests. */
+struct PlatformIndexedWay {
+    OSM::Element element;
+    const OSM::Way *way = nullptr;
+    /** All edges of closed ways, empty for open ways. */
+    std::unordered_set<PlatformNodeEdge, PlatformNodeEdgeHash> edges;
+};
+
+/** Node-based lookup tables for the geometry of a platform.
+ *  Built once per platform, so that checking whether two platforms share nodes
+ *  doesn't need to compare all node lists with each other.
+ *
+ *  This refers to ways of the data set it was built for, and doesn't follow changes
+ *  to the platform it was built for. Callers have to rebuild it in either case.
+ */
+class PlatformGeometryIndex
+{
+public:
+    explicit PlatformGeometryIndex(const Platform &platform, const OSM::DataSet &dataSet);
+
+    /** Same as Platform::isSame(), using the indexes of both platforms built for @p dataSet. */
+    [[nodiscard]] static bool isSame(const Platform &lhs, const PlatformGeometryIndex &lhsIndex,
+                                     const Platform &rhs, const PlatformGeometryIndex &rhsIndex,
+                                     const OSM::DataSet &dataSet);
+
+    PlatformIndexedWay edge;
+    PlatformIndexedWay area;
+    /** Nodes of the outer path of the area. */
+    std::unordered_set<OSM::Id> areaNodes;
+    std::vector<PlatformIndexedWay> tracks;
+    /** Endpoints of open track ways. */
+    std::unordered_multimap<OSM::Id, OSM::Element> trackEndpoints;
+    /** Sorted track elements. */
+    std::vector<OSM::Element> trackElements;
+};
+
+}
+
+#endif // KOSMINDOORMAP_PLATFORM_P_H
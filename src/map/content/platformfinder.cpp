@@ -5,6 +5,7 @@
 */
 
 #include "platformfinder_p.h"
+#include "platform_p.h"
 
 #include <QRegularExpression>
 
@@ -282,42 +283,55 @@ int PlatformFinder::levelForPlatform(const MapLevel &ml, OSM::Element e) const
 
 void PlatformFinder::addPlatform(Platform &&platform)
 {
-    for (Platform &p : m_platforms) {
-        if (Platform::isSame(p, platform, m_data.dataSet())) {
-            p = Platform::merge(p, platform, m_data.dataSet());
+    PlatformGeometryIndex index(platform, m_data.dataSet());
+    for (std::size_t i = 0; i < m_platforms.size(); ++i) {
+        if (PlatformGeometryIndex::isSame(m_platforms[i], m_platformIndexes[i], platform, index, m_data.dataSet())) {
+            m_platforms[i] = Platform::merge(m_platforms[i], platform, m_data.dataSet());
+            m_platformIndexes[i] = PlatformGeometryIndex(m_platforms[i], m_data.dataSet());
             return;
         }
     }
 
     m_platforms.push_back(std::move(platform));
+    m_platformIndexes.push_back(std::move(index));
 }
 
 void PlatformFinder::mergePlatformAreas()
 {
+    std::vector<PlatformGeometryIndex> areaIndexes;
+    areaIndexes.reserve(m_platformAreas.size());
+    for (const auto &area : m_platformAreas) {
+        areaIndexes.emplace_back(area, m_data.dataSet());
+    }
+
     // due to split areas we can end up with multplie entries for the same platform that only merge in the right order
     // so retry until we no longer find anything matching
     std::size_t prevCount = 0;
 
     while (prevCount != m_platformAreas.size() && !m_platformAreas.empty()) {
         prevCount = m_platformAreas.size();
-        for (auto it = m_platformAreas.begin(); it != m_platformAreas.end();) {
+        for (std::size_t i = 0; i < m_platformAreas.size();) {
             bool found = false;
-            for (Platform &p : m_platforms) {
-                if (Platform::isSame(p, (*it), m_data.dataSet())) {
-                    p = Platform::merge(p, (*it), m_data.dataSet());
+            for (std::size_t j = 0; j < m_platforms.size(); ++j) {
+                if (PlatformGeometryIndex::isSame(m_platforms[j], m_platformIndexes[j], m_platformAreas[i], areaIndexes[i], m_data.dataSet())) {
+                    m_platforms[j] = Platform::merge(m_platforms[j], m_platformAreas[i], m_data.dataSet());
+                    m_platformIndexes[j] = PlatformGeometryIndex(m_platforms[j], m_data.dataSet());
                     found = true;
                 }
             }
             if (found) {
-                it = m_platformAreas.erase(it);
+                m_platformAreas.erase(m_platformAreas.begin() + (std::ptrdiff_t)i);
+                areaIndexes.erase(areaIndexes.begin() + (std::ptrdiff_t)i);
             } else {
-                ++it;
+                ++i;
             }
         }
 
         if (prevCount == m_platformAreas.size()) {
-            m_platforms.push_back(m_platformAreas.back());
-            m_platformAreas.erase(std::prev(m_platformAreas.end()));
+            m_platforms.push_back(std::move(m_platformAreas.back()));
+            m_platformIndexes.push_back(std::move(areaIndexes.back()));
+            m_platformAreas.pop_back();
+            areaIndexes.pop_back();
         }
     }
 }
@@ -331,16 +345,19 @@ void PlatformFinder::finalizeResult()
     // integrating the platform elements can have made other platforms mergable that previously weren't,
     // the same can happen in case of a very fine-granular track split
     // so do another merge pass over everything we have found so far
-    for (auto it = m_platforms.begin(); it != std::prev(m_platforms.end()) && it != m_platforms.end(); ++it) {
-        for (auto it2 = std::next(it); it2 != m_platforms.end();) {
-            if (Platform::isSame(*it, *it2, m_data.dataSet())) {
-                (*it) = Platform::merge(*it, *it2, m_data.dataSet());
-                it2 = m_platforms.erase(it2);
+    for (std::size_t i = 0; i + 1 < m_platforms.size(); ++i) {
+        for (std::size_t j = i + 1; j < m_platforms.size();) {
+            if (PlatformGeometryIndex::isSame(m_platforms[i], m_platformIndexes[i], m_platforms[j], m_platformIndexes[j], m_data.dataSet())) {
+                m_platforms[i] = Platform::merge(m_platforms[i], m_platforms[j], m_data.dataSet());
+                m_platformIndexes[i] = PlatformGeometryIndex(m_platforms[i], m_data.dataSet());
+                m_platforms.erase(m_platforms.begin() + (std::ptrdiff_t)j);
+                m_platformIndexes.erase(m_platformIndexes.begin() + (std::ptrdiff_t)j);
             } else {
-                ++it2;
+                ++j;
             }
         }
     }
+    m_platformIndexes.clear();
 
     // remove things that are still incomplete at this point
     m_platforms.erase(std::remove_if(m_platforms.begin(), m_platforms.end(), [](const auto &p) {
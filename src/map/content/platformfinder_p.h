@@ -19,6 +19,7 @@ namespace KOSMIndoorMap {
 
 class MapData;
 class MapLevel;
+class PlatformGeometryIndex;
 
 /** Identifies public transport platforms in OSM data.
  *  @internal only exported for unit tests
@@ -59,6 +60,8 @@ private:
     QCollator m_collator;
 
     std::vector<Platform> m_platforms;
+    /** Geometry indexes of m_platforms, only valid until finalizeResult(). */
+    std::vector<PlatformGeometryIndex> m_platformIndexes;
     std::vector<Platform> m_platformAreas;
     std::vector<Platform> m_floatingSections;
 };
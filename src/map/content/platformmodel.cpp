@@ -5,12 +5,16 @@
 */
 
 #include "platformmodel.h"
+#include "modeldiff_p.h"
 #include "platformfinder_p.h"
 
+#include <QHash>
 #include <QPointF>
 #include <QRegularExpression>
 
+#include <algorithm>
 #include <limits>
+#include <utility>
 
 using namespace KOSMIndoorMap;
 
@@ -28,7 +32,10 @@ PlatformModel::PlatformModel(QObject* parent) :
     connect(this, &PlatformModel::departurePlatformChanged, &m_matchTimer, qOverload<>(&QTimer::start));
 }
 
-PlatformModel::~PlatformModel() = default;
+PlatformModel::~PlatformModel()
+{
+    releaseLabels();
+}
 
 MapData PlatformModel::mapData() const
 {
@@ -41,23 +48,57 @@ void PlatformModel::setMapData(const MapData &data)
         return;
     }
 
-    beginResetModel();
-    m_platforms.clear();
-    m_platformLabels.clear();
-    m_sectionsLabels.clear();
+    // labels can still be referenced by the scene graph via the overlay sources using this model,
+    // so retire the current ones as a whole and update copies of them instead
+    auto platforms = copyLabels();
+    releaseLabels();
+    m_platforms = std::move(platforms);
+    m_labelsEpoch = OverlayReclaimer::currentEpoch();
     m_arrivalPlatformRow = -1;
     m_departurePlatformRow = -1;
 
-    m_data = data;
+    // the current rows reference the previous data until they are replaced
+    const auto prevData = std::exchange(m_data, data);
+    std::vector<PlatformEntry> newPlatforms;
     if (!m_data.isEmpty()) {
         PlatformFinder finder;
-        m_platforms = finder.find(m_data);
-
         m_tagKeys.arrival = m_data.dataSet().makeTagKey("mx:arrival");
         m_tagKeys.departure = m_data.dataSet().makeTagKey("mx:departure");
-        createLabels();
+        newPlatforms = createLabels(finder.find(m_data));
+    }
+
+    const auto isSamePlatform = [](const PlatformEntry &lhs, const PlatformEntry &rhs) {
+        const auto &lp = lhs.platform;
+        const auto &rp = rhs.platform;
+        return lp.name() == rp.name() && lp.mode() == rp.mode() && lp.level() == rp.level() && lp.ifopt() == rp.ifopt()
+            && std::equal(lp.sections().begin(), lp.sections().end(), rp.sections().begin(), rp.sections().end(), [](const auto &lhs, const auto &rhs) {
+                return lhs.name() == rhs.name();
+            });
+    };
+
+    // retain the ids of platforms we keep, so section indexes remain valid
+    std::vector<bool> matched(m_platforms.size(), false);
+    for (auto &p : newPlatforms) {
+        p.id = m_nextId++;
+        for (std::size_t i = 0; i < m_platforms.size(); ++i) {
+            if (!matched[i] && isSamePlatform(m_platforms[i], p)) {
+                matched[i] = true;
+                p.id = m_platforms[i].id;
+                break;
+            }
+        }
+    }
+
+    // all labels change, so kept rows always need a data change notification, including their sections
+    ModelDiff::apply(this, m_platforms, std::move(newPlatforms), [](const PlatformEntry &entry) {
+        return (std::size_t)qHash(entry.platform.name());
+    }, isSamePlatform, [](const PlatformEntry&, const PlatformEntry&) { return false; });
+    for (int i = 0; i < rowCount(); ++i) {
+        const auto idx = index(i, 0);
+        if (const auto sectionCount = rowCount(idx); sectionCount > 0) {
+            Q_EMIT dataChanged(index(0, 0, idx), index(sectionCount - 1, 0, idx));
+        }
     }
-    endResetModel();
     Q_EMIT mapDataChanged();
     Q_EMIT platformIndexChanged();
 }
@@ -76,7 +117,7 @@ int PlatformModel::columnCount(const QModelIndex& parent) const
 int PlatformModel::rowCount(const QModelIndex &parent) const
 {
     if (parent.isValid()) {
-        return parent.internalId() == TOP_PARENT ? m_platforms[parent.row()].sections().size() : 0;
+        return parent.internalId() == TOP_PARENT ? m_platforms[parent.row()].platform.sections().size() : 0;
     }
 
     return m_platforms.size();
@@ -89,14 +130,14 @@ QVariant PlatformModel::data(const QModelIndex &index, int role) const
     }
 
     if (index.internalId() == TOP_PARENT) {
-        const auto &platform = m_platforms[index.row()];
+        const auto &platform = m_platforms[index.row()].platform;
         switch (role) {
             case Qt::DisplayRole:
                 return platform.name();
             case CoordinateRole:
                 return QPointF(platform.position().lonF(), platform.position().latF());
             case ElementRole:
-                return QVariant::fromValue(OSM::Element(m_platformLabels[index.row()]));
+                return QVariant::fromValue(OSM::Element(m_platforms[index.row()].label));
             case LevelRole:
                 return platform.level();
             case TransportModeRole:
@@ -109,7 +150,8 @@ QVariant PlatformModel::data(const QModelIndex &index, int role) const
                 return index.row() == m_departurePlatformRow;
         }
     } else {
-        const auto &platform = m_platforms[index.internalId()];
+        const auto &entry = m_platforms[rowForId(index.internalId())];
+        const auto &platform = entry.platform;
         const auto &section = platform.sections()[index.row()];
         switch (role) {
             case Qt::DisplayRole:
@@ -117,7 +159,7 @@ QVariant PlatformModel::data(const QModelIndex &index, int role) const
             case CoordinateRole:
                 return QPointF(section.position().center().lonF(), section.position().center().latF());
             case ElementRole:
-                return QVariant::fromValue(OSM::Element(m_sectionsLabels[index.internalId()][index.row()]));
+                return QVariant::fromValue(OSM::Element(entry.sectionLabels[index.row()]));
             case LevelRole:
                 return platform.level();
         }
@@ -131,7 +173,7 @@ QModelIndex PlatformModel::index(int row, int column, const QModelIndex &parent)
     if (!parent.isValid()) {
         return createIndex(row, column, TOP_PARENT);
     }
-    return createIndex(row, column, parent.row());
+    return createIndex(row, column, m_platforms[parent.row()].id);
 }
 
 QModelIndex PlatformModel::parent(const QModelIndex &child) const
@@ -139,7 +181,7 @@ QModelIndex PlatformModel::parent(const QModelIndex &child) const
     if (!child.isValid() || child.internalId() == TOP_PARENT) {
         return {};
     }
-    return createIndex(child.internalId(), 0, TOP_PARENT);
+    return createIndex(rowForId(child.internalId()), 0, TOP_PARENT);
 }
 
 QHash<int, QByteArray> PlatformModel::roleNames() const
@@ -243,7 +285,7 @@ int PlatformModel::matchPlatform(const Platform &platform) const
 {
     if (!platform.ifopt().isEmpty()) { // try IFOPT first, if we have that
         const auto it = std::find_if(m_platforms.begin(), m_platforms.end(), [platform](const auto &p) {
-            return p.ifopt() == platform.ifopt();
+            return p.platform.ifopt() == platform.ifopt();
         });
         if (it != m_platforms.end()) {
             return std::distance(m_platforms.begin(), it);
@@ -256,7 +298,8 @@ int PlatformModel::matchPlatform(const Platform &platform) const
 
     // exact match
     int i = 0;
-    for (const auto &p : m_platforms) {
+    for (const auto &entry : m_platforms) {
+        const auto &p = entry.platform;
         if (p.name() == platform.name() && p.mode() == platform.mode()) {
             return i;
         }
@@ -267,7 +310,8 @@ int PlatformModel::matchPlatform(const Platform &platform) const
     // TODO this likely will need to handle more scenarios
     // TODO when we get section ranges here, we might want to use those as well?
     i = 0;
-    for (const auto &p : m_platforms) {
+    for (const auto &entry : m_platforms) {
+        const auto &p = entry.platform;
         if (p.mode() == platform.mode() && isPossiblySamePlatformName(platform.name(), p.name())) {
             return i;
         }
@@ -277,32 +321,71 @@ int PlatformModel::matchPlatform(const Platform &platform) const
     return -1;
 }
 
-void PlatformModel::createLabels()
+std::vector<PlatformModel::PlatformEntry> PlatformModel::createLabels(std::vector<Platform> &&platforms)
 {
     const auto platformTag = m_data.dataSet().makeTagKey("mx:platform");
     const auto sectionTag = m_data.dataSet().makeTagKey("mx:platform_section");
 
-    m_platformLabels.reserve(m_platforms.size());
-    m_sectionsLabels.resize(m_platforms.size());
-    for (std::size_t i = 0; i < m_platforms.size(); ++i) {
-        const auto &p = m_platforms[i];
+    std::vector<PlatformEntry> entries;
+    entries.reserve(platforms.size());
+    for (auto &p : platforms) {
+        PlatformEntry entry;
 
         // TODO using the full edge/track path here might be better for layouting
         auto node = new OSM::Node;
         node->id = m_data.dataSet().nextInternalId();
         node->coordinate = p.position();
         OSM::setTagValue(*node, platformTag, p.name().toUtf8());
-        m_platformLabels.push_back(OSM::UniqueElement(node));
+        entry.label = OSM::UniqueElement(node);
 
-        m_sectionsLabels[i].reserve(p.sections().size());
+        entry.sectionLabels.reserve(p.sections().size());
         for (const auto &sec : p.sections()) {
             auto node = new OSM::Node;
             node->id = m_data.dataSet().nextInternalId();
             node->coordinate = sec.position().center();
             OSM::setTagValue(*node, sectionTag, sec.name().toUtf8());
-            m_sectionsLabels[i].push_back(OSM::UniqueElement(node));
+            entry.sectionLabels.push_back(OSM::UniqueElement(node));
+        }
+
+        entry.platform = std::move(p);
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+std::vector<PlatformModel::PlatformEntry> PlatformModel::copyLabels() const
+{
+    std::vector<PlatformEntry> entries;
+    entries.reserve(m_platforms.size());
+    for (const auto &p : m_platforms) {
+        PlatformEntry entry;
+        entry.platform = p.platform;
+        entry.label = OSM::copy_element(OSM::Element(p.label));
+        entry.sectionLabels.reserve(p.sectionLabels.size());
+        for (const auto &sec : p.sectionLabels) {
+            entry.sectionLabels.push_back(OSM::copy_element(OSM::Element(sec)));
         }
+        entry.id = p.id;
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+void PlatformModel::releaseLabels()
+{
+    // labels can still be referenced by the scene graph via the overlay sources using this model
+    for (auto &p : m_platforms) {
+        OverlayReclaimer::retire(m_labelsEpoch, std::move(p.label));
+        OverlayReclaimer::retire(m_labelsEpoch, std::move(p.sectionLabels));
     }
+    m_platforms.clear();
+}
+
+int PlatformModel::rowForId(quintptr id) const
+{
+    const auto it = std::find_if(m_platforms.begin(), m_platforms.end(), [id](const auto &p) { return p.id == id; });
+    Q_ASSERT(it != m_platforms.end());
+    return (int)std::distance(m_platforms.begin(), it);
 }
 
 void PlatformModel::setPlatformTag(int idx, OSM::TagKey key, bool enabled)
@@ -311,7 +394,7 @@ void PlatformModel::setPlatformTag(int idx, OSM::TagKey key, bool enabled)
         return;
     }
 
-    m_platformLabels[idx].setTagValue(key, enabled ? "1" : "0");
+    m_platforms[idx].label.setTagValue(key, enabled ? "1" : "0");
 }
 
 static QStringView stripPlatform(QStringView p)
@@ -363,20 +446,21 @@ void PlatformModel::applySectionSelection(int platformIdx, OSM::TagKey key, QStr
     const auto sectionSet = parseSectionSet(sections);
 
     std::size_t totalSelected = 0;
-    for (std::size_t i = 0; i < m_platforms[platformIdx].sections().size(); ++i) {
-        if (std::any_of(sectionSet.begin(), sectionSet.end(), [this, i, platformIdx](const QChar s) {
-            return s == m_platforms[platformIdx].sections()[i].name();
+    auto &entry = m_platforms[platformIdx];
+    for (std::size_t i = 0; i < entry.platform.sections().size(); ++i) {
+        if (std::any_of(sectionSet.begin(), sectionSet.end(), [&entry, i](const QChar s) {
+            return s == entry.platform.sections()[i].name();
         })) {
-            m_sectionsLabels[platformIdx][i].setTagValue(key, "1");
+            entry.sectionLabels[i].setTagValue(key, "1");
             ++totalSelected;
         } else {
-            m_sectionsLabels[platformIdx][i].setTagValue(key, "0");
+            entry.sectionLabels[i].setTagValue(key, "0");
         }
     }
 
     // if we enabled all sections, disable them again, highlighting adds no value then
-    if (totalSelected == m_sectionsLabels[platformIdx].size()) {
-        for (auto &s : m_sectionsLabels[platformIdx]) {
+    if (totalSelected == entry.sectionLabels.size()) {
+        for (auto &s : entry.sectionLabels) {
             s.setTagValue(key, "0");
         }
     }
@@ -10,6 +10,7 @@
 #include "kosmindoormap_export.h"
 
 #include <KOSMIndoorMap/MapData>
+#include <KOSMIndoorMap/OverlayReclaimer>
 #include <KOSMIndoorMap/Platform>
 
 #include <QAbstractItemModel>
@@ -80,24 +81,38 @@ Q_SIGNALS:
     void departurePlatformChanged();
 
 private:
+    friend class ModelDiff;
+
+    /** A platform along with its overlay labels. */
+    struct PlatformEntry {
+        Platform platform;
+        OSM::UniqueElement label;
+        std::vector<OSM::UniqueElement> sectionLabels;
+        /** Stable identifier used as internal id of the section indexes, independent of the row. */
+        quintptr id = 0;
+    };
+
     void matchPlatforms();
     int matchPlatform(const Platform &platform) const;
-    void createLabels();
+    [[nodiscard]] std::vector<PlatformEntry> createLabels(std::vector<Platform> &&platforms);
+    [[nodiscard]] std::vector<PlatformEntry> copyLabels() const;
+    void releaseLabels();
+    [[nodiscard]] int rowForId(quintptr id) const;
     void setPlatformTag(int idx, OSM::TagKey key, bool enabled);
 
     QStringView effectiveArrivalSections() const;
     QStringView effectiveDepartureSections() const;
     void applySectionSelection(int platformIdx, OSM::TagKey key, QStringView sections);
 
-    std::vector<Platform> m_platforms;
+    std::vector<PlatformEntry> m_platforms;
     MapData m_data;
     struct {
         OSM::TagKey arrival;
         OSM::TagKey departure;
     } m_tagKeys;
 
-    std::vector<OSM::UniqueElement> m_platformLabels;
-    std::vector<std::vector<OSM::UniqueElement>> m_sectionsLabels;
+    OverlayReclaimer::Epoch m_labelsEpoch = 0;
+    quintptr m_nextId = 0;
 
     Platform m_arrivalPlatform;
     Platform m_departurePlatform;
@@ -101,6 +101,7 @@ public:
     void setTimeZone(const QTimeZone &tz);
 
 private:
+    friend class MapLoaderPrivate;
     void processElements();
     void addElement(int level, OSM::Element e, bool isDependentElement);
     QString levelName(OSM::Element e);
@@ -24,6 +24,10 @@
 #include <QDateTime>
 #include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QRect>
@@ -62,9 +66,51 @@ public:
     std::deque<QUrl> m_pendingChangeSets;
 
     QString m_errorMessage;
+
+    // identifies the requested data, for sharing it with other loaders
+    QString m_cacheKey;
+    void shareData();
+};
+}
+
+namespace {
+// loaded map data shared between all loaders requesting the same data, as long as anyone uses it
+struct MapDataRegistry {
+    QMutex mutex;
+    QHash<QString, std::weak_ptr<KOSMIndoorMap::MapDataPrivate>> entries;
 };
 }
 
+static MapDataRegistry& mapDataRegistry()
+{
+    static MapDataRegistry s_registry;
+    return s_registry;
+}
+
+void KOSMIndoorMap::MapLoaderPrivate::shareData()
+{
+    if (m_cacheKey.isEmpty() || m_data.isEmpty()) {
+        return;
+    }
+
+    auto &registry = mapDataRegistry();
+    QMutexLocker locker(&registry.mutex);
+    for (auto it = registry.entries.begin(); it != registry.entries.end();) {
+        if (it.value().expired()) {
+            it = registry.entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    auto &entry = registry.entries[m_cacheKey];
+    if (auto data = entry.lock()) {
+        m_data.d = std::move(data);
+    } else {
+        entry = m_data.d;
+    }
+}
+
 using namespace KOSMIndoorMap;
 
 MapLoader::MapLoader(QObject *parent)
@@ -86,19 +132,35 @@ void MapLoader::loadFromFile(const QString &fileName)
 
     d->m_errorMessage.clear();
     QFile f(fileName.contains(QLatin1Char(':')) ? QUrl::fromUserInput(fileName).toLocalFile() : fileName);
+    const QFileInfo fi(f);
+    d->m_cacheKey = "file:"_L1 + fi.canonicalFilePath() + u'@' + QString::number(fi.lastModified().toMSecsSinceEpoch());
+    d->m_data = MapData();
+    // errors are reported asynchronously as well, so done() is emitted in any case
     if (!f.open(QFile::ReadOnly)) {
         qCritical() << f.fileName() << f.errorString();
+        d->m_errorMessage = f.errorString();
+        QMetaObject::invokeMethod(this, &MapLoader::applyNextChangeSet, Qt::QueuedConnection);
         return;
     }
     const auto data = f.map(0, f.size());
+    if (!data) {
+        qCritical() << "Failed to mmap file!" << f.fileName() << f.errorString();
+        d->m_errorMessage = f.errorString();
+        QMetaObject::invokeMethod(this, &MapLoader::applyNextChangeSet, Qt::QueuedConnection);
+        return;
+    }
 
     auto reader = OSM::IO::readerForFileName(fileName, &d->m_dataSet);
     if (!reader) {
         qCWarning(Log) << "no file reader for" << fileName;
+        d->m_errorMessage = u"No reader for file format: "_s + fileName;
+        QMetaObject::invokeMethod(this, &MapLoader::applyNextChangeSet, Qt::QueuedConnection);
         return;
     }
     reader->read(data, f.size());
-    d->m_data = MapData();
+    if (reader->hasError()) {
+        d->m_errorMessage = reader->errorString();
+    }
     qCDebug(Log) << "o5m loading took" << loadTime.elapsed() << "ms";
     QMetaObject::invokeMethod(this, &MapLoader::applyNextChangeSet, Qt::QueuedConnection);
 }
@@ -119,6 +181,7 @@ void MapLoader::loadForCoordinate(double lat, double lon, const QDateTime &ttl)
     d->m_errorMessage.clear();
     d->m_marbleMerger.setDataSet(&d->m_dataSet);
     d->m_data = MapData();
+    d->m_cacheKey = "coord:"_L1 + QString::number(lat, 'f', 7) + u',' + QString::number(lon, 'f', 7);
 
     auto tile = Tile::fromCoordinate(lat, lon, TileZoomLevel);
     d->m_loadedTiles = QRect(tile.x, tile.y, 1, 1);
@@ -135,6 +198,8 @@ void MapLoader::loadForBoundingBox(OSM::BoundingBox box)
     d->m_errorMessage.clear();
     d->m_marbleMerger.setDataSet(&d->m_dataSet);
     d->m_data = MapData();
+    d->m_cacheKey = "bbox:"_L1 + QString::number(box.min.latF(), 'f', 7) + u',' + QString::number(box.min.lonF(), 'f', 7)
+        + u',' + QString::number(box.max.latF(), 'f', 7) + u',' + QString::number(box.max.lonF(), 'f', 7);
 
     const auto topLeftTile = Tile::fromCoordinate(box.min.latF(), box.min.lonF(), TileZoomLevel);
     const auto bottomRightTile = Tile::fromCoordinate(box.max.latF(), box.max.lonF(), TileZoomLevel);
@@ -160,6 +225,7 @@ void MapLoader::loadForTile(Tile tile)
     d->m_errorMessage.clear();
     d->m_marbleMerger.setDataSet(&d->m_dataSet);
     d->m_data = MapData();
+    d->m_cacheKey = "tile:"_L1 + QString::number(tile.z) + u'/' + QString::number(tile.x) + u'/' + QString::number(tile.y);
 
     if (tile.z >= TileZoomLevel) {
         d->m_pendingTiles.push_back(std::move(tile));
@@ -179,6 +245,7 @@ void MapLoader::loadForTile(Tile tile)
 void MapLoader::addChangeSet(const QUrl &url)
 {
     d->m_pendingChangeSets.push_back(url);
+    d->m_cacheKey += u'+' + url.toString();
 }
 
 MapData&& MapLoader::takeData()
@@ -318,10 +385,14 @@ QString MapLoader::errorMessage() const
 void MapLoader::applyNextChangeSet()
 {
     if (d->m_pendingChangeSets.empty() || hasError()) {
+        d->m_pendingChangeSets.clear();
         d->m_data.setDataSet(std::move(d->m_dataSet));
         if (d->m_targetBbox.isValid()) {
             d->m_data.setBoundingBox(d->m_targetBbox);
         }
+        if (!hasError()) {
+            d->shareData();
+        }
 
         Q_EMIT isLoadingChanged();
         Q_EMIT done();
@@ -59,6 +59,8 @@ public:
 
     /** Take out the completely loaded result.
      *  Do this before loading the next map with the same loader.
+     *  Loading the same data again while a previous result is still in use
+     *  returns that instance, so views of the same map share their data.
      */
     MapData&& takeData();
 
@@ -7,6 +7,8 @@
 #include "painterrenderer.h"
 #include "stackblur_p.h"
 #include "render-logging.h"
+#include "../scene/scenegraph_p.h"
+#include "../scene/textlayoutcache_p.h"
 
 #include <KOSMIndoorMap/SceneGraph>
 #include <KOSMIndoorMap/View>
@@ -18,6 +20,7 @@
 #include <QImage>
 #include <QLinearGradient>
 #include <QPainter>
+#include <QRegion>
 
 #include <cmath>
 
@@ -40,6 +43,16 @@ void PainterRenderer::render(const SceneGraph &sg, View *view)
     beginRender();
     renderBackground(sg.backgroundColor());
 
+    // partial repaint: only consider items intersecting the area the caller restricted painting to
+    const QRectF screenRect(QPointF(0, 0), QSizeF(m_view->screenWidth(), m_view->screenHeight()));
+    const auto damageRect = m_painter->hasClipping() ? m_painter->clipBoundingRect().intersected(screenRect) : screenRect;
+    const auto partialRender = damageRect != screenRect;
+    const auto damageRegion = partialRender ? m_painter->clipRegion() : QRegion();
+    const auto sceneRect = partialRender
+        ? QRectF(m_view->mapScreenToScene(damageRect.topLeft()), m_view->mapScreenToScene(damageRect.bottomRight())).normalized()
+        : m_view->viewport();
+
+    m_painter->save();
     for (const auto &layerOffsets : sg.layerOffsets()) {
         const auto layerBegin = sg.itemsBegin(layerOffsets);
         const auto layerEnd = sg.itemsEnd(layerOffsets);
@@ -48,11 +61,11 @@ void PainterRenderer::render(const SceneGraph &sg, View *view)
         // select elements currently in view
         m_renderBatch.clear();
         m_renderBatch.reserve(layerOffsets.second - layerOffsets.first);
-        const QRectF screenRect(QPointF(0, 0), QSizeF(m_view->screenWidth(), m_view->screenHeight()));
         for (auto it = layerBegin; it != layerEnd; ++it) {
-            if ((*it).payload->inSceneSpace() && m_view->viewport().intersects((*it).payload->boundingRect(view))) {
+            if ((*it).payload->inSceneSpace() && sceneRect.intersects((*it).payload->boundingRect(view))) {
                 m_renderBatch.push_back((*it).payload.get());
             }
+            // labels outside of the damaged area still need to be considered for collision detection
             if ((*it).payload->inHUDSpace()) {
                 auto bbox = (*it).payload->boundingRect(view);
                 bbox.moveCenter(m_view->mapSceneToScreen(bbox.center()));
@@ -78,14 +91,17 @@ void PainterRenderer::render(const SceneGraph &sg, View *view)
                 } else if (auto i = dynamic_cast<PolylineItem*>(item)) {
                     renderPolyline(i, phase);
                 } else if (auto i = dynamic_cast<LabelItem*>(item)) {
+                    if (partialRender && !damageRegion.intersects(i->screenBoundingRect(m_view).toAlignedRect())) {
+                        continue;
+                    }
                     // skip if a higher up item would overlap this one, unless that is explicitly allowed
                     if (phase == SceneGraphItemPayload::IconPhase) {
                         if (!i->iconHidden) {
-                            renderLabel(i, phase);
+                            renderLabel(sg, i, phase);
                         }
                     } else if (phase == SceneGraphItemPayload::LabelPhase) {
                         if (!i->textHidden) {
-                            renderLabel(i, phase);
+                            renderLabel(sg, i, phase);
                         }
                     }
                 } else {
@@ -94,6 +110,7 @@ void PainterRenderer::render(const SceneGraph &sg, View *view)
             }
         }
     }
+    m_painter->restore();
 
     renderForeground(sg.backgroundColor());
     endRender();
@@ -121,14 +138,14 @@ void PainterRenderer::beginPhase(SceneGraphItemPayload::RenderPhase phase)
         case SceneGraphItemPayload::FillPhase:
             m_painter->setPen(Qt::NoPen);
             m_painter->setTransform(m_view->sceneToScreenTransform() * m_view->deviceTransform());
-            m_painter->setClipRect(m_view->viewport().intersected(m_view->sceneBoundingBox()));
+            m_painter->setClipRect(m_view->viewport().intersected(m_view->sceneBoundingBox()), Qt::IntersectClip);
             m_painter->setRenderHint(QPainter::Antialiasing, false);
             break;
         case SceneGraphItemPayload::CasingPhase:
         case SceneGraphItemPayload::StrokePhase:
             m_painter->setBrush(Qt::NoBrush);
             m_painter->setTransform(m_view->sceneToScreenTransform() * m_view->deviceTransform());
-            m_painter->setClipRect(m_view->viewport().intersected(m_view->sceneBoundingBox()));
+            m_painter->setClipRect(m_view->viewport().intersected(m_view->sceneBoundingBox()), Qt::IntersectClip);
             m_painter->setRenderHint(QPainter::Antialiasing, true);
             break;
         case SceneGraphItemPayload::IconPhase:
@@ -365,7 +382,7 @@ void PainterRenderer::renderPolyline(PolylineItem *item, SceneGraphItemPayload::
     }
 }
 
-void PainterRenderer::renderLabel(LabelItem *item, SceneGraphItemPayload::RenderPhase phase)
+void PainterRenderer::renderLabel(const SceneGraph &sg, LabelItem *item, SceneGraphItemPayload::RenderPhase phase)
 {
     m_painter->save();
     m_painter->translate(m_view->mapSceneToScreen(item->pos));
@@ -413,8 +430,11 @@ void PainterRenderer::renderLabel(LabelItem *item, SceneGraphItemPayload::Render
     }
     box.moveTop(box.top() + item->textOffset);
 
-    // center-align the text (item->text.size().width() != item->textOutputSize()...)
-    box.setWidth(item->text.size().width());
+    // center-align the text
+    const auto &layouts = SceneGraphPrivate::get(sg)->m_textLayouts;
+    const std::shared_ptr<const TextLayout> textLayout = layouts ? layouts->layout(item->text.text(), item->font, item->text.textWidth())
+                                                                 : TextLayoutCache::createLayout(item->text.text(), item->font, item->text.textWidth());
+    box.setWidth(textLayout->size.width());
     box.moveCenter({0.0, box.center().y()});
 
     if (item->hasText() && (phase == SceneGraphItemPayload::LabelPhase || item->hasShield())) {
@@ -428,11 +448,7 @@ void PainterRenderer::renderLabel(LabelItem *item, SceneGraphItemPayload::Render
             haloPainter.setFont(item->font);
             auto haloTextRect = box;
             haloTextRect.moveTopLeft({item->haloRadius, item->haloRadius});
-            if (!item->isComplexText) {
-                haloPainter.drawStaticText(haloTextRect.topLeft(), item->text);
-            } else {
-                haloPainter.drawText(haloTextRect, item->text.text(), item->text.textOption());
-            }
+            textLayout->draw(&haloPainter, haloTextRect.topLeft());
             StackBlur::blur(haloBuffer, item->haloRadius);
             haloPainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
             haloPainter.fillRect(haloBuffer.rect(), item->haloColor);
@@ -442,11 +458,7 @@ void PainterRenderer::renderLabel(LabelItem *item, SceneGraphItemPayload::Render
         // draw text
         m_painter->setPen(item->color);
         m_painter->setFont(item->font);
-        if (!item->isComplexText) {
-            m_painter->drawStaticText(box.topLeft(), item->text);
-        } else {
-            m_painter->drawText(box, item->text.text(), item->text.textOption());
-        }
+        textLayout->draw(m_painter, box.topLeft());
     }
 
     m_painter->restore();
@@ -456,7 +468,7 @@ void PainterRenderer::renderForeground(const QColor &bgColor)
 {
     // fade out the map at the end of the scene box, to indicate you can't scroll further
     m_painter->setTransform(m_view->deviceTransform());
-    m_painter->setClipRect(m_view->mapSceneToScreen(m_view->viewport()));
+    m_painter->setClipRect(m_view->mapSceneToScreen(m_view->viewport()), Qt::IntersectClip);
     const auto borderWidth = 10;
 
     QColor c(bgColor);
@@ -28,6 +28,10 @@ public:
     ~PainterRenderer();
 
     void setPainter(QPainter *painter);
+    /** Renders @p sg.
+     *  If the painter has clipping enabled only the clipped area is rendered, this allows
+     *  to repaint just the area affected by a partial scene update (see SceneController::damage()).
+     */
     void render(const SceneGraph &sg, View *view);
 
 private:
@@ -38,7 +42,7 @@ private:
     void renderPolygon(PolygonItem *item, SceneGraphItemPayload::RenderPhase phase);
     void renderMultiPolygon(MultiPolygonItem *item, SceneGraphItemPayload::RenderPhase phase);
     void renderPolyline(PolylineItem *item, SceneGraphItemPayload::RenderPhase phase);
-    void renderLabel(LabelItem *item, SceneGraphItemPayload::RenderPhase phase);
+    void renderLabel(const SceneGraph &sg, LabelItem *item, SceneGraphItemPayload::RenderPhase phase);
     void renderForeground(const QColor &bgColor);
     void endRender();
 
@@ -10,9 +10,9 @@
 #include <QByteArray>
 #include <QDebug>
 #include <QFile>
-#include <QGuiApplication>
 #include <QIconEngine>
 #include <QImageReader>
+#include <QMutexLocker>
 #include <QPainter>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
@@ -35,12 +35,15 @@ public:
     {
         Q_UNUSED(mode);
         Q_UNUSED(state);
+        QMutexLocker locker(&m_mutex);
         return { m_sourceSize.isValid() ? m_sourceSize : m_image.size() / m_image.devicePixelRatio() };
     }
 
     QIconEngine* clone() const override
     {
         auto engine = new IconEngine;
+        engine->m_iconData = m_iconData;
+        QMutexLocker locker(&m_mutex);
         engine->m_image = m_image;
         return engine;
     }
@@ -54,6 +57,8 @@ private:
     QImage renderStyledSvg(QIODevice *svgFile, const QSizeF &size);
 
     IconData m_iconData;
+    // icons are shared between scene controllers, which can paint from different threads
+    mutable QMutex m_mutex;
     QImage m_image;
     QSize m_sourceSize;
 };
@@ -62,6 +67,9 @@ static bool operator<(const IconData &lhs, const IconData &rhs)
 {
     if (lhs.name == rhs.name) {
         if (lhs.color.rgb() == rhs.color.rgb()) {
+            if (lhs.size.width() == rhs.size.width()) {
+                return lhs.devicePixelRatio < rhs.devicePixelRatio;
+            }
             return lhs.size.width() < rhs.size.width();
         }
         return lhs.color.rgb() < rhs.color.rgb();
@@ -71,12 +79,13 @@ static bool operator<(const IconData &lhs, const IconData &rhs)
 
 static bool operator==(const IconData &lhs, const IconData &rhs)
 {
-    return lhs.name == rhs.name && lhs.color == rhs.color && lhs.size == rhs.size;
+    return lhs.name == rhs.name && lhs.color == rhs.color && lhs.size == rhs.size && lhs.devicePixelRatio == rhs.devicePixelRatio;
 }
 
 QIcon IconLoader::loadIcon(const IconData &iconData) const
 {
     // check our cache
+    QMutexLocker locker(&m_mutex);
     auto it = std::lower_bound(m_cache.begin(), m_cache.end(), iconData, [](const auto &lhs, const auto &rhs) { return lhs.data < rhs; });
     if (it != m_cache.end() && (*it).data == iconData) {
         return (*it).icon;
@@ -103,6 +112,20 @@ QIcon IconLoader::loadIcon(const IconData &iconData) const
     return icon;
 }
 
+std::shared_ptr<IconLoader> IconLoader::shared()
+{
+    static QMutex s_mutex;
+    static std::weak_ptr<IconLoader> s_instance;
+
+    QMutexLocker locker(&s_mutex);
+    auto loader = s_instance.lock();
+    if (!loader) {
+        loader = std::make_shared<IconLoader>();
+        s_instance = loader;
+    }
+    return loader;
+}
+
 QString IconEngine::findSvgAsset(const QString &name)
 {
     return QLatin1String(":/org.kde.kosmindoormap/assets/icons/") + name + QLatin1String(".svg");
@@ -111,6 +134,7 @@ QString IconEngine::findSvgAsset(const QString &name)
 void IconEngine::paint(QPainter *painter, const QRect &rect, [[maybe_unused]] QIcon::Mode mode, [[maybe_unused]] QIcon::State state)
 {
     // check if our pre-rendered image cache has a resolution high enough for this
+    QMutexLocker locker(&m_mutex);
     const auto threshold = std::max<int>(1, std::max(m_image.width(), m_image.height()) * 0.25);
     if (rect.width() > m_image.width() + threshold || rect.height() > m_image.height() + threshold) {
         QFile f(findSvgAsset(m_iconData.name));
@@ -155,8 +179,8 @@ QImage IconEngine::renderStyledSvg(QIODevice *svgFile, const QSizeF &size)
     buffer.seek(0);
     QImageReader imgReader(&buffer, "svg");
     m_sourceSize = imgReader.size();
-    imgReader.setScaledSize((size.isValid() ? size.toSize() : imgReader.size()) * qGuiApp->devicePixelRatio());
+    imgReader.setScaledSize((size.isValid() ? size.toSize() : imgReader.size()) * m_iconData.devicePixelRatio);
     auto img = imgReader.read();
-    img.setDevicePixelRatio(qGuiApp->devicePixelRatio());
+    img.setDevicePixelRatio(m_iconData.devicePixelRatio);
     return img;
 }
@@ -9,9 +9,11 @@
 
 #include <QColor>
 #include <QIcon>
+#include <QMutex>
 #include <QSizeF>
 #include <QString>
 
+#include <memory>
 #include <vector>
 
 class QIODevice;
@@ -24,6 +26,8 @@ public:
     QString name;
     QSizeF size;
     QColor color;
+    /** Device pixel ratio of the target the icon is drawn on. */
+    qreal devicePixelRatio = 1.0;
 };
 
 /** Load (colorized) icons for display on the map from various sources. */
@@ -32,11 +36,15 @@ class IconLoader
 public:
     QIcon loadIcon(const IconData &iconData) const;
 
+    /** Process-wide icon loader instance, shared between all scene controllers. */
+    [[nodiscard]] static std::shared_ptr<IconLoader> shared();
+
 private:
     struct CacheEntry {
         IconData data;
         QIcon icon;
     };
+    mutable QMutex m_mutex;
     mutable std::vector<CacheEntry> m_cache;
 };
 
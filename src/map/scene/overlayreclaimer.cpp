@@ -0,0 +1,144 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "overlayreclaimer.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+using namespace KOSMIndoorMap;
+
+namespace {
+struct Garbage {
+    OverlayReclaimer::Epoch birth;
+    OverlayReclaimer::Epoch death;
+    std::shared_ptr<void> elements;
+    std::size_t count;
+};
+
+struct ReclaimerState {
+    QMutex mutex;
+    OverlayReclaimer::Epoch epoch = 1;
+    int nextReaderId = 1;
+    // epochs of the reads whose references might still be in use, per reader
+    std::unordered_map<int, std::vector<OverlayReclaimer::Epoch>> readers;
+    std::vector<Garbage> garbage;
+
+    [[nodiscard]] bool isReferenced(const Garbage &g) const
+    {
+        return std::any_of(readers.begin(), readers.end(), [&g](const auto &reader) {
+            return std::any_of(reader.second.begin(), reader.second.end(), [&g](auto epoch) {
+                return g.birth < epoch && epoch <= g.death;
+            });
+        });
+    }
+
+    void collect()
+    {
+        garbage.erase(std::remove_if(garbage.begin(), garbage.end(), [this](const auto &g) { return !isReferenced(g); }), garbage.end());
+    }
+
+    void retire(Garbage &&g)
+    {
+        QMutexLocker locker(&mutex);
+        g.death = epoch;
+        if (isReferenced(g)) {
+            garbage.push_back(std::move(g));
+        }
+    }
+};
+}
+
+static ReclaimerState& state()
+{
+    static ReclaimerState s_state;
+    return s_state;
+}
+
+OverlayReclaimer::Epoch OverlayReclaimer::currentEpoch()
+{
+    QMutexLocker locker(&state().mutex);
+    return state().epoch;
+}
+
+void OverlayReclaimer::retireImpl(Epoch birth, std::shared_ptr<void> &&elements, std::size_t count)
+{
+    state().retire(Garbage{birth, 0, std::move(elements), count});
+}
+
+std::size_t OverlayReclaimer::pendingCount()
+{
+    QMutexLocker locker(&state().mutex);
+    std::size_t count = 0;
+    for (const auto &g : state().garbage) {
+        count += g.count;
+    }
+    return count;
+}
+
+
+OverlayReclaimer::Reader::Reader()
+{
+    QMutexLocker locker(&state().mutex);
+    m_id = state().nextReaderId++;
+    state().readers[m_id];
+}
+
+OverlayReclaimer::Reader::Reader(Reader &&other) noexcept
+{
+    std::swap(m_id, other.m_id);
+}
+
+OverlayReclaimer::Reader::~Reader()
+{
+    if (m_id) {
+        QMutexLocker locker(&state().mutex);
+        state().readers.erase(m_id);
+        state().collect();
+    }
+}
+
+OverlayReclaimer::Reader& OverlayReclaimer::Reader::operator=(Reader &&other) noexcept
+{
+    std::swap(m_id, other.m_id);
+    return *this;
+}
+
+void OverlayReclaimer::Reader::beginRead()
+{
+    if (!m_id) {
+        return;
+    }
+    QMutexLocker locker(&state().mutex);
+    state().readers[m_id].push_back(++state().epoch);
+}
+
+void OverlayReclaimer::Reader::endRead()
+{
+    if (!m_id) {
+        return;
+    }
+    QMutexLocker locker(&state().mutex);
+    auto &epochs = state().readers[m_id];
+    if (epochs.size() > 1) {
+        epochs.erase(epochs.begin(), std::prev(epochs.end()));
+        state().collect();
+    }
+}
+
+void OverlayReclaimer::Reader::clear()
+{
+    if (!m_id) {
+        return;
+    }
+    QMutexLocker locker(&state().mutex);
+    state().readers[m_id].clear();
+    state().collect();
+}
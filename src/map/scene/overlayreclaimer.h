@@ -0,0 +1,91 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORMAP_OVERLAYRECLAIMER_H
+#define KOSMINDOORMAP_OVERLAYRECLAIMER_H
+
+#include "kosmindoormap_export.h"
+
+#include <KOSM/Element>
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace KOSMIndoorMap {
+
+/** Epoch-based deferred deletion of dynamically created overlay elements.
+ *
+ *  Overlay sources and models creating their own OSM elements can't delete those
+ *  immediately when they are replaced, as scene graphs might still reference them.
+ *  Instead, they record the epoch at which elements were created and hand them over
+ *  here when they are no longer needed.
+ *
+ *  Every scene graph swap starts a new epoch. Retired elements are deleted once no scene
+ *  graph built between their creation and their retirement is still in use. Elements
+ *  that were never displayed are therefore deleted immediately, and the number of pending
+ *  elements is bounded by what the current scene graphs show.
+ */
+class KOSMINDOORMAP_EXPORT OverlayReclaimer
+{
+public:
+    using Epoch = uint64_t;
+
+    /** The current epoch, to be recorded when creating overlay elements. */
+    [[nodiscard]] static Epoch currentEpoch();
+
+    /** Hand over elements created at @p birth that are no longer part of an overlay.
+     *  @p elements is anything owning those elements, such as an OSM::UniqueElement or
+     *  a container of OSM::UniqueElement or OSM::Node. It is moved from, so the addresses
+     *  of elements held by a container remain valid.
+     */
+    template <typename T>
+    static void retire(Epoch birth, T &&elements)
+    {
+        static_assert(!std::is_lvalue_reference_v<T>, "elements must be handed over as rvalue");
+        std::size_t count = 1;
+        if constexpr (requires { elements.size(); }) {
+            count = elements.size();
+        } else {
+            count = elements ? 1 : 0;
+        }
+        if (count > 0) {
+            retireImpl(birth, std::make_shared<T>(std::move(elements)), count);
+        }
+    }
+
+    /** Number of retired elements not deleted yet. */
+    [[nodiscard]] static std::size_t pendingCount();
+
+    /** Registration handle for something referencing overlay elements, such as a scene graph. */
+    class KOSMINDOORMAP_EXPORT Reader
+    {
+    public:
+        explicit Reader();
+        Reader(const Reader&) = delete;
+        Reader(Reader &&other) noexcept;
+        ~Reader();
+        Reader& operator=(const Reader&) = delete;
+        Reader& operator=(Reader &&other) noexcept;
+
+        /** Starts reading overlay elements, ie. building a new scene graph. */
+        void beginRead();
+        /** Done reading, anything referenced from reads before this point is released. */
+        void endRead();
+        /** Releases all references. */
+        void clear();
+
+    private:
+        int m_id = 0;
+    };
+
+private:
+    static void retireImpl(Epoch birth, std::shared_ptr<void> &&elements, std::size_t count);
+};
+
+}
+
+#endif // KOSMINDOORMAP_OVERLAYRECLAIMER_H
@@ -9,6 +9,10 @@
 #include <QAbstractItemModel>
 #include <QDebug>
 
+#include <algorithm>
+#include <map>
+#include <set>
+
 using namespace KOSMIndoorMap;
 
 namespace KOSMIndoorMap
@@ -16,17 +20,58 @@ namespace KOSMIndoorMap
 class AbstractOverlaySourcePrivate {
 public:
     virtual ~AbstractOverlaySourcePrivate() = default;
+
+    void addChangedElement(OSM::Element element);
+
+    std::function<const std::vector<OSM::Element>*(int)> m_elementsForFloor;
+
+    // elements changed since the last scene graph update, unless m_allChanged is set
+    std::vector<OSM::Element> m_changedElements;
+    bool m_changesReported = false;
+    bool m_allChanged = true;
 };
 
 class ModelOverlaySourcePrivate : public AbstractOverlaySourcePrivate {
 public:
     ~ModelOverlaySourcePrivate() override = default;
-    void recursiveForEach(const QModelIndex &rootIdx, int floorLevel, const std::function<void (OSM::Element, int)> &func) const;
+
+    /** Cached content of a model row. */
+    struct Row {
+        OSM::Element element;
+        OSM::Element hiddenElement;
+        int floorLevel = 0;
+        std::vector<Row> children;
+    };
+
+    [[nodiscard]] const std::vector<OSM::Element>* elementsForFloor(int floorLevel) const;
+
+    [[nodiscard]] Row readRow(const QModelIndex &idx) const;
+    [[nodiscard]] std::vector<Row> readRows(const QModelIndex &parentIdx, int first, int last) const;
+
+    void reloadRows();
+    void insertRows(const QModelIndex &parentIdx, int first, int last);
+    void removeRows(const QModelIndex &parentIdx, int first, int last);
+    void updateRows(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+
+    /** Marks the per-floor lists affected by @p row as outdated. */
+    void setRowDirty(const Row &row);
+    void addChangedElements(const Row &row);
+    void setRowsDirty(std::vector<Row>::const_iterator begin, std::vector<Row>::const_iterator end);
+    /** Rebuilds the outdated per-floor element lists. */
+    void updateFloorElements() const;
+    static void addFloorElements(const Row &row, int floorLevel, std::vector<OSM::Element> &elems);
 
     QPointer<QAbstractItemModel> m_model;
     int m_elementRole = -1;
     int m_floorRole = -1;
     int m_hiddenElementRole = -1;
+
+    std::vector<Row> m_rows;
+    mutable std::map<int, std::vector<OSM::Element>> m_floorElements;
+    mutable std::vector<OSM::Element> m_hiddenElements;
+    mutable std::set<int> m_dirtyFloors;
+    mutable bool m_hiddenElementsDirty = false;
+    mutable bool m_allDirty = true;
 };
 
 }
@@ -38,12 +83,33 @@ AbstractOverlaySource::AbstractOverlaySource(QObject *parent)
 
 AbstractOverlaySource::AbstractOverlaySource(AbstractOverlaySourcePrivate *dd, QObject *parent)
     : QObject(parent)
-    , d_ptr(dd)
+    , d_ptr(dd ? dd : new AbstractOverlaySourcePrivate) // sub-classes without private data pass nullptr here
 {
+    // connected first, so this runs before any receiver updates the scene
+    connect(this, &AbstractOverlaySource::update, this, [this]() {
+        Q_D(AbstractOverlaySource);
+        if (!d->m_changesReported) {
+            d->m_allChanged = true;
+            d->m_changedElements.clear();
+        }
+        d->m_changesReported = false;
+    });
 }
 
 AbstractOverlaySource::~AbstractOverlaySource() = default;
 
+const std::vector<OSM::Element>* AbstractOverlaySource::elementsForFloor(int floorLevel) const
+{
+    Q_D(const AbstractOverlaySource);
+    return d->m_elementsForFloor ? d->m_elementsForFloor(floorLevel) : nullptr;
+}
+
+void AbstractOverlaySource::setElementsForFloorFunction(std::function<const std::vector<OSM::Element>*(int)> &&func)
+{
+    Q_D(AbstractOverlaySource);
+    d->m_elementsForFloor = std::move(func);
+}
+
 void AbstractOverlaySource::beginSwap()
 {
 }
@@ -61,6 +127,32 @@ const std::vector<OSM::Node>* AbstractOverlaySource::transientNodes() const
     return nullptr;
 }
 
+bool AbstractOverlaySource::takeChangedElements(std::vector<OSM::Element> &elems)
+{
+    Q_D(AbstractOverlaySource);
+    const auto allChanged = d->m_allChanged;
+    if (!allChanged) {
+        elems.insert(elems.end(), d->m_changedElements.begin(), d->m_changedElements.end());
+    }
+    d->m_changedElements.clear();
+    d->m_allChanged = false;
+    return !allChanged;
+}
+
+void AbstractOverlaySource::addChangedElement(OSM::Element element)
+{
+    Q_D(AbstractOverlaySource);
+    d->addChangedElement(element);
+}
+
+void AbstractOverlaySourcePrivate::addChangedElement(OSM::Element element)
+{
+    m_changesReported = true;
+    if (!m_allChanged && element.type() != OSM::Type::Null) {
+        m_changedElements.push_back(element);
+    }
+}
+
 
 ModelOverlaySource::ModelOverlaySource(QAbstractItemModel *model, QObject *parent)
     : AbstractOverlaySource(new ModelOverlaySourcePrivate, parent)
@@ -81,58 +173,221 @@ ModelOverlaySource::ModelOverlaySource(QAbstractItemModel *model, QObject *paren
         return;
     }
     d->m_model = model;
+    d->reloadRows();
+    setElementsForFloorFunction([d](int floorLevel) { return d->elementsForFloor(floorLevel); });
 
-    connect(model, &QAbstractItemModel::modelReset, this, &ModelOverlaySource::update);
-    connect(model, &QAbstractItemModel::rowsInserted, this, &ModelOverlaySource::update);
-    connect(model, &QAbstractItemModel::rowsRemoved, this, &ModelOverlaySource::update);
-    connect(model, &QAbstractItemModel::dataChanged, this, &ModelOverlaySource::update);
-
-    connect(model, &QAbstractItemModel::modelReset, this, &ModelOverlaySource::reset);
+    connect(model, &QAbstractItemModel::modelReset, this, [this]() {
+        Q_D(ModelOverlaySource);
+        d->reloadRows();
+        Q_EMIT update();
+        Q_EMIT reset();
+    });
+    connect(model, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &parentIdx, int first, int last) {
+        Q_D(ModelOverlaySource);
+        d->insertRows(parentIdx, first, last);
+        Q_EMIT update();
+    });
+    connect(model, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex &parentIdx, int first, int last) {
+        Q_D(ModelOverlaySource);
+        d->removeRows(parentIdx, first, last);
+        Q_EMIT update();
+    });
+    connect(model, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        Q_D(ModelOverlaySource);
+        d->updateRows(topLeft, bottomRight);
+        Q_EMIT update();
+    });
+    connect(model, &QAbstractItemModel::rowsMoved, this, [this]() {
+        Q_D(ModelOverlaySource);
+        d->reloadRows();
+        Q_EMIT update();
+    });
+    connect(model, &QAbstractItemModel::layoutChanged, this, [this]() {
+        Q_D(ModelOverlaySource);
+        d->reloadRows();
+        Q_EMIT update();
+    });
 }
 
 ModelOverlaySource::~ModelOverlaySource() = default;
 
 void ModelOverlaySource::forEach(int floorLevel, const std::function<void (OSM::Element, int)> &func) const
+{
+    const auto elems = elementsForFloor(floorLevel);
+    if (!elems) {
+        return;
+    }
+    for (auto elem : *elems) {
+        func(elem, floorLevel);
+    }
+}
+
+
+void ModelOverlaySource::hiddenElements(std::vector<OSM::Element> &elems) const
 {
     Q_D(const ModelOverlaySource);
-    if (!d->m_model) {
+    if (!d->m_model || d->m_hiddenElementRole < 0) {
         return;
     }
 
-    d->recursiveForEach({}, floorLevel, func);
+    d->updateFloorElements();
+    elems.insert(elems.end(), d->m_hiddenElements.begin(), d->m_hiddenElements.end());
 }
 
-void ModelOverlaySourcePrivate::recursiveForEach(const QModelIndex &rootIdx, int floorLevel, const std::function<void (OSM::Element, int)> &func) const
+const std::vector<OSM::Element>* ModelOverlaySourcePrivate::elementsForFloor(int floorLevel) const
 {
-    const auto rows = m_model->rowCount(rootIdx);
-    for (int i = 0; i < rows; ++i) {
-        const auto idx = m_model->index(i, 0, rootIdx);
-        const auto floor = idx.data(m_floorRole).toInt();
-        if (floor != floorLevel) {
-            continue;
-        }
+    if (!m_model) {
+        return nullptr;
+    }
 
-        recursiveForEach(idx, floorLevel, func);
+    updateFloorElements();
+    const auto it = m_floorElements.find(floorLevel);
+    if (it == m_floorElements.end()) {
+        static const std::vector<OSM::Element> s_empty;
+        return &s_empty;
+    }
+    return &(*it).second;
+}
 
-        const auto elem = idx.data(m_elementRole).value<OSM::Element>();
-        func(elem, floor);
+ModelOverlaySourcePrivate::Row ModelOverlaySourcePrivate::readRow(const QModelIndex &idx) const
+{
+    Row row;
+    row.element = idx.data(m_elementRole).value<OSM::Element>();
+    row.floorLevel = idx.data(m_floorRole).toInt();
+    if (m_hiddenElementRole >= 0) {
+        row.hiddenElement = idx.data(m_hiddenElementRole).value<OSM::Element>();
     }
+    row.children = readRows(idx, 0, m_model->rowCount(idx) - 1);
+    return row;
 }
 
-void ModelOverlaySource::hiddenElements(std::vector<OSM::Element> &elems) const
+std::vector<ModelOverlaySourcePrivate::Row> ModelOverlaySourcePrivate::readRows(const QModelIndex &parentIdx, int first, int last) const
 {
-    Q_D(const ModelOverlaySource);
-    if (!d->m_model || d->m_hiddenElementRole < 0) {
+    std::vector<Row> rows;
+    rows.reserve(std::max(0, last - first + 1));
+    for (int i = first; i <= last; ++i) {
+        rows.push_back(readRow(m_model->index(i, 0, parentIdx)));
+    }
+    return rows;
+}
+
+void ModelOverlaySourcePrivate::reloadRows()
+{
+    m_rows = readRows({}, 0, m_model->rowCount() - 1);
+    m_allDirty = true;
+}
+
+void ModelOverlaySourcePrivate::insertRows(const QModelIndex &parentIdx, int first, int last)
+{
+    // changes below the top-level are rare, simply re-read everything for those
+    if (parentIdx.isValid() || first > (int)m_rows.size()) {
+        reloadRows();
+        return;
+    }
+
+    auto rows = readRows(parentIdx, first, last);
+    setRowsDirty(rows.begin(), rows.end());
+    m_rows.insert(m_rows.begin() + first, std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+}
+
+void ModelOverlaySourcePrivate::removeRows(const QModelIndex &parentIdx, int first, int last)
+{
+    if (parentIdx.isValid() || last >= (int)m_rows.size()) {
+        reloadRows();
         return;
     }
 
-    const auto rows = d->m_model->rowCount();
-    for (int i = 0; i < rows; ++i) {
-        const auto idx = d->m_model->index(i, 0);
-        const auto elem = idx.data(d->m_hiddenElementRole).value<OSM::Element>();
-        if (elem.type() != OSM::Type::Null) {
-            elems.push_back(elem);
+    setRowsDirty(m_rows.begin() + first, m_rows.begin() + last + 1);
+    m_rows.erase(m_rows.begin() + first, m_rows.begin() + last + 1);
+}
+
+void ModelOverlaySourcePrivate::updateRows(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+{
+    if (topLeft.parent().isValid() || bottomRight.row() >= (int)m_rows.size()) {
+        reloadRows();
+        return;
+    }
+
+    for (int i = topLeft.row(); i <= bottomRight.row(); ++i) {
+        setRowDirty(m_rows[i]); // old floor level
+        m_rows[i] = readRow(m_model->index(i, 0));
+        setRowDirty(m_rows[i]); // new floor level
+    }
+}
+
+void ModelOverlaySourcePrivate::setRowDirty(const Row &row)
+{
+    m_dirtyFloors.insert(row.floorLevel);
+    m_hiddenElementsDirty |= row.hiddenElement.type() != OSM::Type::Null;
+    addChangedElements(row);
+}
+
+void ModelOverlaySourcePrivate::addChangedElements(const Row &row)
+{
+    // hidden elements are compared by the scene controller itself
+    for (const auto &child : row.children) {
+        addChangedElements(child);
+    }
+    addChangedElement(row.element);
+}
+
+void ModelOverlaySourcePrivate::setRowsDirty(std::vector<Row>::const_iterator begin, std::vector<Row>::const_iterator end)
+{
+    std::for_each(begin, end, [this](const auto &row) { setRowDirty(row); });
+}
+
+void ModelOverlaySourcePrivate::updateFloorElements() const
+{
+    if (m_allDirty) {
+        m_floorElements.clear();
+        m_hiddenElements.clear();
+        for (const auto &row : m_rows) {
+            addFloorElements(row, row.floorLevel, m_floorElements[row.floorLevel]);
+            if (row.hiddenElement.type() != OSM::Type::Null) {
+                m_hiddenElements.push_back(row.hiddenElement);
+            }
+        }
+        m_allDirty = false;
+        m_hiddenElementsDirty = false;
+        m_dirtyFloors.clear();
+        return;
+    }
+
+    // only rebuild the lists of floors that changed, the others are typically the majority
+    for (const auto floorLevel : m_dirtyFloors) {
+        auto &elems = m_floorElements[floorLevel];
+        elems.clear();
+        for (const auto &row : m_rows) {
+            addFloorElements(row, floorLevel, elems);
         }
+        if (elems.empty()) {
+            m_floorElements.erase(floorLevel);
+        }
+    }
+    m_dirtyFloors.clear();
+
+    if (m_hiddenElementsDirty) {
+        m_hiddenElements.clear();
+        for (const auto &row : m_rows) {
+            if (row.hiddenElement.type() != OSM::Type::Null) {
+                m_hiddenElements.push_back(row.hiddenElement);
+            }
+        }
+        m_hiddenElementsDirty = false;
+    }
+}
+
+void ModelOverlaySourcePrivate::addFloorElements(const Row &row, int floorLevel, std::vector<OSM::Element> &elems)
+{
+    // child elements are only considered when on the same floor as their parent, and come first
+    if (row.floorLevel != floorLevel) {
+        return;
+    }
+    for (const auto &child : row.children) {
+        addFloorElements(child, floorLevel, elems);
+    }
+    if (row.element.type() != OSM::Type::Null) {
+        elems.push_back(row.element);
     }
 }
 
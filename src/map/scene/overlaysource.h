@@ -32,6 +32,13 @@ public:
     /** Iteration interface with floor level filtering. */
     virtual void forEach(int floorLevel, const std::function<void(OSM::Element, int)> &func) const = 0;
 
+    /** Direct access to all elements on @p floorLevel, for sources that keep per-floor element lists.
+     *  This avoids going through forEach() for every element.
+     *  @returns @c nullptr if the source doesn't provide this, forEach() has to be used then.
+     *  @see setElementsForFloorFunction()
+     */
+    [[nodiscard]] const std::vector<OSM::Element>* elementsForFloor(int floorLevel) const;
+
     /** Adds hidden elements to @param elems. */
     virtual void hiddenElements(std::vector<OSM::Element> &elems) const;
 
@@ -48,6 +55,14 @@ public:
     /** Nodes for newly created geometry. */
     [[nodiscard]] virtual const std::vector<OSM::Node>* transientNodes() const;
 
+    /** Adds the elements changed by update() since the last call to @p elems.
+     *  This allows to repaint only the area affected by those.
+     *  @returns @c false if at least one update didn't report which elements it changed,
+     *  all elements of this source have to be considered changed then.
+     *  @see addChangedElement()
+     */
+    bool takeChangedElements(std::vector<OSM::Element> &elems);
+
 Q_SIGNALS:
     /** Trigger map re-rendering when the source changes. */
     void update();
@@ -61,13 +76,29 @@ Q_SIGNALS:
 protected:
     explicit AbstractOverlaySource(QObject *parent);
     explicit AbstractOverlaySource(AbstractOverlaySourcePrivate *dd, QObject *parent);
+
+    /** Sub-classes maintaining per-floor element lists can expose those via @p func.
+     *  @p func has the same semantics as elementsForFloor(), and the lists it returns
+     *  have to remain valid until the next scene graph update.
+     */
+    void setElementsForFloorFunction(std::function<const std::vector<OSM::Element>*(int)> &&func);
+
+    /** Sub-classes that know which of their elements an update affects report those
+     *  here before emitting update(), including added and removed elements.
+     *  Updates without any reported element are considered to change everything.
+     */
+    void addChangedElement(OSM::Element element);
+
     std::unique_ptr<AbstractOverlaySourcePrivate> d_ptr;
     Q_DECLARE_PRIVATE(AbstractOverlaySource)
 };
 
 class ModelOverlaySourcePrivate;
 
-/** A source for overlay elements, based on a QAbstractItemModel as input. */
+/** A source for overlay elements, based on a QAbstractItemModel as input.
+ *  The model content is cached in per-floor element lists, which are kept up to date
+ *  based on the model change signals.
+ */
 class KOSMINDOORMAP_EXPORT ModelOverlaySource : public AbstractOverlaySource
 {
     Q_OBJECT
@@ -12,7 +12,9 @@
 #include "penwidthutil_p.h"
 #include "poleofinaccessibilityfinder_p.h"
 #include "scenegeometry_p.h"
+#include "scenegraph_p.h"
 #include "openinghourscache_p.h"
+#include "textlayoutcache_p.h"
 #include "texturecache_p.h"
 #include "../style/mapcssdeclaration_p.h"
 #include "../style/mapcssexpressioncontext_p.h"
@@ -33,14 +35,24 @@
 #include <QElapsedTimer>
 #include <QGuiApplication>
 #include <QPalette>
+#include <QRegion>
 #include <QScopedValueRollback>
 
+#include <algorithm>
+#include <iterator>
+#include <optional>
+
 using namespace Qt::Literals::StringLiterals;
 
 namespace KOSMIndoorMap {
 class SceneControllerPrivate
 {
 public:
+    /** Texture @p name for element @p e, the element is damaged once an asynchronously loaded texture becomes available. */
+    [[nodiscard]] std::optional<QImage> textureImage(const QString &name, OSM::Element e) const;
+    /** Device pixel ratio of the target we render for, for rasterizing icons and textures. */
+    [[nodiscard]] qreal devicePixelRatio() const;
+
     MapData m_data;
     const MapCSSStyle *m_styleSheet = nullptr;
     const View *m_view = nullptr;
@@ -52,8 +64,12 @@ public:
     QColor m_defaultTextColor;
     QFont m_defaultFont;
     QPolygonF m_labelPlacementPath;
-    TextureCache m_textureCache;
-    IconLoader m_iconLoader;
+    std::shared_ptr<TextureCache> m_textureCache = TextureCache::shared();
+    QMetaObject::Connection m_textureConnection;
+    // elements waiting for asynchronously loaded textures
+    mutable std::vector<std::pair<QString, OSM::Element>> m_pendingTextures;
+    std::shared_ptr<IconLoader> m_iconLoader = IconLoader::shared();
+    std::shared_ptr<TextLayoutCache> m_textLayoutCache = std::make_shared<TextLayoutCache>();
     OpeningHoursCache m_openingHours;
     PoleOfInaccessibilityFinder m_piaFinder;
 
@@ -61,18 +77,49 @@ public:
     OSM::TagKey m_typeTag;
     OSM::Languages m_langs;
 
+    // changes affecting only a few elements, for repainting just the affected area
+    std::vector<OSM::Element> m_damagedElements;
+    std::vector<OSM::Element> m_overlayElements;
+    bool m_overlayDamaged = false;
+    bool m_partialDirty = false;
+    // accumulated screen-space damage of the scene updates since the last repaint
+    QRegion m_damage;
+    bool m_fullDamage = true;
+
+    qreal m_devicePixelRatio = 1.0;
     bool m_dirty = true;
     bool m_overlay = false;
+    bool m_asyncTextures = false;
 };
 }
 
+std::optional<QImage> SceneControllerPrivate::textureImage(const QString &name, OSM::Element e) const
+{
+    if (m_asyncTextures) {
+        auto img = m_textureCache->requestImage(name, devicePixelRatio());
+        if (!img) {
+            m_pendingTextures.emplace_back(name, e);
+        }
+        return img;
+    }
+    return m_textureCache->image(name, devicePixelRatio());
+}
+
+qreal SceneControllerPrivate::devicePixelRatio() const
+{
+    return m_view ? m_view->deviceTransform().m11() : 1.0;
+}
+
 using namespace KOSMIndoorMap;
 
 SceneController::SceneController() : d(new SceneControllerPrivate)
 {
     d->m_langs = OSM::Languages::fromQLocale(QLocale());
 }
-SceneController::~SceneController() = default;
+SceneController::~SceneController()
+{
+    QObject::disconnect(d->m_textureConnection);
+}
 
 void SceneController::setMapData(const MapData &data)
 {
@@ -110,8 +157,52 @@ void SceneController::setOverlaySources(std::vector<QPointer<AbstractOverlaySour
 
 void SceneController::overlaySourceUpdated()
 {
-    // TODO we could potentially do this more fine-grained?
-    d->m_dirty = true;
+    // which overlay elements changed is determined from the overlay sources on the next scene update
+    d->m_overlayDamaged = true;
+    d->m_partialDirty = true;
+}
+
+void SceneController::setAsyncTextureLoading(QObject *context, std::function<void()> &&callback)
+{
+    QObject::disconnect(d->m_textureConnection);
+    d->m_asyncTextures = context != nullptr;
+    if (!context) {
+        return;
+    }
+    d->m_textureConnection = QObject::connect(d->m_textureCache.get(), &TextureCache::textureLoaded, context, [this, callback = std::move(callback)](const QString &name, qreal dpr) {
+        // only repaint the elements waiting for this texture, which might also be none at all if another scene requested it
+        if (dpr != d->m_devicePixelRatio) {
+            return;
+        }
+        const auto prevDamageCount = d->m_damagedElements.size();
+        for (auto it = d->m_pendingTextures.begin(); it != d->m_pendingTextures.end();) {
+            if ((*it).first == name) {
+                d->m_damagedElements.push_back((*it).second);
+                it = d->m_pendingTextures.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (prevDamageCount != d->m_damagedElements.size()) {
+            d->m_partialDirty = true;
+            callback();
+        }
+    });
+}
+
+[[nodiscard]] static QRegion damagedArea(const SceneGraph &sg, const std::vector<OSM::Element> &elements, const View *view)
+{
+    QRegion area;
+    if (elements.empty()) {
+        return area;
+    }
+    for (const auto &item : sg.items()) {
+        if (item.payload && std::binary_search(elements.begin(), elements.end(), item.element)) {
+            // antialiasing and rounding margin
+            area += item.payload->screenBoundingRect(view).adjusted(-2.0, -2.0, 2.0, 2.0).toAlignedRect();
+        }
+    }
+    return area;
 }
 
 void SceneController::updateScene(SceneGraph &sg) const
@@ -125,14 +216,58 @@ void SceneController::updateScene(SceneGraph &sg) const
     }
 
     // check if the scene is dirty at all
-    if (sg.zoomLevel() == (int)d->m_view->zoomLevel() && sg.currentFloorLevel() == d->m_view->level() && !d->m_dirty) {
+    const auto fullUpdate = sg.zoomLevel() != (int)d->m_view->zoomLevel() || sg.currentFloorLevel() != d->m_view->level()
+        || d->m_devicePixelRatio != d->devicePixelRatio() || d->m_dirty;
+    if (!fullUpdate && !d->m_partialDirty) {
         return;
     }
     sg.setZoomLevel(d->m_view->zoomLevel());
     sg.setCurrentFloorLevel(d->m_view->level());
+    d->m_devicePixelRatio = d->devicePixelRatio();
     d->m_openingHours.setTimeRange(d->m_view->beginTime(), d->m_view->endTime());
     d->m_dirty = false;
 
+    // collect elements that the overlay want to hide
+    auto prevHiddenElements = std::move(d->m_hiddenElements);
+    d->m_hiddenElements.clear();
+    for (const auto &overlaySource : d->m_overlaySources) {
+        overlaySource->hiddenElements(d->m_hiddenElements);
+    }
+    std::sort(d->m_hiddenElements.begin(), d->m_hiddenElements.end());
+
+    // overlay sources reporting which of their elements changed only need those repainted,
+    // for all others every overlay element of the previous and the next scene is considered changed
+    std::vector<OSM::Element> damagedElements;
+    bool overlayFullDamage = false;
+    for (const auto &overlaySource : d->m_overlaySources) {
+        overlayFullDamage |= !overlaySource->takeChangedElements(damagedElements);
+    }
+    overlayFullDamage = overlayFullDamage && d->m_overlayDamaged;
+
+    // for partial updates, determine the area of the changed elements in the previous scene
+    if (fullUpdate) {
+        d->m_fullDamage = true;
+        damagedElements.clear();
+    } else {
+        damagedElements.insert(damagedElements.end(), d->m_damagedElements.begin(), d->m_damagedElements.end());
+        if (overlayFullDamage) {
+            damagedElements.insert(damagedElements.end(), d->m_overlayElements.begin(), d->m_overlayElements.end());
+        }
+        // base elements shown or hidden by the overlays changed as well
+        std::set_symmetric_difference(prevHiddenElements.begin(), prevHiddenElements.end(),
+            d->m_hiddenElements.begin(), d->m_hiddenElements.end(), std::back_inserter(damagedElements));
+        std::sort(damagedElements.begin(), damagedElements.end());
+        d->m_damage += damagedArea(sg, damagedElements, d->m_view);
+    }
+    d->m_damagedElements.clear();
+    d->m_overlayDamaged = false;
+    d->m_partialDirty = false;
+    d->m_overlayElements.clear();
+
+    // textures still missing are requested again below
+    d->m_pendingTextures.clear();
+
+    SceneGraphPrivate::get(sg)->m_textLayouts = d->m_textLayoutCache;
     sg.beginSwap();
     std::for_each(d->m_overlaySources.begin(), d->m_overlaySources.end(), std::mem_fn(&AbstractOverlaySource::beginSwap));
     updateCanvas(sg);
@@ -163,13 +298,6 @@ void SceneController::updateScene(SceneGraph &sg) const
         }
     }
 
-    // collect elements that the overlay want to hide
-    d->m_hiddenElements.clear();
-    for (const auto &overlaySource : d->m_overlaySources) {
-        overlaySource->hiddenElements(d->m_hiddenElements);
-    }
-    std::sort(d->m_hiddenElements.begin(), d->m_hiddenElements.end());
-
     // for each level, update or create scene graph elements, after a some basic bounding box check
     const auto geoBbox = d->m_view->mapSceneToGeo(d->m_view->sceneBoundingBox());
     for (auto it = beginIt; it != endIt; ++it) {
@@ -182,13 +310,21 @@ void SceneController::updateScene(SceneGraph &sg) const
 
     // update overlay elements
     d->m_overlay = true;
+    const auto addOverlayElement = [this, &geoBbox, &sg](OSM::Element e, int floorLevel) {
+        if (OSM::intersects(geoBbox, e.boundingBox()) && e.type() != OSM::Type::Null) {
+            d->m_overlayElements.push_back(e);
+            updateElement(e, floorLevel, sg);
+        }
+    };
     for (const auto &overlaySource : d->m_overlaySources) {
         QScopedValueRollback tranientNodes(d->m_data.dataSet().transientNodes, overlaySource->transientNodes());
-        overlaySource->forEach(d->m_view->level(), [this, &geoBbox, &sg](OSM::Element e, int floorLevel) {
-            if (OSM::intersects(geoBbox, e.boundingBox()) && e.type() != OSM::Type::Null) {
-                updateElement(e, floorLevel, sg);
+        if (const auto elems = overlaySource->elementsForFloor(d->m_view->level())) {
+            for (auto e : *elems) {
+                addOverlayElement(e, d->m_view->level());
             }
-        });
+        } else {
+            overlaySource->forEach(d->m_view->level(), addOverlayElement);
+        }
         d->m_data.dataSet().transientNodes = nullptr;
     }
     d->m_overlay = false;
@@ -197,7 +333,38 @@ void SceneController::updateScene(SceneGraph &sg) const
     sg.endSwap();
     std::for_each(d->m_overlaySources.begin(), d->m_overlaySources.end(), std::mem_fn(&AbstractOverlaySource::endSwap));
 
+    // ... and add the area of the changed elements in the new scene
+    if (!fullUpdate) {
+        if (overlayFullDamage) {
+            damagedElements.insert(damagedElements.end(), d->m_overlayElements.begin(), d->m_overlayElements.end());
+            std::sort(damagedElements.begin(), damagedElements.end());
+        }
+        d->m_damage += damagedArea(sg, damagedElements, d->m_view);
+    }
+
     qCDebug(RenderLog) << "updated scenegraph took" << sgUpdateTimer.elapsed() << "ms";
+    if (RenderLog().isDebugEnabled()) {
+        const auto stats = d->m_textLayoutCache->statistics();
+        qCDebug(RenderLog) << "text layout cache:" << stats.hits << "hits" << stats.misses << "misses" << stats.count << "entries";
+        const auto textureStats = d->m_textureCache->statistics();
+        qCDebug(RenderLog) << "texture cache:" << textureStats.hits << "hits" << textureStats.misses << "misses" << textureStats.count << "entries" << textureStats.size << "bytes";
+    }
+}
+
+QRegion SceneController::damage() const
+{
+    return d->m_damage;
+}
+
+bool SceneController::hasFullDamage() const
+{
+    return d->m_fullDamage;
+}
+
+void SceneController::resetDamage()
+{
+    d->m_damage = {};
+    d->m_fullDamage = false;
 }
 
 void SceneController::updateCanvas(SceneGraph &sg) const
@@ -288,8 +455,11 @@ void SceneController::updateElement(const MapCSSState &state, int level, SceneGr
                     fillOpacity = decl->doubleValue();
                     break;
                 case MapCSSProperty::FillImage:
-                    item->textureBrush.setTextureImage(d->m_textureCache.image(decl->stringValue()));
-                    hasTexture = true;
+                    // while the texture is loading the fill color serves as placeholder
+                    if (const auto img = d->textureImage(decl->stringValue(), state.element)) {
+                        item->textureBrush.setTextureImage(*img);
+                        hasTexture = true;
+                    }
                     break;
                 default:
                     break;
@@ -501,7 +671,8 @@ void SceneController::updateElement(const MapCSSState &state, int level, SceneGr
                 if (!iconData.color.isValid()) {
                     iconData.color = d->m_defaultTextColor;
                 }
-                item->icon = d->m_iconLoader.loadIcon(iconData);
+                iconData.devicePixelRatio = d->devicePixelRatio();
+                item->icon = d->m_iconLoader->loadIcon(iconData);
                 item->iconOpacity = iconData.color.alphaF();
             }
             if (!item->icon.isNull()) {
@@ -526,11 +697,10 @@ void SceneController::updateElement(const MapCSSState &state, int level, SceneGr
                     item->isComplexText = true;
                 }
 
-                // do not use QStaticText::prepare here:
+                // do not prepare the text layout here:
                 // the vast majority of text items will likely not be shown at all for being overlapped or out of view
                 // and pre-computing them is too expensive. Instead this will happen as needed on first use, for only
-                // a smaller amounts at a time.
-                // item->text.prepare({}, item->font);
+                // a smaller amounts at a time, and is then retained by the text layout cache.
 
                 // discard labels that are longer than the line they are aligned with
                 if (result.hasLineProperties() && d->m_labelPlacementPath.size() > 1 && item->angle != 0.0) {
@@ -540,17 +710,22 @@ void SceneController::updateElement(const MapCSSState &state, int level, SceneGr
                     const auto screenP1 = d->m_view->mapSceneToScreen(sceneP1);
                     const auto screenP2 = d->m_view->mapSceneToScreen(sceneP2);
                     const auto screenLen = screenP2.x() - screenP1.x();
-                    if (screenLen < item->text.size().width()) {
+                    const auto layout = d->m_textLayoutCache->layout(item->text.text(), item->font, item->text.textWidth());
+                    item->textOutputSizeCache = layout->outputSize;
+                    if (screenLen < layout->size.width()) {
                         item->text = {};
+                        item->textOutputSizeCache = {};
                     }
                 } else if (result.hasAreaProperties() && textRequireFit && d->m_labelPlacementPath.size() >= 5 && item->angle == 0.0) {
-                    const auto textSize = item->textOutputSize();
+                    const auto textSize = d->m_textLayoutCache->layout(item->text.text(), item->font, item->text.textWidth())->outputSize;
+                    item->textOutputSizeCache = textSize;
                     QRectF sceneTextRect;
                     sceneTextRect.setWidth(d->m_view->mapScreenDistanceToSceneDistance(textSize.width()));
                     sceneTextRect.setHeight(d->m_view->mapScreenDistanceToSceneDistance(textSize.height()));
                     sceneTextRect.moveCenter(item->pos); // TODO consider icon and offset
                     if (!SceneGeometry::polygonContainsRect(d->m_labelPlacementPath, sceneTextRect)) {
                         item->text = {};
+                        item->textOutputSizeCache = {};
                     }
                 }
 
@@ -652,7 +827,9 @@ void SceneController::applyPenStyle(OSM::Element e, const MapCSSDeclaration *dec
             opacity = decl->doubleValue();
             break;
         case MapCSSProperty::Image:
-            pen.setBrush(d->m_textureCache.image(decl->stringValue()));
+            if (const auto img = d->textureImage(decl->stringValue(), e)) {
+                pen.setBrush(*img);
+            }
             unit = Unit::Pixel; // TODO scalable line textures aren't implemented yet
             break;
         default:
@@ -803,6 +980,8 @@ void SceneController::setHoveredElement(OSM::Element element)
     if (d->m_hoverElement == element) {
         return;
     }
+    d->m_damagedElements.push_back(d->m_hoverElement);
+    d->m_damagedElements.push_back(element);
     d->m_hoverElement = element;
-    d->m_dirty = true;
+    d->m_partialDirty = true;
 }
@@ -11,10 +11,13 @@
 
 #include "scenegraphitem.h"
 
+#include <functional>
 #include <memory>
 #include <vector>
 
+class QObject;
 class QPolygonF;
+class QRegion;
 class QString;
 
 namespace OSM {
@@ -46,6 +49,12 @@ public:
     void setOverlaySources(std::vector<QPointer<AbstractOverlaySource>> &&overlays);
     /** Overlay dirty state tracking. */
     void overlaySourceUpdated();
+    /** Load textures asynchronously.
+     *  Until a texture is available affected items are drawn without it. @p callback is invoked
+     *  in the thread of @p context once textures got loaded and the scene needs to be updated.
+     *  By default textures are loaded synchronously, as needed for offline rendering.
+     */
+    void setAsyncTextureLoading(QObject *context, std::function<void()> &&callback);
 
     /** Set currently hovered element. */
     [[nodiscard]] OSM::Element hoveredElement() const;
@@ -56,6 +65,16 @@ public:
      */
     void updateScene(SceneGraph &sg) const;
 
+    // damage tracking
+    /** Screen-space area changed by scene updates since the last resetDamage() call.
+     *  This is only meaningful if hasFullDamage() is @c false.
+     */
+    [[nodiscard]] QRegion damage() const;
+    /** A scene update since the last resetDamage() call changed everything, eg. due to a zoom or floor level change. */
+    [[nodiscard]] bool hasFullDamage() const;
+    /** Reset damage tracking once the changes have been repainted. */
+    void resetDamage();
+
 private:
     void updateCanvas(SceneGraph &sg) const;
     void updateElement(OSM::Element e, int level, SceneGraph &sg) const;
@@ -5,6 +5,7 @@
 */
 
 #include "scenegraph.h"
+#include "scenegraph_p.h"
 
 #include <QDebug>
 #include <QGuiApplication>
@@ -12,10 +13,31 @@
 
 using namespace KOSMIndoorMap;
 
-SceneGraph::SceneGraph() = default;
-SceneGraph::SceneGraph(SceneGraph&&) = default;
+SceneGraph::SceneGraph()
+    : d(std::make_unique<SceneGraphPrivate>())
+{
+}
+
+SceneGraph::SceneGraph(SceneGraph &&other)
+    : SceneGraph()
+{
+    *this = std::move(other);
+}
+
 SceneGraph::~SceneGraph() = default;
-SceneGraph& SceneGraph::operator=(SceneGraph &&other) = default;
+
+SceneGraph& SceneGraph::operator=(SceneGraph &&other)
+{
+    m_items = std::move(other.m_items);
+    m_previousItems = std::move(other.m_previousItems);
+    m_layerOffsets = std::move(other.m_layerOffsets);
+    m_bgColor = other.m_bgColor;
+    m_zoomLevel = other.m_zoomLevel;
+    m_floorLevel = other.m_floorLevel;
+    // keep the moved-from scene graph usable, with its own reader registration
+    std::swap(d, other.d);
+    return *this;
+}
 
 void SceneGraph::clear()
 {
@@ -25,6 +47,7 @@ void SceneGraph::clear()
     m_bgColor = {};
     m_floorLevel = 0;
     m_zoomLevel = 0;
+    d->m_reclaimerReader.clear();
 }
 
 void SceneGraph::addItem(SceneGraphItem &&item)
@@ -65,6 +88,7 @@ bool SceneGraph::zOrderCompare(const SceneGraphItem &lhs, const SceneGraphItem &
 
 void SceneGraph::beginSwap()
 {
+    d->m_reclaimerReader.beginRead();
     std::swap(m_items, m_previousItems);
     m_items.clear();
     std::sort(m_previousItems.begin(), m_previousItems.end(), SceneGraph::itemPoolCompare);
@@ -74,6 +98,7 @@ void SceneGraph::beginSwap()
 void SceneGraph::endSwap()
 {
     m_previousItems.clear();
+    d->m_reclaimerReader.endRead();
 }
 
 int SceneGraph::zoomLevel() const
@@ -23,6 +23,7 @@ class QPointF;
 namespace KOSMIndoorMap {
 
 class SceneGraphItem;
+class SceneGraphPrivate;
 
 /** Scene graph of the currently displayed level. */
 class KOSMINDOORMAP_EXPORT SceneGraph
@@ -69,6 +70,7 @@ public:
     const std::vector<SceneGraphItem>& items() const;
 
 private:
+    friend class SceneGraphPrivate;
     void recomputeLayerIndex();
 
     static bool itemPoolCompare(const SceneGraphItem &lhs, const SceneGraphItem &rhs);
@@ -81,6 +83,8 @@ private:
 
     int m_zoomLevel = 0;
     int m_floorLevel = 0;
+
+    std::unique_ptr<SceneGraphPrivate> d;
 };
 
 
@@ -0,0 +1,30 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORMAP_SCENEGRAPH_P_H
+#define KOSMINDOORMAP_SCENEGRAPH_P_H
+
+#include "overlayreclaimer.h"
+#include "scenegraph.h"
+
+#include <memory>
+
+namespace KOSMIndoorMap {
+
+class TextLayoutCache;
+
+class SceneGraphPrivate
+{
+public:
+    [[nodiscard]] static SceneGraphPrivate* get(const SceneGraph &sg) { return sg.d.get(); }
+
+    OverlayReclaimer::Reader m_reclaimerReader;
+    /** Text layout cache of the scene controller that built this, for rendering the labels. */
+    std::shared_ptr<TextLayoutCache> m_textLayouts;
+};
+
+}
+
+#endif // KOSMINDOORMAP_SCENEGRAPH_P_H
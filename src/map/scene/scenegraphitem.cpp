@@ -24,6 +24,33 @@ bool SceneGraphItemPayload::inHUDSpace() const
     return renderPhases() & (IconPhase | LabelPhase);
 }
 
+QRectF SceneGraphItemPayload::screenBoundingRect(const View *view) const
+{
+    auto bbox = boundingRect(view);
+    if (inSceneSpace()) {
+        bbox = view->mapSceneToScreen(bbox);
+    } else {
+        bbox.moveCenter(view->mapSceneToScreen(bbox.center()));
+    }
+
+    if (const auto item = dynamic_cast<const PolygonBaseItem*>(this)) {
+        // boundingRect() doesn't consider the outline, be generous here rather than dealing with all casing modes
+        const auto screenWidth = [view](const QPen &pen, Unit unit) {
+            if (pen.style() == Qt::NoPen) {
+                return 0.0;
+            }
+            return unit == Unit::Meter ? view->mapMetersToScreen(pen.widthF()) : pen.widthF();
+        };
+        const auto w = screenWidth(item->pen, item->penWidthUnit) + screenWidth(item->casingPen, item->casingPenWidthUnit);
+        bbox.adjust(-w, -w, w, w);
+    } else if (const auto item = dynamic_cast<const LabelItem*>(this)) {
+        // boundingRect() doesn't consider text offsets and halos
+        bbox = bbox.united(item->shieldHitBox(view));
+        bbox.adjust(-item->haloRadius, -item->haloRadius, item->haloRadius, item->haloRadius);
+    }
+    return bbox;
+}
+
 
 uint8_t PolylineItem::renderPhases() const
 {
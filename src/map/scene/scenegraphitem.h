@@ -77,6 +77,10 @@ public:
      *  Performance trumps precision here, so estimating this slightly larger rather than computing it expensively makes sense.
      */
     [[nodiscard]] virtual QRectF boundingRect(const View *view) const = 0;
+    /** Bounding box of everything this item paints, in screen coordinates.
+     *  Used for determining the area that needs repainting when this item changes.
+     */
+    [[nodiscard]] QRectF screenBoundingRect(const View *view) const;
 
     /** Is this item drawn in scene coordinates (as oposed to HUD coordinates)? */
     [[nodiscard]] bool inSceneSpace() const;
@@ -0,0 +1,114 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "textlayoutcache_p.h"
+
+#include <QFontMetricsF>
+#include <QMutexLocker>
+#include <QPainter>
+
+#include <algorithm>
+
+using namespace Qt::Literals::StringLiterals;
+using namespace KOSMIndoorMap;
+
+void TextLayout::draw(QPainter *painter, QPointF pos) const
+{
+    if (m_layout) {
+        m_layout->draw(painter, pos);
+    } else {
+        painter->drawStaticText(pos, m_staticText);
+    }
+}
+
+TextLayoutCache::TextLayoutCache()
+{
+    m_cache.setMaxCost(4096);
+}
+
+TextLayoutCache::~TextLayoutCache() = default;
+
+std::shared_ptr<TextLayout> TextLayoutCache::createLayout(const QString &text, const QFont &font, double maxWidth)
+{
+    auto l = std::make_shared<TextLayout>();
+    const QFontMetricsF fm(font);
+
+    if (maxWidth <= 0.0 && !text.contains('\n'_L1)) {
+        l->m_staticText.setText(text);
+        l->m_staticText.prepare({}, font);
+        l->size = l->m_staticText.size();
+        l->outputSize = fm.size(0, text);
+        return l;
+    }
+
+    // QStaticText misbehaves with a maximum width, and doesn't give us the actual bounding box then either,
+    // so lay this out manually the same way QPainter::drawText would
+    auto s = text;
+    s.replace('\n'_L1, QChar::LineSeparator);
+    l->m_layout = std::make_unique<QTextLayout>(s, font);
+    l->m_layout->setCacheEnabled(true);
+    QTextOption opt;
+    opt.setWrapMode(maxWidth > 0.0 ? QTextOption::WordWrap : QTextOption::NoWrap);
+    l->m_layout->setTextOption(opt);
+
+    const auto lineWidth = maxWidth > 0.0 ? maxWidth : fm.horizontalAdvance(s) + 1.0;
+    double width = 0.0;
+    double height = -fm.leading();
+    l->m_layout->beginLayout();
+    while (true) {
+        auto line = l->m_layout->createLine();
+        if (!line.isValid()) {
+            break;
+        }
+        line.setLineWidth(lineWidth);
+        height += fm.leading();
+        line.setPosition({0.0, height});
+        height += line.height();
+        width = std::max(width, line.naturalTextWidth());
+    }
+    l->m_layout->endLayout();
+
+    // center-align all lines
+    for (int i = 0; i < l->m_layout->lineCount(); ++i) {
+        auto line = l->m_layout->lineAt(i);
+        line.setPosition({(width - line.naturalTextWidth()) / 2.0, line.position().y()});
+    }
+
+    l->size = QSizeF(width, std::max(height, 0.0));
+    l->outputSize = l->size;
+    return l;
+}
+
+std::shared_ptr<const TextLayout> TextLayoutCache::layout(const QString &text, const QFont &font, double maxWidth) const
+{
+    const Key key{ text, font, std::max(maxWidth, 0.0) };
+    QMutexLocker locker(&m_mutex);
+    if (const auto entry = m_cache.object(key)) {
+        ++m_stats.hits;
+        return *entry;
+    }
+    ++m_stats.misses;
+    locker.unlock();
+
+    std::shared_ptr<const TextLayout> l = createLayout(text, font, key.maxWidth);
+
+    locker.relock();
+    m_cache.insert(key, new std::shared_ptr<const TextLayout>(l));
+    return l;
+}
+
+void TextLayoutCache::setMaximumCount(qsizetype count)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(count);
+}
+
+TextLayoutCache::Statistics TextLayoutCache::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    auto stats = m_stats;
+    stats.count = m_cache.count();
+    return stats;
+}
@@ -0,0 +1,94 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORMAP_TEXTLAYOUTCACHE_P_H
+#define KOSMINDOORMAP_TEXTLAYOUTCACHE_P_H
+
+#include "kosmindoormap_export.h"
+
+#include <QCache>
+#include <QFont>
+#include <QMutex>
+#include <QSizeF>
+#include <QStaticText>
+#include <QString>
+#include <QTextLayout>
+
+#include <memory>
+
+class QPainter;
+
+namespace KOSMIndoorMap {
+
+/** Prepared layout of a label text. */
+class KOSMINDOORMAP_EXPORT TextLayout
+{
+public:
+    /** Draws the text with its top left corner at @p pos, using the current pen of @p painter. */
+    void draw(QPainter *painter, QPointF pos) const;
+
+    /** Size of the laid out text, used for centering it. */
+    QSizeF size;
+    /** Bounding box size of the rendered text, used for hit and collision detection. */
+    QSizeF outputSize;
+
+private:
+    friend class TextLayoutCache;
+    QStaticText m_staticText;
+    std::unique_ptr<QTextLayout> m_layout; // for multi-line or word-wrapped text
+};
+
+/** Cache of prepared label text layouts.
+ *  Label texts and fonts barely change between scene rebuilds or zoom levels, so the
+ *  layouts are kept across those and shared between collision sizing and rendering.
+ *  The cache is size-bounded, least recently used layouts are discarded first.
+ *
+ *  Each scene controller has its own instance, as neither QStaticText nor QTextLayout
+ *  can be drawn from multiple threads at the same time.
+ */
+class KOSMINDOORMAP_EXPORT TextLayoutCache
+{
+public:
+    explicit TextLayoutCache();
+    ~TextLayoutCache();
+
+    /** Returns the layout for @p text in @p font, word-wrapped at @p maxWidth if that is positive. */
+    [[nodiscard]] std::shared_ptr<const TextLayout> layout(const QString &text, const QFont &font, double maxWidth) const;
+
+    /** Maximum number of cached layouts. */
+    void setMaximumCount(qsizetype count);
+
+    struct Statistics {
+        int hits = 0;
+        int misses = 0;
+        qsizetype count = 0;
+    };
+    /** Cache hit/miss statistics and current size. */
+    [[nodiscard]] Statistics statistics() const;
+
+    /** Lays out @p text without any caching. */
+    [[nodiscard]] static std::shared_ptr<TextLayout> createLayout(const QString &text, const QFont &font, double maxWidth);
+
+private:
+    struct Key {
+        QString text;
+        QFont font;
+        double maxWidth;
+
+        [[nodiscard]] bool operator==(const Key&) const = default;
+        friend size_t qHash(const Key &key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.text, key.font, key.maxWidth);
+        }
+    };
+
+    mutable QMutex m_mutex;
+    mutable QCache<Key, std::shared_ptr<const TextLayout>> m_cache;
+    mutable Statistics m_stats;
+};
+
+}
+
+#endif // KOSMINDOORMAP_TEXTLAYOUTCACHE_P_H
@@ -8,43 +8,200 @@
 
 #include <QDebug>
 #include <QFile>
-#include <QGuiApplication>
 #include <QImageReader>
+#include <QMutexLocker>
+
+#include <algorithm>
 
 using namespace KOSMIndoorMap;
 
-TextureCache::TextureCache() = default;
-TextureCache::~TextureCache() = default;
+TextureCache::TextureCache()
+{
+    // decoding is mostly I/O and memory bound, no need to occupy all cores for this
+    m_pool.setMaxThreadCount(2);
+}
 
-QImage TextureCache::image(const QString &name) const
+TextureCache::~TextureCache()
 {
-    auto it = std::lower_bound(m_cache.begin(), m_cache.end(), name, [](const auto &lhs, const auto &rhs) { return lhs.name < rhs; });
-    if (it != m_cache.end() && (*it).name == name) {
-        return (*it).image;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending.clear();
     }
+    m_pool.waitForDone();
+}
 
-    CacheEntry entry;
-    entry.name = name;
-
+[[nodiscard]] static QImage loadImage(const QString &name, qreal dpr)
+{
+    QImage image;
     const QString fileName = QLatin1String(":/org.kde.kosmindoormap/assets/textures/") + name;
     if (name.endsWith(QLatin1String(".svg"))) {
         QImageReader imgReader(fileName, "svg");
-        imgReader.setScaledSize(imgReader.size() * qGuiApp->devicePixelRatio());
-        entry.image = imgReader.read();
-        entry.image.setDevicePixelRatio(qGuiApp->devicePixelRatio());
+        imgReader.setScaledSize(imgReader.size() * dpr);
+        image = imgReader.read();
+        image.setDevicePixelRatio(dpr);
     } else {
         // TODO high dpi raster image loading
         // QImageReader is supposed to do that transparently, but that doesn't seem to work here?
         QImageReader imgReader(fileName);
-        entry.image = imgReader.read();
+        image = imgReader.read();
     }
 
-    if (entry.image.isNull()) {
+    if (image.isNull()) {
         qCWarning(Log) << "failed to load texture:" << name;
     } else {
-        qCDebug(Log) << "loaded texture:" << entry.name << entry.image;
+        qCDebug(Log) << "loaded texture:" << name << image;
+    }
+    return image;
+}
+
+std::vector<TextureCache::CacheEntry>::iterator TextureCache::findEntry(const QString &name, qreal dpr) const
+{
+    return std::lower_bound(m_cache.begin(), m_cache.end(), name, [dpr](const auto &lhs, const auto &rhs) {
+        return lhs.name < rhs || (lhs.name == rhs && lhs.devicePixelRatio < dpr);
+    });
+}
+
+std::vector<TextureCache::PendingEntry>::iterator TextureCache::findPending(const QString &name, qreal dpr) const
+{
+    return std::find_if(m_pending.begin(), m_pending.end(), [&name, dpr](const auto &entry) {
+        return entry.name == name && entry.devicePixelRatio == dpr;
+    });
+}
+
+QImage TextureCache::image(const QString &name, qreal dpr) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = findEntry(name, dpr);
+    if (it != m_cache.end() && (*it).name == name && (*it).devicePixelRatio == dpr) {
+        ++m_stats.hits;
+        (*it).lastUsed = ++m_useCounter;
+        return (*it).image;
+    }
+    ++m_stats.misses;
+
+    // no need to load this asynchronously anymore
+    if (auto pendingIt = findPending(name, dpr); pendingIt != m_pending.end() && !(*pendingIt).loading) {
+        m_pending.erase(pendingIt);
+    }
+
+    // decode without holding the lock, so this doesn't block the workers or other callers
+    CacheEntry entry;
+    entry.name = name;
+    entry.devicePixelRatio = dpr;
+    locker.unlock();
+
+    entry.image = loadImage(name, dpr);
+
+    locker.relock();
+    return insertEntry(std::move(entry));
+}
+
+std::optional<QImage> TextureCache::requestImage(const QString &name, qreal dpr)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = findEntry(name, dpr);
+    if (it != m_cache.end() && (*it).name == name && (*it).devicePixelRatio == dpr) {
+        ++m_stats.hits;
+        (*it).lastUsed = ++m_useCounter;
+        return (*it).image;
+    }
+
+    if (auto pendingIt = findPending(name, dpr); pendingIt != m_pending.end()) {
+        ++(*pendingIt).usage;
+        return {};
+    }
+
+    ++m_stats.misses;
+    m_pending.push_back({ name, dpr, 1, false });
+    m_pool.start([this]() { loadNextPending(); });
+    return {};
+}
+
+QImage TextureCache::insertEntry(CacheEntry &&entry) const
+{
+    const auto it = findEntry(entry.name, entry.devicePixelRatio);
+    if (it != m_cache.end() && (*it).name == entry.name && (*it).devicePixelRatio == entry.devicePixelRatio) {
+        (*it).lastUsed = ++m_useCounter;
+        return (*it).image; // loaded by someone else meanwhile
     }
+    entry.lastUsed = ++m_useCounter;
+    m_stats.size += entry.image.sizeInBytes();
+    ++m_stats.count;
+    const auto img = entry.image;
+    m_cache.insert(it, std::move(entry));
 
-    it = m_cache.insert(it, std::move(entry));
-    return (*it).image;
+    // evict least recently used textures, images still in use by a scene graph remain valid as QImage is implicitly shared
+    while (m_stats.size > m_maximumSize && m_cache.size() > 1) {
+        const auto lruIt = std::min_element(m_cache.begin(), m_cache.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.lastUsed < rhs.lastUsed;
+        });
+        qCDebug(Log) << "evicting texture:" << (*lruIt).name;
+        m_stats.size -= (*lruIt).image.sizeInBytes();
+        --m_stats.count;
+        m_cache.erase(lruIt);
+    }
+    return img;
 }
+
+void TextureCache::loadNextPending()
+{
+    QMutexLocker locker(&m_mutex);
+    const auto it = std::max_element(m_pending.begin(), m_pending.end(), [](const auto &lhs, const auto &rhs) {
+        if (lhs.loading != rhs.loading) {
+            return lhs.loading;
+        }
+        return lhs.usage < rhs.usage;
+    });
+    if (it == m_pending.end() || (*it).loading) {
+        return;
+    }
+    (*it).loading = true;
+
+    CacheEntry entry;
+    entry.name = (*it).name;
+    entry.devicePixelRatio = (*it).devicePixelRatio;
+    locker.unlock();
+
+    entry.image = loadImage(entry.name, entry.devicePixelRatio);
+
+    locker.relock();
+    const auto pendingIt = findPending(entry.name, entry.devicePixelRatio);
+    if (pendingIt == m_pending.end()) { // we are shutting down
+        return;
+    }
+    m_pending.erase(pendingIt);
+    const auto name = entry.name;
+    const auto dpr = entry.devicePixelRatio;
+    insertEntry(std::move(entry));
+    locker.unlock();
+
+    Q_EMIT textureLoaded(name, dpr);
+}
+
+void TextureCache::setMaximumSize(qsizetype size)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maximumSize = size;
+}
+
+TextureCache::Statistics TextureCache::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
+
+std::shared_ptr<TextureCache> TextureCache::shared()
+{
+    static QMutex s_mutex;
+    static std::weak_ptr<TextureCache> s_instance;
+
+    QMutexLocker locker(&s_mutex);
+    auto cache = s_instance.lock();
+    if (!cache) {
+        cache = std::make_shared<TextureCache>();
+        s_instance = cache;
+    }
+    return cache;
+}
+
+#include "moc_texturecache_p.cpp"
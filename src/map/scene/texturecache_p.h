@@ -6,28 +6,96 @@
 #ifndef KOSMINDOORMAP_TEXTURECACHE_P_H
 #define KOSMINDOORMAP_TEXTURECACHE_P_H
 
+#include "kosmindoormap_export.h"
+
 #include <QImage>
+#include <QMutex>
+#include <QObject>
 #include <QString>
+#include <QThreadPool>
 
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <vector>
 
+class TextureCacheTest;
+
 namespace KOSMIndoorMap {
 
-/** Texture loader and texture caching for images referenced in MapCSS. */
-class TextureCache
+/** Texture loader and texture caching for images referenced in MapCSS.
+ *  Textures can be loaded synchronously, or asynchronously on a worker thread pool.
+ *  The cache is size-bounded, least recently used textures are discarded first.
+ */
+class KOSMINDOORMAP_EXPORT TextureCache : public QObject
 {
+    Q_OBJECT
 public:
     explicit TextureCache();
     ~TextureCache();
 
-    QImage image(const QString &name) const;
+    /** Returns the texture @p name for a target with device pixel ratio @p dpr, loading it synchronously if necessary. */
+    [[nodiscard]] QImage image(const QString &name, qreal dpr) const;
+
+    /** Returns the texture @p name if already loaded.
+     *  Otherwise the texture is queued for asynchronous loading and @c std::nullopt is returned,
+     *  textureLoaded() is emitted once it becomes available.
+     *  Queued textures are loaded in order of the number of requests they got meanwhile,
+     *  so textures used by many items on screen come first.
+     *  A texture that failed to load is returned as a null image.
+     */
+    [[nodiscard]] std::optional<QImage> requestImage(const QString &name, qreal dpr);
+
+    /** Maximum size of all cached textures, in bytes. */
+    void setMaximumSize(qsizetype size);
+
+    struct Statistics {
+        int hits = 0;
+        int misses = 0;
+        qsizetype size = 0;
+        int count = 0;
+    };
+    /** Cache hit/miss statistics and current size. */
+    [[nodiscard]] Statistics statistics() const;
+
+    /** Process-wide texture cache instance, shared between all scene controllers. */
+    [[nodiscard]] static std::shared_ptr<TextureCache> shared();
+
+Q_SIGNALS:
+    /** Emitted from a worker thread when the asynchronously requested texture @p name
+     *  for device pixel ratio @p devicePixelRatio has been loaded.
+     */
+    void textureLoaded(const QString &name, qreal devicePixelRatio);
 
 private:
+    friend class ::TextureCacheTest;
+
     struct CacheEntry {
         QString name;
+        qreal devicePixelRatio;
         QImage image;
+        uint64_t lastUsed = 0;
+    };
+    struct PendingEntry {
+        QString name;
+        qreal devicePixelRatio;
+        int usage = 0;
+        bool loading = false;
     };
+
+    [[nodiscard]] std::vector<CacheEntry>::iterator findEntry(const QString &name, qreal dpr) const;
+    [[nodiscard]] std::vector<PendingEntry>::iterator findPending(const QString &name, qreal dpr) const;
+    /** Inserts @p entry, unless that texture got loaded meanwhile. Returns the cached image. */
+    QImage insertEntry(CacheEntry &&entry) const;
+    void loadNextPending();
+
+    mutable QMutex m_mutex;
     mutable std::vector<CacheEntry> m_cache;
+    mutable std::vector<PendingEntry> m_pending;
+    mutable uint64_t m_useCounter = 0;
+    mutable Statistics m_stats;
+    qsizetype m_maximumSize = 64 * 1024 * 1024;
+    mutable QThreadPool m_pool;
 };
 
 }
@@ -0,0 +1,147 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "mapcssstylecache.h"
+#include "mapcssstyle.h"
+
+#include <KOSMIndoorMap/MapData>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QUrl>
+
+#include <algorithm>
+#include <vector>
+
+using namespace KOSMIndoorMap;
+
+namespace {
+// compiled styles refer to tag keys owned by the data set, so keep that alive
+struct StyleHolder {
+    QUrl styleUrl;
+    MapData data;
+    MapCSSStyle style;
+    // number of tag keys in the data set at the time of compilation
+    std::size_t tagKeyCount = 0;
+    bool compiled = false;
+
+    void compile()
+    {
+        style.compile(data.dataSet());
+        tagKeyCount = data.dataSet().tagKeyCount();
+        compiled = true;
+    }
+};
+
+struct StyleCache {
+    QMutex mutex;
+    // expired entries are purged before every lookup, so the data set address of a live entry can't be reused
+    std::vector<std::weak_ptr<StyleHolder>> entries;
+
+    void purge()
+    {
+        entries.erase(std::remove_if(entries.begin(), entries.end(), [](const auto &entry) { return entry.expired(); }), entries.end());
+    }
+
+    [[nodiscard]] std::shared_ptr<StyleHolder> find(const QUrl &styleUrl, const MapData &data)
+    {
+        purge();
+        for (const auto &entry : entries) {
+            auto holder = entry.lock();
+            if (holder && holder->compiled && &holder->data.dataSet() == &data.dataSet() && holder->styleUrl == styleUrl) {
+                return holder;
+            }
+        }
+        return {};
+    }
+
+    [[nodiscard]] std::shared_ptr<StyleHolder> holder(const MapCSSStyle *style)
+    {
+        purge();
+        for (const auto &entry : entries) {
+            auto holder = entry.lock();
+            if (holder && &holder->style == style) {
+                return holder;
+            }
+        }
+        return {};
+    }
+};
+}
+
+static StyleCache& styleCache()
+{
+    static StyleCache s_cache;
+    return s_cache;
+}
+
+std::shared_ptr<MapCSSStyle> MapCSSStyleCache::find(const QUrl &styleUrl, const MapData &data, std::shared_ptr<MapCSSStyle> previous)
+{
+    auto &cache = styleCache();
+    QMutexLocker locker(&cache.mutex);
+    if (auto holder = cache.find(styleUrl, data)) {
+        return std::shared_ptr<MapCSSStyle>(holder, &holder->style);
+    }
+    if (!previous || data.isEmpty()) {
+        return {};
+    }
+
+    // previous aliases the holder, so with holder itself there are exactly two references if nobody else uses it
+    auto holder = cache.holder(previous.get());
+    if (!holder || holder->styleUrl != styleUrl || previous.use_count() > 2) {
+        return {};
+    }
+    holder->data = data;
+    holder->compile();
+    return std::move(previous);
+}
+
+std::shared_ptr<MapCSSStyle> MapCSSStyleCache::insert(const QUrl &styleUrl, const MapData &data, MapCSSStyle &&style)
+{
+    auto &cache = styleCache();
+    if (!data.isEmpty()) {
+        QMutexLocker locker(&cache.mutex);
+        if (auto holder = cache.find(styleUrl, data)) {
+            return std::shared_ptr<MapCSSStyle>(holder, &holder->style);
+        }
+    }
+
+    auto holder = std::make_shared<StyleHolder>();
+    holder->styleUrl = styleUrl;
+    holder->style = std::move(style);
+    if (!data.isEmpty()) {
+        holder->data = data;
+        holder->compile();
+    }
+
+    QMutexLocker locker(&cache.mutex);
+    if (!data.isEmpty()) {
+        if (auto other = cache.find(styleUrl, data)) {
+            return std::shared_ptr<MapCSSStyle>(other, &other->style);
+        }
+    }
+    cache.entries.push_back(holder);
+    return std::shared_ptr<MapCSSStyle>(holder, &holder->style);
+}
+
+bool MapCSSStyleCache::recompile(const std::shared_ptr<MapCSSStyle> &style)
+{
+    auto &cache = styleCache();
+    QMutexLocker locker(&cache.mutex);
+    const auto holder = cache.holder(style.get());
+    if (!holder || !holder->compiled || holder->tagKeyCount == holder->data.dataSet().tagKeyCount()) {
+        return false;
+    }
+    holder->compile();
+    return true;
+}
+
+std::size_t MapCSSStyleCache::size()
+{
+    auto &cache = styleCache();
+    QMutexLocker locker(&cache.mutex);
+    cache.purge();
+    return cache.entries.size();
+}
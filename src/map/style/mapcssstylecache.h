@@ -0,0 +1,59 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORMAP_MAPCSSSTYLECACHE_H
+#define KOSMINDOORMAP_MAPCSSSTYLECACHE_H
+
+#include "kosmindoormap_export.h"
+
+#include <cstddef>
+#include <memory>
+
+class QUrl;
+
+namespace KOSMIndoorMap {
+
+class MapCSSStyle;
+class MapData;
+
+/** Process-wide registry of compiled MapCSS styles, shared between map views.
+ *
+ *  Compiling a style resolves tag keys against a specific data set, so styles
+ *  are shared per combination of style URL and map data. Map views loading the same
+ *  map get the same map data from MapLoader, and thus share the compiled style as well.
+ *  Entries are reference-counted, a style is released (together with its reference on
+ *  the map data) when the last view using it drops its reference.
+ */
+class KOSMINDOORMAP_EXPORT MapCSSStyleCache
+{
+public:
+    /** Returns the style loaded from @p styleUrl compiled for @p data, if there is one already.
+     *  Otherwise, if @p previous is an instance of the same style not used anywhere else,
+     *  that is recompiled for @p data and returned. This avoids loading and parsing the
+     *  style sheet again when the data of a view changes.
+     */
+    [[nodiscard]] static std::shared_ptr<MapCSSStyle> find(const QUrl &styleUrl, const MapData &data, std::shared_ptr<MapCSSStyle> previous = {});
+
+    /** Compiles @p style loaded from @p styleUrl for @p data and registers it for sharing.
+     *  If another view registered a style for the same URL and data in the meantime,
+     *  that one is returned instead.
+     *  If @p data is empty, @p style is not compiled and not shared yet. Pass it
+     *  to find() as the previous instance once data is available.
+     */
+    [[nodiscard]] static std::shared_ptr<MapCSSStyle> insert(const QUrl &styleUrl, const MapData &data, MapCSSStyle &&style);
+
+    /** Recompiles @p style if tag keys have been added to its data set since it was compiled,
+     *  e.g. by overlays. Views sharing @p style therefore only recompile it once.
+     *  @returns @c true if @p style has been recompiled.
+     */
+    static bool recompile(const std::shared_ptr<MapCSSStyle> &style);
+
+    /** Number of styles currently loaded. */
+    [[nodiscard]] static std::size_t size();
+};
+
+}
+
+#endif // KOSMINDOORMAP_MAPCSSSTYLECACHE_H
@@ -128,6 +128,16 @@ void MapCSSTerm::compile(const OSM::DataSet &dataSet)
         c->compile(dataSet);
     }
 
+    // conditional expressions are independent of the data set, but we don't want to accumulate entries from previous data sets
+    // created here rather than lazily during evaluation, as compiled styles are evaluated concurrently
+    if (m_op == KOSM_Conditional) {
+        if (m_conditionalCache) {
+            m_conditionalCache->clear();
+        } else {
+            m_conditionalCache = std::make_unique<OSMConditionalExpressionCache>();
+        }
+    }
+
     // TODO resolve tag key in case of m_op == ReadTag and m_children[0] being a constant expression
     // TODO resolve property name in case of m_op == ReadProperty and m_children[0] being a constant expression
 }
@@ -254,13 +264,16 @@ MapCSSValue MapCSSTerm::evaluate(const MapCSSExpressionContext &context) const
         }
         case KOSM_Conditional:
         {
-            OSMConditionalExpression expr; // TODO cache those
-            expr.parse(m_children[0]->evaluate(context).asString());
-
+            const auto source = m_children[0]->evaluate(context).asString();
             OSMConditionalExpressionContext condContext;
             condContext.element = context.state.element;
             condContext.openingHoursCache = context.state.openingHours;
-            return expr.evaluate(condContext);
+            if (!m_conditionalCache) { // not compiled
+                OSMConditionalExpression expr;
+                expr.parse(source);
+                return expr.evaluate(condContext);
+            }
+            return m_conditionalCache->expression(source)->evaluate(condContext);
         }
     }
 
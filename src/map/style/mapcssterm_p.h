@@ -18,6 +18,7 @@ namespace OSM { class DataSet; }
 namespace KOSMIndoorMap {
 
 class MapCSSExpressionContext;
+class OSMConditionalExpressionCache;
 
 /** Part of a MapCSS eval() expression. */
 class MapCSSTerm {
@@ -106,6 +107,10 @@ public:
     Operation m_op = Unknown;
     std::vector<std::unique_ptr<MapCSSTerm>> m_children;
     MapCSSValue m_literal;
+
+private:
+    /** Parsed conditional expressions for KOSM_Conditional. */
+    std::unique_ptr<OSMConditionalExpressionCache> m_conditionalCache;
 };
 
 }
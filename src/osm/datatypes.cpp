@@ -6,6 +6,9 @@
 
 #include "datatypes.h"
 
+#include <algorithm>
+#include <iterator>
+
 using namespace OSM;
 
 const char* OSM::typeName(Type type)
@@ -40,6 +43,11 @@ TagKey DataSet::tagKey(const char *keyName) const
     return m_tagKeyRegistry.key(keyName);
 }
 
+std::size_t DataSet::tagKeyCount() const
+{
+    return m_tagKeyRegistry.size();
+}
+
 Role DataSet::role(const char *roleName) const
 {
     return m_roleRegistry.key(roleName);
@@ -115,6 +123,77 @@ void DataSet::addRelation(Relation &&rel)
     relations.insert(it, std::move(rel));
 }
 
+template <typename Elem>
+static void remapTags(std::vector<Elem> &elements, const StringKeyMapping<TagKey> &mapping)
+{
+    for (auto &elem : elements) {
+        bool changed = false;
+        for (auto &tag : elem.tags) {
+            const auto key = mapping.map(tag.key);
+            changed |= key != tag.key;
+            tag.key = key;
+        }
+        // tags are sorted by key pointer, so this can change the order
+        if (changed) {
+            std::sort(elem.tags.begin(), elem.tags.end());
+        }
+    }
+}
+
+template <typename Elem>
+static void mergeElements(std::vector<Elem> &elements, std::vector<Elem> &&other, DataSet::ConflictPolicy policy)
+{
+    if (other.empty()) {
+        return;
+    }
+    // common case of disjoint id ranges, e.g. for internal ids
+    if (elements.empty() || elements.back().id < other.front().id) {
+        elements.insert(elements.end(), std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        other.clear();
+        return;
+    }
+
+    std::vector<Elem> result;
+    result.reserve(elements.size() + other.size());
+    auto it = elements.begin();
+    auto otherIt = other.begin();
+    while (it != elements.end() && otherIt != other.end()) {
+        if ((*it).id < (*otherIt).id) {
+            result.push_back(std::move(*it++));
+        } else if ((*otherIt).id < (*it).id) {
+            result.push_back(std::move(*otherIt++));
+        } else {
+            result.push_back(policy == DataSet::ConflictPolicy::KeepExisting ? std::move(*it) : std::move(*otherIt));
+            ++it;
+            ++otherIt;
+        }
+    }
+    std::move(it, elements.end(), std::back_inserter(result));
+    std::move(otherIt, other.end(), std::back_inserter(result));
+    elements = std::move(result);
+    other.clear();
+}
+
+void DataSet::unite(DataSet &&other, ConflictPolicy policy)
+{
+    if (const auto mapping = m_tagKeyRegistry.merge(std::move(other.m_tagKeyRegistry)); !mapping.isEmpty()) {
+        remapTags(other.nodes, mapping);
+        remapTags(other.ways, mapping);
+        remapTags(other.relations, mapping);
+    }
+    if (const auto mapping = m_roleRegistry.merge(std::move(other.m_roleRegistry)); !mapping.isEmpty()) {
+        for (auto &rel : other.relations) {
+            for (auto &member : rel.members) {
+                member.setRole(mapping.map(member.role()));
+            }
+        }
+    }
+
+    mergeElements(nodes, std::move(other.nodes), policy);
+    mergeElements(ways, std::move(other.ways), policy);
+    mergeElements(relations, std::move(other.relations), policy);
+}
+
 OSM::Id DataSet::nextInternalId() const
 {
     static OSM::Id nextId = 0;
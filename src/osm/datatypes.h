@@ -373,6 +373,20 @@ public:
     void addWay(Way &&way);
     void addRelation(Relation &&rel);
 
+    /** How to handle elements present in both data sets in unite(). */
+    enum class ConflictPolicy : uint8_t {
+        KeepExisting, ///< keep the element of this data set, same as addNode() etc.
+        ReplaceExisting, ///< replace the element in this data set with the one of the other data set
+    };
+
+    /** Adds all elements of @p other to this data set.
+     *  This merges the sorted element lists in a single linear pass and transfers
+     *  tag keys and role names in bulk, which is considerably faster than adding
+     *  elements of @p other one by one.
+     *  @p other is empty afterwards.
+     */
+    void unite(DataSet &&other, ConflictPolicy policy = ConflictPolicy::KeepExisting);
+
     /** Look up a tag key for the given tag name, if it exists.
      *  If no key exists, an empty/invalid/null key is returned.
      *  Use this for tag lookup, not for creating/adding tags.
@@ -387,6 +401,11 @@ public:
      */
     [[nodiscard]] TagKey makeTagKey(const char *keyName, StringMemory keyMemOpt = StringMemory::Transient);
 
+    /** Number of tag keys in this data set.
+     *  This only ever grows, use it to detect whether new tag keys have been added.
+     */
+    [[nodiscard]] std::size_t tagKeyCount() const;
+
     /** Looks up a role name key.
      *  @see tagKey()
      */
@@ -8,6 +8,8 @@
 
 #include <QLineF>
 
+#include <algorithm>
+#include <cassert>
 #include <limits>
 
 using namespace OSM;
@@ -72,3 +74,82 @@ double OSM::distance(const std::vector<const OSM::Node*> &path, OSM::Coordinate
     }
     return dist;
 }
+
+// meters per latitude unit of OSM::Coordinate
+constexpr inline double LAT_SCALE = 6371000.0 * M_PI / 180.0 / 10'000'000.0;
+
+LocalDistance::LocalDistance(Coordinate ref)
+    : m_refLat(ref.latitude)
+    , m_refLon(ref.longitude)
+{
+    // longitude scale is cos(lat) at the mean latitude of the two points, which we approximate
+    // as cos(lat0 + dlat/2) ~ cos(lat0) - sin(lat0) * dlat/2
+    const auto lat = degToRad(ref.latF());
+    m_xScale = LAT_SCALE * std::cos(lat);
+    m_xScaleSlope = LAT_SCALE * std::sin(lat) * degToRad(1.0 / 10'000'000.0) / 2.0;
+}
+
+LocalDistance::Point LocalDistance::project(Coordinate coord) const
+{
+    const auto dLat = (double)((int64_t)coord.latitude - m_refLat);
+    const auto dLon = (double)((int64_t)coord.longitude - m_refLon);
+    return { dLon * (m_xScale - m_xScaleSlope * dLat), dLat * LAT_SCALE };
+}
+
+double LocalDistance::distance(Coordinate coord) const
+{
+    const auto p = project(coord);
+    return std::sqrt(p.x * p.x + p.y * p.y);
+}
+
+void LocalDistance::distances(std::span<const Coordinate> coords, std::span<double> result) const
+{
+    assert(coords.size() == result.size());
+    for (std::size_t i = 0; i < coords.size(); ++i) {
+        const auto p = project(coords[i]);
+        result[i] = std::sqrt(p.x * p.x + p.y * p.y);
+    }
+}
+
+// squared distance between the origin and the line segment given by @p a and @p b
+[[nodiscard]] static double originToSegmentDistanceSquared(double ax, double ay, double bx, double by)
+{
+    const auto dx = bx - ax;
+    const auto dy = by - ay;
+    const auto len2 = dx * dx + dy * dy;
+    const auto r = len2 > 0.0 ? std::clamp(-(ax * dx + ay * dy) / len2, 0.0, 1.0) : 0.0;
+    const auto px = ax + r * dx;
+    const auto py = ay + r * dy;
+    return px * px + py * py;
+}
+
+double LocalDistance::distance(const std::vector<const OSM::Node*> &path) const
+{
+    if (path.empty()) {
+        return std::numeric_limits<double>::max();
+    }
+
+    if (path.size() == 1) {
+        return distance(path[0]->coordinate);
+    }
+
+    // same loop handling as in OSM::distance for paths, but working on squared distances in the projected space
+    auto dist = std::numeric_limits<double>::max();
+    OSM::Id firstNode = 0;
+    for (auto it = path.begin(); it != std::prev(path.end()) && it != path.end(); ++it) {
+        const auto nextIt = std::next(it);
+        if (firstNode == 0) { // starting a new loop
+            firstNode = (*it)->id;
+        }
+
+        const auto a = project((*it)->coordinate);
+        const auto b = project((*nextIt)->coordinate);
+        dist = std::min(dist, originToSegmentDistanceSquared(a.x, a.y, b.x, b.y));
+
+        if ((*nextIt)->id == firstNode) { // just closed a loop, so this is not a line on the path
+            firstNode = 0;
+            ++it;
+        }
+    }
+    return std::sqrt(dist);
+}
@@ -12,6 +12,7 @@
 #include "datatypes.h"
 
 #include <cmath>
+#include <span>
 
 namespace OSM {
 
@@ -38,6 +39,46 @@ namespace OSM {
 /** Distance between the given polygon and coordinate, in meter. */
 [[nodiscard]] KOSM_EXPORT double distance(const std::vector<const OSM::Node*> &path, Coordinate coord);
 
+/** Fast approximate distances from a fixed reference point.
+ *  This uses a local equirectangular projection around the reference point, with a first order
+ *  correction for the change of longitude scale with latitude. That avoids the trigonometric functions
+ *  of the haversine formula used by OSM::distance() for each point.
+ *
+ *  Within 10km of the reference point the results deviate less than 0.001% from OSM::distance(), which
+ *  is more than enough for anything inside a venue. Results across the antimeridian are wrong though.
+ */
+class KOSM_EXPORT LocalDistance
+{
+public:
+    explicit LocalDistance(Coordinate ref);
+
+    /** Distance between the reference point and @p coord, in meter. */
+    [[nodiscard]] double distance(Coordinate coord) const;
+    /** Distances between the reference point and each of @p coords, in meter.
+     *  @p result has to be of the same size as @p coords.
+     */
+    void distances(std::span<const Coordinate> coords, std::span<double> result) const;
+    /** Distance between the reference point and the given polygon or polyline, in meter.
+     *  Unlike OSM::distance(const std::vector<const OSM::Node*>&, Coordinate) this finds the closest point
+     *  on each segment in the projected metric space rather than in degrees. Away from the equator the latter
+     *  overestimates the distance to diagonal segments, by 17% for a north-east segment at 70° latitude for example.
+     *  Same semantics for paths consisting of multiple loops otherwise.
+     */
+    [[nodiscard]] double distance(const std::vector<const OSM::Node*> &path) const;
+
+private:
+    struct Point {
+        double x;
+        double y;
+    };
+    [[nodiscard]] Point project(Coordinate coord) const;
+
+    int64_t m_refLat;
+    int64_t m_refLon;
+    double m_xScale;
+    double m_xScaleSlope;
+};
+
 }
 
 #endif // OSM_GEOMATH_H
@@ -37,6 +37,8 @@ enum : uint8_t {
 enum : uint16_t {
     O5M_STRING_TABLE_SIZE = 15000,
     O5M_STRING_TABLE_MAXLEN = 250,
+    /** Number of elements after which the writer inserts a reset marker, to allow parallel decoding. */
+    O5M_ELEMENTS_PER_RESET = 16384,
 };
 
 constexpr inline const char O5M_HEADER[] = "o5m2";
@@ -10,6 +10,8 @@
 #include "datasetmergebuffer.h"
 
 #include <QDebug>
+#include <QMutex>
+#include <QThreadPool>
 
 #include <cstdlib>
 #include <cstring>
@@ -22,15 +24,29 @@ O5mParser::O5mParser(DataSet *dataSet)
     m_stringLookupTable.resize(O5M_STRING_TABLE_SIZE);
 }
 
+void O5mParser::setThreadCount(int threadCount)
+{
+    m_threadCount = threadCount;
+}
+
 void O5mParser::readFromData(const uint8_t* data, std::size_t len)
 {
-    std::fill(m_stringLookupTable.begin(), m_stringLookupTable.end(), nullptr);
+    if (m_threadCount != 1) {
+        readParallel(data, len);
+    } else {
+        readChunk(data, data + len);
+    }
+}
+
+bool O5mParser::readChunk(const uint8_t *begin, const uint8_t *endIt)
+{
+    resetStringTable();
     resetDeltaCodingState();
 
-    const auto endIt = data + len;
-    for (auto it = data; it < endIt - 1;) {
+    for (auto it = begin; it < endIt - 1;) {
         const auto blockType = (*it);
         if (blockType == O5M_BLOCK_RESET) {
+            resetStringTable();
             resetDeltaCodingState();
             ++it;
             continue;
@@ -39,13 +55,13 @@ void O5mParser::readFromData(const uint8_t* data, std::size_t len)
         auto blockSize = readUnsigned(++it, endIt);
         if (blockSize >= (uint64_t)(endIt - it)) {
             qWarning() << "premature end of file, or blocksize too large" << (endIt - it) << blockType << blockSize;
-            break;
+            return false;
         }
         switch (blockType) {
             case O5M_BLOCK_HEADER:
                 if (blockSize != 4 || std::strncmp(reinterpret_cast<const char*>(it), O5M_HEADER, 4) != 0) {
                     qWarning() << "Invalid file header";
-                    return;
+                    return false;
                 }
                 break;
             case O5M_BLOCK_BOUNDING_BOX:
@@ -62,11 +78,106 @@ void O5mParser::readFromData(const uint8_t* data, std::size_t len)
                 readRelation(it, it + blockSize);
                 break;
             default:
-                qDebug() << "unhandled o5m block type:" << (it - data) << blockType << blockSize;
+                qDebug() << "unhandled o5m block type:" << (it - begin) << blockType << blockSize;
         }
 
         it += blockSize;
     }
+    return true;
+}
+
+void O5mParser::readParallel(const uint8_t *data, std::size_t len)
+{
+    // find reset markers, those split the input into independently decodable chunks
+    std::vector<const uint8_t*> chunks;
+    chunks.push_back(data);
+    const auto endIt = data + len;
+    for (auto it = data; it < endIt - 1;) {
+        if ((*it) == O5M_BLOCK_RESET) {
+            if (it != data) {
+                chunks.push_back(it);
+            }
+            ++it;
+            continue;
+        }
+        const auto blockSize = readUnsigned(++it, endIt);
+        if (blockSize >= (uint64_t)(endIt - it)) {
+            break; // reported when decoding the affected chunk
+        }
+        it += blockSize;
+    }
+    chunks.push_back(endIt);
+
+    if (chunks.size() <= 2) {
+        readChunk(data, endIt);
+        return;
+    }
+
+    // decode chunks into separate buffers
+    QMutex keyMutex;
+    const auto chunkCount = chunks.size() - 1;
+    std::vector<DataSetMergeBuffer> buffers(chunkCount);
+    std::vector<char> chunkValid(chunkCount, false);
+    {
+        QThreadPool pool;
+        if (m_threadCount > 0) {
+            pool.setMaxThreadCount(m_threadCount);
+        }
+        for (std::size_t i = 0; i < chunkCount; ++i) {
+            pool.start([this, i, &chunks, &buffers, &chunkValid, &keyMutex]() {
+                O5mParser p(m_dataSet);
+                p.m_keyMutex = &keyMutex;
+                p.setMergeBuffer(&buffers[i]);
+                chunkValid[i] = p.readChunk(chunks[i], chunks[i + 1]);
+            });
+        }
+        pool.waitForDone();
+    }
+
+    // merge in input order, stopping where serial decoding would have stopped
+    for (std::size_t i = 0; i < chunkCount; ++i) {
+        for (auto &node : buffers[i].nodes) {
+            addNode(std::move(node));
+        }
+        for (auto &way : buffers[i].ways) {
+            addWay(std::move(way));
+        }
+        for (auto &rel : buffers[i].relations) {
+            addRelation(std::move(rel));
+        }
+        if (!chunkValid[i]) {
+            break;
+        }
+    }
+}
+
+TagKey O5mParser::makeTagKey(const char *keyName)
+{
+    if (!m_keyMutex) {
+        return m_dataSet->makeTagKey(keyName, OSM::StringMemory::Transient); // TODO make use of mmap'ed data for this
+    }
+
+    // strings referenced via the string table point to the same location in the input data
+    const auto it = m_tagKeyCache.find(keyName);
+    if (it != m_tagKeyCache.end()) {
+        return (*it).second;
+    }
+
+    QMutexLocker locker(m_keyMutex);
+    const auto key = m_dataSet->makeTagKey(keyName, OSM::StringMemory::Transient);
+    locker.unlock();
+    m_tagKeyCache.insert({keyName, key});
+    return key;
+}
+
+Role O5mParser::makeRole(const char *roleName)
+{
+    if (!m_keyMutex) {
+        return m_dataSet->makeRole(roleName, OSM::StringMemory::Transient);
+    }
+
+    QMutexLocker locker(m_keyMutex);
+    return m_dataSet->makeRole(roleName, OSM::StringMemory::Transient);
 }
 
 uint64_t O5mParser::readUnsigned(const uint8_t *&it, const uint8_t *endIt) const
@@ -170,7 +281,7 @@ void O5mParser::readTagOrBbox(Elem &e, const uint8_t *&it, const uint8_t *endIt)
     }
 
     OSM::Tag tag;
-    tag.key = m_dataSet->makeTagKey(tagData.first, OSM::StringMemory::Transient); // TODO make use of mmap'ed data for this
+    tag.key = makeTagKey(tagData.first);
     tag.value = QByteArray(tagData.second);
     e.tags.push_back(std::move(tag));
 }
@@ -191,7 +302,7 @@ void O5mParser::readNode(const uint8_t *begin, const uint8_t *end)
         OSM::Tag tag;
         const auto tagData = readStringPair(it, end);
         if (tagData.first) {
-            tag.key = m_dataSet->makeTagKey(tagData.first, OSM::StringMemory::Transient); // TODO use the fact this is mmap'ed data here
+            tag.key = makeTagKey(tagData.first);
             tag.value = QByteArray(tagData.second);
             node.tags.push_back(std::move(tag));
         }
@@ -257,7 +368,7 @@ void O5mParser::readRelation(const uint8_t *begin, const uint8_t *end)
                 mem.setType(OSM::Type::Relation);
                 break;
         }
-        mem.setRole(m_dataSet->makeRole(typeAndRole + 1, OSM::StringMemory::Transient));
+        mem.setRole(makeRole(typeAndRole + 1));
 
         rel.members.push_back(std::move(mem));
     }
@@ -272,6 +383,12 @@ void O5mParser::readRelation(const uint8_t *begin, const uint8_t *end)
     addRelation(std::move(rel));
 }
 
+void O5mParser::resetStringTable()
+{
+    std::fill(m_stringLookupTable.begin(), m_stringLookupTable.end(), nullptr);
+    m_stringLookupPosition = 0;
+}
+
 void O5mParser::resetDeltaCodingState()
 {
     m_nodeIdDelta = 0;
@@ -9,12 +9,15 @@
 
 #include "kosm_export.h"
 #include "abstractreader.h"
+#include "datatypes.h"
 
 #include <cstddef>
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 class O5mParserTest;
+class QMutex;
 
 namespace OSM {
 
@@ -29,8 +32,24 @@ class KOSM_EXPORT O5mParser : public AbstractReader
 public:
     explicit O5mParser(DataSet *dataSet);
 
+    /** Enables parallel decoding using up to @p threadCount threads.
+     *  The input is split at reset markers, which reset the string table and the delta
+     *  coding state and thus result in independently decodable chunks. The result is
+     *  identical to serial decoding.
+     *  A value of 1 (the default) disables parallel decoding, 0 uses all available cores.
+     */
+    void setThreadCount(int threadCount);
+
 private:
     void readFromData(const uint8_t *data, std::size_t len) override;
+    /** Decodes the blocks in [@p begin, @p end).
+     *  @returns @c false if decoding had to be aborted due to invalid input.
+     */
+    bool readChunk(const uint8_t *begin, const uint8_t *end);
+    void readParallel(const uint8_t *data, std::size_t len);
+
+    [[nodiscard]] TagKey makeTagKey(const char *keyName);
+    [[nodiscard]] Role makeRole(const char *roleName);
 
     friend class ::O5mParserTest;
 
@@ -50,8 +69,9 @@ private:
     void readWay(const uint8_t *begin, const uint8_t *end);
     void readRelation(const uint8_t *begin, const uint8_t *end);
 
-    // delta coding state
+    // delta coding and string table state
     void resetDeltaCodingState();
+    void resetStringTable();
 
     int64_t m_nodeIdDelta = 0;
     int32_t m_latDelata = 0; // this can overflow, but that is intentional according to the spec!
@@ -67,6 +87,12 @@ private:
 
     std::vector<const char*> m_stringLookupTable;
     uint16_t m_stringLookupPosition = 0;
+
+    int m_threadCount = 1;
+    // for parallel decoding: shared lock for creating string keys in the DataSet
+    // and a per-thread cache for those, keyed by the string location in the input data
+    QMutex *m_keyMutex = nullptr;
+    std::unordered_map<const char*, TagKey> m_tagKeyCache;
 };
 
 }
@@ -73,7 +73,16 @@ void O5mWriter::writeNodes(const OSM::DataSet &dataSet, QIODevice *io)
 
     QByteArray bufferData;
     QBuffer buffer(&bufferData);
+    std::size_t count = 0;
     for(auto const &node: dataSet.nodes) {
+        if (++count % O5M_ELEMENTS_PER_RESET == 0) {
+            writeByte(O5M_BLOCK_RESET, io);
+            m_stringTable.clear();
+            prevId = 0;
+            prevLat = 900'000'000ll;
+            prevLon = 1'800'000'000ll;
+        }
+
         bufferData.clear();
         buffer.open(QIODevice::WriteOnly);
         writeByte(O5M_BLOCK_NODE, io);
@@ -111,7 +120,15 @@ void O5mWriter::writeWays(const OSM::DataSet &dataSet, QIODevice *io)
     QByteArray referencesBufferData;
     QBuffer referencesBuffer(&referencesBufferData);
 
+    std::size_t count = 0;
     for (auto const &way: dataSet.ways) {
+        if (++count % O5M_ELEMENTS_PER_RESET == 0) {
+            writeByte(O5M_BLOCK_RESET, io);
+            m_stringTable.clear();
+            prevId = 0;
+            prevNodeId = 0;
+        }
+
         writeByte(O5M_BLOCK_WAY, io);
 
         bufferData.clear();
@@ -153,7 +170,15 @@ void O5mWriter::writeRelations(const OSM::DataSet &dataSet, QIODevice *io)
     QBuffer referencesBuffer(&referencesBufferData);
     QByteArray role;
 
+    std::size_t count = 0;
     for (auto const &relation: dataSet.relations) {
+        if (++count % O5M_ELEMENTS_PER_RESET == 0) {
+            writeByte(O5M_BLOCK_RESET, io);
+            m_stringTable.clear();
+            prevId = 0;
+            std::fill(std::begin(prevMemberId), std::end(prevMemberId), 0);
+        }
+
         writeByte(O5M_BLOCK_RELATION, io);
 
         bufferData.clear();
@@ -4,13 +4,14 @@
 */
 
 #include "oscparser.h"
+#include "xmlpullparser.h"
+#include "datasetmergebuffer.h"
 #include "datatypes.h"
 
 #include <QDebug>
 #include <QIODevice>
 #include <QXmlStreamReader>
 
-#include <cmath>
 
 using namespace Qt::Literals::StringLiterals;
 using namespace OSM;
@@ -42,6 +43,95 @@ void OscParser::readFromIODevice(QIODevice *io)
     }
 }
 
+void OscParser::readFromData(const uint8_t *data, std::size_t len)
+{
+    // changes are only applied once the entire input has been parsed successfully
+    // so we can still fall back to QXmlStreamReader otherwise
+    enum class Action : uint8_t { None, Create, Modify, Delete };
+    std::vector<std::pair<Action, OSM::Type>> changes;
+    DataSetMergeBuffer buffer;
+
+    XmlPullParser reader(reinterpret_cast<const char*>(data), reinterpret_cast<const char*>(data) + len);
+    auto action = Action::None;
+    while (!reader.atEnd()) {
+        const auto token = reader.readNext();
+        if (token == XmlPullParser::EndElement && (reader.name() == "create" || reader.name() == "modify" || reader.name() == "delete")) {
+            action = Action::None;
+            continue;
+        }
+        if (token != XmlPullParser::StartElement) {
+            continue;
+        }
+
+        if (reader.name() == "create") {
+            action = Action::Create;
+        } else if (reader.name() == "modify") {
+            action = Action::Modify;
+        } else if (reader.name() == "delete") {
+            action = Action::Delete;
+        } else if (action != Action::None) {
+            if (reader.name() == "node") {
+                buffer.nodes.push_back(parseNode(reader));
+                changes.emplace_back(action, OSM::Type::Node);
+            } else if (reader.name() == "way") {
+                buffer.ways.push_back(parseWay(reader));
+                changes.emplace_back(action, OSM::Type::Way);
+            } else if (reader.name() == "relation") {
+                buffer.relations.push_back(parseRelation(reader));
+                changes.emplace_back(action, OSM::Type::Relation);
+            } else {
+                reader.skipCurrentElement();
+            }
+        }
+    }
+    clearStringCache();
+
+    if (reader.hasError()) {
+        AbstractReader::readFromData(data, len);
+        return;
+    }
+
+    auto nodeIt = buffer.nodes.begin();
+    auto wayIt = buffer.ways.begin();
+    auto relIt = buffer.relations.begin();
+    for (const auto &[changeAction, type] : changes) {
+        switch (type) {
+            case OSM::Type::Null:
+                break;
+            case OSM::Type::Node:
+                if (changeAction == Action::Create) {
+                    create(std::move(*nodeIt));
+                } else if (changeAction == Action::Modify) {
+                    modify(std::move(*nodeIt));
+                } else {
+                    remove(*nodeIt, m_dataSet->nodes);
+                }
+                ++nodeIt;
+                break;
+            case OSM::Type::Way:
+                if (changeAction == Action::Create) {
+                    create(std::move(*wayIt));
+                } else if (changeAction == Action::Modify) {
+                    modify(std::move(*wayIt));
+                } else {
+                    remove(*wayIt, m_dataSet->ways);
+                }
+                ++wayIt;
+                break;
+            case OSM::Type::Relation:
+                if (changeAction == Action::Create) {
+                    create(std::move(*relIt));
+                } else if (changeAction == Action::Modify) {
+                    modify(std::move(*relIt));
+                } else {
+                    remove(*relIt, m_dataSet->relations);
+                }
+                ++relIt;
+                break;
+        }
+    }
+}
+
 template <typename T>
 void OscParser::assignNewId(T &elem, std::unordered_map<OSM::Id, OSM::Id> &idMap)
 {
@@ -93,19 +183,11 @@ void OscParser::parseCreate(QXmlStreamReader &reader)
             continue;
         }
         if (reader.name() == "node"_L1) {
-            auto node = parseNode(reader);
-            assignNewId(node, m_nodeIdMap);
-            addNode(std::move(node));
+            create(parseNode(reader));
         } else if (reader.name() == "way"_L1) {
-            auto way = parseWay(reader);
-            assignNewId(way, m_wayIdMap);
-            mapNodeIds(way);
-            addWay(std::move(way));
-        } else if (reader.name() == "releation"_L1) {
-            auto rel = parseRelation(reader);
-            assignNewId(rel, m_relIdMap);
-            mapMemberIds(rel);
-            addRelation(std::move(rel));
+            create(parseWay(reader));
+        } else if (reader.name() == "relation"_L1) {
+            create(parseRelation(reader));
         } else {
             reader.skipCurrentElement();
         }
@@ -123,43 +205,11 @@ void OscParser::parseModify(QXmlStreamReader &reader)
             continue;
         }
         if (reader.name() == "node"_L1) {
-            auto modifiedNode = parseNode(reader);
-            if (const auto it = std::lower_bound(m_dataSet->nodes.begin(), m_dataSet->nodes.end(), modifiedNode.id); it != m_dataSet->nodes.end() && (*it).id == modifiedNode.id) {
-                if (modifiedNode.coordinate.isValid()) {
-                    (*it).coordinate = modifiedNode.coordinate;
-                }
-                if (!modifiedNode.tags.empty()) {
-                    (*it).tags = std::move(modifiedNode.tags);
-                }
-            } else {
-                qDebug() << "modified node not in data set:" << modifiedNode.url();
-            }
+            modify(parseNode(reader));
         } else if (reader.name() == "way"_L1) {
-            auto modifiedWay = parseWay(reader);
-            if (const auto it = std::lower_bound(m_dataSet->ways.begin(), m_dataSet->ways.end(), modifiedWay.id); it != m_dataSet->ways.end() && (*it).id == modifiedWay.id) {
-                if (!modifiedWay.tags.empty()) {
-                    (*it).tags = std::move(modifiedWay.tags);
-                }
-                if (!modifiedWay.nodes.empty()) {
-                    mapNodeIds(modifiedWay);
-                    (*it).nodes = std::move(modifiedWay.nodes);
-                }
-            } else {
-                qDebug() << "modified way not in data set:" << modifiedWay.url();
-            }
-        } else if (reader.name() == "releation"_L1) {
-            auto modifiedRel = parseRelation(reader);
-            if (const auto it = std::lower_bound(m_dataSet->relations.begin(), m_dataSet->relations.end(), modifiedRel.id); it != m_dataSet->relations.end() && (*it).id == modifiedRel.id) {
-                if (!modifiedRel.tags.empty()) {
-                    (*it).tags = std::move(modifiedRel.tags);
-                }
-                if (!modifiedRel.members.empty()) {
-                    mapMemberIds(modifiedRel);
-                    (*it).members = std::move(modifiedRel.members);
-                }
-            } else {
-                qDebug() << "modified relation not in data set:" << modifiedRel.url();
-            }
+            modify(parseWay(reader));
+        } else if (reader.name() == "relation"_L1) {
+            modify(parseRelation(reader));
         } else {
             reader.skipCurrentElement();
         }
@@ -168,40 +218,96 @@ void OscParser::parseModify(QXmlStreamReader &reader)
 
 void OscParser::parseDelete(QXmlStreamReader &reader)
 {
-    // we don't actually delete but just drop all tags
-    // this avoids having to deal with broken referential integrity
-    // but nevertheless results in the deleted element having not effect anymore
     while (!reader.atEnd() && !reader.hasError()) {
         reader.readNext();
-        if (reader.tokenType() == QXmlStreamReader::EndElement && reader.name() == "modify"_L1) {
+        if (reader.tokenType() == QXmlStreamReader::EndElement && reader.name() == "delete"_L1) {
             return;
         }
         if (reader.tokenType() != QXmlStreamReader::StartElement) {
             continue;
         }
         if (reader.name() == "node"_L1) {
-            const auto node = parseNode(reader);
-            if (const auto it = std::lower_bound(m_dataSet->nodes.begin(), m_dataSet->nodes.end(), node.id); it != m_dataSet->nodes.end() && (*it).id == node.id) {
-                (*it).tags.clear();
-            } else {
-                qDebug() << "deleted node not in data set:" << node.url();
-            }
+            remove(parseNode(reader), m_dataSet->nodes);
         } else if (reader.name() == "way"_L1) {
-            const auto way = parseWay(reader);
-            if (const auto it = std::lower_bound(m_dataSet->ways.begin(), m_dataSet->ways.end(), way.id); it != m_dataSet->ways.end() && (*it).id == way.id) {
-                (*it).tags.clear();
-            } else {
-                qDebug() << "modified way not in data set:" << way.url();
-            }
-        } else if (reader.name() == "releation"_L1) {
-            const auto rel = parseRelation(reader);
-            if (const auto it = std::lower_bound(m_dataSet->relations.begin(), m_dataSet->relations.end(), rel.id); it != m_dataSet->relations.end() && (*it).id == rel.id) {
-                (*it).tags.clear();
-            } else {
-                qDebug() << "modified relation not in data set:" << rel.url();
-            }
+            remove(parseWay(reader), m_dataSet->ways);
+        } else if (reader.name() == "relation"_L1) {
+            remove(parseRelation(reader), m_dataSet->relations);
         } else {
             reader.skipCurrentElement();
         }
     }
 }
+
+void OscParser::create(OSM::Node &&node)
+{
+    assignNewId(node, m_nodeIdMap);
+    addNode(std::move(node));
+}
+
+void OscParser::create(OSM::Way &&way)
+{
+    assignNewId(way, m_wayIdMap);
+    mapNodeIds(way);
+    addWay(std::move(way));
+}
+
+void OscParser::create(OSM::Relation &&rel)
+{
+    assignNewId(rel, m_relIdMap);
+    mapMemberIds(rel);
+    addRelation(std::move(rel));
+}
+
+void OscParser::modify(OSM::Node &&modifiedNode)
+{
+    if (const auto it = std::lower_bound(m_dataSet->nodes.begin(), m_dataSet->nodes.end(), modifiedNode.id); it != m_dataSet->nodes.end() && (*it).id == modifiedNode.id) {
+        if (modifiedNode.coordinate.isValid()) {
+            (*it).coordinate = modifiedNode.coordinate;
+        }
+        if (!modifiedNode.tags.empty()) {
+            (*it).tags = std::move(modifiedNode.tags);
+        }
+    } else {
+        qDebug() << "modified node not in data set:" << modifiedNode.url();
+    }
+}
+
+void OscParser::modify(OSM::Way &&modifiedWay)
+{
+    if (const auto it = std::lower_bound(m_dataSet->ways.begin(), m_dataSet->ways.end(), modifiedWay.id); it != m_dataSet->ways.end() && (*it).id == modifiedWay.id) {
+        if (!modifiedWay.tags.empty()) {
+            (*it).tags = std::move(modifiedWay.tags);
+        }
+        if (!modifiedWay.nodes.empty()) {
+            mapNodeIds(modifiedWay);
+            (*it).nodes = std::move(modifiedWay.nodes);
+        }
+    } else {
+        qDebug() << "modified way not in data set:" << modifiedWay.url();
+    }
+}
+
+void OscParser::modify(OSM::Relation &&modifiedRel)
+{
+    if (const auto it = std::lower_bound(m_dataSet->relations.begin(), m_dataSet->relations.end(), modifiedRel.id); it != m_dataSet->relations.end() && (*it).id == modifiedRel.id) {
+        if (!modifiedRel.tags.empty()) {
+            (*it).tags = std::move(modifiedRel.tags);
+        }
+        if (!modifiedRel.members.empty()) {
+            mapMemberIds(modifiedRel);
+            (*it).members = std::move(modifiedRel.members);
+        }
+    } else {
+        qDebug() << "modified relation not in data set:" << modifiedRel.url();
+    }
+}
+
+template <typename T>
+void OscParser::remove(const T &elem, std::vector<T> &elements)
+{
+    if (const auto it = std::lower_bound(elements.begin(), elements.end(), elem.id); it != elements.end() && (*it).id == elem.id) {
+        (*it).tags.clear();
+    } else {
+        qDebug() << "deleted element not in data set:" << elem.url();
+    }
+}
@@ -23,10 +23,25 @@ public:
 
 private:
     void readFromIODevice(QIODevice *io) override;
+    void readFromData(const uint8_t *data, std::size_t len) override;
     void parseCreate(QXmlStreamReader &reader);
     void parseModify(QXmlStreamReader &reader);
     void parseDelete(QXmlStreamReader &reader);
 
+    /** Apply individual changes to the data set. */
+    void create(OSM::Node &&node);
+    void create(OSM::Way &&way);
+    void create(OSM::Relation &&rel);
+    void modify(OSM::Node &&modifiedNode);
+    void modify(OSM::Way &&modifiedWay);
+    void modify(OSM::Relation &&modifiedRel);
+    /** We don't actually delete but just drop all tags.
+     *  This avoids having to deal with broken referential integrity
+     *  but nevertheless results in the deleted element having not effect anymore.
+     */
+    template <typename T>
+    void remove(const T &elem, std::vector<T> &elements);
+
     template <typename T>
     void assignNewId(T &elem, std::unordered_map<OSM::Id, OSM::Id> &idMap);
     [[nodiscard]] static OSM::Id mapId(OSM::Id id, const std::unordered_map<OSM::Id, OSM::Id> &idMap);
@@ -80,9 +80,9 @@ DataSet&& OverpassQuery::takeResult()
     return std::move(m_result);
 }
 
-OverpassQuery::Error OverpassQuery::processReply(QNetworkReply *reply)
+OverpassQuery::Error OverpassQuery::processReply(QNetworkReply *reply, DataSet &result) const
 {
-    auto reader = OSM::IO::readerForMimeType(u"application/vnd.openstreetmap.data+xml", &m_result);
+    auto reader = OSM::IO::readerForMimeType(u"application/vnd.openstreetmap.data+xml", &result);
     if (!reader) {
         qWarning() << "No support for reading OSM XML available!";
         return QueryError;
@@ -93,10 +93,15 @@ OverpassQuery::Error OverpassQuery::processReply(QNetworkReply *reply)
         qWarning() << "Request:" << reply->request().url();
         return reader->errorString().contains(QLatin1String("timed out"), Qt::CaseInsensitive) ? QueryTimeout : QueryError;
     }
-    qDebug() << "Nodes:" << m_result.nodes.size();
-    qDebug() << "Ways:" << m_result.ways.size();
-    qDebug() << "Relations:" << m_result.relations.size();
+    qDebug() << "Nodes:" << result.nodes.size();
+    qDebug() << "Ways:" << result.ways.size();
+    qDebug() << "Relations:" << result.relations.size();
     return NoError;
 }
 
+void OverpassQuery::addResult(DataSet &&result)
+{
+    m_result.unite(std::move(result));
+}
+
 #include "moc_overpassquery.cpp"
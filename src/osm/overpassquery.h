@@ -79,7 +79,10 @@ private:
     friend class OverpassQueryManager;
     friend class OverpassQueryManagerPrivate;
 
-    [[nodiscard]] Error processReply(QNetworkReply *reply);
+    /** Parse the result of a single task in @p reply into @p result. */
+    [[nodiscard]] Error processReply(QNetworkReply *reply, DataSet &result) const;
+    /** Merge the result of a single task into the overall query result. */
+    void addResult(DataSet &&result);
 
     QString m_query;
     QRectF m_bbox = { -180.0, -90.0, 360.0, 180.0 };
@@ -6,11 +6,16 @@
 
 #include "overpassquerymanager.h"
 #include "overpassquery.h"
+#include "io.h"
 
+#include <QCryptographicHash>
 #include <QDateTime>
+#include <QDir>
+#include <QFile>
 #include <QNetworkAccessManager>
 #include <QNetworkDiskCache>
 #include <QNetworkReply>
+#include <QSaveFile>
 #include <QStandardPaths>
 #include <QTimer>
 #include <QUrl>
@@ -18,6 +23,7 @@
 
 #include <chrono>
 #include <deque>
+#include <numeric>
 
 using namespace OSM;
 
@@ -26,6 +32,7 @@ struct OverpassQueryTask {
     OverpassQuery *query = nullptr;
     QRectF bbox;
     bool forceReload = false;
+    bool resultCacheChecked = false;
 };
 
 struct OverpassQueryExecutor {
@@ -37,19 +44,30 @@ struct OverpassQueryExecutor {
 
 class OverpassQueryManagerPrivate {
 public:
+    void addQuery(OverpassQuery *query, bool forceReload);
     void executeTasks();
     void taskFinished(OverpassQueryExecutor *executor, QNetworkReply *reply);
-    void checkQueryFinished(OverpassQuery *query) const;
+    void checkQueryFinished(OverpassQuery *query);
     void cancelQuery(OverpassQuery *query);
 
+    [[nodiscard]] QString resultCacheFileName(const OverpassQueryTask &task) const;
+    [[nodiscard]] bool loadCachedResult(const OverpassQueryTask &task) const;
+    void storeCachedResult(const OverpassQueryTask &task, const DataSet &result);
+    void expireResultCache() const;
+
     OverpassQueryManager *q;
     QNetworkAccessManager *m_nam;
     QTimer *m_nextTaskTimer;
     std::vector<OverpassQueryExecutor> m_executors;
     std::deque<std::unique_ptr<OverpassQueryTask>> m_tasks;
+    QString m_resultCacheDir;
+    bool m_resultCacheChanged = false;
 };
 }
 
+// the result cache contains o5m files, which are a fraction of the size of the corresponding XML replies
+constexpr inline qint64 RESULT_CACHE_SIZE = 250'000'000; // 250MB
+
 static const char* executor_configs[] = {
     "https://overpass-api.de/api/interpreter",
     "https://overpass.openstreetmap.fr/api/interpreter",
@@ -74,6 +92,10 @@ OverpassQueryManager::OverpassQueryManager(QObject *parent)
     diskCache->setMaximumCacheSize(1'000'000'000); // 1GB
     d->m_nam->setCache(diskCache);
 
+    d->m_resultCacheDir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QLatin1String("/org.kde.osm/overpass-results/");
+    QDir().mkpath(d->m_resultCacheDir);
+    d->expireResultCache();
+
     d->m_nextTaskTimer = new QTimer(this);
     d->m_nextTaskTimer->setSingleShot(true);
     connect(d->m_nextTaskTimer, &QTimer::timeout, this, [this]() { d->executeTasks(); });
@@ -88,6 +110,16 @@ OverpassQueryManager::OverpassQueryManager(QObject *parent)
 OverpassQueryManager::~OverpassQueryManager() = default;
 
 void OverpassQueryManager::execute(OverpassQuery *query)
+{
+    d->addQuery(query, false);
+}
+
+void OverpassQueryManager::reload(OverpassQuery *query)
+{
+    d->addQuery(query, true);
+}
+
+void OverpassQueryManagerPrivate::addQuery(OverpassQuery *query, bool forceReload)
 {
     // validate input
     if (query->query().isEmpty() || query->boundingBox().isNull() || !query->boundingBox().isValid() || query->tileSize().isNull() || !query->tileSize().isValid()) {
@@ -107,15 +139,39 @@ void OverpassQueryManager::execute(OverpassQuery *query)
             auto task = std::make_unique<OverpassQueryTask>();
             task->query = query;
             task->bbox = { query->boundingBox().x() + x * xTileSize, query->boundingBox().y() + y * yTileSize, xTileSize, yTileSize };
-            d->m_tasks.push_back(std::move(task));
+            task->forceReload = forceReload;
+            m_tasks.push_back(std::move(task));
         }
     }
 
-    d->executeTasks();
+    // results might be available from cache right away, don't emit finished() synchronously though
+    QMetaObject::invokeMethod(q, [this]() { executeTasks(); }, Qt::QueuedConnection);
 }
 
 void OverpassQueryManagerPrivate::executeTasks()
 {
+    // tasks with a cached result don't need an executor
+    std::vector<OverpassQuery*> cachedQueries;
+    for (auto it = m_tasks.begin(); it != m_tasks.end();) {
+        auto &task = *it;
+        if (task->resultCacheChecked || task->forceReload) {
+            ++it;
+            continue;
+        }
+        task->resultCacheChecked = true;
+        if (!loadCachedResult(*task)) {
+            ++it;
+            continue;
+        }
+        if (std::find(cachedQueries.begin(), cachedQueries.end(), task->query) == cachedQueries.end()) {
+            cachedQueries.push_back(task->query);
+        }
+        it = m_tasks.erase(it);
+    }
+    for (auto query : cachedQueries) {
+        checkQueryFinished(query);
+    }
+
     const auto now = QDateTime::currentDateTimeUtc();
     std::chrono::seconds nextSlot = std::chrono::hours(1);
 
@@ -139,13 +195,18 @@ void OverpassQueryManagerPrivate::executeTasks()
         executor.task = std::move(m_tasks.front());
         m_tasks.pop_front();
 
+        // whatever we get from the network replaces the cached result, don't keep a stale one around should that fail
+        if (executor.task->forceReload) {
+            QFile::remove(resultCacheFileName(*executor.task));
+        }
+
         // actually execute query
         auto url = executor.endpoint;
         QUrlQuery params;
         params.addQueryItem(QStringLiteral("data"), executor.task->query->query(executor.task->bbox));
         url.setQuery(params);
         QNetworkRequest req(url);
-        req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, executor.task->forceReload ? QNetworkRequest::PreferNetwork : QNetworkRequest::AlwaysCache);
+        req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, executor.task->forceReload ? QNetworkRequest::AlwaysNetwork : QNetworkRequest::AlwaysCache);
         auto reply = m_nam->get(req);
         // TODO enable stream parsing for XML replies by connecting to QNetworkReply::readyRead
         QObject::connect(reply, &QNetworkReply::finished, q, [this, &executor, reply]() {
@@ -175,7 +236,12 @@ void OverpassQueryManagerPrivate::taskFinished(OverpassQueryExecutor *executor,
         query->m_error = OverpassQuery::NetworkError;
         cancelQuery(query);
     } else {
-        const auto queryError = query->processReply(reply);
+        DataSet result;
+        const auto queryError = query->processReply(reply, result);
+        if (queryError == OverpassQuery::NoError) {
+            storeCachedResult(*executor->task, result);
+            query->addResult(std::move(result));
+        }
         // on query timeout, break up the task in 4 sub-tasks, if we are allowed to
         if (queryError == OverpassQuery::QueryTimeout
             && executor->task->bbox.width() > query->minimumTileSize().width()
@@ -213,14 +279,90 @@ void OverpassQueryManagerPrivate::taskFinished(OverpassQueryExecutor *executor,
     executeTasks();
 }
 
-void OverpassQueryManagerPrivate::checkQueryFinished(OverpassQuery *query) const
+void OverpassQueryManagerPrivate::checkQueryFinished(OverpassQuery *query)
 {
     if (std::any_of(m_executors.begin(), m_executors.end(), [query](const auto &executor) { return executor.task && executor.task->query == query; })
         || std::any_of(m_tasks.begin(), m_tasks.end(), [query](const auto &task) { return task->query == query; }))
         return;
+
+    // long running sessions can accumulate a lot of results, so don't rely on the expiry on startup only
+    // this is done once per query rather than per stored tile, as it needs to look at the entire cache
+    if (m_resultCacheChanged) {
+        m_resultCacheChanged = false;
+        expireResultCache();
+    }
     Q_EMIT query->finished();
 }
 
+QString OverpassQueryManagerPrivate::resultCacheFileName(const OverpassQueryTask &task) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(task.query->query(task.bbox).toUtf8());
+    // the query doesn't necessarily contain a bbox placeholder
+    for (const auto v : { task.bbox.x(), task.bbox.y(), task.bbox.width(), task.bbox.height() }) {
+        hash.addData(QByteArray::number(v, 'g', 17));
+    }
+    return m_resultCacheDir + QString::fromLatin1(hash.result().toHex()) + QLatin1String(".o5m");
+}
+
+bool OverpassQueryManagerPrivate::loadCachedResult(const OverpassQueryTask &task) const
+{
+    QFile f(resultCacheFileName(task));
+    if (!f.open(QFile::ReadOnly)) {
+        return false;
+    }
+    const auto data = f.map(0, f.size());
+    if (!data) {
+        return false;
+    }
+
+    DataSet result;
+    auto reader = OSM::IO::readerForFileName(f.fileName(), &result);
+    if (!reader) {
+        return false;
+    }
+    reader->read(data, f.size());
+    if (reader->hasError()) {
+        qWarning() << "Discarding broken cached query result:" << f.fileName() << reader->errorString();
+        f.unmap(data);
+        f.remove();
+        return false;
+    }
+
+    // cache expiry is based on the modification time, so this keeps recently used results around
+    f.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    task.query->addResult(std::move(result));
+    return true;
+}
+
+void OverpassQueryManagerPrivate::storeCachedResult(const OverpassQueryTask &task, const DataSet &result)
+{
+    QSaveFile f(resultCacheFileName(task));
+    auto writer = OSM::IO::writerForFileName(f.fileName());
+    if (!writer || !f.open(QFile::WriteOnly)) {
+        qWarning() << "Failed to store query result:" << f.fileName() << f.errorString();
+        return;
+    }
+    writer->write(result, &f);
+    if (f.commit()) {
+        m_resultCacheChanged = true;
+    }
+}
+
+void OverpassQueryManagerPrivate::expireResultCache() const
+{
+    // least recently used results first
+    const auto entries = QDir(m_resultCacheDir).entryInfoList({ QStringLiteral("*.o5m") }, QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 size = std::accumulate(entries.begin(), entries.end(), qint64(0), [](qint64 size, const QFileInfo &entry) { return size + entry.size(); });
+    for (const auto &entry : entries) {
+        if (size <= RESULT_CACHE_SIZE) {
+            break;
+        }
+        size -= entry.size();
+        QFile::remove(entry.absoluteFilePath());
+    }
+}
+
 void OverpassQueryManagerPrivate::cancelQuery(OverpassQuery *query)
 {
     qDebug() << "cancelling query...";
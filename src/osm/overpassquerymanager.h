@@ -30,6 +30,11 @@ public:
      *  Once done, OverpassQuery::finished will be emitted.
      */
     void execute(OverpassQuery *query);
+    /** Executes @p query, bypassing any cached results.
+     *  Results fetched from the network replace the cached ones.
+     *  Once done, OverpassQuery::finished will be emitted.
+     */
+    void reload(OverpassQuery *query);
 
 private:
     std::unique_ptr<OverpassQueryManagerPrivate> d;
@@ -7,54 +7,78 @@
 #include "pathutil.h"
 #include "element.h"
 
+#include <algorithm>
 #include <cassert>
 
 using namespace OSM;
 
-static OSM::Id appendNextPath(const DataSet &dataSet, std::vector<const Node*> &nodes, OSM::Id startNode, std::vector<const Way*> &ways)
+namespace {
+struct WayEndpoint {
+    OSM::Id node;
+    std::size_t way;
+};
+
+[[nodiscard]] bool operator<(const WayEndpoint &lhs, const WayEndpoint &rhs)
 {
-    if (ways.empty()) {
-        return {};
-    }
+    return lhs.node == rhs.node ? lhs.way < rhs.way : lhs.node < rhs.node;
+}
+
+[[nodiscard]] bool operator<(const WayEndpoint &lhs, OSM::Id rhs)
+{
+    return lhs.node < rhs;
+}
+}
 
-    for (auto it = std::next(ways.begin()); it != ways.end(); ++it) {
-        if ((*it)->nodes.empty()) {
+void OSM::assemblePath(const DataSet &dataSet, std::vector<const Way*> &&ways, std::vector<const Node*> &path)
+{
+    // index all way endpoints, so finding the next way to append doesn't need to scan all remaining ways
+    // within the same node, ways are in input order so we pick the same one a linear search would pick
+    std::vector<WayEndpoint> endpoints;
+    endpoints.reserve(ways.size() * 2);
+    for (std::size_t i = 0; i < ways.size(); ++i) {
+        if (ways[i]->nodes.empty()) {
             continue;
         }
-        if ((*it)->nodes.front() == startNode) {
-            appendNodesFromWay(dataSet, nodes, (*it)->nodes.begin(), (*it)->nodes.end());
-            const auto lastNodeId = (*it)->nodes.back();
-            ways.erase(it);
-            return lastNodeId;
-        }
-        // path segments can also be backwards
-        if ((*it)->nodes.back() == startNode) {
-            appendNodesFromWay(dataSet, nodes, (*it)->nodes.rbegin(), (*it)->nodes.rend());
-            const auto lastNodeId = (*it)->nodes.front();
-            ways.erase(it);
-            return lastNodeId;
-        }
+        endpoints.push_back({ ways[i]->nodes.front(), i });
+        endpoints.push_back({ ways[i]->nodes.back(), i });
     }
+    std::sort(endpoints.begin(), endpoints.end());
 
-    return {};
-}
+    std::vector<bool> used(ways.size(), false);
+    const auto findNextWay = [&](OSM::Id node) -> const Way* {
+        for (auto it = std::lower_bound(endpoints.begin(), endpoints.end(), node); it != endpoints.end() && (*it).node == node; ++it) {
+            if (!used[(*it).way]) {
+                used[(*it).way] = true;
+                return ways[(*it).way];
+            }
+        }
+        return nullptr;
+    };
 
-void OSM::assemblePath(const DataSet &dataSet, std::vector<const Way*> &&ways, std::vector<const Node*> &path)
-{
-    for (auto it = ways.begin(); it != ways.end();) {
-        if ((*it)->nodes.empty()) {
-            ++it;
+    for (std::size_t i = 0; i < ways.size(); ++i) {
+        if (used[i] || ways[i]->nodes.empty()) {
             continue;
         }
-        appendNodesFromWay(dataSet, path, (*it)->nodes.begin(), (*it)->nodes.end());
-        const auto startNode = (*it)->nodes.front();
-        auto lastNode = (*it)->nodes.back();
+        used[i] = true;
+        appendNodesFromWay(dataSet, path, ways[i]->nodes.begin(), ways[i]->nodes.end());
+        const auto startNode = ways[i]->nodes.front();
+        auto lastNode = ways[i]->nodes.back();
 
+        // a closed way still gets one more connected way appended
         do {
-            lastNode = appendNextPath(dataSet, path, lastNode, ways);
-        } while (lastNode && lastNode != startNode);
-
-        it = ways.erase(it);
+            const auto way = findNextWay(lastNode);
+            if (!way) {
+                break;
+            }
+            if (way->nodes.front() == lastNode) {
+                appendNodesFromWay(dataSet, path, way->nodes.begin(), way->nodes.end());
+                lastNode = way->nodes.back();
+            } else {
+                // path segments can also be backwards
+                appendNodesFromWay(dataSet, path, way->nodes.rbegin(), way->nodes.rend());
+                lastNode = way->nodes.front();
+            }
+        } while (lastNode != startNode);
     }
 }
 
@@ -50,3 +50,41 @@ const char* OSM::StringKeyRegistryBase::keyInternal(const char *name) const
     }
     return (*it);
 }
+
+std::vector<std::pair<const char*, const char*>> OSM::StringKeyRegistryBase::mergeInternal(OSM::StringKeyRegistryBase &&other)
+{
+    std::vector<std::pair<const char*, const char*>> mapping;
+    std::vector<const char*> registry;
+    registry.reserve(m_registry.size() + other.m_registry.size());
+
+    // both registries are sorted by string content, so merge them like sorted lists
+    auto it = m_registry.begin();
+    auto otherIt = other.m_registry.begin();
+    while (it != m_registry.end() && otherIt != other.m_registry.end()) {
+        const auto cmp = std::strcmp((*it), (*otherIt));
+        if (cmp < 0) {
+            registry.push_back(*it++);
+        } else if (cmp > 0) {
+            registry.push_back(*otherIt++);
+        } else {
+            if ((*it) != (*otherIt)) {
+                mapping.emplace_back(*otherIt, *it);
+            }
+            registry.push_back(*it);
+            ++it;
+            ++otherIt;
+        }
+    }
+    registry.insert(registry.end(), it, m_registry.end());
+    registry.insert(registry.end(), otherIt, other.m_registry.end());
+    m_registry = std::move(registry);
+    other.m_registry.clear();
+
+    // keys not in the mapping are used as-is, and elements of other might still refer to the remapped ones
+    // so we need to take ownership of all memory of other
+    m_pool.insert(m_pool.end(), other.m_pool.begin(), other.m_pool.end());
+    other.m_pool.clear();
+
+    std::sort(mapping.begin(), mapping.end());
+    return mapping;
+}
@@ -9,13 +9,42 @@
 
 #include "kosm_export.h"
 
+#include <algorithm>
 #include <cstring>
+#include <utility>
 #include <vector>
 
 namespace OSM {
 
 enum class StringMemory { Persistent, Transient };
 
+template <typename T> class StringKeyRegistry;
+
+/** Maps keys from one registry to equivalent keys in another registry.
+ *  @see StringKeyRegistry::merge()
+ */
+template <typename T>
+class StringKeyMapping
+{
+public:
+    /** Returns @c true if no key needs to be changed. */
+    [[nodiscard]] inline bool isEmpty() const { return m_map.empty(); }
+
+    /** Returns the key equivalent to @p key. */
+    [[nodiscard]] inline T map(T key) const
+    {
+        const auto it = std::lower_bound(m_map.begin(), m_map.end(), key.key, [](const auto &lhs, const char *rhs) { return lhs.first < rhs; });
+        if (it != m_map.end() && (*it).first == key.key) {
+            key.key = (*it).second;
+        }
+        return key;
+    }
+
+private:
+    friend class StringKeyRegistry<T>;
+    std::vector<std::pair<const char*, const char*>> m_map;
+};
+
 /** @internal */
 class KOSM_EXPORT StringKeyRegistryBase
 {
@@ -27,6 +56,7 @@ protected:
 
     [[nodiscard]] const char* makeKeyInternal(const char *name, std::size_t len, StringMemory memOpt);
     [[nodiscard]] const char* keyInternal(const char *name) const;
+    [[nodiscard]] std::vector<std::pair<const char*, const char*>> mergeInternal(StringKeyRegistryBase &&other);
 
     std::vector<char*> m_pool;
     std::vector<const char*> m_registry;
@@ -65,6 +95,24 @@ public:
         key.key = keyInternal(name);
         return key;
     }
+
+    /** Number of keys in this registry. */
+    [[nodiscard]] inline std::size_t size() const
+    {
+        return m_registry.size();
+    }
+
+    /** Adds all keys of @p other to this registry, in a single linear pass.
+     *  Memory owned by @p other is taken over by this registry, so keys of @p other remain valid,
+     *  but they might not be the same as keys for the same string in this registry. Such keys
+     *  are contained in the returned mapping.
+     */
+    [[nodiscard]] inline StringKeyMapping<T> merge(StringKeyRegistry<T> &&other)
+    {
+        StringKeyMapping<T> mapping;
+        mapping.m_map = mergeInternal(std::move(other));
+        return mapping;
+    }
 };
 
 /** Base class for unique string keys. */
@@ -85,6 +133,7 @@ protected:
 
 private:
     template <typename T> friend class StringKeyRegistry;
+    template <typename T> friend class StringKeyMapping;
     const char* key = nullptr;
 };
 
@@ -5,13 +5,15 @@
 */
 
 #include "xmlparser.h"
+#include "xmlpullparser.h"
+#include "datasetmergebuffer.h"
 #include "datatypes.h"
 
 #include <QDebug>
 #include <QIODevice>
 #include <QXmlStreamReader>
 
-#include <cmath>
+#include <charconv>
 
 using namespace OSM;
 
@@ -46,29 +48,105 @@ void XmlParser::readFromIODevice(QIODevice *io)
     }
 }
 
+void XmlParser::readFromData(const uint8_t *data, std::size_t len)
+{
+    // elements are only added once the entire input has been parsed successfully
+    // so we can still fall back to QXmlStreamReader otherwise
+    DataSetMergeBuffer buffer;
+    XmlPullParser reader(reinterpret_cast<const char*>(data), reinterpret_cast<const char*>(data) + len);
+    while (!reader.atEnd()) {
+        if (reader.readNext() != XmlPullParser::StartElement) {
+            continue;
+        }
+
+        if (reader.name() == "node") {
+            buffer.nodes.push_back(parseNode(reader));
+        } else if (reader.name() == "way") {
+            buffer.ways.push_back(parseWay(reader));
+        } else if (reader.name() == "relation") {
+            buffer.relations.push_back(parseRelation(reader));
+        } else if (reader.name() == "remark") {
+            const auto remark = reader.readElementText();
+            if (!reader.hasError()) {
+                m_error = QString::fromUtf8(remark);
+            }
+            break;
+        }
+    }
+    clearStringCache();
+
+    if (reader.hasError()) {
+        AbstractReader::readFromData(data, len);
+        return;
+    }
+
+    for (auto &node : buffer.nodes) {
+        addNode(std::move(node));
+    }
+    for (auto &way : buffer.ways) {
+        addWay(std::move(way));
+    }
+    for (auto &rel : buffer.relations) {
+        addRelation(std::move(rel));
+    }
+}
+
+void XmlParser::clearStringCache()
+{
+    m_tagKeyCache.clear();
+    m_roleCache.clear();
+}
+
 // parse double coordinate value without actually doing floating point computations
-// this avoids any loss in precision we can other get heret
-uint32_t parseCoordinateValue(QStringView s, int offset)
+// this avoids any loss in precision we can other get here
+static uint32_t parseCoordinateValue(std::string_view s, int offset)
 {
-    const auto idx = s.indexOf(QLatin1Char('.'));
-    if (idx < 0) {
-        return s.toUInt() * 10'000'000;
+    bool negative = false;
+    if (!s.empty() && (s[0] == '-' || s[0] == '+')) {
+        negative = s[0] == '-';
+        s.remove_prefix(1);
     }
-    uint32_t result = (uint32_t)(s.left(idx).toInt() + offset) * 10'000'000;
-    const auto decimals = s.mid(idx + 1);
-    if (decimals.size() >= 7) {
-        result += decimals.left(7).toUInt();
-    } else {
-        result += decimals.toUInt() * std::pow(10, 7 - decimals.size());
+
+    int64_t value = 0;
+    std::size_t i = 0;
+    for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; ++i) {
+        value = value * 10 + (s[i] - '0');
+    }
+    int decimals = 0;
+    if (i < s.size() && s[i] == '.') {
+        for (++i; i < s.size() && s[i] >= '0' && s[i] <= '9' && decimals < 7; ++i, ++decimals) {
+            value = value * 10 + (s[i] - '0');
+        }
     }
-    return result;
+    for (; decimals < 7; ++decimals) {
+        value *= 10;
+    }
+
+    return (uint32_t)((negative ? -value : value) + (int64_t)offset * 10'000'000);
+}
+
+static uint32_t parseCoordinateValue(QStringView s, int offset)
+{
+    const auto latin1 = s.toLatin1();
+    return parseCoordinateValue(std::string_view(latin1.constData(), latin1.size()), offset);
+}
+
+[[nodiscard]] static OSM::Id parseId(std::string_view s)
+{
+    OSM::Id id = 0;
+    std::from_chars(s.data(), s.data() + s.size(), id);
+    return id;
 }
 
 OSM::Node XmlParser::parseNode(QXmlStreamReader &reader) const
 {
     Node node;
     node.id = reader.attributes().value(QLatin1String("id")).toLongLong();
-    node.coordinate = Coordinate(parseCoordinateValue(reader.attributes().value(QLatin1String("lat")), 90), parseCoordinateValue(reader.attributes().value(QLatin1String("lon")), 180));
+    const auto lat = reader.attributes().value(QLatin1String("lat"));
+    const auto lon = reader.attributes().value(QLatin1String("lon"));
+    if (!lat.isEmpty() && !lon.isEmpty()) {
+        node.coordinate = Coordinate(parseCoordinateValue(lat, 90), parseCoordinateValue(lon, 180));
+    }
 
     while (!reader.atEnd() && reader.readNext() != QXmlStreamReader::EndElement) {
         if (reader.tokenType() != QXmlStreamReader::StartElement) {
@@ -168,3 +246,116 @@ void XmlParser::parseBounds(QXmlStreamReader &reader, T &elem) const
     elem.bbox.min = Coordinate(reader.attributes().value(QLatin1String("minlat")).toDouble(), reader.attributes().value(QLatin1String("minlon")).toDouble());
     elem.bbox.max = Coordinate(reader.attributes().value(QLatin1String("maxlat")).toDouble(), reader.attributes().value(QLatin1String("maxlon")).toDouble());
 }
+
+OSM::Node XmlParser::parseNode(XmlPullParser &reader)
+{
+    Node node;
+    node.id = parseId(reader.rawAttribute("id"));
+    const auto lat = reader.rawAttribute("lat");
+    const auto lon = reader.rawAttribute("lon");
+    if (!lat.empty() && !lon.empty()) {
+        node.coordinate = Coordinate(parseCoordinateValue(lat, 90), parseCoordinateValue(lon, 180));
+    }
+
+    while (reader.readNext() == XmlPullParser::StartElement) {
+        if (reader.name() == "tag") {
+            parseTag(reader, node);
+        }
+        reader.skipCurrentElement();
+    }
+
+    return node;
+}
+
+OSM::Way XmlParser::parseWay(XmlPullParser &reader)
+{
+    Way way;
+    way.id = parseId(reader.rawAttribute("id"));
+
+    while (reader.readNext() == XmlPullParser::StartElement) {
+        if (reader.name() == "nd") {
+            way.nodes.push_back(parseId(reader.rawAttribute("ref")));
+        } else if (reader.name() == "tag") {
+            parseTagOrBounds(reader, way);
+        } else if (reader.name() == "bounds") {
+            parseBounds(reader, way);
+        }
+        reader.skipCurrentElement();
+    }
+
+    return way;
+}
+
+OSM::Relation XmlParser::parseRelation(XmlPullParser &reader)
+{
+    Relation rel;
+    rel.id = parseId(reader.rawAttribute("id"));
+
+    while (reader.readNext() == XmlPullParser::StartElement) {
+        if (reader.name() == "tag") {
+            parseTagOrBounds(reader, rel);
+        } else if (reader.name() == "bounds") { // Overpass style bounding box
+            parseBounds(reader, rel);
+        } else if (reader.name() == "member") {
+            Member member;
+            member.id = parseId(reader.rawAttribute("ref"));
+            const auto type = reader.rawAttribute("type");
+            if (type == "node") {
+                member.setType(Type::Node);
+            } else if (type == "way") {
+                member.setType(Type::Way);
+            } else {
+                member.setType(Type::Relation);
+            }
+            member.setRole(makeStringKey(reader, reader.rawAttribute("role"), m_roleCache, &DataSet::makeRole));
+            rel.members.push_back(std::move(member));
+        }
+        reader.skipCurrentElement();
+    }
+
+    return rel;
+}
+
+template <typename T>
+void XmlParser::parseTag(XmlPullParser &reader, T &elem)
+{
+    const auto key = makeStringKey(reader, reader.rawAttribute("k"), m_tagKeyCache, &DataSet::makeTagKey);
+    OSM::setTagValue(elem, key, reader.attribute("v"));
+}
+
+template <typename T>
+void XmlParser::parseTagOrBounds(XmlPullParser &reader, T &elem)
+{
+    if (reader.rawAttribute("k") == "bBox") { // osmconvert style bounding box
+        const auto v = reader.attribute("v").split(',');
+        if (v.size() == 4) {
+            elem.bbox.min = Coordinate(v[1].toDouble(), v[0].toDouble());
+            elem.bbox.max = Coordinate(v[3].toDouble(), v[2].toDouble());
+        }
+    } else {
+        parseTag(reader, elem);
+    }
+}
+
+template<typename T>
+void XmlParser::parseBounds(XmlPullParser &reader, T &elem)
+{
+    // overpass style bounding box
+    elem.bbox.min = Coordinate(reader.attribute("minlat").toDouble(), reader.attribute("minlon").toDouble());
+    elem.bbox.max = Coordinate(reader.attribute("maxlat").toDouble(), reader.attribute("maxlon").toDouble());
+}
+
+template <typename T>
+T XmlParser::makeStringKey(XmlPullParser &reader, std::string_view raw, std::unordered_map<std::string_view, T> &cache, T(DataSet::*make)(const char*, StringMemory))
+{
+    if (XmlPullParser::needsDecoding(raw)) {
+        return (m_dataSet->*make)(reader.decodeAttribute(raw).constData(), OSM::StringMemory::Transient);
+    }
+
+    if (const auto it = cache.find(raw); it != cache.end()) {
+        return (*it).second;
+    }
+    const auto key = (m_dataSet->*make)(QByteArray(raw.data(), (qsizetype)raw.size()).constData(), OSM::StringMemory::Transient);
+    cache.emplace(raw, key);
+    return key;
+}
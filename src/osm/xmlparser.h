@@ -8,16 +8,25 @@
 #define OSM_XMLPARSER_H
 
 #include "abstractreader.h"
+#include "datatypes.h"
 
 #include <QString>
 
+#include <string_view>
+#include <unordered_map>
+
 class QIODevice;
 class QXmlStreamReader;
 
 namespace OSM {
 
 class DataSet;
+class XmlPullParser;
 
+/** Parser for OSM XML data.
+ *  Memory-mapped UTF-8 input is handled by XmlPullParser directly, anything
+ *  that one cannot handle, as well as QIODevice input, goes through QXmlStreamReader.
+ */
 class XmlParser : public AbstractReader
 {
 public:
@@ -28,8 +37,15 @@ protected: // for reuse by the OSC parser
     [[nodiscard]] OSM::Way parseWay(QXmlStreamReader &reader) const;
     [[nodiscard]] OSM::Relation parseRelation(QXmlStreamReader &reader) const;
 
+    [[nodiscard]] OSM::Node parseNode(XmlPullParser &reader);
+    [[nodiscard]] OSM::Way parseWay(XmlPullParser &reader);
+    [[nodiscard]] OSM::Relation parseRelation(XmlPullParser &reader);
+    /** Drop cached strings referring to the input data of XmlPullParser. */
+    void clearStringCache();
+
 private:
     void readFromIODevice(QIODevice *io) override;
+    void readFromData(const uint8_t *data, std::size_t len) override;
 
     template <typename T>
     void parseTag(QXmlStreamReader &reader, T &elem) const;
@@ -37,6 +53,19 @@ private:
     void parseTagOrBounds(QXmlStreamReader &reader, T&elem) const;
     template <typename T>
     void parseBounds(QXmlStreamReader &reader, T &elem) const;
+
+    template <typename T>
+    void parseTag(XmlPullParser &reader, T &elem);
+    template <typename T>
+    void parseTagOrBounds(XmlPullParser &reader, T &elem);
+    template <typename T>
+    void parseBounds(XmlPullParser &reader, T &elem);
+    template <typename T>
+    [[nodiscard]] T makeStringKey(XmlPullParser &reader, std::string_view raw, std::unordered_map<std::string_view, T> &cache, T(DataSet::*make)(const char*, StringMemory));
+
+    // tag keys and roles by their raw value in the input data, to avoid repeated registry lookups
+    std::unordered_map<std::string_view, TagKey> m_tagKeyCache;
+    std::unordered_map<std::string_view, Role> m_roleCache;
 };
 
 }
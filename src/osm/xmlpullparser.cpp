@@ -0,0 +1,388 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "xmlpullparser.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+using namespace OSM;
+
+[[nodiscard]] static constexpr bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+[[nodiscard]] static constexpr bool isNameEnd(char c)
+{
+    return isSpace(c) || c == '/' || c == '>' || c == '=';
+}
+
+XmlPullParser::XmlPullParser(const char *begin, const char *end)
+    : m_it(begin)
+    , m_end(end)
+{
+    // skip UTF-8 BOM
+    if (m_end - m_it >= 3 && (uint8_t)m_it[0] == 0xEF && (uint8_t)m_it[1] == 0xBB && (uint8_t)m_it[2] == 0xBF) {
+        m_it += 3;
+    }
+    // UTF-16/32, with or without BOM
+    if (m_end - m_it >= 2 && (((uint8_t)m_it[0] == 0xFE && (uint8_t)m_it[1] == 0xFF) || ((uint8_t)m_it[0] == 0xFF && (uint8_t)m_it[1] == 0xFE) || m_it[0] == '\0' || m_it[1] == '\0')) {
+        setError();
+    }
+}
+
+XmlPullParser::TokenType XmlPullParser::readNext()
+{
+    if (atEnd()) {
+        return m_token;
+    }
+    if (m_selfClosing) {
+        m_selfClosing = false;
+        return m_token = EndElement;
+    }
+
+    while (true) {
+        const auto tagBegin = static_cast<const char*>(std::memchr(m_it, '<', m_end - m_it));
+        if (!tagBegin) {
+            m_it = m_end;
+            if (!m_openElements.empty()) {
+                setError();
+                return m_token;
+            }
+            return m_token = EndDocument;
+        }
+
+        m_it = tagBegin + 1;
+        if (m_it == m_end) {
+            setError();
+            return m_token;
+        }
+
+        switch (*m_it) {
+            case '?':
+                if (!readProcessingInstruction()) {
+                    return m_token;
+                }
+                continue;
+            case '!':
+            {
+                // only comments are supported, DTDs and CDATA sections are left to QXmlStreamReader
+                const std::string_view s(m_it, m_end - m_it);
+                if (s.size() < 3 || s[1] != '-' || s[2] != '-') {
+                    setError();
+                    return m_token;
+                }
+                const auto commentEnd = s.find("-->", 3);
+                if (commentEnd == std::string_view::npos) {
+                    setError();
+                    return m_token;
+                }
+                m_it += commentEnd + 3;
+                continue;
+            }
+            case '/':
+                if (!readEndElement()) {
+                    return m_token;
+                }
+                return m_token = EndElement;
+            default:
+                if (!readStartElement()) {
+                    return m_token;
+                }
+                return m_token = StartElement;
+        }
+    }
+}
+
+bool XmlPullParser::readProcessingInstruction()
+{
+    const std::string_view s(m_it, m_end - m_it);
+    const auto piEnd = s.find("?>");
+    if (piEnd == std::string_view::npos) {
+        setError();
+        return false;
+    }
+    m_it += piEnd + 2;
+
+    // XML declaration, make sure we are actually looking at UTF-8
+    const auto pi = s.substr(1, piEnd - 1);
+    if (pi.size() < 4 || pi.substr(0, 3) != "xml" || !isSpace(pi[3])) {
+        return true;
+    }
+    auto idx = pi.find("encoding");
+    if (idx == std::string_view::npos) {
+        return true;
+    }
+    idx += 8;
+    while (idx < pi.size() && (isSpace(pi[idx]) || pi[idx] == '=')) {
+        ++idx;
+    }
+    if (idx >= pi.size() || (pi[idx] != '"' && pi[idx] != '\'')) {
+        setError();
+        return false;
+    }
+    const auto encodingEnd = pi.find(pi[idx], idx + 1);
+    if (encodingEnd == std::string_view::npos) {
+        setError();
+        return false;
+    }
+    const auto encoding = pi.substr(idx + 1, encodingEnd - idx - 1);
+    if (encoding.size() != 5 || (encoding[0] | 0x20) != 'u' || (encoding[1] | 0x20) != 't' || (encoding[2] | 0x20) != 'f' || encoding[3] != '-' || encoding[4] != '8') {
+        setError();
+        return false;
+    }
+    return true;
+}
+
+bool XmlPullParser::readStartElement()
+{
+    const auto nameBegin = m_it;
+    while (m_it != m_end && !isNameEnd(*m_it)) {
+        ++m_it;
+    }
+    if (m_it == nameBegin) {
+        setError();
+        return false;
+    }
+    m_name = std::string_view(nameBegin, m_it - nameBegin);
+    m_attributes.clear();
+
+    while (true) {
+        while (m_it != m_end && isSpace(*m_it)) {
+            ++m_it;
+        }
+        if (m_it == m_end) {
+            setError();
+            return false;
+        }
+
+        if (*m_it == '>') {
+            ++m_it;
+            m_openElements.push_back(m_name);
+            return true;
+        }
+        if (*m_it == '/') {
+            if (m_it + 1 == m_end || m_it[1] != '>') {
+                setError();
+                return false;
+            }
+            m_it += 2;
+            m_selfClosing = true;
+            return true;
+        }
+
+        const auto attrNameBegin = m_it;
+        while (m_it != m_end && !isNameEnd(*m_it)) {
+            ++m_it;
+        }
+        const std::string_view attrName(attrNameBegin, m_it - attrNameBegin);
+        while (m_it != m_end && isSpace(*m_it)) {
+            ++m_it;
+        }
+        if (attrName.empty() || m_it == m_end || *m_it != '=') {
+            setError();
+            return false;
+        }
+        ++m_it;
+        while (m_it != m_end && isSpace(*m_it)) {
+            ++m_it;
+        }
+        if (m_it == m_end || (*m_it != '"' && *m_it != '\'')) {
+            setError();
+            return false;
+        }
+        const auto quote = *m_it++;
+        const auto valueEnd = static_cast<const char*>(std::memchr(m_it, quote, m_end - m_it));
+        if (!valueEnd) {
+            setError();
+            return false;
+        }
+        m_attributes.emplace_back(attrName, std::string_view(m_it, valueEnd - m_it));
+        m_it = valueEnd + 1;
+    }
+}
+
+bool XmlPullParser::readEndElement()
+{
+    ++m_it;
+    const auto nameBegin = m_it;
+    while (m_it != m_end && !isNameEnd(*m_it)) {
+        ++m_it;
+    }
+    m_name = std::string_view(nameBegin, m_it - nameBegin);
+    while (m_it != m_end && isSpace(*m_it)) {
+        ++m_it;
+    }
+    if (m_it == m_end || *m_it != '>' || m_openElements.empty() || m_openElements.back() != m_name) {
+        setError();
+        return false;
+    }
+    ++m_it;
+    m_openElements.pop_back();
+    return true;
+}
+
+std::string_view XmlPullParser::rawAttribute(std::string_view name) const
+{
+    for (const auto &attr : m_attributes) {
+        if (attr.first == name) {
+            return attr.second;
+        }
+    }
+    return {};
+}
+
+QByteArray XmlPullParser::attribute(std::string_view name)
+{
+    return decodeAttribute(rawAttribute(name));
+}
+
+QByteArray XmlPullParser::decodeAttribute(std::string_view raw)
+{
+    if (!needsDecoding(raw)) {
+        return QByteArray(raw.data(), (qsizetype)raw.size());
+    }
+    QByteArray out;
+    if (!decode(raw, out, true)) {
+        setError();
+    }
+    return out;
+}
+
+bool XmlPullParser::needsDecoding(std::string_view raw)
+{
+    for (const auto c : raw) {
+        if (c == '&' || (uint8_t)c < 0x20) {
+            return true;
+        }
+    }
+    return false;
+}
+
+[[nodiscard]] static bool appendCodePoint(uint32_t c, QByteArray &out)
+{
+    if (c == 0 || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+        return false;
+    }
+    if (c < 0x80) {
+        out += (char)c;
+    } else if (c < 0x800) {
+        out += (char)(0xC0 | (c >> 6));
+        out += (char)(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+        out += (char)(0xE0 | (c >> 12));
+        out += (char)(0x80 | ((c >> 6) & 0x3F));
+        out += (char)(0x80 | (c & 0x3F));
+    } else {
+        out += (char)(0xF0 | (c >> 18));
+        out += (char)(0x80 | ((c >> 12) & 0x3F));
+        out += (char)(0x80 | ((c >> 6) & 0x3F));
+        out += (char)(0x80 | (c & 0x3F));
+    }
+    return true;
+}
+
+bool XmlPullParser::decode(std::string_view raw, QByteArray &out, bool isAttribute) const
+{
+    out.reserve((qsizetype)raw.size());
+    for (std::size_t i = 0; i < raw.size(); ++i) {
+        const auto c = raw[i];
+        if (c == '&') {
+            const auto entityEnd = raw.find(';', i);
+            if (entityEnd == std::string_view::npos) {
+                return false;
+            }
+            const auto entity = raw.substr(i + 1, entityEnd - i - 1);
+            if (entity == "amp") {
+                out += '&';
+            } else if (entity == "lt") {
+                out += '<';
+            } else if (entity == "gt") {
+                out += '>';
+            } else if (entity == "quot") {
+                out += '"';
+            } else if (entity == "apos") {
+                out += '\'';
+            } else if (entity.size() > 1 && entity[0] == '#') {
+                const auto isHex = entity[1] == 'x';
+                const auto num = entity.substr(isHex ? 2 : 1);
+                uint32_t codePoint = 0;
+                const auto res = std::from_chars(num.data(), num.data() + num.size(), codePoint, isHex ? 16 : 10);
+                if (num.empty() || res.ec != std::errc{} || res.ptr != num.data() + num.size() || !appendCodePoint(codePoint, out)) {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+            i = entityEnd;
+        } else if (c == '\r') {
+            // line end normalization
+            if (i + 1 < raw.size() && raw[i + 1] == '\n') {
+                continue;
+            }
+            out += isAttribute ? ' ' : '\n';
+        } else if (isAttribute && (c == '\n' || c == '\t')) {
+            // attribute value normalization
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return true;
+}
+
+void XmlPullParser::skipCurrentElement()
+{
+    if (m_token != StartElement) {
+        return;
+    }
+    int depth = 1;
+    while (depth > 0) {
+        switch (readNext()) {
+            case StartElement:
+                ++depth;
+                break;
+            case EndElement:
+                --depth;
+                break;
+            default:
+                return;
+        }
+    }
+}
+
+QByteArray XmlPullParser::readElementText()
+{
+    if (m_token != StartElement) {
+        return {};
+    }
+    if (m_selfClosing) {
+        readNext();
+        return {};
+    }
+
+    const auto textEnd = static_cast<const char*>(std::memchr(m_it, '<', m_end - m_it));
+    if (!textEnd) {
+        setError();
+        return {};
+    }
+    QByteArray text;
+    if (!decode(std::string_view(m_it, textEnd - m_it), text, false)) {
+        setError();
+        return {};
+    }
+    m_it = textEnd;
+    if (readNext() != EndElement) {
+        setError();
+    }
+    return text;
+}
+
+void XmlPullParser::setError()
+{
+    m_token = Invalid;
+}
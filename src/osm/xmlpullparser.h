@@ -0,0 +1,80 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef OSM_XMLPULLPARSER_H
+#define OSM_XMLPULLPARSER_H
+
+#include <QByteArray>
+
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace OSM {
+
+/** Minimal non-validating UTF-8 XML pull parser for the OSM XML and osmChange dialects.
+ *  Works directly on the (memory-mapped) input data, names and raw attribute values
+ *  are returned as views into that buffer.
+ *
+ *  Anything beyond what those formats need (DTDs, CDATA sections, non UTF-8 encodings,
+ *  custom entities) is reported as an error, callers are expected to fall back to
+ *  QXmlStreamReader in that case.
+ */
+class XmlPullParser
+{
+public:
+    explicit XmlPullParser(const char *begin, const char *end);
+
+    enum TokenType {
+        NoToken,
+        StartElement,
+        EndElement,
+        EndDocument,
+        Invalid,
+    };
+
+    TokenType readNext();
+    [[nodiscard]] inline TokenType tokenType() const { return m_token; }
+    [[nodiscard]] inline bool atEnd() const { return m_token == EndDocument || m_token == Invalid; }
+    [[nodiscard]] inline bool hasError() const { return m_token == Invalid; }
+
+    /** Name of the current element. */
+    [[nodiscard]] inline std::string_view name() const { return m_name; }
+
+    /** Raw value of attribute @p name of the current start element, without entities being expanded.
+     *  Returns a null view if the attribute doesn't exist.
+     */
+    [[nodiscard]] std::string_view rawAttribute(std::string_view name) const;
+    /** Decoded value of attribute @p name of the current start element. */
+    [[nodiscard]] QByteArray attribute(std::string_view name);
+    /** Decodes a raw attribute value. */
+    [[nodiscard]] QByteArray decodeAttribute(std::string_view raw);
+    /** Returns @c true if @p raw contains anything that needs decoding. */
+    [[nodiscard]] static bool needsDecoding(std::string_view raw);
+
+    /** Skip to the end of the current start element. */
+    void skipCurrentElement();
+    /** Text content of the current start element, advances to its end element. */
+    [[nodiscard]] QByteArray readElementText();
+
+private:
+    void setError();
+    [[nodiscard]] bool readProcessingInstruction();
+    [[nodiscard]] bool readStartElement();
+    [[nodiscard]] bool readEndElement();
+    [[nodiscard]] bool decode(std::string_view raw, QByteArray &out, bool isAttribute) const;
+
+    const char *m_it = nullptr;
+    const char *m_end = nullptr;
+    TokenType m_token = NoToken;
+    std::string_view m_name;
+    std::vector<std::pair<std::string_view, std::string_view>> m_attributes;
+    std::vector<std::string_view> m_openElements;
+    bool m_selfClosing = false;
+};
+
+}
+
+#endif // OSM_XMLPULLPARSER_H
@@ -0,0 +1,31 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORROUTING_AGENTPROFILE_H
+#define KOSMINDOORROUTING_AGENTPROFILE_H
+
+namespace KOSMIndoorRouting {
+
+/** Physical dimensions of the agent a nav mesh is built for.
+ *  Unlike RoutingProfile this changes the nav mesh geometry itself, e.g. a wheelchair
+ *  needs a larger radius and can only climb small steps.
+ *  All values are in meter.
+ *  @see NavMeshBuilder::setAgentProfiles()
+ */
+class AgentProfile {
+public:
+    /** Minimum clearance needed above the floor. */
+    float height = 2.0f;
+    /** Minimum distance to walls and obstacles. */
+    float radius = 0.2f;
+    /** Maximum height of steps that can be climbed. */
+    float maxClimb = 0.9f;
+
+    [[nodiscard]] constexpr inline bool operator==(const AgentProfile &other) const = default;
+};
+
+}
+
+#endif
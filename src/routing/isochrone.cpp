@@ -0,0 +1,49 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "isochrone.h"
+
+namespace KOSMIndoorRouting {
+class IsochronePrivate : public QSharedData {
+public:
+    std::vector<IsochronePolygon> m_polygons;
+    std::vector<IsochroneContour> m_contours;
+};
+}
+
+using namespace KOSMIndoorRouting;
+
+Isochrone::Isochrone()
+    : d(new IsochronePrivate)
+{
+}
+
+Isochrone::Isochrone(const Isochrone &) = default;
+Isochrone::Isochrone(Isochrone &&) noexcept = default;
+Isochrone::~Isochrone() = default;
+Isochrone& Isochrone::operator=(const Isochrone &) = default;
+Isochrone& Isochrone::operator=(Isochrone &&) noexcept = default;
+
+const std::vector<IsochronePolygon>& Isochrone::polygons() const
+{
+    return d->m_polygons;
+}
+
+void Isochrone::setPolygons(std::vector<IsochronePolygon> &&polygons)
+{
+    d.detach();
+    d->m_polygons = std::move(polygons);
+}
+
+const std::vector<IsochroneContour>& Isochrone::contours() const
+{
+    return d->m_contours;
+}
+
+void Isochrone::setContours(std::vector<IsochroneContour> &&contours)
+{
+    d.detach();
+    d->m_contours = std::move(contours);
+}
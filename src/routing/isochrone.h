@@ -0,0 +1,65 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORROUTING_ISOCHRONE_H
+#define KOSMINDOORROUTING_ISOCHRONE_H
+
+#include "kosmindoorrouting_export.h"
+
+#include <KOSM/Datatypes>
+
+#include <QExplicitlySharedDataPointer>
+
+#include <chrono>
+#include <vector>
+
+namespace KOSMIndoorRouting {
+
+/** A nav mesh polygon reachable within the isochrone limit. */
+class IsochronePolygon {
+public:
+    std::vector<OSM::Coordinate> outline;
+    int floorLevel = 0;
+    /** Travel time to reach this polygon. */
+    std::chrono::duration<float> duration = {};
+};
+
+/** Boundary line of the reachable area on a single floor. */
+class IsochroneContour {
+public:
+    std::vector<OSM::Coordinate> path;
+    int floorLevel = 0;
+};
+
+class IsochronePrivate;
+
+/** Result of a reachability query.
+ *  @see NavMesh::isochrone()
+ */
+class KOSMINDOORROUTING_EXPORT Isochrone
+{
+public:
+    explicit Isochrone();
+    Isochrone(const Isochrone &);
+    Isochrone(Isochrone &&) noexcept;
+    ~Isochrone();
+    Isochrone& operator=(const Isochrone &);
+    Isochrone& operator=(Isochrone &&) noexcept;
+
+    /** All reachable nav mesh polygons, ordered by increasing travel time. */
+    [[nodiscard]] const std::vector<IsochronePolygon>& polygons() const;
+    void setPolygons(std::vector<IsochronePolygon> &&polygons);
+
+    /** Outlines of the reachable area, for display. */
+    [[nodiscard]] const std::vector<IsochroneContour>& contours() const;
+    void setContours(std::vector<IsochroneContour> &&contours);
+
+private:
+    QExplicitlySharedDataPointer<IsochronePrivate> d;
+};
+
+}
+
+#endif
@@ -5,11 +5,24 @@
 
 #include "navmesh.h"
 #include "navmesh_p.h"
+#include "navmeshgeometry_p.h"
+#include "navmeshposition.h"
+#include "isochrone.h"
 #include "logging.h"
+#include "routingarea.h"
+#include "routingprofile.h"
 
 #include <QFile>
+#include <QMutexLocker>
+#include <QPolygonF>
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
+#include <map>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
 
 using namespace KOSMIndoorRouting;
 
@@ -55,6 +68,611 @@ NavMeshTransform NavMesh::transform() const
     return d ? d->m_transform : NavMeshTransform();
 }
 
+#if HAVE_RECAST
+dtQueryFilter NavMeshPrivate::queryFilter(const RoutingProfile &profile) const
+{
+    dtQueryFilter filter;
+    filter.setIncludeFlags(profile.flags());
+    filter.setExcludeFlags((uint16_t)~profile.flags() | CLOSED_POLY_FLAG);
+
+    QMutexLocker locker(&m_mutex);
+    for (int i = 1; i < AREA_TYPE_COUNT - 1; ++i) {
+        const auto cost = profile.cost(static_cast<AreaType>(i));
+        filter.setAreaCost(i, cost);
+        filter.setAreaCost(closurePenaltyArea(i), cost * m_closurePenalty);
+    }
+    const auto walkableCost = profile.cost(AreaType::Walkable);
+    filter.setAreaCost(RC_WALKABLE_AREA, walkableCost);
+    filter.setAreaCost(closurePenaltyArea(RC_WALKABLE_AREA), walkableCost * m_closurePenalty);
+    return filter;
+}
+
+std::vector<dtPolyRef> NavMeshPrivate::closurePolygons(const std::vector<OSM::Coordinate> &polygon, int floorLevel) const
+{
+    QPolygonF closure;
+    closure.reserve((qsizetype)polygon.size());
+    for (const auto &c : polygon) {
+        closure.push_back(m_transform.mapGeoToNav(c));
+    }
+    const auto bbox = closure.boundingRect();
+    const rcVec3 center{ (float)bbox.center().x(), m_transform.mapHeightToNav(floorLevel), (float)bbox.center().y() };
+    const rcVec3 halfExtents{ (float)bbox.width() / 2.0f, 2.0f, (float)bbox.height() / 2.0f };
+
+    dtQueryFilter filter; // includes everything
+    std::vector<dtPolyRef> polys;
+    polys.resize(1024);
+    int polyCount = 0;
+    while (true) {
+        // queryPolygons() silently truncates the result when running out of space
+        m_navMeshQuery->queryPolygons(center, halfExtents, &filter, polys.data(), &polyCount, (int)polys.size());
+        if (polyCount < (int)polys.size()) {
+            break;
+        }
+        polys.resize(polys.size() * 2);
+    }
+    polys.resize(polyCount);
+
+    // queryPolygons() is bounding box based, so filter out polygons that don't actually intersect
+    polys.erase(std::remove_if(polys.begin(), polys.end(), [this, &closure](dtPolyRef ref) {
+        const dtMeshTile *tile = nullptr;
+        const dtPoly *poly = nullptr;
+        m_navMesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+        if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION) {
+            return true;
+        }
+        QPolygonF p;
+        p.reserve(poly->vertCount);
+        for (int i = 0; i < poly->vertCount; ++i) {
+            const auto v = &tile->verts[poly->verts[i] * 3];
+            p.push_back(QPointF(v[0], v[2]));
+        }
+        return !p.intersects(closure);
+    }), polys.end());
+    return polys;
+}
+
+void NavMeshPrivate::updateClosurePolygons(const std::vector<dtPolyRef> &polys)
+{
+    for (const auto ref : polys) {
+        auto it = m_closureOriginalState.find(ref);
+        if (it == m_closureOriginalState.end()) {
+            PolyState state;
+            m_navMesh->getPolyFlags(ref, &state.flags);
+            m_navMesh->getPolyArea(ref, &state.area);
+            it = m_closureOriginalState.insert({ref, state}).first;
+        }
+
+        bool excluded = false;
+        bool penalized = false;
+        for (const auto &closure : m_closures) {
+            if (std::find(closure.polys.begin(), closure.polys.end(), ref) == closure.polys.end()) {
+                continue;
+            }
+            excluded |= closure.mode == NavMesh::ClosureMode::Exclude;
+            penalized |= closure.mode == NavMesh::ClosureMode::Penalize;
+        }
+
+        const auto state = (*it).second;
+        m_navMesh->setPolyFlags(ref, excluded ? (state.flags | CLOSED_POLY_FLAG) : state.flags);
+        m_navMesh->setPolyArea(ref, penalized ? closurePenaltyArea(state.area) : state.area);
+        if (!excluded && !penalized) {
+            m_closureOriginalState.erase(it);
+        }
+    }
+}
+
+// midpoint of the portal between two polygons, equivalent to dtNavMeshQuery::getPortalPoints
+[[nodiscard]] static bool portalMidPoint(dtPolyRef fromRef, const dtMeshTile *fromTile, const dtPoly *fromPoly, const dtLink &link, const dtMeshTile *toTile, const dtPoly *toPoly, rcVec3 &mid)
+{
+    if (fromPoly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION) {
+        dtVcopy(mid, &fromTile->verts[fromPoly->verts[link.edge] * 3]);
+        return true;
+    }
+    if (toPoly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION) {
+        for (auto i = toPoly->firstLink; i != DT_NULL_LINK; i = toTile->links[i].next) {
+            if (toTile->links[i].ref == fromRef) {
+                dtVcopy(mid, &toTile->verts[toPoly->verts[toTile->links[i].edge] * 3]);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const float *v0 = &fromTile->verts[fromPoly->verts[link.edge] * 3];
+    const float *v1 = &fromTile->verts[fromPoly->verts[(link.edge + 1) % fromPoly->vertCount] * 3];
+    if (link.side != 0xff && (link.bmin != 0 || link.bmax != 255)) {
+        // portal at a tile border only covering part of the edge
+        rcVec3 left;
+        rcVec3 right;
+        dtVlerp(left, v0, v1, (float)link.bmin / 255.0f);
+        dtVlerp(right, v0, v1, (float)link.bmax / 255.0f);
+        dtVlerp(mid, left, right, 0.5f);
+    } else {
+        dtVlerp(mid, v0, v1, 0.5f);
+    }
+    return true;
+}
+
+QRect NavMeshPrivate::tileRect(const float *bmin, const float *bmax) const
+{
+    int minX = 0, minY = 0, maxX = 0, maxY = 0;
+    m_navMesh->calcTileLoc(bmin, &minX, &minY);
+    m_navMesh->calcTileLoc(bmax, &maxX, &maxY);
+    return QRect(QPoint(minX, minY), QPoint(maxX, maxY)).intersected(allTiles());
+}
+
+void NavMeshPrivate::ensureTiles(const QRect &tiles)
+{
+    for (int ty = tiles.top(); ty <= tiles.bottom(); ++ty) {
+        for (int tx = tiles.left(); tx <= tiles.right(); ++tx) {
+            ensureTile(tx, ty);
+        }
+    }
+}
+
+void NavMeshPrivate::ensureTile(int tx, int ty)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_tileStates.empty()) {
+        return;
+    }
+    const auto idx = (std::size_t)(ty * m_tileCountX + tx);
+    while (!m_tileStates.empty() && m_tileStates[idx] == TileState::Building) {
+        m_tileBuilt.wait(&m_mutex);
+    }
+    if (m_tileStates.empty() || m_tileStates[idx] == TileState::Built) {
+        return;
+    }
+
+    // build the tile without holding the lock, so queries on already built parts can continue
+    m_tileStates[idx] = TileState::Building;
+    const auto geometry = m_geometry;
+    locker.unlock();
+
+    rcContext ctx;
+    std::vector<NavMeshGeometry::TileData> tiles;
+    if (!geometry->buildTiles(&ctx, tx, ty, {m_agent}, tiles)) {
+        qCWarning(Log) << "failed to build tile" << tx << ty;
+    }
+
+    locker.relock();
+    if (!tiles.empty() && tiles[0].data) {
+        auto &tile = tiles[0];
+        if (dtStatusSucceed(m_navMesh->addTile(tile.data.get(), tile.size, DT_TILE_FREE_DATA, 0, nullptr))) {
+            (void)tile.data.release();
+            m_snapIndex.clear();
+        } else {
+            qCWarning(Log) << "failed to add tile" << tx << ty;
+        }
+    }
+    m_tileStates[idx] = TileState::Built;
+    if (++m_builtTileCount == m_tileStates.size()) {
+        qCDebug(Log) << "all tiles built";
+        m_tileStates.clear();
+        m_geometry.reset();
+    }
+    m_tileBuilt.wakeAll();
+}
+
+float NavMeshPrivate::pathCost(const dtQueryFilter &filter, const float *startPos, const float *endPos, const dtPolyRef *path, int pathCount) const
+{
+    float cost = 0.0f;
+    rcVec3 pos;
+    dtVcopy(pos, startPos);
+    for (int i = 0; i < pathCount; ++i) {
+        const dtMeshTile *tile = nullptr;
+        const dtPoly *poly = nullptr;
+        m_navMesh->getTileAndPolyByRefUnsafe(path[i], &tile, &poly);
+
+        if (i == pathCount - 1) {
+            return cost + filter.getCost(pos, endPos, 0, nullptr, nullptr, path[i], tile, poly, 0, nullptr, nullptr);
+        }
+
+        const dtMeshTile *nextTile = nullptr;
+        const dtPoly *nextPoly = nullptr;
+        m_navMesh->getTileAndPolyByRefUnsafe(path[i + 1], &nextTile, &nextPoly);
+        auto linkIdx = poly->firstLink;
+        for (; linkIdx != DT_NULL_LINK && tile->links[linkIdx].ref != path[i + 1]; linkIdx = tile->links[linkIdx].next) {}
+        rcVec3 mid;
+        if (linkIdx == DT_NULL_LINK || !portalMidPoint(path[i], tile, poly, tile->links[linkIdx], nextTile, nextPoly, mid)) {
+            return std::numeric_limits<float>::max();
+        }
+        cost += filter.getCost(pos, mid, 0, nullptr, nullptr, path[i], tile, poly, path[i + 1], nextTile, nextPoly);
+        pos = mid;
+    }
+    return cost;
+}
+
+float NavMeshPrivate::leavingCostBound(const QRect &tiles, const float *startPos, const float *endPos) const
+{
+    // distance to the closest side of the tile region that isn't also the edge of the entire nav mesh
+    const auto params = m_navMesh->getParams();
+    const auto minX = params->orig[0] + (float)tiles.left() * params->tileWidth;
+    const auto maxX = params->orig[0] + (float)(tiles.right() + 1) * params->tileWidth;
+    const auto minZ = params->orig[2] + (float)tiles.top() * params->tileHeight;
+    const auto maxZ = params->orig[2] + (float)(tiles.bottom() + 1) * params->tileHeight;
+    const auto all = allTiles();
+
+    const auto distanceToBorder = [&](const float *pos) {
+        auto dist = std::numeric_limits<float>::max();
+        if (tiles.left() > all.left()) {
+            dist = std::min(dist, pos[0] - minX);
+        }
+        if (tiles.right() < all.right()) {
+            dist = std::min(dist, maxX - pos[0]);
+        }
+        if (tiles.top() > all.top()) {
+            dist = std::min(dist, pos[2] - minZ);
+        }
+        if (tiles.bottom() < all.bottom()) {
+            dist = std::min(dist, maxZ - pos[2]);
+        }
+        return std::max(0.0f, dist);
+    };
+    return distanceToBorder(startPos) + distanceToBorder(endPos);
+}
+
+namespace {
+struct IsochroneNode {
+    float cost;
+    rcVec3 pos;
+};
+
+// for chaining contour segments, vertices of adjacent polygons are bit-identical in Detour
+struct VertexKey {
+    float x;
+    float y;
+    float z;
+    [[nodiscard]] constexpr bool operator<(const VertexKey &other) const
+    {
+        return std::tie(x, y, z) < std::tie(other.x, other.y, other.z);
+    }
+};
+}
+#endif
+
+#if HAVE_RECAST
+std::vector<std::optional<rcVec3>> NavMeshPrivate::snap(const std::vector<rcVec3> &positions, const dtQueryFilter &filter, float maxDistance)
+{
+    std::vector<std::optional<rcVec3>> result(positions.size());
+    if (positions.empty()) {
+        return result;
+    }
+
+    // make sure all lazily built tiles within reach exist
+    rcVec3 bmin{ std::numeric_limits<float>::max(), 0.0f, std::numeric_limits<float>::max() };
+    rcVec3 bmax{ std::numeric_limits<float>::lowest(), 0.0f, std::numeric_limits<float>::lowest() };
+    for (const auto &pos : positions) {
+        bmin.x = std::min(bmin.x, pos.x - maxDistance);
+        bmin.z = std::min(bmin.z, pos.z - maxDistance);
+        bmax.x = std::max(bmax.x, pos.x + maxDistance);
+        bmax.z = std::max(bmax.z, pos.z + maxDistance);
+    }
+    ensureTiles(tileRect(bmin, bmax));
+    QMutexLocker locker(&m_mutex);
+
+    if (m_snapIndex.isEmpty()) {
+        m_snapIndex.build(m_navMesh.get(), m_transform);
+    }
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        rcVec3 snapped;
+        if (m_snapIndex.snap(m_navMeshQuery.get(), filter, positions[i], m_transform.mapNavHeightToFloorLevel(positions[i].y), maxDistance, snapped)) {
+            result[i] = snapped;
+        }
+    }
+    return result;
+}
+#endif
+
+NavMeshPosition NavMesh::snap(const NavMeshPosition &position, float maxDistance) const
+{
+    return snap(std::vector<NavMeshPosition>{position}, RoutingProfile(), maxDistance).front();
+}
+
+std::vector<NavMeshPosition> NavMesh::snap(const std::vector<NavMeshPosition> &positions, float maxDistance) const
+{
+    return snap(positions, RoutingProfile(), maxDistance);
+}
+
+NavMeshPosition NavMesh::snap(const NavMeshPosition &position, const RoutingProfile &profile, float maxDistance) const
+{
+    return snap(std::vector<NavMeshPosition>{position}, profile, maxDistance).front();
+}
+
+std::vector<NavMeshPosition> NavMesh::snap(const std::vector<NavMeshPosition> &positions, const RoutingProfile &profile, float maxDistance) const
+{
+    std::vector<NavMeshPosition> result(positions.size());
+#if HAVE_RECAST
+    if (!d || !d->m_navMesh || !d->m_navMeshQuery) {
+        return result;
+    }
+
+    std::vector<rcVec3> navPositions;
+    std::vector<std::size_t> indexes;
+    navPositions.reserve(positions.size());
+    indexes.reserve(positions.size());
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        if (positions[i].isValid()) {
+            navPositions.push_back(d->m_transform.mapGeoHeightToNav(positions[i].coordinate, positions[i].floorLevel));
+            indexes.push_back(i);
+        }
+    }
+
+    const auto filter = d->queryFilter(profile);
+    const auto snapped = d->snap(navPositions, filter, maxDistance);
+    for (std::size_t i = 0; i < snapped.size(); ++i) {
+        if (snapped[i]) {
+            auto &pos = result[indexes[i]];
+            pos.coordinate = d->m_transform.mapNavToGeo(*snapped[i]);
+            pos.floorLevel = d->m_transform.mapNavHeightToFloorLevel(snapped[i]->y);
+        }
+    }
+#else
+    Q_UNUSED(profile);
+    Q_UNUSED(maxDistance);
+#endif
+    return result;
+}
+
+Isochrone NavMesh::isochrone(OSM::Coordinate start, int floorLevel, const RoutingProfile &profile, std::chrono::seconds maxDuration) const
+{
+    Isochrone result;
+#if HAVE_RECAST
+    if (!d || !d->m_navMesh || !d->m_navMeshQuery) {
+        return result;
+    }
+
+    const auto *mesh = d->m_navMesh.get();
+    const auto filter = d->queryFilter(profile);
+    const auto startPos = d->m_transform.mapGeoHeightToNav(start, floorLevel);
+    // travel costs are weighted distances in meter
+    const auto maxCost = std::chrono::duration<float>(maxDuration).count() * profile.walkingSpeed();
+
+    // as all area costs are at least 1, nothing further away than maxCost can be reached
+    const rcVec3 bmin{ startPos.x - maxCost, startPos.y, startPos.z - maxCost };
+    const rcVec3 bmax{ startPos.x + maxCost, startPos.y, startPos.z + maxCost };
+    d->ensureTiles(d->tileRect(bmin, bmax));
+    QMutexLocker locker(&d->m_mutex);
+
+    rcVec3 polyPickExt({ 2.0f, 4.0f, 2.0f });
+    dtPolyRef startRef = 0;
+    rcVec3 startPolyPos;
+    if (dtStatusFailed(d->m_navMeshQuery->findNearestPoly(startPos, polyPickExt, &filter, &startRef, startPolyPos)) || !startRef) {
+        qCDebug(Log) << "isochrone start position not on nav mesh";
+        return result;
+    }
+
+    // cost-bounded Dijkstra over the polygon graph
+    // costs are those at the polygon entry point, same as in dtNavMeshQuery::findPolysAroundCircle
+    std::unordered_map<dtPolyRef, IsochroneNode> nodes;
+    using QueueEntry = std::pair<float, dtPolyRef>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    std::vector<dtPolyRef> settled;
+
+    nodes.insert({startRef, IsochroneNode{ 0.0f, startPolyPos }});
+    queue.push({0.0f, startRef});
+
+    while (!queue.empty()) {
+        const auto [cost, ref] = queue.top();
+        queue.pop();
+        const auto node = nodes.at(ref);
+        if (cost > node.cost) {
+            continue; // outdated queue entry
+        }
+        settled.push_back(ref);
+
+        const dtMeshTile *tile = nullptr;
+        const dtPoly *poly = nullptr;
+        mesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+
+        for (auto i = poly->firstLink; i != DT_NULL_LINK; i = tile->links[i].next) {
+            const auto &link = tile->links[i];
+            if (!link.ref) {
+                continue;
+            }
+            const dtMeshTile *nextTile = nullptr;
+            const dtPoly *nextPoly = nullptr;
+            mesh->getTileAndPolyByRefUnsafe(link.ref, &nextTile, &nextPoly);
+            if (!filter.passFilter(link.ref, nextTile, nextPoly)) {
+                continue;
+            }
+
+            rcVec3 mid;
+            if (!portalMidPoint(ref, tile, poly, link, nextTile, nextPoly, mid)) {
+                continue;
+            }
+            const auto nextCost = node.cost + filter.getCost(node.pos, mid, 0, nullptr, nullptr, ref, tile, poly, link.ref, nextTile, nextPoly);
+            if (nextCost > maxCost) {
+                continue;
+            }
+            const auto it = nodes.find(link.ref);
+            if (it != nodes.end() && (*it).second.cost <= nextCost) {
+                continue;
+            }
+            nodes.insert_or_assign(link.ref, IsochroneNode{ nextCost, mid });
+            queue.push({nextCost, link.ref});
+        }
+    }
+
+    // result polygons
+    std::vector<IsochronePolygon> polygons;
+    polygons.reserve(settled.size());
+    std::map<int, std::multimap<VertexKey, VertexKey>> segments;
+    for (const auto ref : settled) {
+        const dtMeshTile *tile = nullptr;
+        const dtPoly *poly = nullptr;
+        mesh->getTileAndPolyByRefUnsafe(ref, &tile, &poly);
+        if (poly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION) {
+            continue;
+        }
+
+        IsochronePolygon p;
+        p.duration = std::chrono::duration<float>(nodes.at(ref).cost / profile.walkingSpeed());
+        p.outline.reserve(poly->vertCount + 1);
+        float height = 0.0f;
+        for (int i = 0; i < poly->vertCount; ++i) {
+            const auto v = &tile->verts[poly->verts[i] * 3];
+            p.outline.push_back(d->m_transform.mapNavToGeo({ v[0], v[1], v[2] }));
+            height += v[1];
+        }
+        p.outline.push_back(p.outline.front());
+        p.floorLevel = d->m_transform.mapNavHeightToFloorLevel(height / (float)poly->vertCount);
+
+        // boundary edges: no reachable neighbor polygon on that edge
+        for (int edge = 0; edge < poly->vertCount; ++edge) {
+            bool isBoundary = true;
+            for (auto i = poly->firstLink; i != DT_NULL_LINK && isBoundary; i = tile->links[i].next) {
+                const auto &link = tile->links[i];
+                if (link.edge != edge || !link.ref || !nodes.contains(link.ref)) {
+                    continue;
+                }
+                const dtMeshTile *nextTile = nullptr;
+                const dtPoly *nextPoly = nullptr;
+                mesh->getTileAndPolyByRefUnsafe(link.ref, &nextTile, &nextPoly);
+                isBoundary = nextPoly->getType() == DT_POLYTYPE_OFFMESH_CONNECTION;
+            }
+            if (isBoundary) {
+                const auto v0 = &tile->verts[poly->verts[edge] * 3];
+                const auto v1 = &tile->verts[poly->verts[(edge + 1) % poly->vertCount] * 3];
+                segments[p.floorLevel].insert({VertexKey{ v0[0], v0[1], v0[2] }, VertexKey{ v1[0], v1[1], v1[2] }});
+            }
+        }
+        polygons.push_back(std::move(p));
+    }
+
+    // chain boundary segments into contour lines
+    std::vector<IsochroneContour> contours;
+    for (auto &[level, levelSegments] : segments) {
+        while (!levelSegments.empty()) {
+            IsochroneContour contour;
+            contour.floorLevel = level;
+            auto it = levelSegments.begin();
+            contour.path.push_back(d->m_transform.mapNavToGeo({ (*it).first.x, (*it).first.y, (*it).first.z }));
+            while (it != levelSegments.end()) {
+                const auto next = (*it).second;
+                contour.path.push_back(d->m_transform.mapNavToGeo({ next.x, next.y, next.z }));
+                levelSegments.erase(it);
+                it = levelSegments.find(next);
+            }
+            contours.push_back(std::move(contour));
+        }
+    }
+
+    result.setPolygons(std::move(polygons));
+    result.setContours(std::move(contours));
+#else
+    Q_UNUSED(start);
+    Q_UNUSED(floorLevel);
+    Q_UNUSED(profile);
+    Q_UNUSED(maxDuration);
+#endif
+    return result;
+}
+
+int NavMesh::addClosure(const std::vector<OSM::Coordinate> &polygon, int floorLevel, ClosureMode mode)
+{
+#if HAVE_RECAST
+    if (!d || !d->m_navMesh || !d->m_navMeshQuery || polygon.empty()) {
+        return 0;
+    }
+
+    QPolygonF bbox;
+    for (const auto &c : polygon) {
+        bbox.push_back(d->m_transform.mapGeoToNav(c));
+    }
+    const auto rect = bbox.boundingRect();
+    const rcVec3 bmin{ (float)rect.left(), 0.0f, (float)rect.top() };
+    const rcVec3 bmax{ (float)rect.right(), 0.0f, (float)rect.bottom() };
+    d->ensureTiles(d->tileRect(bmin, bmax));
+    QMutexLocker locker(&d->m_mutex);
+
+    auto polys = d->closurePolygons(polygon, floorLevel);
+    if (polys.empty()) {
+        return 0;
+    }
+    d->m_closures.push_back({d->m_nextClosureId++, mode, std::move(polys)});
+    d->updateClosurePolygons(d->m_closures.back().polys);
+    return d->m_closures.back().id;
+#else
+    Q_UNUSED(polygon);
+    Q_UNUSED(floorLevel);
+    Q_UNUSED(mode);
+    return 0;
+#endif
+}
+
+int NavMesh::addClosure(OSM::Coordinate coord, int floorLevel, ClosureMode mode)
+{
+#if HAVE_RECAST
+    if (!d || !d->m_navMesh || !d->m_navMeshQuery) {
+        return 0;
+    }
+
+    dtQueryFilter filter; // includes everything
+    rcVec3 polyPickExt({ 2.0f, 4.0f, 2.0f });
+    const auto pos = d->m_transform.mapGeoHeightToNav(coord, floorLevel);
+    d->ensureTiles(d->tileRect(rcVec3{ pos.x - polyPickExt.x, pos.y, pos.z - polyPickExt.z }, rcVec3{ pos.x + polyPickExt.x, pos.y, pos.z + polyPickExt.z }));
+    QMutexLocker locker(&d->m_mutex);
+
+    dtPolyRef ref = 0;
+    d->m_navMeshQuery->findNearestPoly(pos, polyPickExt, &filter, &ref, nullptr);
+    if (!ref) {
+        return 0;
+    }
+    d->m_closures.push_back({d->m_nextClosureId++, mode, {ref}});
+    d->updateClosurePolygons(d->m_closures.back().polys);
+    return d->m_closures.back().id;
+#else
+    Q_UNUSED(coord);
+    Q_UNUSED(floorLevel);
+    Q_UNUSED(mode);
+    return 0;
+#endif
+}
+
+void NavMesh::removeClosure(int closureId)
+{
+#if HAVE_RECAST
+    if (!d) {
+        return;
+    }
+    QMutexLocker locker(&d->m_mutex);
+    const auto it = std::find_if(d->m_closures.begin(), d->m_closures.end(), [closureId](const auto &closure) { return closure.id == closureId; });
+    if (it == d->m_closures.end()) {
+        return;
+    }
+    const auto polys = std::move((*it).polys);
+    d->m_closures.erase(it);
+    d->updateClosurePolygons(polys);
+#else
+    Q_UNUSED(closureId);
+#endif
+}
+
+void NavMesh::clearClosures()
+{
+#if HAVE_RECAST
+    if (!d) {
+        return;
+    }
+    QMutexLocker locker(&d->m_mutex);
+    d->m_closures.clear();
+    for (const auto &[ref, state] : d->m_closureOriginalState) {
+        d->m_navMesh->setPolyFlags(ref, state.flags);
+        d->m_navMesh->setPolyArea(ref, state.area);
+    }
+    d->m_closureOriginalState.clear();
+#endif
+}
+
+void NavMesh::setClosurePenalty(float penalty)
+{
+    if (d) {
+        QMutexLocker locker(&d->m_mutex);
+        d->m_closurePenalty = std::max(1.0f, penalty);
+    }
+}
+
 void NavMesh::writeToFile(const QString &fileName) const
 {
     QFile f(fileName);
@@ -63,6 +681,8 @@ void NavMesh::writeToFile(const QString &fileName) const
         return;
     }
 #if HAVE_RECAST
+    d->ensureTiles(d->allTiles());
+    QMutexLocker locker(&d->m_mutex);
     const auto *mesh = d->m_navMesh.get();
 
     NavMeshSetHeader header;
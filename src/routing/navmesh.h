@@ -8,14 +8,21 @@
 
 #include "kosmindoorrouting_export.h"
 
+#include <KOSM/Datatypes>
+
+#include <chrono>
 #include <memory>
+#include <vector>
 
 class QString;
 
 namespace KOSMIndoorRouting {
 
+class Isochrone;
+class NavMeshPosition;
 class NavMeshTransform;
 class NavMeshPrivate;
+class RoutingProfile;
 
 /** Compiled nav mesh for routing */
 class KOSMINDOORROUTING_EXPORT NavMesh
@@ -38,6 +45,55 @@ public:
 
     [[nodiscard]] NavMeshTransform transform() const;
 
+    /** Snaps @p position to the closest walkable point on the same floor level.
+     *  The search radius grows progressively up to @p maxDistance meters, so positions
+     *  far away from any walkable area can be snapped as well.
+     *  Only areas @p profile allows are considered, closed areas (see addClosure()) are not considered.
+     *  @returns An invalid position if there is no walkable area within @p maxDistance.
+     *  The floor level is that of the snapped point, which can differ from the one of
+     *  @p position when snapping onto stairs or ramps connecting floors.
+     */
+    [[nodiscard]] NavMeshPosition snap(const NavMeshPosition &position, const RoutingProfile &profile, float maxDistance = 10.0f) const;
+    /** Snaps all of @p positions at once.
+     *  This is considerably faster than snapping each position individually.
+     *  @returns A list of snapped positions of the same size and order as @p positions.
+     */
+    [[nodiscard]] std::vector<NavMeshPosition> snap(const std::vector<NavMeshPosition> &positions, const RoutingProfile &profile, float maxDistance = 10.0f) const;
+    /** Same as the above, for a default constructed RoutingProfile. */
+    [[nodiscard]] NavMeshPosition snap(const NavMeshPosition &position, float maxDistance = 10.0f) const;
+    [[nodiscard]] std::vector<NavMeshPosition> snap(const std::vector<NavMeshPosition> &positions, float maxDistance = 10.0f) const;
+
+    /** Computes the area reachable from @p start on @p floorLevel within @p maxDuration.
+     *  This is a single cost-bounded flood over the nav mesh polygon graph, using the same
+     *  area costs, area flags and floor level transfers as RoutingJob does for @p profile.
+     *  Travel times are distances weighted with the area cost factors of @p profile,
+     *  at the walking speed of @p profile.
+     *  This is safe to call from any thread, it is serialized with concurrently running RoutingJobs on the same nav mesh.
+     */
+    [[nodiscard]] Isochrone isochrone(OSM::Coordinate start, int floorLevel, const RoutingProfile &profile, std::chrono::seconds maxDuration) const;
+
+    /** How closed parts of the nav mesh are treated by routing. */
+    enum class ClosureMode {
+        Exclude, ///< closed areas are not routed through at all
+        Penalize, ///< closed areas are avoided if possible, see setClosurePenalty()
+    };
+
+    /** Temporarily close the area covered by @p polygon on @p floorLevel.
+     *  This takes effect for all subsequent routing and isochrone queries, without rebuilding the nav mesh.
+     *  Closures are shared between all copies of a nav mesh, and are lost when the nav mesh is rebuilt.
+     *  @returns An identifier for use with removeClosure(), or @c 0 if nothing was closed.
+     */
+    int addClosure(const std::vector<OSM::Coordinate> &polygon, int floorLevel, ClosureMode mode = ClosureMode::Exclude);
+    /** Temporarily close the nav mesh polygon at @p coord on @p floorLevel. */
+    int addClosure(OSM::Coordinate coord, int floorLevel, ClosureMode mode = ClosureMode::Exclude);
+    /** Reverts the closure @p closureId. */
+    void removeClosure(int closureId);
+    /** Reverts all closures. */
+    void clearClosures();
+
+    /** Cost factor for areas closed with ClosureMode::Penalize. */
+    void setClosurePenalty(float penalty);
+
     /** Write nav mesh data to the given file.
      *  Uses the file format used by the Recast demo, so this is primarily
      *  for debugging.
@@ -6,13 +6,39 @@
 #ifndef KOSMINDOORROUTING_NAVMESH_P_H
 #define KOSMINDOORROUTING_NAVMESH_P_H
 
+#include "agentprofile.h"
 #include "navmesh.h"
+#include "navmeshsnapindex_p.h"
 #include "navmeshtransform.h"
 #include "recastnav_p.h"
+#include "routingarea.h"
 
+#include <QMutex>
 #include <QObject>
+#include <QRect>
+#include <QWaitCondition>
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace KOSMIndoorRouting {
+
+class NavMeshGeometry;
+class RoutingProfile;
+
+/** Detour polygon flag marking polygons excluded by a closure. */
+constexpr inline uint16_t CLOSED_POLY_FLAG = 0x8000;
+/** Detour area id for polygons of area type @p area penalized by a closure.
+ *  Each area type has its own penalized counterpart, so the penalty applies
+ *  on top of the cost of the original area type.
+ */
+[[nodiscard]] constexpr inline uint8_t closurePenaltyArea(uint8_t area)
+{
+    return area == qToUnderlying(AreaType::Walkable) ? 62 : 32 + area;
+}
+static_assert(AREA_TYPE_COUNT < 30);
+
 class NavMeshPrivate
 {
 public:
@@ -25,6 +51,10 @@ public:
         return navMesh.d.get();
     }
 
+    [[nodiscard]] static inline std::weak_ptr<NavMeshPrivate> weakRef(const NavMesh &navMesh) {
+        return navMesh.d;
+    }
+
     [[nodiscard]] static inline NavMeshPrivate *create(NavMesh &navMesh) {
         assert(!navMesh.d);
         navMesh.d = std::make_shared<NavMeshPrivate>();
@@ -32,9 +62,70 @@ public:
     }
 
 #if HAVE_RECAST
+    /** Query filter implementing the area flags and costs of @p profile, and the current closures. */
+    [[nodiscard]] dtQueryFilter queryFilter(const RoutingProfile &profile) const;
+
+    /** Snap nav mesh space positions @p positions to the closest point on a polygon passing @p filter.
+     *  The floor level of each position is derived from its height.
+     *  Must not be called with m_mutex held.
+     */
+    [[nodiscard]] std::vector<std::optional<rcVec3>> snap(const std::vector<rcVec3> &positions, const dtQueryFilter &filter, float maxDistance);
+
+    /** Find all polygons affected by a closure. */
+    [[nodiscard]] std::vector<dtPolyRef> closurePolygons(const std::vector<OSM::Coordinate> &polygon, int floorLevel) const;
+    /** Re-apply flags and area ids for @p polys based on the currently active closures. */
+    void updateClosurePolygons(const std::vector<dtPolyRef> &polys);
+
+    /** All tiles of this nav mesh. */
+    [[nodiscard]] inline QRect allTiles() const { return QRect(0, 0, m_tileCountX, m_tileCountY); }
+    /** Tiles covering the nav mesh space bounding box @p bmin, @p bmax. */
+    [[nodiscard]] QRect tileRect(const float *bmin, const float *bmax) const;
+    /** Make sure all tiles in @p tiles are built.
+     *  Missing tiles are built in the calling thread, must not be called with m_mutex held.
+     */
+    void ensureTiles(const QRect &tiles);
+    void ensureTile(int tx, int ty);
+
+    /** Cost of @p path according to @p filter, computed the same way as dtNavMeshQuery::findPath does. */
+    [[nodiscard]] float pathCost(const dtQueryFilter &filter, const float *startPos, const float *endPos, const dtPolyRef *path, int pathCount) const;
+    /** Lower bound for the cost of any path from @p startPos to @p endPos that leaves @p tiles.
+     *  Relies on all area costs being at least 1.
+     */
+    [[nodiscard]] float leavingCostBound(const QRect &tiles, const float *startPos, const float *endPos) const;
+
     dtNavMeshPtr m_navMesh;
     dtNavMeshQueryPtr m_navMeshQuery;
+    // built on first use, reset when tiles are added
+    NavMeshSnapIndex m_snapIndex;
+
+    // lazy tile building, empty/null once all tiles are built (m_tileStates is protected by m_mutex)
+    enum class TileState : uint8_t { Missing, Building, Built };
+    std::shared_ptr<const NavMeshGeometry> m_geometry;
+    std::vector<TileState> m_tileStates;
+    std::size_t m_builtTileCount = 0;
+    QWaitCondition m_tileBuilt;
+
+    struct Closure {
+        int id;
+        NavMesh::ClosureMode mode;
+        std::vector<dtPolyRef> polys;
+    };
+    std::vector<Closure> m_closures;
+    // original state of polygons modified by closures
+    struct PolyState {
+        uint16_t flags;
+        uint8_t area;
+    };
+    std::unordered_map<dtPolyRef, PolyState> m_closureOriginalState;
 #endif
+    int m_tileCountX = 0;
+    int m_tileCountY = 0;
+    AgentProfile m_agent;
+    /** Serializes nav mesh queries and modifications (tiles being added, closures). */
+    mutable QMutex m_mutex;
+
+    int m_nextClosureId = 1;
+    float m_closurePenalty = 50.0f; // protected by m_mutex
 
     NavMeshTransform m_transform;
 
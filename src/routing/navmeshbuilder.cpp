@@ -5,8 +5,10 @@
 
 #include "navmeshbuilder.h"
 
+#include "agentprofile.h"
 #include "navmesh.h"
 #include "navmesh_p.h"
+#include "navmeshgeometry_p.h"
 #include "navmeshtransform.h"
 #include "recastnav_p.h"
 // #include "recastnavdebug_p.h"
@@ -35,10 +37,7 @@
 #include <private/qtriangulator_p.h>
 #include <private/qtriangulatingstroker_p.h>
 
-#if HAVE_RECAST
-#include <DetourNavMeshBuilder.h>
-#endif
-
+#include <algorithm>
 #include <cmath>
 #include <unordered_map>
 #include <unordered_set>
@@ -47,8 +46,6 @@ class rcContext;
 
 namespace KOSMIndoorRouting {
 
-enum class LinkDirection { Forward, Backward, Bidirectional };
-
 // ordered by priority, must match m_areaClassKeys array below
 struct {
     const char *name;
@@ -83,12 +80,8 @@ public:
     [[nodiscard]] double doorWidth(const OSM::Node *node);
     void extrudeWall(const std::vector<const OSM::Node*> &way, int floorLevel);
 
-    void addVertex(float x, float y, float z);
-    void addFace(std::size_t i, std::size_t j, std::size_t k, AreaType areaType);
-    void addOffMeshConnection(float x1, float y1, float z1, float x2, float y2, float z2, LinkDirection linkDir, AreaType areaType);
-
     void buildNavMesh();
-    [[nodiscard]] bool buildNavMeshTile(rcContext *ctx, int tx, int ty, NavMeshPrivate *result);
+    void buildRemainingTiles();
 
     void writeGsetFile();
     void writeObjFile();
@@ -108,25 +101,11 @@ public:
 
     std::unordered_set<OSM::Element> m_processedLinks;
 
-    // triangle data
-    std::vector<float> m_verts;
-    inline int numVerts() const { return (int)m_verts.size() / 3; }
-    std::vector<int> m_tris;
-    inline int numTris() const { return (int)m_tris.size() / 3; }
-    std::vector<uint8_t> m_triAreaIds;
+    std::shared_ptr<NavMeshGeometry> m_geometry;
 
-    // off mesh connection data
-    struct {
-        std::vector<float> verts;
-        std::vector<float> rads;
-        std::vector<uint16_t> flags;
-        std::vector<uint8_t> areas;
-        std::vector<uint8_t> dir;
-        std::vector<uint32_t> userId;
-    } m_offMeshCon;
-    inline int offMeshCount() const { return (int) m_offMeshCon.rads.size(); }
-
-    NavMesh m_navMesh;
+    std::vector<AgentProfile> m_agents = { AgentProfile() };
+    std::vector<NavMesh> m_navMeshes;
+    bool m_lazyTileBuilding = false;
 
     struct {
         OSM::TagKey door;
@@ -257,6 +236,19 @@ void NavMeshBuilder::setEquipmentModel(KOSMIndoorMap::AbstractOverlaySource *equ
     // TODO can we do incremental updates when a realtime elevator status changes?
 }
 
+void NavMeshBuilder::setAgentProfiles(const std::vector<AgentProfile> &agents)
+{
+    d->m_agents = agents;
+    if (d->m_agents.empty()) {
+        d->m_agents.push_back(AgentProfile());
+    }
+}
+
+void NavMeshBuilder::setLazyTileBuilding(bool lazy)
+{
+    d->m_lazyTileBuilding = lazy;
+}
+
 void NavMeshBuilder::writeDebugNavMesh(const QString &gsetFile, const QString &objFile)
 {
     d->m_gsetFileName = gsetFile;
@@ -341,6 +333,8 @@ void NavMeshBuilder::start()
 
     d->m_transform.initialize(d->m_data.boundingBox());
     d->indexNodeLevels();
+    d->m_geometry = std::make_shared<NavMeshGeometry>();
+    d->m_vertexOffset = 0;
 
     std::vector<OSM::Element> hiddenElements;
     if (d->m_equipmentModel) {
@@ -369,14 +363,18 @@ void NavMeshBuilder::start()
         d->writeObjFile();
     }
 
-    qCDebug(Log) << "Vertex data size:" << d->m_verts.size() * sizeof(float);
-    qCDebug(Log) << "Triangle index size:" << d->m_tris.size() * sizeof(int);
-    qCDebug(Log) << "Triangle area size:" << d->m_triAreaIds.size();
-    qCDebug(Log) << "Off-mesh data size:" << d->offMeshCount() * 16;
+    qCDebug(Log) << "Vertex data size:" << d->m_geometry->m_verts.size() * sizeof(float);
+    qCDebug(Log) << "Triangle index size:" << d->m_geometry->m_tris.size() * sizeof(int);
+    qCDebug(Log) << "Triangle area size:" << d->m_geometry->m_triAreaIds.size();
+    qCDebug(Log) << "Off-mesh data size:" << d->m_geometry->offMeshCount() * 16;
+
+    d->m_geometry->setBounds(d->m_transform.mapGeoHeightToNav(d->m_data.boundingBox().min, std::prev(d->m_data.levelMap().end())->first.numericLevel()),
+                             d->m_transform.mapGeoHeightToNav(d->m_data.boundingBox().max, d->m_data.levelMap().begin()->first.numericLevel()));
 
     // the second half of this (which takes the majority of the time) runs in a secondary thread
     QThreadPool::globalInstance()->start([this]() {
         d->buildNavMesh();
+        d->buildRemainingTiles();
         QMetaObject::invokeMethod(this, &NavMeshBuilder::finished, Qt::QueuedConnection);
     });
 }
@@ -418,18 +416,18 @@ void NavMeshBuilderPrivate::processGeometry(OSM::Element elem, int floorLevel, c
             qCDebug(Log) << "A" << elem.url() << m_transform.mapGeoToNav(path).boundingRect() << path.elementCount() << triSet.indices.size() << triSet.vertices.size() << m_vertexOffset << floorLevel;
 
             for (qsizetype i = 0; i < triSet.vertices.size(); i += 2) {
-                addVertex(triSet.vertices[i], m_transform.mapHeightToNav(floorLevel), triSet.vertices[i + 1]);
+                m_geometry->addVertex(triSet.vertices[i], m_transform.mapHeightToNav(floorLevel), triSet.vertices[i + 1]);
             }
             if (triSet.indices.type() == QVertexIndexVector::UnsignedShort) {
                 for (qsizetype i = 0; i <triSet.indices.size(); i += 3) {
-                    addFace(*(reinterpret_cast<const uint16_t*>(triSet.indices.data()) + i) + m_vertexOffset,
+                    m_geometry->addFace(*(reinterpret_cast<const uint16_t*>(triSet.indices.data()) + i) + m_vertexOffset,
                             *(reinterpret_cast<const uint16_t*>(triSet.indices.data()) + i + 1) + m_vertexOffset,
                             *(reinterpret_cast<const uint16_t*>(triSet.indices.data()) + i + 2) + m_vertexOffset,
                             areaType(res));
                 }
             } else if (triSet.indices.type() == QVertexIndexVector::UnsignedInt) {
                 for (qsizetype i = 0; i <triSet.indices.size(); i += 3) {
-                    addFace(*(reinterpret_cast<const uint32_t*>(triSet.indices.data()) + i) + m_vertexOffset,
+                    m_geometry->addFace(*(reinterpret_cast<const uint32_t*>(triSet.indices.data()) + i) + m_vertexOffset,
                             *(reinterpret_cast<const uint32_t*>(triSet.indices.data()) + i + 1) + m_vertexOffset,
                             *(reinterpret_cast<const uint32_t*>(triSet.indices.data()) + i + 2) + m_vertexOffset,
                             areaType(res));
@@ -467,14 +465,14 @@ void NavMeshBuilderPrivate::processGeometry(OSM::Element elem, int floorLevel, c
                         l = QLineF(poly.at(0), p).length() < QLineF(poly.at(1), p).length() ? l1 : l2;
                     }
                 }
-                addVertex(*(stroker.vertices() + i), m_transform.mapHeightToNav(l), *(stroker.vertices() + i + 1));
+                m_geometry->addVertex(*(stroker.vertices() + i), m_transform.mapHeightToNav(l), *(stroker.vertices() + i + 1));
             }
             for (int i = 0; i < stroker.vertexCount() / 2 - 2; ++i) {
                 // GL_TRIANGLE_STRIP winding order
                 if (i % 2) {
-                    addFace(m_vertexOffset + i, m_vertexOffset + i + 1, m_vertexOffset + i + 2, areaType(res));
+                    m_geometry->addFace(m_vertexOffset + i, m_vertexOffset + i + 1, m_vertexOffset + i + 2, areaType(res));
                 } else {
-                    addFace(m_vertexOffset + i + 1, m_vertexOffset + i, m_vertexOffset + i + 2, areaType(res));
+                    m_geometry->addFace(m_vertexOffset + i + 1, m_vertexOffset + i, m_vertexOffset + i + 2, areaType(res));
                 }
             }
             m_vertexOffset += stroker.vertexCount() / 2;
@@ -527,7 +525,7 @@ void NavMeshBuilderPrivate::processLink(OSM::Element elem, int floorLevel, LinkD
             // TODO doesn't work for concave polygons!
             const QPointF p = m_transform.mapGeoToNav(elem.center());
             for (std::size_t i = 0; i < levels.size() - 1; ++i) {
-                addOffMeshConnection(p.x(), m_transform.mapHeightToNav(levels[i]), p.y(), p.x(), m_transform.mapHeightToNav(levels[i + 1]), p.y(), LinkDirection::Bidirectional, areaType(res));
+                m_geometry->addOffMeshConnection(p.x(), m_transform.mapHeightToNav(levels[i]), p.y(), p.x(), m_transform.mapHeightToNav(levels[i + 1]), p.y(), LinkDirection::Bidirectional, areaType(res));
             }
             m_processedLinks.insert(elem);
         }
@@ -564,7 +562,7 @@ void NavMeshBuilderPrivate::processLink(OSM::Element elem, int floorLevel, LinkD
                 const auto poly = createPolygon(m_data.dataSet(), elem);
                 const auto p1 = m_transform.mapGeoToNav(poly.at(0));
                 const auto p2 = m_transform.mapGeoToNav(poly.at(1));
-                addOffMeshConnection(p1.x(), m_transform.mapHeightToNav(l1), p1.y(), p2.x(), m_transform.mapHeightToNav(l2), p2.y(), linkDir, areaType(res));
+                m_geometry->addOffMeshConnection(p1.x(), m_transform.mapHeightToNav(l1), p1.y(), p2.x(), m_transform.mapHeightToNav(l2), p2.y(), linkDir, areaType(res));
             } else {
                 qCDebug(Log) << "  failed to determin levels for link" << elem.url() <<floorLevel << l1 << l2 << levels;
             }
@@ -623,8 +621,8 @@ void NavMeshBuilderPrivate::extrudeWall(const std::vector<const OSM::Node*> &way
 
         qsizetype offset = m_vertexOffset;
         if (!reuseEdge) {
-            addVertex((float)p1.x(), m_transform.mapHeightToNav(floorLevel), (float)p1.y());
-            addVertex((float)p1.x(), m_transform.mapHeightToNav(floorLevel + 10), (float)p1.y());
+            m_geometry->addVertex((float)p1.x(), m_transform.mapHeightToNav(floorLevel), (float)p1.y());
+            m_geometry->addVertex((float)p1.x(), m_transform.mapHeightToNav(floorLevel + 10), (float)p1.y());
             m_vertexOffset += 2;
             reuseEdge = true;
         } else {
@@ -632,49 +630,15 @@ void NavMeshBuilderPrivate::extrudeWall(const std::vector<const OSM::Node*> &way
             offset -= 2;
         }
 
-        addVertex((float)p2.x(), m_transform.mapHeightToNav(floorLevel), (float)p2.y());
-        addVertex((float)p2.x(), m_transform.mapHeightToNav(floorLevel + 10), (float)p2.y());
+        m_geometry->addVertex((float)p2.x(), m_transform.mapHeightToNav(floorLevel), (float)p2.y());
+        m_geometry->addVertex((float)p2.x(), m_transform.mapHeightToNav(floorLevel + 10), (float)p2.y());
         m_vertexOffset += 2;
 
-        addFace(offset, offset + 2, offset + 1, AreaType::Unwalkable);
-        addFace(offset + 2, offset + 3, offset + 1, AreaType::Unwalkable);
+        m_geometry->addFace(offset, offset + 2, offset + 1, AreaType::Unwalkable);
+        m_geometry->addFace(offset + 2, offset + 3, offset + 1, AreaType::Unwalkable);
     }
 }
 
-void NavMeshBuilderPrivate::addVertex(float x, float y, float z)
-{
-    for (const auto v : {x, y, z}) {
-        m_verts.push_back(v);
-    }
-}
-
-void NavMeshBuilderPrivate::addFace(std::size_t i, std::size_t j, std::size_t k, AreaType areaType)
-{
-    for (const auto v : {i, j, k}) {
-        m_tris.push_back((int)v);
-    }
-    m_triAreaIds.push_back(qToUnderlying(areaType));
-}
-
-void NavMeshBuilderPrivate::addOffMeshConnection(float x1, float y1, float z1, float x2, float y2, float z2, LinkDirection linkDir, AreaType areaType)
-{
-    if (linkDir == LinkDirection::Backward) {
-        std::swap(x1, x2);
-        std::swap(y1, y2);
-        std::swap(z1, z2);
-        linkDir = LinkDirection::Forward;
-    }
-
-    for (const auto v : { x1, y1, z1, x2, y2, z2 }) {
-        m_offMeshCon.verts.push_back(v);
-    }
-    m_offMeshCon.rads.push_back(0.6); // ???
-    m_offMeshCon.flags.push_back(flagsForAreaType(areaType));
-    m_offMeshCon.areas.push_back(qToUnderlying(areaType));
-    m_offMeshCon.dir.push_back(linkDir == LinkDirection::Bidirectional ? 1 : 0);
-    m_offMeshCon.userId.push_back(0); // ???
-}
-
 void NavMeshBuilderPrivate::writeGsetFile()
 {
     QFile f(m_gsetFileName);
@@ -689,11 +653,11 @@ void NavMeshBuilderPrivate::writeGsetFile()
     f.write(QByteArray::number(RECAST_CELL_HEIGHT));
     f.write(" ");
 
-    f.write(QByteArray::number(RECAST_AGENT_HEIGHT));
+    f.write(QByteArray::number(m_agents.front().height));
     f.write(" ");
-    f.write(QByteArray::number(RECAST_AGENT_RADIUS));
+    f.write(QByteArray::number(m_agents.front().radius));
     f.write(" ");
-    f.write(QByteArray::number(RECAST_AGENT_MAX_CLIMB));
+    f.write(QByteArray::number(m_agents.front().maxClimb));
     f.write(" ");
     f.write(QByteArray::number(RECAST_AGENT_MAX_SLOPE));
     f.write(" ");
@@ -733,19 +697,19 @@ void NavMeshBuilderPrivate::writeGsetFile()
 
     f.write("0\n"); // tile size?
 
-    for (int i = 0; i < offMeshCount(); ++i) {
+    for (int i = 0; i < m_geometry->offMeshCount(); ++i) {
         f.write("c ");
         for (int j = 0; j < 6; ++j) {
-            f.write(QByteArray::number(m_offMeshCon.verts[i * 6 + j]));
+            f.write(QByteArray::number(m_geometry->m_offMeshCon.verts[i * 6 + j]));
             f.write(" ");
         }
-        f.write(QByteArray::number(m_offMeshCon.rads[i]));
+        f.write(QByteArray::number(m_geometry->m_offMeshCon.rads[i]));
         f.write(" ");
-        f.write(QByteArray::number(m_offMeshCon.dir[i]));
+        f.write(QByteArray::number(m_geometry->m_offMeshCon.dir[i]));
         f.write(" ");
-        f.write(QByteArray::number(m_offMeshCon.areas[i]));
+        f.write(QByteArray::number(m_geometry->m_offMeshCon.areas[i]));
         f.write(" ");
-        f.write(QByteArray::number(m_offMeshCon.flags[i]));
+        f.write(QByteArray::number(m_geometry->m_offMeshCon.flags[i]));
         f.write("\n");
     }
 }
@@ -755,23 +719,23 @@ void NavMeshBuilderPrivate::writeObjFile()
     QFile f(m_objFileName);
     f.open(QFile::WriteOnly);
 
-    for (std::size_t i = 0; i < m_verts.size(); i += 3) {
+    for (std::size_t i = 0; i < m_geometry->m_verts.size(); i += 3) {
         f.write("v ");
-        f.write(QByteArray::number(m_verts[i]));
+        f.write(QByteArray::number(m_geometry->m_verts[i]));
         f.write(" ");
-        f.write(QByteArray::number(m_verts[i+1]));
+        f.write(QByteArray::number(m_geometry->m_verts[i+1]));
         f.write(" ");
-        f.write(QByteArray::number(m_verts[i+2]));
+        f.write(QByteArray::number(m_geometry->m_verts[i+2]));
         f.write("\n");
     }
 
-    for (std::size_t i = 0; i < m_tris.size(); i += 3) {
+    for (std::size_t i = 0; i < m_geometry->m_tris.size(); i += 3) {
         f.write("f ");
-        f.write(QByteArray::number(m_tris[i] + 1));
+        f.write(QByteArray::number(m_geometry->m_tris[i] + 1));
         f.write(" ");
-        f.write(QByteArray::number(m_tris[i+1] + 1));
+        f.write(QByteArray::number(m_geometry->m_tris[i+1] + 1));
         f.write(" ");
-        f.write(QByteArray::number(m_tris[i+2] + 1));
+        f.write(QByteArray::number(m_geometry->m_tris[i+2] + 1));
         f.write("\n");
     }
 }
@@ -780,242 +744,107 @@ void NavMeshBuilderPrivate::buildNavMesh()
 {
     qCDebug(Log) << QThread::currentThread();
 
-    const auto bmin = m_transform.mapGeoHeightToNav(m_data.boundingBox().min, std::prev(m_data.levelMap().end())->first.numericLevel());
-    const auto bmax = m_transform.mapGeoHeightToNav(m_data.boundingBox().max, m_data.levelMap().begin()->first.numericLevel());
-
-    NavMesh resultData;
-    const auto result = NavMeshPrivate::create(resultData);
-    result->m_transform = m_transform;
-    result->m_updateSignal = QObject::connect(m_equipmentModel, &KOSMIndoorMap::AbstractOverlaySource::update, m_equipmentModel, [result]() {
-        result->m_dirty = true;
-        qCDebug(Log) << "nav mesh invalidated";
-    }, Qt::DirectConnection);
+    std::vector<NavMesh> resultData(m_agents.size());
+    std::vector<NavMeshPrivate*> results;
+    results.reserve(m_agents.size());
+    for (std::size_t i = 0; i < m_agents.size(); ++i) {
+        const auto result = NavMeshPrivate::create(resultData[i]);
+        result->m_transform = m_transform;
+        result->m_agent = m_agents[i];
+        result->m_updateSignal = QObject::connect(m_equipmentModel, &KOSMIndoorMap::AbstractOverlaySource::update, m_equipmentModel, [result]() {
+            result->m_dirty = true;
+            qCDebug(Log) << "nav mesh invalidated";
+        }, Qt::DirectConnection);
+        results.push_back(result);
+    }
 
     // steps as defined in the Recast demo app
 #if HAVE_RECAST
-    // step 1: setup
-    rcContext ctx;
-    int width = 0;
-    int height = 0;
-    rcCalcGridSize(bmin, bmax, RECAST_CELL_SIZE, &width, &height);
-    qCDebug(Log) << width << "x" << height << "cells";
-
-    const auto tileWidth = (width + RECAST_TILE_SIZE - 1) / RECAST_TILE_SIZE;
-    const auto tileHeight = (height + RECAST_TILE_SIZE - 1) / RECAST_TILE_SIZE;
-    qCDebug(Log) << tileWidth << "x" << tileHeight << "tiles";
-
-    // from Sample_TileMesh.cpp of Recast:
-    // Max tiles and max polys affect how the tile IDs are caculated.
-    // There are 22 bits available for identifying a tile and a polygon.
-    const auto tileBits = std::min<int>(std::ceil(std::log2(tileWidth * tileHeight)), 14);
-    const auto polyBits = 22 - tileBits;
-    qCDebug(Log) << "using" << tileBits << "bits for tiles and" << polyBits << "bits for polygons";
-
-    result->m_navMesh.reset(dtAllocNavMesh());
-    {
-        dtNavMeshParams params;
-        rcVcopy(params.orig, bmin);
-        params.tileWidth = RECAST_TILE_SIZE * RECAST_CELL_SIZE;
-        params.tileHeight = RECAST_TILE_SIZE * RECAST_CELL_SIZE;
-        params.maxTiles = (1 << tileBits);
-        params.maxPolys = (1 << polyBits);
-
+    const auto params = m_geometry->navMeshParams();
+    for (auto result : results) {
+        result->m_navMesh.reset(dtAllocNavMesh());
         result->m_navMesh->init(&params);
+        result->m_tileCountX = m_geometry->m_tileWidth;
+        result->m_tileCountY = m_geometry->m_tileHeight;
+
+        if (m_lazyTileBuilding) {
+            // tiles are built on demand by queries, or in the background by buildRemainingTiles()
+            result->m_geometry = m_geometry;
+            result->m_tileStates.resize((std::size_t)(result->m_tileCountX * result->m_tileCountY), NavMeshPrivate::TileState::Missing);
+        }
     }
 
-    for (int tx = 0; tx < tileWidth; ++tx) {
-        for (int ty = 0; ty < tileHeight; ++ty) {
-            if (!buildNavMeshTile(&ctx, tx, ty, result)) {
-                return;
+    if (!m_lazyTileBuilding) {
+        rcContext ctx;
+        std::vector<NavMeshGeometry::TileData> tiles;
+        for (int tx = 0; tx < m_geometry->m_tileWidth; ++tx) {
+            for (int ty = 0; ty < m_geometry->m_tileHeight; ++ty) {
+                if (!m_geometry->buildTiles(&ctx, tx, ty, m_agents, tiles)) {
+                    return;
+                }
+                for (std::size_t i = 0; i < tiles.size(); ++i) {
+                    if (!tiles[i].data) {
+                        continue;
+                    }
+                    auto navMesh = results[i]->m_navMesh.get();
+                    if (dtStatusFailed(navMesh->addTile(tiles[i].data.get(), tiles[i].size, DT_TILE_FREE_DATA, 0, nullptr))) {
+                        qCWarning(Log) << "Failed to add tile to dtNavMesh";
+                        return;
+                    }
+                    (void)tiles[i].data.release(); // managed by navMesh now
+                }
             }
         }
     }
 
-    result->m_navMeshQuery.reset(dtAllocNavMeshQuery());
-    const auto status = result->m_navMeshQuery->init(result->m_navMesh.get(), RECAST_NAV_QUERY_MAX_NODES);
-    if (dtStatusFailed(status)) {
-        qCWarning(Log) << "Failed to init dtNavMeshQuery";
-        return;
+    for (auto result : results) {
+        result->m_navMeshQuery.reset(dtAllocNavMeshQuery());
+        const auto status = result->m_navMeshQuery->init(result->m_navMesh.get(), RECAST_NAV_QUERY_MAX_NODES);
+        if (dtStatusFailed(status)) {
+            qCWarning(Log) << "Failed to init dtNavMeshQuery";
+            return;
+        }
     }
 
-    m_navMesh = std::move(resultData);
+    m_navMeshes = std::move(resultData);
     qCDebug(Log) << "done";
 #endif
 }
 
-bool NavMeshBuilderPrivate::buildNavMeshTile(rcContext *ctx, int tx, int ty, NavMeshPrivate *result)
+void NavMeshBuilderPrivate::buildRemainingTiles()
 {
-    qCDebug(Log) << "  building tile" << tx << ty;
-
-    const auto walkableHeight = (int)std::ceil(RECAST_AGENT_HEIGHT / RECAST_CELL_HEIGHT);
-    const auto walkableClimb = (int)std::floor(RECAST_AGENT_MAX_CLIMB/ RECAST_CELL_HEIGHT);
-    const auto walkableRadius = (int)std::ceil(RECAST_AGENT_RADIUS / RECAST_CELL_SIZE);
-    const auto borderSize = (float)walkableRadius + 3.0f;
-
-    // tile boundaries
-    auto bmin = m_transform.mapGeoHeightToNav(m_data.boundingBox().min, std::prev(m_data.levelMap().end())->first.numericLevel());
-    bmin.x += (float)tx * RECAST_TILE_SIZE * RECAST_CELL_SIZE;
-    bmin.z += (float)ty * RECAST_TILE_SIZE * RECAST_CELL_SIZE;
-
-    auto bmax = m_transform.mapGeoHeightToNav(m_data.boundingBox().max, m_data.levelMap().begin()->first.numericLevel());
-    bmax.x = std::min(bmax.x, bmin.x + RECAST_TILE_SIZE * RECAST_CELL_SIZE);
-    bmax.z = std::min(bmax.z, bmin.z + RECAST_TILE_SIZE * RECAST_CELL_SIZE);
-
-    // expand tile to slightly overlap with neighboring tiles for get things to connect properly
-    bmin.x -= borderSize * RECAST_CELL_SIZE;
-    bmin.z -= borderSize * RECAST_CELL_SIZE;
-    bmax.x += borderSize * RECAST_CELL_SIZE;
-    bmax.z += borderSize * RECAST_CELL_SIZE;
-
 #if HAVE_RECAST
-    // step 1: setup
-    int width = 0;
-    int height = 0;
-    rcCalcGridSize(bmin, bmax, RECAST_CELL_SIZE, &width, &height);
-
-    // step 2: build input polygons
-    rcHeightfieldPtr solid(rcAllocHeightfield());
-    if (!rcCreateHeightfield(ctx, *solid, width, height, bmin, bmax, RECAST_CELL_SIZE, RECAST_CELL_HEIGHT)) {
-        qCWarning(Log) << "Failed to create solid heightfield.";
-        return false;
-    }
-
-    if (!rcRasterizeTriangles(ctx, m_verts.data(), numVerts(), m_tris.data(), m_triAreaIds.data(), numTris(), *solid, walkableClimb)) {
-        qCWarning(Log) << "Failed to rasterize triangles";
-        return false;
-    }
-
-    // step 3: filter walkable sufaces
-
-    rcFilterLowHangingWalkableObstacles(ctx, walkableClimb, *solid);
-    rcFilterLedgeSpans(ctx, walkableHeight, walkableClimb, *solid);
-    rcFilterWalkableLowHeightSpans(ctx, walkableHeight, *solid);
-
-    // step 4: partition surface into regions
-    rcCompactHeightfieldPtr chf(rcAllocCompactHeightfield());
-    if (!rcBuildCompactHeightfield(ctx, walkableHeight, walkableClimb, *solid, *chf)) {
-        qCWarning(Log) << "Failed to build compact height field.";
-        return false;
-    }
-    solid.reset();
-
-    if (!rcErodeWalkableArea(ctx, walkableRadius, *chf)) {
-        qCWarning(Log) << "Failed to erode walkable area";
-        return false;
-    }
-
-    if constexpr (RECAST_PARTITION_TYPE == RecastPartitionType::Monotone) {
-        if (!rcBuildRegionsMonotone(ctx, *chf, (int)borderSize, (int)std::pow(RECAST_REGION_MIN_AREA, 2.0), (int)std::pow(RECAST_REGION_MERGE_AREA, 2.0))) {
-            qCWarning(Log) << "Failed to build monotone regions";
-            return false;
-        }
-    } else if constexpr (RECAST_PARTITION_TYPE == RecastPartitionType::Watershed) {
-        if (!rcBuildDistanceField(ctx, *chf)) {
-            qCWarning(Log) << "Failed to build distance field.";
-            return false;
-        }
-        if (!rcBuildRegions(ctx, *chf, (int)borderSize, (int)std::pow(RECAST_REGION_MIN_AREA, 2.0), (int)std::pow(RECAST_REGION_MERGE_AREA, 2.0))) {
-            qCWarning(Log) << "Failed to build watershed regions.";
-            return false;
+    for (const auto &mesh : m_navMeshes) {
+        const auto meshData = NavMeshPrivate::get(mesh);
+        if (!meshData->m_geometry) {
+            continue;
         }
-    } else {
-        static_assert("partition type not yet implemented");
-    }
-
-    // step 5: create contours
-    rcContourSetPtr cset(rcAllocContourSet());
-    if (!rcBuildContours(ctx, *chf, RECAST_MAX_SIMPLIFICATION_ERROR, RECAST_MAX_EDGE_LEN / RECAST_CELL_SIZE, *cset)) {
-        qCWarning(Log) << "Failed to create contours.";
-        return false;
-    }
 
-    // step 6: create polygon mesh from countours
-    rcPolyMeshPtr pmesh(rcAllocPolyMesh());
-    if (!rcBuildPolyMesh(ctx, *cset, DT_VERTS_PER_POLYGON, *pmesh)) {
-        qCWarning(Log) << "Failed to triangulate contours";
-        return false;
-    }
-    if (pmesh->npolys == 0) {
-        qCDebug(Log) << "skipping empty tile"; // TODO can we do this even earlier?
-        return true;
+        // low priority so this doesn't delay routing jobs, tiles already built on demand are skipped
+        const auto tiles = meshData->allTiles();
+        for (int ty = tiles.top(); ty <= tiles.bottom(); ++ty) {
+            for (int tx = tiles.left(); tx <= tiles.right(); ++tx) {
+                QThreadPool::globalInstance()->start([weakNavMesh = NavMeshPrivate::weakRef(mesh), tx, ty]() {
+                    if (const auto navMesh = weakNavMesh.lock()) {
+                        navMesh->ensureTile(tx, ty);
+                    }
+                }, -1);
+            }
+        }
     }
-
-#if 0
-    QFile f(u"pmesh.obj"_s);
-    f.open(QFile::WriteOnly);
-    RecastDebugIoAdapter adapter(&f);
-    duDumpPolyMeshToObj(*pmesh, &adapter);
 #endif
-
-    // step 7: create detail mesh
-    rcPolyMeshDetailPtr dmesh(rcAllocPolyMeshDetail());
-    if (!rcBuildPolyMeshDetail(ctx, *pmesh, *chf, RECAST_DETAIL_SAMPLE_DIST * RECAST_CELL_SIZE, RECAST_DETAIL_SAMPLE_MAX_ERROR * RECAST_CELL_HEIGHT, *dmesh)) {
-        qCWarning(Log) << "Failed to build detail mesh";
-        return false;
-    }
-    chf.reset();
-    cset.reset();
-
-    // step 8 create detour data
-    uint8_t *navData = nullptr;
-    int navDataSize = 0;
-
-    for (int i = 0; i < pmesh->npolys; ++i) {
-        pmesh->flags[i] = flagsForAreaType(static_cast<AreaType>(pmesh->areas[i]));
-    }
-
-    dtNavMeshCreateParams params;
-    std::memset(&params, 0, sizeof(params));
-    params.verts = pmesh->verts;
-    params.vertCount = pmesh->nverts;
-    params.polys = pmesh->polys;
-    params.polyAreas = pmesh->areas;
-    params.polyFlags = pmesh->flags;
-    params.polyCount = pmesh->npolys;
-    params.nvp = pmesh->nvp;
-    params.detailMeshes = dmesh->meshes;
-    params.detailVerts = dmesh->verts;
-    params.detailVertsCount = dmesh->nverts;
-    params.detailTris = dmesh->tris;
-    params.detailTriCount = dmesh->ntris;
-    params.offMeshConVerts = m_offMeshCon.verts.data();
-    params.offMeshConRad = m_offMeshCon.rads.data();
-    params.offMeshConDir = m_offMeshCon.dir.data();
-    params.offMeshConAreas = m_offMeshCon.areas.data();
-    params.offMeshConFlags = m_offMeshCon.flags.data();
-    params.offMeshConUserID = m_offMeshCon.userId.data();
-    params.offMeshConCount = offMeshCount();
-    params.walkableHeight = RECAST_AGENT_HEIGHT;
-    params.walkableRadius = RECAST_AGENT_RADIUS;
-    params.walkableClimb = RECAST_AGENT_MAX_CLIMB;
-    params.tileX = tx;
-    params.tileY = ty;
-    params.tileLayer = 0;
-    rcVcopy(params.bmin, pmesh->bmin);
-    rcVcopy(params.bmax, pmesh->bmax);
-    params.cs = RECAST_CELL_SIZE;
-    params.ch = RECAST_CELL_HEIGHT;
-    params.buildBvTree = true;
-
-    if (!dtCreateNavMeshData(&params, &navData, &navDataSize)) {
-        qCWarning(Log) << "dtCreateNavMeshData failed"; // TODO error propagation
-        return false;
-    }
-    std::unique_ptr<uint8_t> navDataPtr(navData);
-
-    result->m_navMesh->removeTile(result->m_navMesh->getTileRefAt(tx, ty, 0), {}, nullptr);
-    auto status = result->m_navMesh->addTile(navData, navDataSize, DT_TILE_FREE_DATA, {}, nullptr);
-    if (dtStatusFailed(status)) {
-        qCWarning(Log) << "Failed to add tile to dtNavMesh";
-        return false;
-    }
-
-    (void)navDataPtr.release(); // managed by navMesh now
-#endif
-    return true;
 }
 
 NavMesh NavMeshBuilder::navMesh() const
 {
-    return d->m_navMesh;
+    return d->m_navMeshes.empty() ? NavMesh() : d->m_navMeshes.front();
+}
+
+NavMesh NavMeshBuilder::navMesh(const AgentProfile &agent) const
+{
+    const auto it = std::find(d->m_agents.begin(), d->m_agents.end(), agent);
+    if (it == d->m_agents.end() || d->m_navMeshes.size() != d->m_agents.size()) {
+        return {};
+    }
+    return d->m_navMeshes[std::distance(d->m_agents.begin(), it)];
 }
@@ -11,6 +11,7 @@
 #include <QObject>
 
 #include <memory>
+#include <vector>
 
 namespace KOSMIndoorMap {
 class AbstractOverlaySource;
@@ -19,6 +20,7 @@ class MapData;
 
 namespace KOSMIndoorRouting {
 
+class AgentProfile;
 class NavMesh;
 class NavMeshBuilderPrivate;
 
@@ -33,11 +35,30 @@ public:
     void setMapData(const KOSMIndoorMap::MapData &mapData);
     void setEquipmentModel(KOSMIndoorMap::AbstractOverlaySource *equipmentModel);
 
+    /** Agents to build nav meshes for, one nav mesh per agent.
+     *  Geometry extraction is shared between all agents, rasterization between agents that
+     *  only differ in height, so this is cheaper than building each one separately.
+     *  Results are the same as with separate builds.
+     *  Default is a single AgentProfile with default values.
+     */
+    void setAgentProfiles(const std::vector<AgentProfile> &agents);
+
+    /** Build nav mesh tiles on demand.
+     *  When enabled, finished() is emitted before any tile is built. Routing and isochrone
+     *  queries then build the tiles they need themselves, starting around the start and end
+     *  positions, while the remaining tiles are built by low priority background tasks.
+     *  Results are the same as with the default eager build.
+     */
+    void setLazyTileBuilding(bool lazy);
+
     void writeDebugNavMesh(const QString &gsetFile, const QString &objFile);
 
     void start();
 
+    /** Nav mesh for the first agent profile. */
     [[nodiscard]] NavMesh navMesh() const;
+    /** Nav mesh for @p agent, which has to be one of the profiles passed to setAgentProfiles(). */
+    [[nodiscard]] NavMesh navMesh(const AgentProfile &agent) const;
 
 Q_SIGNALS:
     void finished();
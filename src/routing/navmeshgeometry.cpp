@@ -0,0 +1,324 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "navmeshgeometry_p.h"
+#include "recastnavsettings_p.h"
+#include <logging.h>
+
+#if HAVE_RECAST
+#include <DetourNavMeshBuilder.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+using namespace KOSMIndoorRouting;
+
+void NavMeshGeometry::addVertex(float x, float y, float z)
+{
+    for (const auto v : {x, y, z}) {
+        m_verts.push_back(v);
+    }
+}
+
+void NavMeshGeometry::addFace(std::size_t i, std::size_t j, std::size_t k, AreaType areaType)
+{
+    for (const auto v : {i, j, k}) {
+        m_tris.push_back((int)v);
+    }
+    m_triAreaIds.push_back(qToUnderlying(areaType));
+}
+
+void NavMeshGeometry::addOffMeshConnection(float x1, float y1, float z1, float x2, float y2, float z2, LinkDirection linkDir, AreaType areaType)
+{
+    if (linkDir == LinkDirection::Backward) {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+        std::swap(z1, z2);
+        linkDir = LinkDirection::Forward;
+    }
+
+    for (const auto v : { x1, y1, z1, x2, y2, z2 }) {
+        m_offMeshCon.verts.push_back(v);
+    }
+    m_offMeshCon.rads.push_back(0.6); // ???
+    m_offMeshCon.flags.push_back(flagsForAreaType(areaType));
+    m_offMeshCon.areas.push_back(qToUnderlying(areaType));
+    m_offMeshCon.dir.push_back(linkDir == LinkDirection::Bidirectional ? 1 : 0);
+    m_offMeshCon.userId.push_back(0); // ???
+}
+
+void NavMeshGeometry::setBounds(rcVec3 bmin, rcVec3 bmax)
+{
+    m_bmin = bmin;
+    m_bmax = bmax;
+
+#if HAVE_RECAST
+    int width = 0;
+    int height = 0;
+    rcCalcGridSize(m_bmin, m_bmax, RECAST_CELL_SIZE, &width, &height);
+    qCDebug(Log) << width << "x" << height << "cells";
+
+    m_tileWidth = (width + RECAST_TILE_SIZE - 1) / RECAST_TILE_SIZE;
+    m_tileHeight = (height + RECAST_TILE_SIZE - 1) / RECAST_TILE_SIZE;
+    qCDebug(Log) << m_tileWidth << "x" << m_tileHeight << "tiles";
+
+    // from Sample_TileMesh.cpp of Recast:
+    // Max tiles and max polys affect how the tile IDs are caculated.
+    // There are 22 bits available for identifying a tile and a polygon.
+    m_tileBits = std::min<int>(std::ceil(std::log2(m_tileWidth * m_tileHeight)), 14);
+    m_polyBits = 22 - m_tileBits;
+    qCDebug(Log) << "using" << m_tileBits << "bits for tiles and" << m_polyBits << "bits for polygons";
+#endif
+}
+
+#if HAVE_RECAST
+dtNavMeshParams NavMeshGeometry::navMeshParams() const
+{
+    dtNavMeshParams params;
+    rcVcopy(params.orig, m_bmin);
+    params.tileWidth = RECAST_TILE_SIZE * RECAST_CELL_SIZE;
+    params.tileHeight = RECAST_TILE_SIZE * RECAST_CELL_SIZE;
+    params.maxTiles = (1 << m_tileBits);
+    params.maxPolys = (1 << m_polyBits);
+    return params;
+}
+
+bool NavMeshGeometry::buildTiles(rcContext *ctx, int tx, int ty, const std::vector<AgentProfile> &agents, std::vector<TileData> &tiles) const
+{
+    qCDebug(Log) << "  building tile" << tx << ty << "for" << agents.size() << "agents";
+    tiles.clear();
+    tiles.resize(agents.size());
+
+    // the climb affects merging of walkable flags of close spans during rasterization, so the heightfield can
+    // only be shared between agents with the same climb. Span contents of a cell don't depend on the heightfield
+    // bounds though, so agents with a smaller border get a cropped copy of the heightfield with the largest border.
+    std::vector<bool> done(agents.size(), false);
+    std::vector<std::size_t> group;
+    for (std::size_t groupIdx = 0; groupIdx < agents.size(); ++groupIdx) {
+        if (done[groupIdx]) {
+            continue;
+        }
+        const auto walkableClimb = (int)std::floor(agents[groupIdx].maxClimb / RECAST_CELL_HEIGHT);
+        group.clear();
+        for (auto agentIdx = groupIdx; agentIdx < agents.size(); ++agentIdx) {
+            if (!done[agentIdx] && (int)std::floor(agents[agentIdx].maxClimb / RECAST_CELL_HEIGHT) == walkableClimb) {
+                group.push_back(agentIdx);
+                done[agentIdx] = true;
+            }
+        }
+
+        // the agent with the largest border comes last, it can use the heightfield directly
+        std::stable_sort(group.begin(), group.end(), [&agents](auto lhs, auto rhs) {
+            return borderSize(agents[lhs]) < borderSize(agents[rhs]);
+        });
+        const auto maxBorderSize = borderSize(agents[group.back()]);
+
+        // tile boundaries
+        auto bmin = m_bmin;
+        bmin.x += (float)tx * RECAST_TILE_SIZE * RECAST_CELL_SIZE;
+        bmin.z += (float)ty * RECAST_TILE_SIZE * RECAST_CELL_SIZE;
+
+        auto bmax = m_bmax;
+        bmax.x = std::min(bmax.x, bmin.x + RECAST_TILE_SIZE * RECAST_CELL_SIZE);
+        bmax.z = std::min(bmax.z, bmin.z + RECAST_TILE_SIZE * RECAST_CELL_SIZE);
+
+        // expand tile to slightly overlap with neighboring tiles for get things to connect properly
+        bmin.x -= (float)maxBorderSize * RECAST_CELL_SIZE;
+        bmin.z -= (float)maxBorderSize * RECAST_CELL_SIZE;
+        bmax.x += (float)maxBorderSize * RECAST_CELL_SIZE;
+        bmax.z += (float)maxBorderSize * RECAST_CELL_SIZE;
+
+        // step 1: setup
+        int width = 0;
+        int height = 0;
+        rcCalcGridSize(bmin, bmax, RECAST_CELL_SIZE, &width, &height);
+
+        // step 2: build input polygons
+        rcHeightfieldPtr solid(rcAllocHeightfield());
+        if (!rcCreateHeightfield(ctx, *solid, width, height, bmin, bmax, RECAST_CELL_SIZE, RECAST_CELL_HEIGHT)) {
+            qCWarning(Log) << "Failed to create solid heightfield.";
+            return false;
+        }
+
+        if (!rcRasterizeTriangles(ctx, m_verts.data(), numVerts(), m_tris.data(), m_triAreaIds.data(), numTris(), *solid, walkableClimb)) {
+            qCWarning(Log) << "Failed to rasterize triangles";
+            return false;
+        }
+
+        // the agent-specific filters below change span area ids, so all but the last agent work on a copy
+        for (auto it = group.begin(); it != std::prev(group.end()); ++it) {
+            rcHeightfieldPtr copy(rcAllocHeightfield());
+            if (!cropHeightfield(ctx, *solid, maxBorderSize - borderSize(agents[*it]), *copy)
+             || !buildAgentTile(ctx, tx, ty, agents[*it], *copy, tiles[*it])) {
+                return false;
+            }
+        }
+        if (!buildAgentTile(ctx, tx, ty, agents[group.back()], *solid, tiles[group.back()])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int NavMeshGeometry::borderSize(const AgentProfile &agent)
+{
+    return (int)std::ceil(agent.radius / RECAST_CELL_SIZE) + 3;
+}
+
+bool NavMeshGeometry::cropHeightfield(rcContext *ctx, const rcHeightfield &src, int inset, rcHeightfield &dst)
+{
+    const auto width = src.width - 2 * inset;
+    const auto height = src.height - 2 * inset;
+    const rcVec3 bmin{ src.bmin[0] + (float)inset * src.cs, src.bmin[1], src.bmin[2] + (float)inset * src.cs };
+    const rcVec3 bmax{ src.bmax[0] - (float)inset * src.cs, src.bmax[1], src.bmax[2] - (float)inset * src.cs };
+    if (!rcCreateHeightfield(ctx, dst, width, height, bmin, bmax, src.cs, src.ch)) {
+        qCWarning(Log) << "Failed to create cropped heightfield.";
+        return false;
+    }
+
+    // spans of a cell never overlap or touch, so adding them in order doesn't merge anything
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            for (auto span = src.spans[(x + inset) + (y + inset) * src.width]; span; span = span->next) {
+                if (!rcAddSpan(ctx, dst, x, y, span->smin, span->smax, span->area, 0)) {
+                    qCWarning(Log) << "Failed to copy heightfield span.";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool NavMeshGeometry::buildAgentTile(rcContext *ctx, int tx, int ty, const AgentProfile &agent, rcHeightfield &solid, TileData &tile) const
+{
+    const auto border = borderSize(agent);
+    const auto walkableHeight = (int)std::ceil(agent.height / RECAST_CELL_HEIGHT);
+    const auto walkableClimb = (int)std::floor(agent.maxClimb / RECAST_CELL_HEIGHT);
+    const auto walkableRadius = (int)std::ceil(agent.radius / RECAST_CELL_SIZE);
+
+    // step 3: filter walkable sufaces
+    rcFilterLowHangingWalkableObstacles(ctx, walkableClimb, solid);
+    rcFilterLedgeSpans(ctx, walkableHeight, walkableClimb, solid);
+    rcFilterWalkableLowHeightSpans(ctx, walkableHeight, solid);
+
+    rcCompactHeightfieldPtr chf(rcAllocCompactHeightfield());
+    if (!rcBuildCompactHeightfield(ctx, walkableHeight, walkableClimb, solid, *chf)) {
+        qCWarning(Log) << "Failed to build compact height field.";
+        return false;
+    }
+
+    // step 4: partition surface into regions
+    if (!rcErodeWalkableArea(ctx, walkableRadius, *chf)) {
+        qCWarning(Log) << "Failed to erode walkable area";
+        return false;
+    }
+
+    if constexpr (RECAST_PARTITION_TYPE == RecastPartitionType::Monotone) {
+        if (!rcBuildRegionsMonotone(ctx, *chf, border, (int)std::pow(RECAST_REGION_MIN_AREA, 2.0), (int)std::pow(RECAST_REGION_MERGE_AREA, 2.0))) {
+            qCWarning(Log) << "Failed to build monotone regions";
+            return false;
+        }
+    } else if constexpr (RECAST_PARTITION_TYPE == RecastPartitionType::Watershed) {
+        if (!rcBuildDistanceField(ctx, *chf)) {
+            qCWarning(Log) << "Failed to build distance field.";
+            return false;
+        }
+        if (!rcBuildRegions(ctx, *chf, border, (int)std::pow(RECAST_REGION_MIN_AREA, 2.0), (int)std::pow(RECAST_REGION_MERGE_AREA, 2.0))) {
+            qCWarning(Log) << "Failed to build watershed regions.";
+            return false;
+        }
+    } else {
+        static_assert("partition type not yet implemented");
+    }
+
+    // step 5: create contours
+    rcContourSetPtr cset(rcAllocContourSet());
+    if (!rcBuildContours(ctx, *chf, RECAST_MAX_SIMPLIFICATION_ERROR, RECAST_MAX_EDGE_LEN / RECAST_CELL_SIZE, *cset)) {
+        qCWarning(Log) << "Failed to create contours.";
+        return false;
+    }
+
+    // step 6: create polygon mesh from countours
+    rcPolyMeshPtr pmesh(rcAllocPolyMesh());
+    if (!rcBuildPolyMesh(ctx, *cset, DT_VERTS_PER_POLYGON, *pmesh)) {
+        qCWarning(Log) << "Failed to triangulate contours";
+        return false;
+    }
+    if (pmesh->npolys == 0) {
+        qCDebug(Log) << "skipping empty tile"; // TODO can we do this even earlier?
+        return true;
+    }
+
+#if 0
+    QFile f(u"pmesh.obj"_s);
+    f.open(QFile::WriteOnly);
+    RecastDebugIoAdapter adapter(&f);
+    duDumpPolyMeshToObj(*pmesh, &adapter);
+#endif
+
+    // step 7: create detail mesh
+    rcPolyMeshDetailPtr dmesh(rcAllocPolyMeshDetail());
+    if (!rcBuildPolyMeshDetail(ctx, *pmesh, *chf, RECAST_DETAIL_SAMPLE_DIST * RECAST_CELL_SIZE, RECAST_DETAIL_SAMPLE_MAX_ERROR * RECAST_CELL_HEIGHT, *dmesh)) {
+        qCWarning(Log) << "Failed to build detail mesh";
+        return false;
+    }
+    chf.reset();
+    cset.reset();
+
+    // step 8 create detour data
+    uint8_t *navData = nullptr;
+    int navDataSize = 0;
+
+    for (int i = 0; i < pmesh->npolys; ++i) {
+        pmesh->flags[i] = flagsForAreaType(static_cast<AreaType>(pmesh->areas[i]));
+    }
+
+    dtNavMeshCreateParams params;
+    std::memset(&params, 0, sizeof(params));
+    params.verts = pmesh->verts;
+    params.vertCount = pmesh->nverts;
+    params.polys = pmesh->polys;
+    params.polyAreas = pmesh->areas;
+    params.polyFlags = pmesh->flags;
+    params.polyCount = pmesh->npolys;
+    params.nvp = pmesh->nvp;
+    params.detailMeshes = dmesh->meshes;
+    params.detailVerts = dmesh->verts;
+    params.detailVertsCount = dmesh->nverts;
+    params.detailTris = dmesh->tris;
+    params.detailTriCount = dmesh->ntris;
+    params.offMeshConVerts = m_offMeshCon.verts.data();
+    params.offMeshConRad = m_offMeshCon.rads.data();
+    params.offMeshConDir = m_offMeshCon.dir.data();
+    params.offMeshConAreas = m_offMeshCon.areas.data();
+    params.offMeshConFlags = m_offMeshCon.flags.data();
+    params.offMeshConUserID = m_offMeshCon.userId.data();
+    params.offMeshConCount = offMeshCount();
+    params.walkableHeight = agent.height;
+    params.walkableRadius = agent.radius;
+    params.walkableClimb = agent.maxClimb;
+    params.tileX = tx;
+    params.tileY = ty;
+    params.tileLayer = 0;
+    rcVcopy(params.bmin, pmesh->bmin);
+    rcVcopy(params.bmax, pmesh->bmax);
+    params.cs = RECAST_CELL_SIZE;
+    params.ch = RECAST_CELL_HEIGHT;
+    params.buildBvTree = true;
+
+    if (!dtCreateNavMeshData(&params, &navData, &navDataSize)) {
+        qCWarning(Log) << "dtCreateNavMeshData failed"; // TODO error propagation
+        return false;
+    }
+    tile.data.reset(navData);
+    tile.size = navDataSize;
+    return true;
+}
+#endif
+
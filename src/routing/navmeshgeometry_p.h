@@ -0,0 +1,94 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORROUTING_NAVMESHGEOMETRY_P_H
+#define KOSMINDOORROUTING_NAVMESHGEOMETRY_P_H
+
+#include "agentprofile.h"
+#include "navmeshtransform.h"
+#include "recastnav_p.h"
+#include "routingarea.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class rcContext;
+struct rcHeightfield;
+
+namespace KOSMIndoorRouting {
+
+enum class LinkDirection { Forward, Backward, Bidirectional };
+
+/** Input geometry for building nav mesh tiles.
+ *  This is produced by NavMeshBuilder in the main thread, and is immutable afterwards,
+ *  so it can be shared with tile building in other threads.
+ */
+class NavMeshGeometry
+{
+public:
+    void addVertex(float x, float y, float z);
+    void addFace(std::size_t i, std::size_t j, std::size_t k, AreaType areaType);
+    void addOffMeshConnection(float x1, float y1, float z1, float x2, float y2, float z2, LinkDirection linkDir, AreaType areaType);
+
+    /** Set nav mesh bounds, and compute the tile layout from that. */
+    void setBounds(rcVec3 bmin, rcVec3 bmax);
+
+    // triangle data
+    std::vector<float> m_verts;
+    [[nodiscard]] inline int numVerts() const { return (int)m_verts.size() / 3; }
+    std::vector<int> m_tris;
+    [[nodiscard]] inline int numTris() const { return (int)m_tris.size() / 3; }
+    std::vector<uint8_t> m_triAreaIds;
+
+    // off mesh connection data
+    struct {
+        std::vector<float> verts;
+        std::vector<float> rads;
+        std::vector<uint16_t> flags;
+        std::vector<uint8_t> areas;
+        std::vector<uint8_t> dir;
+        std::vector<uint32_t> userId;
+    } m_offMeshCon;
+    [[nodiscard]] inline int offMeshCount() const { return (int) m_offMeshCon.rads.size(); }
+
+    // nav mesh bounds and tile layout
+    rcVec3 m_bmin;
+    rcVec3 m_bmax;
+    int m_tileWidth = 0;
+    int m_tileHeight = 0;
+    int m_tileBits = 0;
+    int m_polyBits = 0;
+
+#if HAVE_RECAST
+    struct TileDataDeleter {
+        inline void operator()(uint8_t *data) const { dtFree(data); }
+    };
+    /** Detour tile data, empty for tiles without any polygons. */
+    struct TileData {
+        std::unique_ptr<uint8_t, TileDataDeleter> data;
+        int size = 0;
+    };
+
+    /** Parameters for dtNavMesh::init(). */
+    [[nodiscard]] dtNavMeshParams navMeshParams() const;
+    /** Build the nav mesh data for tile @p tx, @p ty for each of @p agents.
+     *  Rasterization is done only once per climb. Agents with the same climb but
+     *  a smaller radius use a cropped copy of the heightfield of the largest radius.
+     */
+    [[nodiscard]] bool buildTiles(rcContext *ctx, int tx, int ty, const std::vector<AgentProfile> &agents, std::vector<TileData> &tiles) const;
+
+private:
+    /** Tile border in cells needed for @p agent. */
+    [[nodiscard]] static int borderSize(const AgentProfile &agent);
+    /** Copy @p src into @p dst, without the outer @p inset cells. */
+    [[nodiscard]] static bool cropHeightfield(rcContext *ctx, const rcHeightfield &src, int inset, rcHeightfield &dst);
+    [[nodiscard]] bool buildAgentTile(rcContext *ctx, int tx, int ty, const AgentProfile &agent, rcHeightfield &solid, TileData &tile) const;
+#endif
+};
+
+}
+
+#endif
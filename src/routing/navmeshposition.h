@@ -0,0 +1,26 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORROUTING_NAVMESHPOSITION_H
+#define KOSMINDOORROUTING_NAVMESHPOSITION_H
+
+#include <KOSM/Datatypes>
+
+namespace KOSMIndoorRouting {
+
+/** A geographic position on a specific floor level.
+ *  @see NavMesh::snap()
+ */
+class NavMeshPosition {
+public:
+    OSM::Coordinate coordinate;
+    int floorLevel = 0;
+
+    [[nodiscard]] constexpr inline bool isValid() const { return coordinate.isValid(); }
+};
+
+}
+
+#endif
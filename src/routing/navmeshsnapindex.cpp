@@ -0,0 +1,182 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "navmeshsnapindex_p.h"
+
+#if HAVE_RECAST
+#include <DetourCommon.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace KOSMIndoorRouting;
+
+#if HAVE_RECAST
+// in meter, polygons are typically a few meters in size
+constexpr inline float SNAP_INDEX_CELL_SIZE = 4.0f;
+
+void NavMeshSnapIndex::build(const dtNavMesh *navMesh, const NavMeshTransform &transform)
+{
+    clear();
+    m_navMesh = navMesh;
+
+    for (int i = 0; i < navMesh->getMaxTiles(); ++i) {
+        const auto tile = navMesh->getTile(i);
+        if (!tile || !tile->header) {
+            continue;
+        }
+        const auto base = navMesh->getPolyRefBase(tile);
+        for (int j = 0; j < tile->header->polyCount; ++j) {
+            const auto &poly = tile->polys[j];
+            if (poly.getType() == DT_POLYTYPE_OFFMESH_CONNECTION || poly.vertCount == 0) {
+                continue;
+            }
+
+            Entry entry{ base | (dtPolyRef)j, std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+            auto minY = std::numeric_limits<float>::max();
+            auto maxY = std::numeric_limits<float>::lowest();
+            for (int k = 0; k < poly.vertCount; ++k) {
+                const auto v = &tile->verts[poly.verts[k] * 3];
+                entry.minX = std::min(entry.minX, v[0]);
+                entry.maxX = std::max(entry.maxX, v[0]);
+                minY = std::min(minY, v[1]);
+                maxY = std::max(maxY, v[1]);
+                entry.minZ = std::min(entry.minZ, v[2]);
+                entry.maxZ = std::max(entry.maxZ, v[2]);
+            }
+
+            // polygons connecting floors (stairs, ramps) are reachable from both ends
+            const auto minLevel = transform.mapNavHeightToFloorLevel(minY);
+            const auto maxLevel = transform.mapNavHeightToFloorLevel(maxY);
+            m_floors[minLevel].entries.push_back(entry);
+            if (maxLevel != minLevel) {
+                m_floors[maxLevel].entries.push_back(entry);
+            }
+        }
+    }
+
+    for (auto &[level, floor] : m_floors) {
+        buildCells(floor);
+    }
+}
+
+void NavMeshSnapIndex::buildCells(FloorIndex &floor)
+{
+    floor.originX = std::numeric_limits<float>::max();
+    floor.originZ = std::numeric_limits<float>::max();
+    auto maxX = std::numeric_limits<float>::lowest();
+    auto maxZ = std::numeric_limits<float>::lowest();
+    for (const auto &entry : floor.entries) {
+        floor.originX = std::min(floor.originX, entry.minX);
+        floor.originZ = std::min(floor.originZ, entry.minZ);
+        maxX = std::max(maxX, entry.maxX);
+        maxZ = std::max(maxZ, entry.maxZ);
+    }
+    floor.width = (int)((maxX - floor.originX) / SNAP_INDEX_CELL_SIZE) + 1;
+    floor.height = (int)((maxZ - floor.originZ) / SNAP_INDEX_CELL_SIZE) + 1;
+
+    // counting sort of the entries into all cells they overlap
+    const auto forEachCell = [&floor](const Entry &entry, auto &&func) {
+        const auto x0 = (int)((entry.minX - floor.originX) / SNAP_INDEX_CELL_SIZE);
+        const auto x1 = (int)((entry.maxX - floor.originX) / SNAP_INDEX_CELL_SIZE);
+        const auto z0 = (int)((entry.minZ - floor.originZ) / SNAP_INDEX_CELL_SIZE);
+        const auto z1 = (int)((entry.maxZ - floor.originZ) / SNAP_INDEX_CELL_SIZE);
+        for (int z = z0; z <= z1; ++z) {
+            for (int x = x0; x <= x1; ++x) {
+                func(z * floor.width + x);
+            }
+        }
+    };
+
+    floor.cellOffsets.assign((std::size_t)(floor.width * floor.height) + 1, 0);
+    for (const auto &entry : floor.entries) {
+        forEachCell(entry, [&floor](int cell) { ++floor.cellOffsets[cell + 1]; });
+    }
+    for (std::size_t i = 1; i < floor.cellOffsets.size(); ++i) {
+        floor.cellOffsets[i] += floor.cellOffsets[i - 1];
+    }
+    floor.cellEntries.resize(floor.cellOffsets.back());
+    auto fill = floor.cellOffsets;
+    for (uint32_t i = 0; i < (uint32_t)floor.entries.size(); ++i) {
+        forEachCell(floor.entries[i], [&floor, &fill, i](int cell) { floor.cellEntries[fill[cell]++] = i; });
+    }
+}
+
+void NavMeshSnapIndex::clear()
+{
+    m_floors.clear();
+}
+
+bool NavMeshSnapIndex::snap(const dtNavMeshQuery *query, const dtQueryFilter &filter, const rcVec3 &pos, int floorLevel, float maxDistance, rcVec3 &result) const
+{
+    const auto it = m_floors.find(floorLevel);
+    if (it == m_floors.end()) {
+        return false;
+    }
+    const auto &floor = (*it).second;
+
+    const auto cx = (int)std::floor((pos.x - floor.originX) / SNAP_INDEX_CELL_SIZE);
+    const auto cz = (int)std::floor((pos.z - floor.originZ) / SNAP_INDEX_CELL_SIZE);
+    auto bestDistSqr = maxDistance * maxDistance;
+    bool found = false;
+
+    const auto searchCell = [&](int x, int z) {
+        if (x < 0 || z < 0 || x >= floor.width || z >= floor.height) {
+            return;
+        }
+        const auto cell = z * floor.width + x;
+        for (auto i = floor.cellOffsets[cell]; i < floor.cellOffsets[cell + 1]; ++i) {
+            const auto &entry = floor.entries[floor.cellEntries[i]];
+            const auto dx = std::max({ entry.minX - pos.x, 0.0f, pos.x - entry.maxX });
+            const auto dz = std::max({ entry.minZ - pos.z, 0.0f, pos.z - entry.maxZ });
+            if (dx * dx + dz * dz > bestDistSqr) {
+                continue;
+            }
+            const dtMeshTile *tile = nullptr;
+            const dtPoly *poly = nullptr;
+            m_navMesh->getTileAndPolyByRefUnsafe(entry.ref, &tile, &poly);
+            if (!filter.passFilter(entry.ref, tile, poly)) {
+                continue;
+            }
+            rcVec3 closest;
+            if (dtStatusFailed(query->closestPointOnPoly(entry.ref, pos, closest, nullptr))) {
+                continue;
+            }
+            const auto distSqr = dtVdist2DSqr(pos, closest);
+            if (distSqr <= bestDistSqr) {
+                bestDistSqr = distSqr;
+                result = closest;
+                found = true;
+            }
+        }
+    };
+
+    // search ring by ring, until nothing in the next ring can be closer anymore
+    for (int r = 0;; ++r) {
+        const auto ringDist = (float)(r - 1) * SNAP_INDEX_CELL_SIZE;
+        if (r > 0 && ringDist * ringDist > bestDistSqr) {
+            break;
+        }
+        if (cx - r < 0 && cz - r < 0 && cx + r >= floor.width && cz + r >= floor.height) {
+            break;
+        }
+        if (r == 0) {
+            searchCell(cx, cz);
+            continue;
+        }
+        for (int x = cx - r; x <= cx + r; ++x) {
+            searchCell(x, cz - r);
+            searchCell(x, cz + r);
+        }
+        for (int z = cz - r + 1; z < cz + r; ++z) {
+            searchCell(cx - r, z);
+            searchCell(cx + r, z);
+        }
+    }
+    return found;
+}
+#endif
@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORROUTING_NAVMESHSNAPINDEX_P_H
+#define KOSMINDOORROUTING_NAVMESHSNAPINDEX_P_H
+
+#include "navmeshtransform.h"
+#include "recastnav_p.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace KOSMIndoorRouting {
+
+#if HAVE_RECAST
+/** Per-floor uniform grid over all walkable nav mesh polygons.
+ *  Used for snapping arbitrary positions to the closest walkable point, searching
+ *  outwards ring by ring, which unlike dtNavMeshQuery::findNearestPoly doesn't need
+ *  a fixed search extent.
+ */
+class NavMeshSnapIndex
+{
+public:
+    void build(const dtNavMesh *navMesh, const NavMeshTransform &transform);
+    void clear();
+    [[nodiscard]] inline bool isEmpty() const { return m_floors.empty(); }
+
+    /** Closest walkable point to @p pos on @p floorLevel, if there is one within @p maxDistance.
+     *  Polygons not passing @p filter are ignored.
+     */
+    [[nodiscard]] bool snap(const dtNavMeshQuery *query, const dtQueryFilter &filter, const rcVec3 &pos, int floorLevel, float maxDistance, rcVec3 &result) const;
+
+private:
+    struct Entry {
+        dtPolyRef ref;
+        float minX;
+        float minZ;
+        float maxX;
+        float maxZ;
+    };
+    struct FloorIndex {
+        float originX = 0.0f;
+        float originZ = 0.0f;
+        int width = 0;
+        int height = 0;
+        std::vector<Entry> entries;
+        // entries per cell, cellOffsets[i] to cellOffsets[i + 1] in cellEntries
+        std::vector<uint32_t> cellOffsets;
+        std::vector<uint32_t> cellEntries;
+    };
+    static void buildCells(FloorIndex &floor);
+
+    const dtNavMesh *m_navMesh = nullptr;
+    std::unordered_map<int, FloorIndex> m_floors;
+};
+#endif
+
+}
+
+#endif
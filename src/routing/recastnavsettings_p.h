@@ -11,9 +11,7 @@ namespace KOSMIndoorRouting {
 constexpr inline float RECAST_CELL_SIZE = 0.2f;
 constexpr inline float RECAST_CELL_HEIGHT = 0.2f;
 
-constexpr inline float RECAST_AGENT_HEIGHT = 2.0f;
-constexpr inline float RECAST_AGENT_RADIUS = 0.2f;
-constexpr inline float RECAST_AGENT_MAX_CLIMB = 0.9f;
+// agent height, radius and max climb are set per nav mesh, see AgentProfile
 constexpr inline float RECAST_AGENT_MAX_SLOPE = 75.0f;
 
 constexpr inline int RECAST_REGION_MIN_AREA = 8;
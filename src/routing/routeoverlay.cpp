@@ -6,13 +6,20 @@
 #include "routeoverlay.h"
 
 using namespace KOSMIndoorRouting;
+using KOSMIndoorMap::OverlayReclaimer;
 
 RouteOverlay::RouteOverlay(QObject *parent)
     : KOSMIndoorMap::AbstractOverlaySource(parent)
 {
 }
 
-RouteOverlay::~RouteOverlay() = default;
+RouteOverlay::~RouteOverlay()
+{
+    OverlayReclaimer::retire(m_startEpoch, std::move(m_startNode));
+    OverlayReclaimer::retire(m_endEpoch, std::move(m_endNode));
+    OverlayReclaimer::retire(m_routeEpoch, std::move(m_routeWays));
+    OverlayReclaimer::retire(m_routeEpoch, std::move(m_transientNodes));
+}
 
 void RouteOverlay::setMapData(const KOSMIndoorMap::MapData &mapData)
 {
@@ -27,10 +34,9 @@ void RouteOverlay::setMapData(const KOSMIndoorMap::MapData &mapData)
 
 void RouteOverlay::setStart(OSM::Coordinate c, int floorLevel)
 {
-    if (m_startNode) {
-        m_gc.push_back(std::move(m_startNode));
-    }
+    OverlayReclaimer::retire(m_startEpoch, std::move(m_startNode));
     if (c.isValid()) {
+        m_startEpoch = OverlayReclaimer::currentEpoch();
         m_startNode = OSM::UniqueElement(new OSM::Node);
         m_startNode.setId(m_data.dataSet().nextInternalId());
         m_startNode.node()->coordinate = c;
@@ -42,10 +48,9 @@ void RouteOverlay::setStart(OSM::Coordinate c, int floorLevel)
 
 void RouteOverlay::setEnd(OSM::Coordinate c, int floorLevel)
 {
-    if (m_endNode) {
-        m_gc.push_back(std::move(m_endNode));
-    }
+    OverlayReclaimer::retire(m_endEpoch, std::move(m_endNode));
     if (c.isValid()) {
+        m_endEpoch = OverlayReclaimer::currentEpoch();
         m_endNode = OSM::UniqueElement(new OSM::Node);
         m_endNode.setId(m_data.dataSet().nextInternalId());
         m_endNode.node()->coordinate = c;
@@ -57,14 +62,14 @@ void RouteOverlay::setEnd(OSM::Coordinate c, int floorLevel)
 
 void RouteOverlay::setRoute(const Route &route)
 {
-    for (auto &way : m_routeWays) {
-        m_gc.push_back(std::move(way));
-    }
+    OverlayReclaimer::retire(m_routeEpoch, std::move(m_routeWays));
+    OverlayReclaimer::retire(m_routeEpoch, std::move(m_transientNodes));
     m_routeWays.clear();
     m_routeWayFloorLevels.clear();
-    m_transientNodesGC.push_back(std::move(m_transientNodes));
+    m_transientNodes.clear();
 
     m_route = route;
+    m_routeEpoch = OverlayReclaimer::currentEpoch();
     if (m_route.steps().size() < 2) {
         Q_EMIT update();
         return;
@@ -131,12 +136,6 @@ void RouteOverlay::forEach(int floorLevel, const std::function<void(OSM::Element
     }
 }
 
-void RouteOverlay::endSwap()
-{
-    m_gc.clear();
-    m_transientNodesGC.clear();
-}
-
 const std::vector<OSM::Node>* RouteOverlay::transientNodes() const
 {
     return &m_transientNodes;
@@ -10,6 +10,7 @@
 #include "route.h"
 
 #include <KOSMIndoorMap/MapData>
+#include <KOSMIndoorMap/OverlayReclaimer>
 #include <KOSMIndoorMap/OverlaySource>
 
 namespace KOSMIndoorRouting {
@@ -28,7 +29,6 @@ public:
     void setRoute(const Route &route);
 
     void forEach(int floorLevel, const std::function<void(OSM::Element, int)> &func) const override;
-    void endSwap() override;
     [[nodiscard]] const std::vector<OSM::Node>* transientNodes() const override;
 
 private:
@@ -45,8 +45,10 @@ private:
     int m_endLevel = 0;
     Route m_route;
 
-    std::vector<OSM::UniqueElement> m_gc;
-    std::vector<std::vector<OSM::Node>> m_transientNodesGC;
+    // creation epochs of the above elements, for deferred deletion
+    KOSMIndoorMap::OverlayReclaimer::Epoch m_startEpoch = 0;
+    KOSMIndoorMap::OverlayReclaimer::Epoch m_endEpoch = 0;
+    KOSMIndoorMap::OverlayReclaimer::Epoch m_routeEpoch = 0;
 };
 
 }
@@ -13,8 +13,11 @@
 #include "routingarea.h"
 #include "routingprofile.h"
 
+#include <QMutexLocker>
 #include <QThreadPool>
 
+#include <algorithm>
+
 namespace KOSMIndoorRouting {
 class RoutingJobPrivate {
 public:
@@ -30,6 +33,9 @@ public:
 
 using namespace KOSMIndoorRouting;
 
+// in meter, how far start and end positions are moved at most to reach a usable area
+constexpr inline float MAX_SNAP_DISTANCE = 25.0f;
+
 RoutingJob::RoutingJob(QObject *parent)
     : QObject(parent)
     , d(std::make_unique<RoutingJobPrivate>())
@@ -80,34 +86,63 @@ void RoutingJobPrivate::performQuery()
     const auto navMesh = NavMeshPrivate::get(m_navMesh);
     qCDebug(Log) <<m_start.x <<m_start.y << m_start.z << m_end.x << m_end.y << m_end.z;
 #if HAVE_RECAST
-    dtQueryFilter filter;
-    filter.setIncludeFlags(m_profile.flags());
-    filter.setExcludeFlags(~m_profile.flags());
-    for (int i = 1; i < AREA_TYPE_COUNT - 1; ++i) {
-        filter.setAreaCost(i, m_profile.cost(static_cast<AreaType>(i)));
-    }
-    filter.setAreaCost(RC_WALKABLE_AREA, m_profile.cost(AreaType::Walkable));
+    const auto filter = navMesh->queryFilter(m_profile);
     qCDebug(Log) << filter.getIncludeFlags() << filter.getExcludeFlags();
 
-    rcVec3 polyPickExt({ 2.0f, 4.0f, 2.0f }); // ???
-    dtPolyRef startPoly;
-    navMesh->m_navMeshQuery->findNearestPoly(m_start, polyPickExt, &filter, &startPoly, nullptr);
-    dtPolyRef endPoly;
-    navMesh->m_navMeshQuery->findNearestPoly(m_end, polyPickExt, &filter, &endPoly, nullptr);
+    // snap start and end to the closest point usable with this profile, so the polygon lookup below
+    // only needs a minimal search extent and positions off the nav mesh can still be routed from/to
+    auto start = m_start;
+    auto end = m_end;
+    const auto snapped = navMesh->snap({ m_start, m_end }, filter, MAX_SNAP_DISTANCE);
+    if (snapped[0]) {
+        start = *snapped[0];
+    }
+    if (snapped[1]) {
+        end = *snapped[1];
+    }
+    qCDebug(Log) << start.x << start.y << start.z << end.x << end.y << end.z;
+
+    // snapped positions are on a polygon, search only vertically for it
+    const rcVec3 polyPickExt{ 0.1f, 1.0f, 0.1f };
+    const rcVec3 bmin{ std::min(start.x, end.x) - polyPickExt.x, 0.0f, std::min(start.z, end.z) - polyPickExt.z };
+    const rcVec3 bmax{ std::max(start.x, end.x) + polyPickExt.x, 0.0f, std::max(start.z, end.z) + polyPickExt.z };
 
+    // with lazy tile building, start with the tiles around start and end and expand from there
+    // until no path leaving the built area could possibly be cheaper than the one found
+    auto tiles = navMesh->tileRect(bmin, bmax);
     dtPolyRef path[256];
     int pathCount = 0;
-    qCDebug(Log) <<startPoly <<endPoly;
-    auto status = navMesh->m_navMeshQuery->findPath(startPoly, endPoly, m_start, m_end, &filter, path, &pathCount, 256); // TODO
-    qCDebug(Log) << pathCount << status;
+    while (true) {
+        navMesh->ensureTiles(tiles);
+        QMutexLocker locker(&navMesh->m_mutex);
+
+        dtPolyRef startPoly = 0;
+        navMesh->m_navMeshQuery->findNearestPoly(start, polyPickExt, &filter, &startPoly, nullptr);
+        dtPolyRef endPoly = 0;
+        navMesh->m_navMeshQuery->findNearestPoly(end, polyPickExt, &filter, &endPoly, nullptr);
+
+        qCDebug(Log) <<startPoly <<endPoly << tiles;
+        auto status = navMesh->m_navMeshQuery->findPath(startPoly, endPoly, start, end, &filter, path, &pathCount, 256); // TODO
+        qCDebug(Log) << pathCount << status;
+
+        if (navMesh->m_tileStates.empty() || tiles == navMesh->allTiles()) {
+            break;
+        }
+        if (dtStatusSucceed(status) && !dtStatusDetail(status, DT_PARTIAL_RESULT) && pathCount > 0
+            && navMesh->pathCost(filter, start, end, path, pathCount) <= navMesh->leavingCostBound(tiles, start, end)) {
+            break;
+        }
+        tiles = tiles.adjusted(-1, -1, 1, 1).intersected(navMesh->allTiles());
+    }
 
+    QMutexLocker locker(&navMesh->m_mutex);
     std::vector<rcVec3> straightPath;
     straightPath.resize(256);
     std::vector<uint8_t> straightPathFlags;
     straightPathFlags.resize(256);
     int straightPathCount = 0;
     dtPolyRef straightPathPolys[256];
-    status = navMesh->m_navMeshQuery->findStraightPath(m_start, m_end, path, pathCount, (float*)straightPath.data(), straightPathFlags.data(), straightPathPolys, &straightPathCount, 256, 0);
+    const auto status = navMesh->m_navMeshQuery->findStraightPath(start, end, path, pathCount, (float*)straightPath.data(), straightPathFlags.data(), straightPathPolys, &straightPathCount, 256, 0);
     qCDebug(Log) <<straightPathCount << status;
     std::vector<RouteStep> steps;
     steps.reserve(straightPathCount);
@@ -14,6 +14,7 @@ class RoutingProfilePrivate : public QSharedData
 public:
     AreaFlags flags = ~AreaFlags{};
     std::array<float, AREA_TYPE_COUNT> costs;
+    float walkingSpeed = 1.3f; // m/s
 };
 }
 
@@ -45,7 +46,9 @@ RoutingProfile& RoutingProfile::operator=(RoutingProfile&&) noexcept = default;
 
 bool RoutingProfile::operator==(const RoutingProfile &other) const
 {
-    return d->flags == other.d->flags && std::equal(d->costs.begin(), d->costs.end(), other.d->costs.begin());
+    return d->flags == other.d->flags
+        && std::equal(d->costs.begin(), d->costs.end(), other.d->costs.begin())
+        && d->walkingSpeed == other.d->walkingSpeed;
 }
 
 AreaFlags RoutingProfile::flags() const
@@ -74,4 +77,15 @@ void RoutingProfile::setCost(KOSMIndoorRouting::AreaType area, float cost)
     }
 }
 
+float RoutingProfile::walkingSpeed() const
+{
+    return d->walkingSpeed;
+}
+
+void RoutingProfile::setWalkingSpeed(float speed)
+{
+    d.detach();
+    d->walkingSpeed = std::max(0.1f, speed);
+}
+
 #include "moc_routingprofile.cpp"
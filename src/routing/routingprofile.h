@@ -23,6 +23,7 @@ class KOSMINDOORROUTING_EXPORT RoutingProfile
 {
     Q_GADGET
     Q_PROPERTY(KOSMIndoorRouting::AreaFlags flags READ flags WRITE setFlags)
+    Q_PROPERTY(float walkingSpeed READ walkingSpeed WRITE setWalkingSpeed)
 public:
     explicit RoutingProfile();
     ~RoutingProfile();
@@ -41,6 +42,13 @@ public:
     Q_INVOKABLE [[nodiscard]] float cost(KOSMIndoorRouting::AreaType area) const;
     Q_INVOKABLE void setCost(KOSMIndoorRouting::AreaType area, float cost);
 
+    /** Walking speed in meter per second on areas with a cost factor of 1.0.
+     *  Used for converting travel costs into travel times, area cost factors
+     *  act as slow-down factors then.
+     */
+    [[nodiscard]] float walkingSpeed() const;
+    void setWalkingSpeed(float speed);
+
 private:
     QExplicitlySharedDataPointer<RoutingProfilePrivate> d;
 };
@@ -0,0 +1,112 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "tiletool.h"
+
+#include <KOSMIndoorMap/MapCSSStyle>
+#include <KOSMIndoorMap/PainterRenderer>
+#include <KOSMIndoorMap/SceneController>
+#include <KOSMIndoorMap/SceneGraph>
+#include <KOSMIndoorMap/View>
+
+#include <osm/datatypes.h>
+
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QGuiApplication>
+#include <QImage>
+#include <QImageWriter>
+#include <QPainter>
+#include <QSaveFile>
+
+using namespace Qt::Literals::StringLiterals;
+using namespace KOSMIndoorMap;
+
+namespace {
+struct RenderSettings {
+    QByteArray format;
+    int tileSize = 256;
+};
+}
+
+/** Render worker, owns all non-shareable per-thread state. */
+static void renderTiles(TileTool &tool, const RenderSettings &settings, const MapCSSStyle &style)
+{
+    View view;
+    view.setScreenSize({settings.tileSize, settings.tileSize});
+    // the viewport is constrained to the scene bounding box, so allow the entire world
+    // for tiles partially outside of the venue
+    view.setSceneBoundingBox(OSM::BoundingBox(OSM::Coordinate(-85.0511, -180.0), OSM::Coordinate(85.0511, 180.0)));
+
+    SceneController controller;
+    controller.setMapData(tool.mapData());
+    controller.setStyleSheet(&style);
+    controller.setView(&view);
+
+    SceneGraph sg;
+    PainterRenderer renderer;
+    QImage img(settings.tileSize, settings.tileSize, QImage::Format_ARGB32_Premultiplied);
+
+    while (const auto job = tool.nextJob()) {
+        view.setLevel(job->level);
+        view.setViewport(View::mapGeoToScene(job->tile.boundingBox()));
+        controller.updateScene(sg);
+
+        img.fill(Qt::transparent);
+        QPainter painter(&img);
+        renderer.setPainter(&painter);
+        renderer.render(sg, &view);
+        painter.end();
+
+        const auto fileName = tool.tilePath(*job);
+        QDir().mkpath(fileName.left(fileName.lastIndexOf('/'_L1)));
+        // write atomically, so an interrupted run doesn't leave truncated tiles behind that would be skipped on resume
+        QSaveFile f(fileName);
+        QImageWriter writer(&f, settings.format);
+        if (!f.open(QFile::WriteOnly) || !writer.write(img) || !f.commit()) {
+            qWarning() << "Failed to write tile" << fileName << f.errorString() << writer.errorString();
+            tool.finishJob(*job, TileTool::Failed);
+            continue;
+        }
+        tool.finishJob(*job, TileTool::Written);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    // we don't need a display, but we need QGuiApplication for fonts and text layouting
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    TileTool tool(parser, u"render"_s);
+    QCommandLineOption formatOpt(u"format"_s, u"tile image format"_s, u"png|webp"_s, u"png"_s);
+    parser.addOption(formatOpt);
+    QCommandLineOption tileSizeOpt(u"tile-size"_s, u"tile size in pixels"_s, u"pixels"_s, u"256"_s);
+    parser.addOption(tileSizeOpt);
+    parser.process(app);
+
+    RenderSettings settings;
+    settings.format = parser.value(formatOpt).toLatin1();
+    settings.tileSize = parser.value(tileSizeOpt).toInt();
+    if (settings.tileSize <= 0) {
+        parser.showHelp(1);
+    }
+    if (!QImageWriter::supportedImageFormats().contains(settings.format)) {
+        qCritical() << "Unsupported image format:" << settings.format;
+        return 1;
+    }
+
+    if (!tool.load(parser, QString::fromLatin1(settings.format))) {
+        return 1;
+    }
+    return tool.run([&tool, &settings](const MapCSSStyle &style) {
+        renderTiles(tool, settings, style);
+    });
+}
@@ -0,0 +1,212 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "tiletool.h"
+
+#include <KOSMIndoorMap/MapCSSLoader>
+#include <KOSMIndoorMap/MapCSSParser>
+#include <KOSMIndoorMap/MapLoader>
+
+#include <osm/datatypes.h>
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <chrono>
+#include <thread>
+
+using namespace Qt::Literals::StringLiterals;
+using namespace KOSMIndoorMap;
+
+TileTool::TileTool(QCommandLineParser &parser, const QString &action)
+    : m_fileOpt({u"f"_s, u"file"_s}, u"OSM file to "_s + action, u"file"_s)
+    , m_pointOpt({u"p"_s, u"point"_s}, action + u" area around point"_s, u"lat,lon"_s)
+    , m_outputOpt({u"o"_s, u"output"_s}, u"output path"_s, u"directory"_s)
+    , m_styleOpt({u"s"_s, u"style"_s}, u"MapCSS style sheet"_s, u"style"_s, u"breeze-light"_s)
+    , m_minZoomOpt(u"min-zoom"_s, u"lowest zoom level to "_s + action, u"z"_s, u"17"_s)
+    , m_maxZoomOpt(u"max-zoom"_s, u"highest zoom level to "_s + action, u"z"_s, u"21"_s)
+    , m_jobsOpt({u"j"_s, u"jobs"_s}, u"number of "_s + action + u" threads"_s, u"count"_s, QString::number(QThread::idealThreadCount()))
+{
+    for (const auto &opt : {m_fileOpt, m_pointOpt, m_outputOpt, m_styleOpt, m_minZoomOpt, m_maxZoomOpt, m_jobsOpt}) {
+        parser.addOption(opt);
+    }
+}
+
+TileTool::~TileTool() = default;
+
+bool TileTool::load(QCommandLineParser &parser, const QString &fileSuffix)
+{
+    m_fileSuffix = fileSuffix;
+    m_outputPath = parser.value(m_outputOpt);
+    m_minZoom = parser.value(m_minZoomOpt).toInt();
+    m_maxZoom = parser.value(m_maxZoomOpt).toInt();
+    m_threadCount = std::max(1, parser.value(m_jobsOpt).toInt());
+    if (m_outputPath.isEmpty() || m_minZoom < 0 || m_maxZoom > 24 || m_minZoom > m_maxZoom) {
+        parser.showHelp(1);
+    }
+
+    // load the venue
+    MapLoader loader;
+    QObject::connect(&loader, &MapLoader::done, QCoreApplication::instance(), &QCoreApplication::quit);
+    if (parser.isSet(m_fileOpt)) {
+        loader.loadFromFile(parser.value(m_fileOpt));
+    } else {
+        const auto coords = QStringView(parser.value(m_pointOpt)).split(QLatin1Char(','));
+        if (coords.size() != 2) {
+            qCritical() << "Invalid coordinate!";
+            return false;
+        }
+        loader.loadForCoordinate(coords[0].toDouble(), coords[1].toDouble());
+    }
+    QCoreApplication::exec();
+    if (loader.hasError()) {
+        qCritical() << "Failed to load map data:" << loader.errorMessage();
+        return false;
+    }
+    m_data = loader.takeData();
+
+    // download remote style sheet assets if needed
+    const auto styleUrl = MapCSSLoader::resolve(parser.value(m_styleOpt));
+    MapCSSLoader styleLoader(styleUrl, KOSMIndoorMap::defaultNetworkAccessManagerFactory);
+    bool styleLoaded = false;
+    QObject::connect(&styleLoader, &MapCSSLoader::finished, QCoreApplication::instance(), [&styleLoaded]() {
+        styleLoaded = true;
+        QCoreApplication::quit();
+    });
+    styleLoader.start();
+    if (!styleLoaded) {
+        QCoreApplication::exec();
+    }
+    if (styleLoader.hasError()) {
+        qCritical() << "Failed to load style sheet:" << styleLoader.errorMessage();
+        return false;
+    }
+
+    // compiling a style modifies the data set, so do this upfront for each thread here,
+    // the styles are not shared between threads as they contain lazily populated caches
+    m_styles.reserve(m_threadCount);
+    m_styles.push_back(styleLoader.takeStyle());
+    while ((int)m_styles.size() < m_threadCount) {
+        MapCSSParser p;
+        m_styles.push_back(p.parse(styleUrl));
+    }
+    for (auto &style : m_styles) {
+        style.compile(m_data.dataSet());
+    }
+
+    // determine all tiles covering the venue, on all full floor levels
+    const auto bbox = m_data.boundingBox();
+    for (const auto &level : m_data.levelMap()) {
+        if (!level.first.isFullLevel()) {
+            continue;
+        }
+        m_levels.push_back(level.first.numericLevel());
+        for (auto z = m_minZoom; z <= m_maxZoom; ++z) {
+            const auto topLeft = Tile::fromCoordinate(bbox.max.latF(), bbox.min.lonF(), z);
+            const auto bottomRight = Tile::fromCoordinate(bbox.min.latF(), bbox.max.lonF(), z);
+            for (auto x = topLeft.x; x <= bottomRight.x; ++x) {
+                for (auto y = topLeft.y; y <= bottomRight.y; ++y) {
+                    m_jobs.push_back({level.first.numericLevel(), Tile(x, y, z)});
+                }
+            }
+        }
+    }
+
+    // empty tiles don't produce a file, so we need to remember those separately for resuming
+    QDir().mkpath(m_outputPath);
+    m_emptyTilesFile.setFileName(m_outputPath + "/.empty-tiles"_L1);
+    if (m_emptyTilesFile.open(QFile::ReadOnly)) {
+        while (!m_emptyTilesFile.atEnd()) {
+            m_emptyTiles.insert(QString::fromUtf8(m_emptyTilesFile.readLine().trimmed()));
+        }
+        m_emptyTilesFile.close();
+    }
+    return true;
+}
+
+QString TileTool::tilePath(const TileJob &job) const
+{
+    return m_outputPath + '/'_L1 + QString::number(job.level) + '/'_L1 + QString::number(job.tile.z) + '/'_L1
+        + QString::number(job.tile.x) + '/'_L1 + QString::number(job.tile.y) + '.'_L1 + m_fileSuffix;
+}
+
+QString TileTool::emptyTileKey(const TileJob &job)
+{
+    return QString::number(job.level) + '/'_L1 + QString::number(job.tile.z) + '/'_L1 + QString::number(job.tile.x) + '/'_L1 + QString::number(job.tile.y);
+}
+
+const TileJob* TileTool::nextJob()
+{
+    // jobs are sorted by level and zoom, so consecutive jobs mostly reuse the scene graph
+    for (auto idx = m_nextJob++; idx < m_jobs.size(); idx = m_nextJob++) {
+        const auto &job = m_jobs[idx];
+        // m_emptyTiles is only written to in load()
+        if (QFile::exists(tilePath(job)) || m_emptyTiles.contains(emptyTileKey(job))) {
+            ++m_skipped;
+            continue;
+        }
+        return &job;
+    }
+    return nullptr;
+}
+
+void TileTool::finishJob(const TileJob &job, Result result)
+{
+    switch (result) {
+        case Written:
+            ++m_written;
+            break;
+        case Empty:
+        {
+            QMutexLocker locker(&m_emptyTilesMutex);
+            if (m_emptyTilesFile.isOpen() || m_emptyTilesFile.open(QFile::WriteOnly | QFile::Append)) {
+                // flush right away, so this survives the run being interrupted
+                m_emptyTilesFile.write(emptyTileKey(job).toUtf8() + '\n');
+                m_emptyTilesFile.flush();
+            }
+            ++m_empty;
+            break;
+        }
+        case Failed:
+            ++m_failed;
+            break;
+    }
+}
+
+int TileTool::run(const std::function<void(const MapCSSStyle &style)> &worker)
+{
+    qInfo() << "Processing" << m_jobs.size() << "tiles using" << m_threadCount << "threads";
+
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<std::thread> workers;
+    workers.reserve(m_threadCount);
+    for (const auto &style : m_styles) {
+        workers.emplace_back(worker, std::cref(style));
+    }
+
+    // progress report
+    const auto progress = [this]() {
+        return m_written + m_empty + m_skipped + m_failed;
+    };
+    while (progress() < m_jobs.size()) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        qInfo().nospace() << progress() << "/" << m_jobs.size() << " tiles (" << (progress() * 100 / std::max<std::size_t>(1, m_jobs.size())) << "%)";
+    }
+    for (auto &w : workers) {
+        w.join();
+    }
+
+    // throughput summary
+    const auto elapsed = std::max<qint64>(1, timer.elapsed());
+    qInfo().nospace() << "Wrote " << m_written << " tiles in " << elapsed << "ms (" << ((m_written + m_empty) * 1000.0 / elapsed) << " tiles/s), "
+                      << m_empty << " empty, " << m_skipped << " already existing, " << m_failed << " failed";
+    return m_failed > 0 ? 1 : 0;
+}
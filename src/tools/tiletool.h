@@ -0,0 +1,121 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef KOSMINDOORMAP_TILETOOL_H
+#define KOSMINDOORMAP_TILETOOL_H
+
+#include <KOSMIndoorMap/MapCSSStyle>
+#include <KOSMIndoorMap/MapData>
+#include <loader/tilecache_p.h>
+
+#include <QCommandLineOption>
+#include <QFile>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+class QCommandLineParser;
+
+namespace KOSMIndoorMap {
+
+struct TileJob {
+    int level;
+    Tile tile;
+};
+
+/** Shared parts of the tile pyramid generation tools.
+ *  This covers the common command line options, loading map data and style sheet,
+ *  enumerating the tiles covering the venue, distributing them over worker threads,
+ *  skipping tiles generated by a previous run, and progress and throughput reporting.
+ */
+class TileTool
+{
+public:
+    /** Result of generating a single tile. */
+    enum Result {
+        Written,
+        Empty, ///< the tile has no content, no file is written for it
+        Failed,
+    };
+
+    /** Adds the shared command line options to @p parser.
+     *  @param action verb used in the option descriptions, e.g. "render".
+     */
+    explicit TileTool(QCommandLineParser &parser, const QString &action);
+    ~TileTool();
+
+    /** Reads the shared options after @p parser processed the command line,
+     *  loads map data and style sheet and determines the tiles to generate.
+     *  @param fileSuffix file name extension of the generated tiles, without the leading dot.
+     *  @returns @c false on errors, those have been reported already.
+     */
+    [[nodiscard]] bool load(QCommandLineParser &parser, const QString &fileSuffix);
+
+    [[nodiscard]] inline const MapData& mapData() const { return m_data; }
+    [[nodiscard]] inline const QString& outputPath() const { return m_outputPath; }
+    [[nodiscard]] inline int minZoom() const { return m_minZoom; }
+    [[nodiscard]] inline int maxZoom() const { return m_maxZoom; }
+    /** All full floor levels tiles are generated for. */
+    [[nodiscard]] inline const std::vector<int>& levels() const { return m_levels; }
+
+    /** Output file name for @p job. */
+    [[nodiscard]] QString tilePath(const TileJob &job) const;
+
+    /** Returns the next tile to generate, or @c nullptr if there is none left.
+     *  Tiles written or found empty by a previous run are skipped.
+     *  Thread-safe.
+     */
+    [[nodiscard]] const TileJob* nextJob();
+    /** Records the result for @p job. Empty tiles are remembered for resuming an interrupted run.
+     *  Thread-safe.
+     */
+    void finishJob(const TileJob &job, Result result);
+
+    /** Runs @p worker on each worker thread, with its own instance of the style sheet each.
+     *  The worker is supposed to process tiles using nextJob() and finishJob() until there are none left.
+     *  @returns the process exit code.
+     */
+    [[nodiscard]] int run(const std::function<void(const MapCSSStyle &style)> &worker);
+
+private:
+    [[nodiscard]] static QString emptyTileKey(const TileJob &job);
+
+    QCommandLineOption m_fileOpt;
+    QCommandLineOption m_pointOpt;
+    QCommandLineOption m_outputOpt;
+    QCommandLineOption m_styleOpt;
+    QCommandLineOption m_minZoomOpt;
+    QCommandLineOption m_maxZoomOpt;
+    QCommandLineOption m_jobsOpt;
+    QString m_fileSuffix;
+
+    MapData m_data;
+    QString m_outputPath;
+    int m_minZoom = 0;
+    int m_maxZoom = 0;
+    int m_threadCount = 1;
+    std::vector<MapCSSStyle> m_styles;
+    std::vector<TileJob> m_jobs;
+    std::vector<int> m_levels;
+
+    // tiles found empty in previous runs
+    QSet<QString> m_emptyTiles;
+    QMutex m_emptyTilesMutex;
+    QFile m_emptyTilesFile;
+
+    std::atomic<std::size_t> m_nextJob = 0;
+    std::atomic<std::size_t> m_written = 0;
+    std::atomic<std::size_t> m_empty = 0;
+    std::atomic<std::size_t> m_skipped = 0;
+    std::atomic<std::size_t> m_failed = 0;
+};
+
+}
+
+#endif // KOSMINDOORMAP_TILETOOL_H
@@ -0,0 +1,791 @@
+/*
+    SPDX-FileCopyrightText: 2026 Volker Krause <vkrause@kde.org>
+    SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "tiletool.h"
+
+#include <KOSMIndoorMap/MapCSSStyle>
+#include <KOSMIndoorMap/SceneController>
+#include <KOSMIndoorMap/SceneGraph>
+#include <KOSMIndoorMap/View>
+#include <scene/scenegraphitem.h>
+
+#include <osm/datatypes.h>
+
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QGuiApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <zlib.h>
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+using namespace Qt::Literals::StringLiterals;
+using namespace KOSMIndoorMap;
+
+// Mapbox Vector Tile encoding, see https://github.com/mapbox/vector-tile-spec/tree/master/2.1
+// This is simple enough to not justify a dependency on libprotobuf for this.
+namespace {
+enum WireType : uint8_t {
+    Varint = 0,
+    Fixed64 = 1,
+    LengthDelimited = 2,
+};
+
+class ProtobufWriter
+{
+public:
+    void writeVarint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            data.push_back(char((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        data.push_back(char(value));
+    }
+    void writeKey(int field, WireType type)
+    {
+        writeVarint((uint64_t(field) << 3) | type);
+    }
+    void writeVarintField(int field, uint64_t value)
+    {
+        writeKey(field, Varint);
+        writeVarint(value);
+    }
+    void writeDoubleField(int field, double value)
+    {
+        writeKey(field, Fixed64);
+        const auto v = qToLittleEndian(std::bit_cast<uint64_t>(value));
+        data.append(reinterpret_cast<const char*>(&v), sizeof(v));
+    }
+    void writeBytesField(int field, QByteArrayView value)
+    {
+        writeKey(field, LengthDelimited);
+        writeVarint(value.size());
+        data.append(value);
+    }
+    void writePackedField(int field, const std::vector<uint32_t> &values)
+    {
+        ProtobufWriter packed;
+        for (const auto v : values) {
+            packed.writeVarint(v);
+        }
+        writeBytesField(field, packed.data);
+    }
+
+    QByteArray data;
+};
+
+[[nodiscard]] constexpr uint32_t zigZag(int32_t value)
+{
+    return (uint32_t(value) << 1) ^ uint32_t(value >> 31);
+}
+
+enum GeometryType : uint8_t {
+    Point = 1,
+    LineString = 2,
+    Polygon = 3,
+};
+
+enum GeometryCommand : uint8_t {
+    MoveTo = 1,
+    LineTo = 2,
+    ClosePath = 7,
+};
+
+/** Integer tile coordinate. */
+struct TilePoint {
+    int32_t x;
+    int32_t y;
+    [[nodiscard]] constexpr bool operator==(const TilePoint&) const = default;
+};
+
+/** A single MVT layer, with deduplicated property keys and values. */
+class VectorTileLayer
+{
+public:
+    explicit VectorTileLayer(const char *name) : m_name(name) {}
+
+    [[nodiscard]] inline bool isEmpty() const { return m_featureCount == 0; }
+
+    void addProperty(const char *key, const QString &value)
+    {
+        ProtobufWriter v;
+        v.writeBytesField(1, value.toUtf8());
+        addProperty(key, v.data);
+    }
+    void addProperty(const char *key, double value)
+    {
+        ProtobufWriter v;
+        v.writeDoubleField(3, value);
+        addProperty(key, v.data);
+    }
+    void addProperty(const char *key, int64_t value)
+    {
+        ProtobufWriter v;
+        v.writeVarintField(6, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+        addProperty(key, v.data);
+    }
+
+    void moveTo(TilePoint p)
+    {
+        m_geometry.push_back(command(MoveTo, 1));
+        appendPoint(p);
+    }
+    void lineTo(const TilePoint *begin, const TilePoint *end)
+    {
+        m_geometry.push_back(command(LineTo, (uint32_t)std::distance(begin, end)));
+        for (auto it = begin; it != end; ++it) {
+            appendPoint(*it);
+        }
+    }
+    void closePath()
+    {
+        m_geometry.push_back(command(ClosePath, 1));
+    }
+
+    /** Finish the current feature, or discard it if it ended up without any geometry. */
+    void commitFeature(GeometryType type)
+    {
+        if (!m_geometry.empty()) {
+            ProtobufWriter feature;
+            feature.writePackedField(2, m_tags);
+            feature.writeVarintField(3, type);
+            feature.writePackedField(4, m_geometry);
+            m_features.writeBytesField(2, feature.data);
+            ++m_featureCount;
+        }
+        m_tags.clear();
+        m_geometry.clear();
+        m_cursor = {0, 0};
+    }
+
+    void write(ProtobufWriter &tile, uint32_t extent) const
+    {
+        ProtobufWriter layer;
+        layer.writeVarintField(15, 2);
+        layer.writeBytesField(1, m_name);
+        layer.data.append(m_features.data);
+        for (const auto &key : m_keys) {
+            layer.writeBytesField(3, key);
+        }
+        for (const auto &value : m_values) {
+            layer.writeBytesField(4, value);
+        }
+        layer.writeVarintField(5, extent);
+        tile.writeBytesField(3, layer.data);
+    }
+
+    void clear()
+    {
+        m_keys.clear();
+        m_keyIndex.clear();
+        m_values.clear();
+        m_valueIndex.clear();
+        m_features.data.clear();
+        m_featureCount = 0;
+    }
+
+private:
+    [[nodiscard]] static constexpr uint32_t command(GeometryCommand cmd, uint32_t count)
+    {
+        return (cmd & 0x7) | (count << 3);
+    }
+    void appendPoint(TilePoint p)
+    {
+        m_geometry.push_back(zigZag(p.x - m_cursor.x));
+        m_geometry.push_back(zigZag(p.y - m_cursor.y));
+        m_cursor = p;
+    }
+    void addProperty(const char *key, const QByteArray &encodedValue)
+    {
+        m_tags.push_back(indexOf(m_keys, m_keyIndex, QByteArray(key)));
+        m_tags.push_back(indexOf(m_values, m_valueIndex, encodedValue));
+    }
+    [[nodiscard]] static uint32_t indexOf(std::vector<QByteArray> &table, QHash<QByteArray, uint32_t> &index, const QByteArray &value)
+    {
+        const auto it = index.constFind(value);
+        if (it != index.constEnd()) {
+            return it.value();
+        }
+        table.push_back(value);
+        index.insert(value, (uint32_t)table.size() - 1);
+        return (uint32_t)table.size() - 1;
+    }
+
+    QByteArray m_name;
+    std::vector<QByteArray> m_keys;
+    QHash<QByteArray, uint32_t> m_keyIndex;
+    std::vector<QByteArray> m_values; // encoded Value messages
+    QHash<QByteArray, uint32_t> m_valueIndex;
+    ProtobufWriter m_features;
+    std::size_t m_featureCount = 0;
+
+    // current feature
+    std::vector<uint32_t> m_tags;
+    std::vector<uint32_t> m_geometry;
+    TilePoint m_cursor = {0, 0};
+};
+
+struct ExportSettings {
+    uint32_t extent = 4096;
+    uint32_t buffer = 64;
+    bool compress = false;
+};
+
+/** Converts scene graph content of one tile to MVT geometry and properties. */
+class TileEncoder
+{
+public:
+    explicit TileEncoder(const ExportSettings &settings)
+        : m_extent(settings.extent)
+        , m_buffer(settings.buffer)
+    {}
+
+    void setTile(const QRectF &sceneRect, const View *view)
+    {
+        m_sceneRect = sceneRect;
+        m_scale = m_extent / sceneRect.width();
+        m_view = view;
+        m_clipRect = QRectF(-(double)m_buffer, -(double)m_buffer, m_extent + 2.0 * m_buffer, m_extent + 2.0 * m_buffer);
+        m_sceneClipRect = QRectF(mapFromTile(m_clipRect.topLeft()), mapFromTile(m_clipRect.bottomRight()));
+    }
+
+    void addItem(const SceneGraphItem &item)
+    {
+        if (const auto i = dynamic_cast<PolygonItem*>(item.payload.get())) {
+            addPolygon(item, i);
+        } else if (const auto i = dynamic_cast<MultiPolygonItem*>(item.payload.get())) {
+            addMultiPolygon(item, i);
+        } else if (const auto i = dynamic_cast<PolylineItem*>(item.payload.get())) {
+            addPolyline(item, i);
+        } else if (const auto i = dynamic_cast<LabelItem*>(item.payload.get())) {
+            addLabel(item, i);
+        }
+    }
+
+    /** Serialize all layers, returns an empty result if there is no content. */
+    [[nodiscard]] QByteArray write()
+    {
+        ProtobufWriter tile;
+        for (auto layer : {&m_polygons, &m_lines, &m_labels}) {
+            if (!layer->isEmpty()) {
+                layer->write(tile, m_extent);
+            }
+            layer->clear();
+        }
+        return tile.data;
+    }
+
+private:
+    [[nodiscard]] inline QPointF mapToTile(QPointF p) const
+    {
+        return (p - m_sceneRect.topLeft()) * m_scale;
+    }
+    [[nodiscard]] inline QPointF mapFromTile(QPointF p) const
+    {
+        return p / m_scale + m_sceneRect.topLeft();
+    }
+    [[nodiscard]] static inline TilePoint quantize(QPointF p)
+    {
+        return {(int32_t)std::lround(p.x()), (int32_t)std::lround(p.y())};
+    }
+
+    [[nodiscard]] double mapToPixels(double width, Unit unit) const
+    {
+        switch (unit) {
+            case Unit::Pixel:
+                return width;
+            case Unit::Meter:
+                return m_view->mapMetersToScreen(width);
+        }
+        return width;
+    }
+
+    static QString colorName(const QColor &c)
+    {
+        if (c.alpha() == 255) {
+            return c.name(QColor::HexRgb);
+        }
+        return u"rgba(%1,%2,%3,%4)"_s.arg(c.red()).arg(c.green()).arg(c.blue()).arg(c.alphaF());
+    }
+
+    void addCommonProperties(VectorTileLayer &layer, const SceneGraphItem &item) const
+    {
+        if (item.element.type() != OSM::Type::Null) {
+            layer.addProperty("osm_type", QString::fromLatin1(OSM::typeName(item.element.type())));
+            layer.addProperty("osm_id", (int64_t)item.element.id());
+        }
+        layer.addProperty("layer", (int64_t)item.layer);
+        layer.addProperty("z", (int64_t)item.payload->z);
+    }
+
+    void addPenProperties(VectorTileLayer &layer, const QPen &pen, Unit penUnit, const QPen &casingPen, Unit casingUnit) const
+    {
+        if (pen.style() != Qt::NoPen) {
+            layer.addProperty("line-color", colorName(pen.color()));
+            layer.addProperty("line-width", mapToPixels(pen.widthF(), penUnit));
+            if (pen.style() != Qt::SolidLine) {
+                QStringList dashes;
+                for (const auto d : pen.dashPattern()) {
+                    dashes.push_back(QString::number(d));
+                }
+                layer.addProperty("line-dasharray", dashes.join(','_L1));
+            }
+        }
+        if (casingPen.style() != Qt::NoPen && casingPen.widthF() > 0.0) {
+            layer.addProperty("casing-color", colorName(casingPen.color()));
+            layer.addProperty("casing-width", mapToPixels(casingPen.widthF(), casingUnit));
+        }
+    }
+
+    void addPolygonProperties(const SceneGraphItem &item, const PolygonBaseItem *p)
+    {
+        addCommonProperties(m_polygons, item);
+        if (p->fillBrush.style() != Qt::NoBrush) {
+            m_polygons.addProperty("fill-color", colorName(p->fillBrush.color()));
+        }
+        addPenProperties(m_polygons, p->pen, p->penWidthUnit, p->casingPen, p->casingPenWidthUnit);
+    }
+
+    /** Sutherland-Hodgman clipping against the buffered tile in tile coordinates,
+     *  followed by quantization and removal of degenerated segments.
+     *  Result ends up in m_ring.
+     */
+    [[nodiscard]] bool clipRing(const QPolygonF &polygon, bool needsClipping)
+    {
+        m_clipIn.clear();
+        m_clipIn.reserve(polygon.size());
+        for (const auto &p : polygon) {
+            m_clipIn.push_back(mapToTile(p));
+        }
+
+        if (needsClipping) {
+            const auto clipEdge = [this](auto inside, auto intersect) {
+                m_clipOut.clear();
+                if (m_clipIn.empty()) {
+                    return;
+                }
+                auto prev = m_clipIn.back();
+                for (const auto &cur : m_clipIn) {
+                    if (inside(cur)) {
+                        if (!inside(prev)) {
+                            m_clipOut.push_back(intersect(prev, cur));
+                        }
+                        m_clipOut.push_back(cur);
+                    } else if (inside(prev)) {
+                        m_clipOut.push_back(intersect(prev, cur));
+                    }
+                    prev = cur;
+                }
+                std::swap(m_clipIn, m_clipOut);
+            };
+            const auto atX = [](QPointF p1, QPointF p2, double x) {
+                return QPointF(x, p1.y() + (p2.y() - p1.y()) * (x - p1.x()) / (p2.x() - p1.x()));
+            };
+            const auto atY = [](QPointF p1, QPointF p2, double y) {
+                return QPointF(p1.x() + (p2.x() - p1.x()) * (y - p1.y()) / (p2.y() - p1.y()), y);
+            };
+            const auto r = m_clipRect;
+            clipEdge([r](QPointF p) { return p.x() >= r.left(); }, [&](QPointF p1, QPointF p2) { return atX(p1, p2, r.left()); });
+            clipEdge([r](QPointF p) { return p.x() <= r.right(); }, [&](QPointF p1, QPointF p2) { return atX(p1, p2, r.right()); });
+            clipEdge([r](QPointF p) { return p.y() >= r.top(); }, [&](QPointF p1, QPointF p2) { return atY(p1, p2, r.top()); });
+            clipEdge([r](QPointF p) { return p.y() <= r.bottom(); }, [&](QPointF p1, QPointF p2) { return atY(p1, p2, r.bottom()); });
+        }
+
+        m_ring.clear();
+        for (const auto &p : m_clipIn) {
+            const auto q = quantize(p);
+            if (m_ring.empty() || m_ring.back() != q) {
+                m_ring.push_back(q);
+            }
+        }
+        while (m_ring.size() > 1 && m_ring.front() == m_ring.back()) {
+            m_ring.pop_back();
+        }
+        return m_ring.size() >= 3 && ringArea() != 0;
+    }
+
+    /** Twice the signed area of m_ring, positive for clockwise rings in tile coordinates (y pointing down). */
+    [[nodiscard]] int64_t ringArea() const
+    {
+        int64_t area = 0;
+        auto prev = m_ring.back();
+        for (const auto &p : m_ring) {
+            area += (int64_t)prev.x * p.y - (int64_t)p.x * prev.y;
+            prev = p;
+        }
+        return area;
+    }
+
+    /** Appends m_ring as exterior (clockwise) or interior (counter-clockwise) ring. */
+    void writeRing(bool exterior)
+    {
+        if ((ringArea() > 0) != exterior) {
+            std::reverse(m_ring.begin(), m_ring.end());
+        }
+        m_polygons.moveTo(m_ring.front());
+        m_polygons.lineTo(m_ring.data() + 1, m_ring.data() + m_ring.size());
+        m_polygons.closePath();
+    }
+
+    void addPolygon(const SceneGraphItem &item, const PolygonItem *p)
+    {
+        const auto bbox = p->polygon.boundingRect();
+        if (!m_sceneClipRect.intersects(bbox)) {
+            return;
+        }
+        if (!clipRing(p->polygon, !m_sceneClipRect.contains(bbox))) {
+            return;
+        }
+        addPolygonProperties(item, p);
+        writeRing(true);
+        m_polygons.commitFeature(Polygon);
+    }
+
+    void addMultiPolygon(const SceneGraphItem &item, const MultiPolygonItem *p)
+    {
+        const auto bbox = p->path.boundingRect();
+        if (!m_sceneClipRect.intersects(bbox)) {
+            return;
+        }
+        const auto needsClipping = !m_sceneClipRect.contains(bbox);
+
+        // MVT needs interior rings directly following their exterior ring, so reconstruct the nesting
+        const auto rings = p->path.toSubpathPolygons();
+        std::vector<int> depth(rings.size(), 0);
+        std::vector<int> parent(rings.size(), -1);
+        for (qsizetype i = 0; i < rings.size(); ++i) {
+            if (rings[i].isEmpty()) {
+                continue;
+            }
+            for (qsizetype j = 0; j < rings.size(); ++j) {
+                if (i != j && rings[j].size() >= 3 && rings[j].boundingRect().contains(rings[i].front()) && rings[j].containsPoint(rings[i].front(), Qt::OddEvenFill)) {
+                    ++depth[i];
+                }
+            }
+        }
+        for (qsizetype i = 0; i < rings.size(); ++i) {
+            if (depth[i] % 2 == 0 || rings[i].isEmpty()) {
+                continue;
+            }
+            for (qsizetype j = 0; j < rings.size(); ++j) {
+                if (depth[j] == depth[i] - 1 && rings[j].size() >= 3 && rings[j].containsPoint(rings[i].front(), Qt::OddEvenFill)) {
+                    parent[i] = (int)j;
+                    break;
+                }
+            }
+        }
+
+        addPolygonProperties(item, p);
+        for (qsizetype i = 0; i < rings.size(); ++i) {
+            if (depth[i] % 2 != 0) {
+                continue;
+            }
+            if (!clipRing(rings[i], needsClipping)) {
+                continue;
+            }
+            writeRing(true);
+            for (qsizetype j = 0; j < rings.size(); ++j) {
+                if (parent[j] == i && clipRing(rings[j], needsClipping)) {
+                    writeRing(false);
+                }
+            }
+        }
+        m_polygons.commitFeature(Polygon);
+    }
+
+    /** Liang-Barsky clipping of a single segment against the buffered tile. */
+    [[nodiscard]] bool clipSegment(QPointF &p1, QPointF &p2) const
+    {
+        const auto dx = p2.x() - p1.x();
+        const auto dy = p2.y() - p1.y();
+        double t0 = 0.0;
+        double t1 = 1.0;
+        const auto clip = [&t0, &t1](double p, double q) {
+            if (p == 0.0) {
+                return q >= 0.0;
+            }
+            const auto t = q / p;
+            if (p < 0.0) {
+                if (t > t1) { return false; }
+                t0 = std::max(t0, t);
+            } else {
+                if (t < t0) { return false; }
+                t1 = std::min(t1, t);
+            }
+            return true;
+        };
+        if (!clip(-dx, p1.x() - m_clipRect.left()) || !clip(dx, m_clipRect.right() - p1.x())
+         || !clip(-dy, p1.y() - m_clipRect.top()) || !clip(dy, m_clipRect.bottom() - p1.y())) {
+            return false;
+        }
+        const auto start = p1;
+        p1 = start + QPointF(dx, dy) * t0;
+        p2 = start + QPointF(dx, dy) * t1;
+        return true;
+    }
+
+    void flushLine()
+    {
+        if (m_ring.size() >= 2) {
+            m_lines.moveTo(m_ring.front());
+            m_lines.lineTo(m_ring.data() + 1, m_ring.data() + m_ring.size());
+        }
+        m_ring.clear();
+    }
+
+    void addPolyline(const SceneGraphItem &item, const PolylineItem *p)
+    {
+        if (p->path.size() < 2) {
+            return;
+        }
+        const auto bbox = p->path.boundingRect();
+        if (!m_sceneClipRect.intersects(bbox)) {
+            return;
+        }
+        const auto needsClipping = !m_sceneClipRect.contains(bbox);
+
+        addCommonProperties(m_lines, item);
+        addPenProperties(m_lines, p->pen, p->penWidthUnit, p->casingPen, p->casingPenWidthUnit);
+
+        // clipping can split a line into several parts
+        m_ring.clear();
+        auto prev = mapToTile(p->path.front());
+        for (qsizetype i = 1; i < p->path.size(); ++i) {
+            const auto cur = mapToTile(p->path[i]);
+            auto p1 = prev;
+            auto p2 = cur;
+            prev = cur;
+            if (needsClipping && !clipSegment(p1, p2)) {
+                flushLine();
+                continue;
+            }
+            const auto q1 = quantize(p1);
+            if (m_ring.empty() || m_ring.back() != q1) {
+                flushLine();
+                m_ring.push_back(q1);
+            }
+            const auto q2 = quantize(p2);
+            if (m_ring.back() != q2) {
+                m_ring.push_back(q2);
+            }
+        }
+        flushLine();
+        m_lines.commitFeature(LineString);
+    }
+
+    void addLabel(const SceneGraphItem &item, const LabelItem *l)
+    {
+        if (!m_sceneClipRect.contains(l->pos)) {
+            return;
+        }
+
+        addCommonProperties(m_labels, item);
+        if (l->hasText() && !l->textHidden) {
+            m_labels.addProperty("text", l->text.text());
+            m_labels.addProperty("text-color", colorName(l->color));
+            m_labels.addProperty("font-size", l->font.pixelSize() > 0 ? (double)l->font.pixelSize() : l->font.pointSizeF());
+            if (l->font.bold()) {
+                m_labels.addProperty("font-weight", u"bold"_s);
+            }
+            if (l->font.italic()) {
+                m_labels.addProperty("font-style", u"italic"_s);
+            }
+            if (l->haloRadius > 0.0 && l->haloColor.alpha() > 0) {
+                m_labels.addProperty("text-halo-color", colorName(l->haloColor));
+                m_labels.addProperty("text-halo-radius", l->haloRadius);
+            }
+            if (l->textOffset != 0.0) {
+                m_labels.addProperty("text-offset", l->textOffset);
+            }
+        }
+        if (l->hasIcon() && !l->iconHidden) {
+            if (!l->icon.name().isEmpty()) {
+                m_labels.addProperty("icon-image", l->icon.name());
+            }
+            m_labels.addProperty("icon-width", mapToPixels(l->iconSize.width(), l->iconWidthUnit));
+            m_labels.addProperty("icon-height", mapToPixels(l->iconSize.height(), l->iconHeightUnit));
+            if (l->iconOpacity < 1.0) {
+                m_labels.addProperty("icon-opacity", l->iconOpacity);
+            }
+        }
+        if (l->hasShield()) {
+            m_labels.addProperty("shield-color", colorName(l->shieldColor));
+        }
+        if (l->angle != 0.0) {
+            m_labels.addProperty("angle", l->angle);
+        }
+        m_labels.moveTo(quantize(mapToTile(l->pos)));
+        m_labels.commitFeature(Point);
+    }
+
+    uint32_t m_extent;
+    uint32_t m_buffer;
+    QRectF m_sceneRect;
+    QRectF m_sceneClipRect;
+    QRectF m_clipRect;
+    double m_scale = 1.0;
+    const View *m_view = nullptr;
+
+    VectorTileLayer m_polygons{"polygons"};
+    VectorTileLayer m_lines{"lines"};
+    VectorTileLayer m_labels{"labels"};
+
+    // scratch buffers, reused to avoid allocations per item
+    std::vector<QPointF> m_clipIn;
+    std::vector<QPointF> m_clipOut;
+    std::vector<TilePoint> m_ring;
+};
+}
+
+[[nodiscard]] static QByteArray gzipCompress(const QByteArray &data)
+{
+    z_stream zStream;
+    std::memset(&zStream, 0, sizeof(zStream));
+    // window bits + 16 selects the gzip format, which is what HTTP clients expect for Content-Encoding: gzip
+    if (deflateInit2(&zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return {};
+    }
+    QByteArray result;
+    result.resize((qsizetype)deflateBound(&zStream, data.size()));
+    zStream.next_in = (uint8_t*)data.constData();
+    zStream.avail_in = data.size();
+    zStream.next_out = (uint8_t*)result.data();
+    zStream.avail_out = result.size();
+    const auto ret = deflate(&zStream, Z_FINISH);
+    result.resize(ret == Z_STREAM_END ? result.size() - zStream.avail_out : 0);
+    deflateEnd(&zStream);
+    return result;
+}
+
+/** Export worker, owns all non-shareable per-thread state. */
+static void exportTiles(TileTool &tool, const ExportSettings &settings, const MapCSSStyle &style)
+{
+    View view;
+    // MVT clients assume 256px tiles for pixel sizes
+    view.setScreenSize({256, 256});
+    // the viewport is constrained to the scene bounding box, so allow the entire world
+    // for tiles partially outside of the venue
+    view.setSceneBoundingBox(OSM::BoundingBox(OSM::Coordinate(-85.0511, -180.0), OSM::Coordinate(85.0511, 180.0)));
+
+    SceneController controller;
+    controller.setMapData(tool.mapData());
+    controller.setStyleSheet(&style);
+    controller.setView(&view);
+
+    SceneGraph sg;
+    TileEncoder encoder(settings);
+
+    while (const auto job = tool.nextJob()) {
+        const auto sceneRect = View::mapGeoToScene(job->tile.boundingBox());
+        view.setLevel(job->level);
+        view.setViewport(sceneRect);
+        controller.updateScene(sg);
+
+        encoder.setTile(sceneRect, &view);
+        for (const auto &item : sg.items()) {
+            if (item.payload) {
+                encoder.addItem(item);
+            }
+        }
+        auto data = encoder.write();
+        if (data.isEmpty()) {
+            tool.finishJob(*job, TileTool::Empty);
+            continue;
+        }
+        if (settings.compress) {
+            data = gzipCompress(data);
+        }
+
+        const auto fileName = tool.tilePath(*job);
+        QDir().mkpath(fileName.left(fileName.lastIndexOf('/'_L1)));
+        // write atomically, so an interrupted run doesn't leave truncated tiles behind that would be skipped on resume
+        QSaveFile f(fileName);
+        if (data.isEmpty() || !f.open(QFile::WriteOnly) || f.write(data) != data.size() || !f.commit()) {
+            qWarning() << "Failed to write tile" << fileName << f.errorString();
+            tool.finishJob(*job, TileTool::Failed);
+            continue;
+        }
+        tool.finishJob(*job, TileTool::Written);
+    }
+}
+
+/** TileJSON-like description of the exported tile set. */
+static bool writeMetadata(const TileTool &tool, const ExportSettings &settings)
+{
+    const auto bbox = tool.mapData().boundingBox();
+    QJsonArray levelArray;
+    for (const auto level : tool.levels()) {
+        levelArray.push_back(level);
+    }
+    QJsonArray layers;
+    for (const auto layer : {"polygons"_L1, "lines"_L1, "labels"_L1}) {
+        layers.push_back(QJsonObject{{"id"_L1, layer}});
+    }
+    const QJsonObject metadata{
+        {"format"_L1, "pbf"_L1},
+        {"tiles"_L1, u"{level}/{z}/{x}/{y}.mvt"_s},
+        {"compression"_L1, settings.compress ? "gzip"_L1 : "none"_L1},
+        {"extent"_L1, (int)settings.extent},
+        {"minzoom"_L1, tool.minZoom()},
+        {"maxzoom"_L1, tool.maxZoom()},
+        {"bounds"_L1, QJsonArray{bbox.min.lonF(), bbox.min.latF(), bbox.max.lonF(), bbox.max.latF()}},
+        {"levels"_L1, levelArray},
+        {"vector_layers"_L1, layers},
+    };
+
+    QDir().mkpath(tool.outputPath());
+    QSaveFile f(tool.outputPath() + "/metadata.json"_L1);
+    if (!f.open(QFile::WriteOnly)) {
+        qCritical() << f.errorString();
+        return false;
+    }
+    f.write(QJsonDocument(metadata).toJson());
+    return f.commit();
+}
+
+int main(int argc, char **argv)
+{
+    // we don't need a display, but we need QGuiApplication for fonts and text layouting
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    TileTool tool(parser, u"export"_s);
+    QCommandLineOption extentOpt(u"extent"_s, u"tile coordinate extent"_s, u"units"_s, u"4096"_s);
+    parser.addOption(extentOpt);
+    QCommandLineOption bufferOpt(u"buffer"_s, u"geometry buffer around tiles"_s, u"units"_s, u"64"_s);
+    parser.addOption(bufferOpt);
+    QCommandLineOption gzipOpt(u"gzip"_s, u"gzip-compress tiles"_s);
+    parser.addOption(gzipOpt);
+    parser.process(app);
+
+    ExportSettings settings;
+    settings.extent = parser.value(extentOpt).toUInt();
+    settings.buffer = parser.value(bufferOpt).toUInt();
+    settings.compress = parser.isSet(gzipOpt);
+    if (settings.extent == 0 || settings.buffer >= settings.extent) {
+        parser.showHelp(1);
+    }
+
+    if (!tool.load(parser, u"mvt"_s) || !writeMetadata(tool, settings)) {
+        return 1;
+    }
+    return tool.run([&tool, &settings](const MapCSSStyle &style) {
+        exportTiles(tool, settings, style);
+    });
+}
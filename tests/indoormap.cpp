@@ -63,6 +63,16 @@ MapWidget::MapWidget(QWidget* parent)
 {
     m_view.setScreenSize(size());
     m_controller.setView(&m_view);
+    m_controller.setAsyncTextureLoading(this, [this]() {
+        // only repaint the area of the items that were waiting for the texture
+        m_controller.updateScene(m_sg);
+        if (m_controller.hasFullDamage()) {
+            update();
+        } else if (const auto damage = m_controller.damage(); !damage.isEmpty()) {
+            update(damage);
+        }
+        m_controller.resetDamage();
+    });
 }
 
 void MapWidget::paintEvent(QPaintEvent *event)
@@ -71,6 +81,7 @@ void MapWidget::paintEvent(QPaintEvent *event)
     QPainter p(this);
     m_renderer.setPainter(&p);
     m_renderer.render(m_sg, &m_view);
+    m_controller.resetDamage();
     return QWidget::paintEvent(event);
 }
 
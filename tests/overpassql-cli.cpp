@@ -36,6 +36,8 @@ int main(int argc, char **argv)
     parser.addOption(minTileSizeOption);
     QCommandLineOption outFileOption( { S("o"), S("output") }, S("Output file name"), S("out"));
     parser.addOption(outFileOption);
+    QCommandLineOption reloadOption({ S("r"), S("reload") }, S("Bypass cached results"));
+    parser.addOption(reloadOption);
     parser.process(app);
 
     OSM::OverpassQueryManager mgr;
@@ -103,7 +105,11 @@ int main(int argc, char **argv)
 
         app.quit();
     });
-    mgr.execute(&query);
+    if (parser.isSet(reloadOption)) {
+        mgr.reload(&query);
+    } else {
+        mgr.execute(&query);
+    }
 
     return app.exec();
 }